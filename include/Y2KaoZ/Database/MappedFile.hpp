@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+namespace Y2KaoZ::Database {
+
+/// @brief A read-only memory mapping of a whole file, advised for sequential access.
+class Y2KAOZDATABASE_EXPORT MappedFile {
+public:
+  MappedFile() = delete;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  auto operator=(const MappedFile&) -> MappedFile& = delete;
+  auto operator=(MappedFile&&) -> MappedFile& = delete;
+
+  /// @brief Maps the file
+  /// @throws std::system_error if the file can not be opened or mapped
+  explicit MappedFile(const std::filesystem::path& path);
+  ~MappedFile();
+
+  /// @brief Returns the first byte of the file, nullptr for an empty file
+  [[nodiscard]] auto data() const noexcept -> const char*;
+
+  /// @brief Returns the size of the file in bytes
+  [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+  /// @brief Returns the whole file as characters
+  [[nodiscard]] auto view() const noexcept -> std::string_view;
+
+  /// @brief Lets the kernel drop the pages before offset, which will not be read again, from memory
+  void release(std::size_t offset) noexcept;
+
+private:
+  char* data_ = nullptr;
+  std::size_t size_ = 0;
+  std::size_t released_ = 0;
+};
+
+} // namespace Y2KaoZ::Database
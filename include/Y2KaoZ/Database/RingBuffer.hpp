@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace Y2KaoZ::Database {
+
+/// @brief A bounded lock-free multi-producer multi-consumer queue (Vyukov's sequence-number ring).
+/// @note The capacity is rounded up to a power of two, T must be default constructible.
+template <typename T>
+class RingBuffer {
+public:
+  RingBuffer() = delete;
+  RingBuffer(const RingBuffer&) = delete;
+  RingBuffer(RingBuffer&&) = delete;
+  auto operator=(const RingBuffer&) -> RingBuffer& = delete;
+  auto operator=(RingBuffer&&) -> RingBuffer& = delete;
+  ~RingBuffer() = default;
+
+  explicit RingBuffer(std::size_t capacity)
+    : cells_(std::bit_ceil(capacity < 2 ? 2 : capacity))
+    , mask_(cells_.size() - 1) {
+    for (std::size_t i = 0; i < cells_.size(); ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  /// @brief Returns the maximum number of elements in the ring
+  [[nodiscard]] auto capacity() const noexcept -> std::size_t {
+    return cells_.size();
+  }
+
+  /// @brief Returns an approximation of the number of elements in the ring
+  [[nodiscard]] auto size() const noexcept -> std::size_t {
+    auto enqueued = enqueue_.load(std::memory_order_relaxed);
+    auto dequeued = dequeue_.load(std::memory_order_relaxed);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+  }
+
+  /// @brief Moves value into the ring, returns false (leaving value untouched) if the ring is full
+  [[nodiscard]] auto tryPush(T&& value) -> bool {
+    auto position = enqueue_.load(std::memory_order_relaxed);
+    for (;;) {
+      auto& cell = cells_[position & mask_];
+      auto sequence = cell.sequence.load(std::memory_order_acquire);
+      if (sequence == position) {
+        if (enqueue_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          cell.value = std::move(value);
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (sequence < position) {
+        return false;
+      } else {
+        position = enqueue_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// @brief Copies value into the ring, returns false if the ring is full
+  [[nodiscard]] auto tryPush(const T& value) -> bool {
+    T copy = value;
+    return tryPush(std::move(copy));
+  }
+
+  /// @brief Removes the oldest element of the ring, returns an empty optional if the ring is empty
+  [[nodiscard]] auto tryPop() -> std::optional<T> {
+    auto position = dequeue_.load(std::memory_order_relaxed);
+    for (;;) {
+      auto& cell = cells_[position & mask_];
+      auto sequence = cell.sequence.load(std::memory_order_acquire);
+      if (sequence == position + 1) {
+        if (dequeue_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          std::optional<T> result{std::move(cell.value)};
+          cell.value = T{};
+          cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+          return result;
+        }
+      } else if (sequence < position + 1) {
+        return {};
+      } else {
+        position = dequeue_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+private:
+  static constexpr std::size_t CACHE_LINE = 64;
+  struct Cell {
+    std::atomic<std::size_t> sequence;
+    T value;
+  };
+  std::vector<Cell> cells_;
+  std::size_t mask_;
+  alignas(CACHE_LINE) std::atomic<std::size_t> enqueue_{0};
+  alignas(CACHE_LINE) std::atomic<std::size_t> dequeue_{0};
+};
+
+} // namespace Y2KaoZ::Database
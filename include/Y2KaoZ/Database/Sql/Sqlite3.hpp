@@ -1,4 +1,26 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/ArrowExport.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/CancellationToken.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/ChangeFeed.hpp"
 #include "Y2KaoZ/Database/Sql/Sqlite3/Connection.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Csv.hpp"
 #include "Y2KaoZ/Database/Sql/Sqlite3/Exception.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/FullTextIndex.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Json.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/KeyFilter.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/KvStore.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/MaintenanceScheduler.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Memory.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/PageCache.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/PagedQuery.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/ParallelScan.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/PrefetchingReader.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/QueryPlan.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Recorder.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Replay.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/ResultCache.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Session.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/ShardedDatabase.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/SizeClassAllocator.hpp"
 #include "Y2KaoZ/Database/Sql/Sqlite3/Statement.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/StatsVfs.hpp"
 #include "Y2KaoZ/Database/Sql/Sqlite3/Transaction.hpp"
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Arrow.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Statement.hpp"
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <cstddef>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief Exports the remaining rows of the executed statement through the Arrow C stream interface.
+/// @note schema receives a struct of one nullable field per column: int64 ("l"), float64 ("g"), utf8 ("u") or binary
+/// ("z"). The type comes from the declared type of the column when it has an INTEGER, REAL, TEXT or BLOB affinity, and
+/// otherwise from the value of the current row; other values are converted with the rules of sqlite3_column_*. Every
+/// get_next reads up to batchSize rows straight into the buffers of a record batch, which are handed over without
+/// copies, a batch ends earlier if its utf8 or binary data would exceed the 32 bit offsets. The statement must outlive
+/// the stream and not be used until it is released. Both structures are released by the consumer.
+Y2KAOZDATABASE_EXPORT void exportArrow(
+  Statement& statement,
+  ArrowSchema* schema,
+  ArrowArrayStream* stream,
+  std::size_t batchSize = Statement::ARROW_BATCH_SIZE);
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
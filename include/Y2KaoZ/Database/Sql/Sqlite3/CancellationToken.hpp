@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <atomic>
+#include <memory>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief A flag shared by its copies, set from any thread to cancel the statements it is attached to.
+/// @note Statements notice the cancellation within the VM steps set by Statement::setProgressSteps and throw an
+/// InterruptedException. Use Connection::interrupt to stop the statements of a connection without waiting.
+class Y2KAOZDATABASE_EXPORT CancellationToken {
+public:
+  CancellationToken();
+
+  /// @brief Requests the cancellation of every statement using this token or a copy of it
+  void cancel() noexcept;
+
+  /// @brief Returns true once cancel has been called
+  [[nodiscard]] auto cancelled() const noexcept -> bool;
+
+  /// @brief Clears the cancellation so that the token can be used again
+  void reset() noexcept;
+
+private:
+  std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Y2KaoZ/Database/RingBuffer.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Connection.hpp"
+#include "Y2KaoZ/Database/Types.hpp"
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief A committed row change.
+struct Y2KAOZDATABASE_EXPORT ChangeEvent {
+  RowChange change = RowChange::Insert;
+  std::string database;
+  std::string table;
+  /// @brief The rowid after the change, or before it for deletes.
+  std::int64_t rowid = 0;
+  /// @brief The row before an update or delete, only available with the preupdate hook.
+  std::optional<ResultVector> oldValues;
+  /// @brief The row after an insert or update, only available with the preupdate hook.
+  std::optional<ResultVector> newValues;
+};
+
+/// @brief Buffers the row changes of each transaction and publishes them on commit into a bounded lock-free ring.
+/// @note Changes of rolled back transactions are discarded, as well as those undone by ROLLBACK TO a savepoint or by
+/// a failed statement (run by Statement, Connection::execute or executeFile). When the ring is full the writer never
+/// blocks, the events that do not fit are dropped and counted instead.
+class Y2KAOZDATABASE_EXPORT ChangeFeed {
+public:
+  static constexpr std::size_t DEFAULT_CAPACITY = 4096;
+
+  ChangeFeed() = delete;
+  ChangeFeed(const ChangeFeed&) = delete;
+  ChangeFeed(ChangeFeed&& other) noexcept = default;
+  auto operator=(const ChangeFeed&) -> ChangeFeed& = delete;
+  auto operator=(ChangeFeed&&) -> ChangeFeed& = delete;
+
+  /// @brief Starts recording the changes made through connection
+  explicit ChangeFeed(Connection connection, std::size_t capacity = DEFAULT_CAPACITY);
+
+  /// @brief Stops recording changes
+  ~ChangeFeed();
+
+  /// @brief Returns the capacity of the ring
+  [[nodiscard]] auto capacity() const noexcept -> std::size_t;
+
+  /// @brief Returns the number of committed events that did not fit in the ring
+  [[nodiscard]] auto dropped() const noexcept -> std::uint64_t;
+
+  /// @brief Returns the oldest committed event, without blocking the writer. Safe to call from any thread.
+  [[nodiscard]] auto tryPop() -> std::optional<ChangeEvent>;
+
+  /// @brief Returns up to max committed events, without blocking the writer. Safe to call from any thread.
+  [[nodiscard]] auto drain(std::size_t max = std::numeric_limits<std::size_t>::max()) -> std::vector<ChangeEvent>;
+
+private:
+  struct State {
+    explicit State(Connection c, std::size_t capacity);
+
+    // Undoes the pending events of the savepoints rolled back to.
+    void onSavepoint(SavepointChange change, std::string_view name);
+
+    Connection connection;
+    std::vector<ChangeEvent> pending;
+    // The open savepoints and the number of pending events when they began.
+    std::vector<std::pair<std::string, std::size_t>> savepoints;
+    // The number of pending events when the last statement started.
+    std::size_t statementMark = 0;
+    RingBuffer<ChangeEvent> ring;
+    std::atomic<std::uint64_t> dropped{0};
+    std::vector<Connection::HookId> hooks;
+  };
+  std::unique_ptr<State> state_;
+};
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
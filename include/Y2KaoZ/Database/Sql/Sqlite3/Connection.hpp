@@ -2,43 +2,218 @@
 
 #include "Y2KaoZ/Database/Visibility.hpp"
 #include <filesystem>
+#include <functional>
 #include <gsl/pointers>
+#include <memory>
 #include <sqlite3.h>
+#include <string>
 
 namespace Y2KaoZ::Database::Sql::Sqlite3 {
 
+class ChangeFeed;
+class Recorder;
 class Transaction;
 class Statement;
 
+/// @brief How far the execution of an SQL script went.
+struct Y2KAOZDATABASE_EXPORT ScriptProgress {
+  std::uint64_t bytes = 0;      ///< bytes of the script consumed
+  std::uint64_t totalBytes = 0; ///< size of the script
+  std::uint64_t statements = 0; ///< statements executed
+};
+
+/// @brief Controls how an SQL script is executed.
+struct Y2KAOZDATABASE_EXPORT ScriptOptions {
+  static constexpr std::size_t DEFAULT_BATCH_SIZE = 1000;
+  /// Number of statements committed together in a transaction, 0 lets every statement commit on its own.
+  std::size_t batchSize = DEFAULT_BATCH_SIZE;
+  /// Called every batchSize statements and once at the end.
+  std::function<void(const ScriptProgress&)> progress;
+};
+
+/// @brief Memory used by a connection and by sqlite as a whole, in bytes unless stated otherwise.
+/// @note The process wide counters need SQLITE_CONFIG_MEMSTATUS, which is enabled by default.
+struct Y2KAOZDATABASE_EXPORT MemoryStats {
+  // This connection
+  std::int64_t cacheUsed = 0;          ///< page cache, shared caches included
+  std::int64_t cacheUsedShared = 0;    ///< page cache, shared caches divided among their connections
+  std::int64_t schemaUsed = 0;         ///< parsed schemas
+  std::int64_t statementUsed = 0;      ///< prepared statements
+  std::int64_t lookasideUsed = 0;      ///< lookaside slots in use
+  std::int64_t lookasideHits = 0;      ///< allocations served by lookaside
+  std::int64_t lookasideMissSize = 0;  ///< allocations too large for a lookaside slot
+  std::int64_t lookasideMissFull = 0;  ///< allocations made while every lookaside slot was taken
+  std::int64_t cacheHits = 0;          ///< page cache hits
+  std::int64_t cacheMisses = 0;        ///< page cache misses
+  std::int64_t cacheWrites = 0;        ///< dirty pages written
+  std::int64_t cacheSpills = 0;        ///< dirty pages written in the middle of a transaction
+  // The whole process
+  std::int64_t memoryUsed = 0;         ///< memory currently allocated by sqlite
+  std::int64_t memoryHighwater = 0;    ///< the highest value of memoryUsed
+  std::int64_t mallocCount = 0;        ///< allocations currently outstanding
+  std::int64_t largestAllocation = 0;  ///< the largest allocation requested
+  std::int64_t pageCacheOverflow = 0;  ///< page cache bytes that did not fit in SQLITE_CONFIG_PAGECACHE memory
+  std::int64_t softHeapLimit = 0;      ///< 0 when there is none
+};
+
+/// @brief The kind of change made to a row.
+enum class RowChange : std::uint8_t
+{
+  Insert = 0,
+  Update,
+  Delete
+};
+
+/// @brief A savepoint boundary reported to a savepoint hook.
+/// @note Every statement is also reported as a savepoint without a name: Begin when it starts running, RollbackTo
+/// when it failed and its changes were undone. Statements that succeed are not released explicitly.
+enum class SavepointChange : std::uint8_t
+{
+  Begin = 0, ///< SAVEPOINT name is run, or a statement starts
+  Release,   ///< RELEASE name is run, the changes since the savepoint join the enclosing one
+  RollbackTo ///< ROLLBACK TO name is run, or a statement failed: the changes since the savepoint are undone
+};
+
 class Y2KAOZDATABASE_EXPORT Connection {
 public:
-  static const std::uint32_t OPEN_READWRITE = SQLITE_OPEN_READWRITE;
-  static const std::uint32_t OPEN_CREATE = SQLITE_OPEN_CREATE;
+  using HookId = std::size_t;
+  using UpdateHook =
+    std::function<void(RowChange change, std::string_view database, std::string_view table, std::int64_t rowid)>;
+  using CommitHook = std::function<void()>;
+  using RollbackHook = std::function<void()>;
+  using SavepointHook = std::function<void(SavepointChange change, std::string_view name)>;
+  /// @note Returning true interrupts the running statement, which fails with SQLITE_INTERRUPT.
+  using ProgressHook = std::function<bool()>;
+  /// @note Returns SQLITE_OK to allow the action, SQLITE_IGNORE or SQLITE_DENY, see sqlite3_set_authorizer. The
+  /// names sqlite does not provide for the action are empty.
+  using Authorizer = std::function<int(
+    int action,
+    std::string_view first,
+    std::string_view second,
+    std::string_view database,
+    std::string_view trigger)>;
+#ifdef SQLITE_ENABLE_PREUPDATE_HOOK
+  /// @note sqlite3_preupdate_old/new/count/depth may be called on backend() from inside the hook.
+  using PreUpdateHook = std::function<void(
+    RowChange change,
+    std::string_view database,
+    std::string_view table,
+    std::int64_t oldRowid,
+    std::int64_t newRowid)>;
+#endif
+
+  static constexpr std::uint32_t OPEN_READONLY = SQLITE_OPEN_READONLY;
+  static constexpr std::uint32_t OPEN_READWRITE = SQLITE_OPEN_READWRITE;
+  static constexpr std::uint32_t OPEN_CREATE = SQLITE_OPEN_CREATE;
   /// A private, temporary in-memory database is created for the connection.
   Connection();
 
-  /// Opens the database in filename for the connection.
-  explicit Connection(const std::filesystem::path& filename, std::uint32_t flags = OPEN_READWRITE | OPEN_CREATE);
+  /// Opens the database in filename for the connection, through the VFS registered as vfs or the default one.
+  explicit Connection(
+    const std::filesystem::path& filename,
+    std::uint32_t flags = OPEN_READWRITE | OPEN_CREATE,
+    const std::string& vfs = {});
+
+  /// @brief Quotes an SQL identifier (table, column or schema name) so it can be embedded in a statement
+  [[nodiscard]] static auto quoteIdentifier(std::string_view identifier) -> std::string;
 
   /// @brief Returns the raw sqlite3 backend pointer
   [[nodiscard]] auto backend() const -> gsl::not_null<sqlite3*>;
 
+  /// @brief Returns the filename of the main database, empty for temporary or in-memory databases
+  [[nodiscard]] auto filename() const -> std::filesystem::path;
+
   /// @brief Executes semicolon-separated SQL statements
   void execute(std::string_view statements) const;
 
+  /// @brief Executes the SQL script in path, memory mapped and walked one statement at a time in constant memory
+  /// @note Unless the script controls its own transactions, statements are committed in batches of
+  /// options.batchSize. Transaction control statements, ATTACH, DETACH, VACUUM and PRAGMA end the current batch and
+  /// run on their own. If a statement fails its batch is rolled back, the batches before it stay committed. The script
+  /// is not recorded (see record): a recorder keeps every SQL text it logs in memory, which would defeat the point.
+  auto executeFile(const std::filesystem::path& path, const ScriptOptions& options = {}) const -> ScriptProgress;
+
   /// @brief Returns the number of rows affected by the last SQL statement
   [[nodiscard]] auto rowCount() const -> std::size_t;
 
   /// @brief Returns the ID of the last inserted row or sequence value
   [[nodiscard]] auto lastInsertRowId() const -> std::int64_t;
 
+  /// @brief Stops the statements running on the connection as soon as possible, they throw InterruptedException
+  /// @note Unlike every other member this one may be called from another thread, on a copy of the connection.
+  void interrupt() const noexcept;
+
   /// @brief Prepares a statement for execution and returns a statement object
   [[nodiscard]] auto prepare(std::string_view statement) -> Statement;
 
   /// @brief Initiates a transaction
   [[nodiscard]] auto beginTransaction() -> Transaction;
 
+  /// @brief Creates a feed of the row changes committed through this database connection
+  [[nodiscard]] auto changeFeed(std::size_t capacity) -> ChangeFeed;
+
+  /// @brief Registers a callback invoked for every row inserted, updated or deleted in a rowid table
+  /// @note Hooks are shared by every copy of the connection and must not use the connection to run statements.
+  auto addUpdateHook(UpdateHook hook) -> HookId;
+
+  /// @brief Registers a callback invoked whenever a transaction is committed
+  auto addCommitHook(CommitHook hook) -> HookId;
+
+  /// @brief Registers a callback invoked whenever a transaction is rolled back
+  auto addRollbackHook(RollbackHook hook) -> HookId;
+
+  /// @brief Registers a callback invoked when a savepoint is opened, released or rolled back to, see SavepointChange
+  /// @note Statement failures are only seen for statements run by Statement, execute and executeFile. A full
+  /// ROLLBACK is reported to the rollback hooks and a COMMIT to the commit hooks, not to this one.
+  auto addSavepointHook(SavepointHook hook) -> HookId;
+
+  /// @brief Registers a callback invoked every steps virtual machine instructions while a statement runs
+  /// @note sqlite has one progress handler per connection, it calls every hook as often as the hook with the fewest
+  /// steps asks for. Statements with a deadline or a cancellation token register one for the duration of each step.
+  /// @throws std::invalid_argument if steps is not positive
+  auto addProgressHook(ProgressHook hook, int steps) -> HookId;
+
+  /// @brief Registers a callback asked to authorize every action of the statements being prepared
+  /// @note sqlite has one authorizer per connection, it asks every hook: an action is denied if one of them denies it
+  /// and ignored if one of them ignores it. An authorizer set on backend() with sqlite3_set_authorizer is replaced.
+  auto addAuthorizer(Authorizer hook) -> HookId;
+
+#ifdef SQLITE_ENABLE_PREUPDATE_HOOK
+  /// @brief Registers a callback invoked before every row is inserted, updated or deleted
+  auto addPreUpdateHook(PreUpdateHook hook) -> HookId;
+#endif
+
+  /// @brief Logs every statement executed through this connection and its copies to recorder, nullptr stops
+  /// @note Scripts run with executeFile are not logged.
+  void record(std::shared_ptr<Recorder> recorder);
+
+  /// @brief Returns the recorder attached with record, or nullptr
+  [[nodiscard]] auto recorder() const noexcept -> Recorder*;
+
+  /// @brief Returns the memory used by this connection and by sqlite
+  /// @note If resetCounters is true the hit, miss, write and spill counters of the connection and the process wide
+  /// high-water marks start again from their current value.
+  [[nodiscard]] auto memoryStats(bool resetCounters = false) const -> MemoryStats;
+
+  /// @brief Gives the connection slotCount lookaside slots of slotSize bytes, 0 slots disables lookaside
+  /// @note Lookaside serves the small and short lived allocations of the connection without locking the allocator.
+  /// It can only be changed while no slot is used, right after the connection is opened. Builds of sqlite without
+  /// lookaside (SQLITE_OMIT_LOOKASIDE) accept and ignore it.
+  /// @throws Exception if slots are in use
+  void setLookaside(int slotSize, int slotCount);
+
+  /// @brief Unregisters a hook
+  void removeHook(HookId id);
+
 private:
+  friend class Statement;
+
+  // Reports to the savepoint hooks that the statement that started last failed.
+  void statementFailed() const;
+
+  struct Context;
+  // Declared before db_ so it outlives the database handle whose hooks point to it.
+  std::shared_ptr<Context> context_;
   std::shared_ptr<sqlite3> db_;
 };
 
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Sql/Sqlite3/Connection.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Statement.hpp"
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief Format and pipeline settings of importCsv and exportCsv, set delimiter to '\t' for TSV.
+struct Y2KAOZDATABASE_EXPORT CsvOptions {
+  static constexpr std::size_t DEFAULT_BATCH_SIZE = 100000;
+  static constexpr std::size_t DEFAULT_CHUNK_SIZE = 4ULL * 1024ULL * 1024ULL;
+
+  char delimiter = ',';
+  char quote = '"';
+  /// The first record holds the column names.
+  bool header = true;
+  /// Rows inserted per transaction.
+  std::size_t batchSize = DEFAULT_BATCH_SIZE;
+  /// Bytes of input parsed by a worker at a time.
+  std::size_t chunkSize = DEFAULT_CHUNK_SIZE;
+  /// Parser threads, 0 uses one per hardware thread.
+  std::size_t threads = 0;
+};
+
+/// @brief Throughput of an import or an export.
+struct Y2KAOZDATABASE_EXPORT CsvStats {
+  std::uint64_t rows = 0;
+  std::uint64_t bytes = 0;
+  double seconds = 0.0;
+
+  /// @brief Returns rows / seconds, 0 if nothing was measured
+  [[nodiscard]] auto rowsPerSecond() const noexcept -> double;
+};
+
+/// @brief Inserts the records of the CSV file in path into table, creating it from the header if it does not exist.
+/// @note The file is memory mapped and split into chunks at record boundaries, worker threads parse the chunks while
+/// the calling thread inserts the parsed fields with a single prepared statement, binding them without copies.
+/// Fields are inserted as text and converted by the column affinity. Records whose number of fields differs from the
+/// number of columns raise an Exception, the batches inserted before it stay committed.
+Y2KAOZDATABASE_EXPORT auto importCsv(
+  Connection& connection,
+  const std::filesystem::path& path,
+  std::string_view table,
+  const CsvOptions& options = {}) -> CsvStats;
+
+/// @brief Executes the prepared and bound statement and writes its rows to the CSV file in path.
+/// @note NULL is written as an empty field, numbers are formatted with std::to_chars.
+Y2KAOZDATABASE_EXPORT auto exportCsv(
+  Statement& statement,
+  const std::filesystem::path& path,
+  const CsvOptions& options = {}) -> CsvStats;
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
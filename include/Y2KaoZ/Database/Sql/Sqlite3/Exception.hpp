@@ -10,4 +10,11 @@ public:
   explicit Exception(const std::string& what);
 };
 
+/// @brief Thrown when a statement is stopped by its deadline, its CancellationToken or Connection::interrupt.
+/// @note The statement has been reset and can be executed again.
+class Y2KAOZDATABASE_EXPORT InterruptedException : public Exception {
+public:
+  explicit InterruptedException(const std::string& what);
+};
+
 } // namespace Y2KaoZ::Database::Sql::Sqlite3
\ No newline at end of file
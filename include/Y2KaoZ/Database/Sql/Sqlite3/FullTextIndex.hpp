@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Sql/Sqlite3/Connection.hpp"
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief How a FullTextIndex tokenizes and ranks its content.
+struct Y2KAOZDATABASE_EXPORT FullTextOptions {
+  /// The FTS5 tokenize option.
+  std::string tokenizer = "unicode61 remove_diacritics 2";
+  /// The FTS5 prefix option, like "2 3" to index the prefixes of 2 and 3 characters for prefix queries.
+  std::string prefix;
+  /// The column of the content table that holds its rowid, an INTEGER PRIMARY KEY or rowid.
+  std::string rowid = "rowid";
+  /// The bm25 weight of every indexed column, every column weighs 1 by default.
+  std::vector<double> weights;
+};
+
+/// @brief What a search returns in its snippets.
+struct Y2KAOZDATABASE_EXPORT SnippetOptions {
+  static constexpr int DEFAULT_TOKENS = 16;
+  /// The indexed column the snippet is taken from, -1 picks the column that matches best.
+  int column = -1;
+  std::string before = "[";
+  std::string after = "]";
+  std::string ellipsis = "...";
+  /// The length of the snippet in tokens, at most 64, 0 leaves snippets out.
+  int tokens = DEFAULT_TOKENS;
+};
+
+/// @brief A row matching a search.
+/// @note snippet is a view into sqlite, it is only valid during the call to the visitor.
+struct Y2KAOZDATABASE_EXPORT FullTextHit {
+  std::int64_t rowid = 0;
+  /// The bm25 score of the row, lower is better, the hits come in increasing order.
+  double score = 0;
+  std::string_view snippet;
+};
+
+/// @brief An FTS5 index over the TEXT columns of a table, kept up to date by triggers.
+/// @note The index is an external content FTS5 table: it stores the tokens only and reads the text back from the
+/// content table for snippets. Triggers on the content table update it as rows are inserted, deleted and updated, so
+/// writes must go through SQL on a connection that has the triggers. Searches use the FTS5 query syntax, a word
+/// matches a token and "word*" a prefix.
+class Y2KAOZDATABASE_EXPORT FullTextIndex {
+public:
+  using HitVisitor = std::function<bool(const FullTextHit& hit)>;
+
+  FullTextIndex() = delete;
+  FullTextIndex(const FullTextIndex&) = delete;
+  FullTextIndex(FullTextIndex&&) noexcept;
+  auto operator=(const FullTextIndex&) -> FullTextIndex& = delete;
+  auto operator=(FullTextIndex&&) -> FullTextIndex& = delete;
+
+  /// @brief Opens the index of columns of table, named table_fts by default, creating it and its triggers if needed
+  /// @note A new index over a table that already has rows is built from them.
+  /// @throws Exception if FTS5 is not available or the table or columns do not exist
+  FullTextIndex(
+    Connection connection,
+    const std::string& table,
+    const std::vector<std::string>& columns,
+    const FullTextOptions& options = {},
+    const std::string& index = {});
+  ~FullTextIndex();
+
+  /// @brief Returns the name of the FTS5 table
+  [[nodiscard]] auto name() const -> const std::string&;
+
+  /// @brief Runs load with the triggers removed, then builds the index from the content table in the same transaction
+  /// @note Indexing every row at once is much faster than a trigger per row for large loads. The connection must not
+  /// be in a transaction. If load throws everything is rolled back.
+  void bulkLoad(const std::function<void()>& load);
+
+  /// @brief Builds the index again from the content table
+  void rebuild();
+
+  /// @brief Merges every segment of the index into one, for the fastest searches after a bulk load
+  void optimize();
+
+  /// @brief Merges segments for about pages pages of writes, returns false once there is nothing left to merge
+  /// @note Unlike optimize this does a bounded amount of work, to spread merges over idle time.
+  auto merge(int pages) -> bool;
+
+  /// @brief Sets how many segments of the same level are merged automatically after a write, 0 disables it
+  void setAutomerge(int segments);
+
+  /// @brief Checks that the index matches the content table
+  /// @throws Exception if it does not
+  void check();
+
+  /// @brief Visits the rows matching query, best first, until limit hits or visitor returns false
+  /// @returns the number of hits visited
+  /// @throws Exception if the query is not valid FTS5 syntax
+  auto search(
+    std::string_view query,
+    std::size_t limit,
+    const HitVisitor& visitor,
+    const SnippetOptions& snippet = {}) -> std::size_t;
+
+  /// @brief Returns the rowids of the rows matching query, best first
+  [[nodiscard]] auto search(std::string_view query, std::size_t limit) -> std::vector<std::int64_t>;
+
+  /// @brief Drops the index and its triggers, leaving the content table alone
+  void drop();
+
+private:
+  struct State;
+  std::unique_ptr<State> state_;
+};
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <cstdint>
+#include <fmt/format.h>
+#include <functional>
+#include <string_view>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+class Statement;
+
+/// @brief How the rows are laid out by writeJson.
+enum class JsonLayout : std::uint8_t
+{
+  Objects = 0, ///< [{"a":1,"b":"x"},...]
+  Arrays,      ///< [[1,"x"],...]
+  ObjectLines, ///< one object per line, for newline delimited JSON
+  ArrayLines   ///< one array per line
+};
+
+/// @brief How writeJson writes BLOB values.
+enum class JsonBlobs : std::uint8_t
+{
+  Base64 = 0, ///< a string in standard base64, with padding
+  Hex         ///< a string of lowercase hexadecimal digits
+};
+
+/// @brief Settings of writeJson.
+struct Y2KAOZDATABASE_EXPORT JsonOptions {
+  static constexpr std::size_t DEFAULT_FLUSH_SIZE = 64ULL * 1024ULL;
+
+  JsonLayout layout = JsonLayout::Objects;
+  JsonBlobs blobs = JsonBlobs::Base64;
+  /// Integers beyond 2^53, which JavaScript can not represent exactly, are written as strings.
+  bool bigIntegersAsStrings = false;
+  /// The significant digits of REAL values, 0 writes the shortest representation that reads back the same value.
+  /// Precisions above std::numeric_limits<double>::max_digits10 (17) write 17 digits.
+  int realPrecision = 0;
+  /// The callback sink receives the output in chunks of about that many bytes.
+  std::size_t flushSize = DEFAULT_FLUSH_SIZE;
+};
+
+/// @brief Receives the output of writeJson chunk by chunk.
+using JsonSink = std::function<void(std::string_view chunk)>;
+
+/// @brief Writes the remaining rows of the executed statement as JSON to sink and returns the number of rows.
+/// @note Values are read straight from sqlite3_column_* into an output buffer, the object keys are escaped once per
+/// call. INTEGER and REAL values are formatted with std::to_chars, NaN and infinities are written as null. TEXT is
+/// escaped as JSON strings and is expected to be UTF-8.
+Y2KAOZDATABASE_EXPORT auto writeJson(Statement& statement, const JsonSink& sink, const JsonOptions& options = {})
+  -> std::uint64_t;
+
+/// @brief Appends the remaining rows of the executed statement as JSON to buffer and returns the number of rows.
+Y2KAOZDATABASE_EXPORT auto writeJson(Statement& statement, fmt::memory_buffer& buffer, const JsonOptions& options = {})
+  -> std::uint64_t;
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
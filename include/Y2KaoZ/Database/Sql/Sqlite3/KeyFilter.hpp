@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Sql/Sqlite3/Connection.hpp"
+#include "Y2KaoZ/Database/Types.hpp"
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+class Statement;
+
+/// @brief How a KeyFilter is sized and when it is rebuilt.
+struct Y2KAOZDATABASE_EXPORT KeyFilterOptions {
+  static constexpr double DEFAULT_FALSE_POSITIVE_RATE = 0.01;
+  static constexpr double DEFAULT_REBUILD_RATIO = 0.25;
+  static constexpr std::size_t MINIMUM_CAPACITY = 1024;
+
+  /// The number of keys the filter is sized for, 0 sizes it for twice the rows of the table. It is rebuilt larger
+  /// once more keys were added.
+  std::size_t capacity = 0;
+  /// The false positive rate the filter is sized for, at capacity.
+  double falsePositiveRate = DEFAULT_FALSE_POSITIVE_RATE;
+  /// The filter is rebuilt once that fraction of its keys was deleted or updated, since their stale bits only add
+  /// false positives.
+  double rebuildRatio = DEFAULT_REBUILD_RATIO;
+};
+
+/// @brief What a KeyFilter did so far.
+struct Y2KAOZDATABASE_EXPORT KeyFilterStats {
+  std::uint64_t keys = 0;           ///< keys added since the last build, stale ones included
+  std::uint64_t capacity = 0;       ///< keys the filter is sized for
+  std::uint64_t bits = 0;           ///< size of the filter
+  std::uint64_t hashes = 0;         ///< bits set per key
+  std::uint64_t lookups = 0;        ///< keys checked against the filter
+  std::uint64_t filtered = 0;       ///< lookups answered by the filter alone, without sqlite
+  std::uint64_t falsePositives = 0; ///< lookups the filter let through that sqlite did not find
+  std::uint64_t rebuilds = 0;       ///< builds after the first one
+
+  /// @brief Returns the share of the missing keys the filter let through, measured by contains and lookup
+  [[nodiscard]] auto falsePositiveRate() const noexcept -> double;
+
+  /// @brief Returns the false positive rate expected from the number of keys and the size of the filter
+  [[nodiscard]] auto expectedFalsePositiveRate() const noexcept -> double;
+};
+
+/// @brief An in-memory Bloom filter of the values of a key column, to answer point lookups of missing keys without
+/// descending the B-tree.
+/// @note The filter is built by a ParallelScan of the table when the database is a file, or by a scan through the
+/// connection otherwise. Rows inserted or updated through the connection are added by an update hook, which only
+/// records their rowid; their keys are read before the next lookup, so the table must be a rowid table. Changes
+/// committed by other connections or processes show in PRAGMA data_version and make the next lookup rebuild the filter.
+/// A filter built inside a transaction is built again once the transaction ends or rolls back to a savepoint, which may
+/// bring back rows it did not see. Keys are hashed by type: INTEGER keys (and REAL keys with an integral value) must be
+/// looked up as integers, TEXT keys as text and BLOB keys as blobs, a key looked up with another type than it is stored
+/// with may be reported missing. Declare the key column INTEGER, TEXT or BLOB, ideally in a STRICT table. Keys are also
+/// hashed by their exact bytes, so the key column must use the BINARY collation: under NOCASE or RTRIM, sqlite finds
+/// keys that differ from the stored ones by case or trailing spaces, which the filter would report missing. Like the
+/// connection, a filter is used by one thread at a time.
+class Y2KAOZDATABASE_EXPORT KeyFilter {
+public:
+  KeyFilter() = delete;
+  KeyFilter(const KeyFilter&) = delete;
+  KeyFilter(KeyFilter&&) noexcept;
+  auto operator=(const KeyFilter&) -> KeyFilter& = delete;
+  auto operator=(KeyFilter&&) -> KeyFilter& = delete;
+
+  /// @brief Builds the filter of column in table of the main database of connection
+  /// @throws std::invalid_argument if column does not use the BINARY collation
+  explicit KeyFilter(
+    Connection connection,
+    const std::string& table,
+    const std::string& column,
+    const KeyFilterOptions& options = {});
+  ~KeyFilter();
+
+  /// @brief Tells whether key may be in the table, false means it is certainly missing
+  [[nodiscard]] auto mayContain(std::int64_t key) -> bool;
+  [[nodiscard]] auto mayContain(std::string_view key) -> bool;
+  [[nodiscard]] auto mayContain(BlobView key) -> bool;
+
+  /// @brief Tells whether key is in the table, asking sqlite only if the filter lets it through
+  [[nodiscard]] auto contains(std::int64_t key) -> bool;
+  [[nodiscard]] auto contains(std::string_view key) -> bool;
+  [[nodiscard]] auto contains(BlobView key) -> bool;
+
+  /// @brief Binds key to the first parameter of statement and executes it, unless the filter rules key out
+  /// @returns true if statement has rows to fetch; false if the filter ruled the key out or nothing was found
+  /// @note statement should select rows by key, for example "SELECT * FROM t WHERE key = ?1". Text and blob keys are
+  /// bound without copies, they must stay valid while the rows are fetched.
+  auto lookup(std::int64_t key, Statement& statement) -> bool;
+  auto lookup(std::string_view key, Statement& statement) -> bool;
+  auto lookup(BlobView key, Statement& statement) -> bool;
+
+  /// @brief Builds the filter again from the table
+  void rebuild();
+
+  /// @brief Returns the counters of the filter
+  /// @note If resetCounters is true the lookup counters start again from zero.
+  [[nodiscard]] auto stats(bool resetCounters = false) -> KeyFilterStats;
+
+private:
+  struct State;
+  std::unique_ptr<State> state_;
+};
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Sql/Sqlite3/Connection.hpp"
+#include "Y2KaoZ/Database/Types.hpp"
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief A key and its value, as passed to KvStore::multiPut.
+struct Y2KAOZDATABASE_EXPORT KvEntry {
+  BlobView key;
+  BlobView value;
+};
+
+/// @brief Gets and puts values by key in a WITHOUT ROWID table, bypassing SQL text and variant results.
+/// @note Keys and values are stored as BLOBs and compared byte by byte, so iteration follows the memcmp order of the
+/// keys. Every operation runs a statement prepared once by the constructor, binding the keys and values given without
+/// copying them. The values returned are views into sqlite: the view of a get stays valid until the next call on the
+/// store, which also keeps the read open until then (release() ends it sooner); the views given to a visitor are only
+/// valid during the call. Like the connection, a store is used by one thread at a time.
+class Y2KAOZDATABASE_EXPORT KvStore {
+public:
+  static constexpr auto DEFAULT_TABLE = "kv";
+  /// Receives the index of a key of multiGet and its value, std::nullopt if the key is missing.
+  using GetVisitor = std::function<void(std::size_t index, std::optional<BlobView> value)>;
+  /// Receives the entries of a scan in key order, returns false to stop.
+  using ScanVisitor = std::function<bool(BlobView key, BlobView value)>;
+
+  KvStore() = delete;
+  KvStore(const KvStore&) = delete;
+  KvStore(KvStore&&) noexcept;
+  auto operator=(const KvStore&) -> KvStore& = delete;
+  auto operator=(KvStore&&) -> KvStore& = delete;
+
+  /// @brief Creates table in the main database of connection unless it exists and prepares the statements
+  explicit KvStore(Connection connection, const std::string& table = DEFAULT_TABLE);
+  ~KvStore();
+
+  /// @brief Returns the bytes of text, to use strings as keys or values
+  [[nodiscard]] static auto bytes(std::string_view text) noexcept -> BlobView;
+
+  /// @brief Returns bytes as text
+  [[nodiscard]] static auto text(BlobView bytes) noexcept -> std::string_view;
+
+  /// @brief Returns the value of key, std::nullopt if it is missing
+  [[nodiscard]] auto get(BlobView key) -> std::optional<BlobView>;
+  [[nodiscard]] auto get(std::string_view key) -> std::optional<std::string_view>;
+
+  /// @brief Tells whether key has a value
+  [[nodiscard]] auto contains(BlobView key) -> bool;
+
+  /// @brief Ends the read left open by the last get, its view must not be used anymore
+  void release();
+
+  /// @brief Sets the value of key, replacing the previous one
+  void put(BlobView key, BlobView value);
+  void put(std::string_view key, std::string_view value);
+
+  /// @brief Removes key, returns false if it was missing
+  auto erase(BlobView key) -> bool;
+  auto erase(std::string_view key) -> bool;
+
+  /// @brief Looks every key up in a single read transaction and passes the values to visitor
+  /// @note Outside of a transaction one is started for the batch, inside one the keys are read as part of it.
+  void multiGet(std::span<const BlobView> keys, const GetVisitor& visitor);
+
+  /// @brief Sets the values of every entry in a single transaction, all or nothing
+  /// @note Outside of a transaction one is started for the batch, inside one the entries become part of it.
+  void multiPut(std::span<const KvEntry> entries);
+
+  /// @brief Visits the entries whose key starts with prefix, in key order
+  /// @note The visitor must not start another scan on the store, the changes it makes may or may not be visited.
+  void scanPrefix(BlobView prefix, const ScanVisitor& visitor);
+
+  /// @brief Visits the entries whose key is in [from, to), in key order, up to the last key without to
+  /// @note The visitor must not start another scan on the store, the changes it makes may or may not be visited.
+  void scanRange(BlobView from, std::optional<BlobView> to, const ScanVisitor& visitor);
+
+  /// @brief Returns the number of entries
+  [[nodiscard]] auto size() -> std::int64_t;
+
+private:
+  struct State;
+  std::unique_ptr<State> state_;
+};
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
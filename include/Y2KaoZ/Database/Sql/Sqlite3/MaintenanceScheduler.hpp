@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief The modes of sqlite3_wal_checkpoint_v2, from the least to the most intrusive.
+enum class CheckpointMode : std::uint8_t
+{
+  Passive = 0, ///< copies what it can without waiting for readers or writers
+  Full,        ///< waits for the writers, then copies every frame
+  Restart,     ///< like Full, then waits for the readers so the next writer starts the WAL over
+  Truncate     ///< like Restart, then truncates the WAL file to zero bytes
+};
+
+/// @brief The outcome of one checkpoint.
+struct Y2KAOZDATABASE_EXPORT CheckpointReport {
+  CheckpointMode mode = CheckpointMode::Passive;
+  std::chrono::nanoseconds duration{0};
+  std::int64_t walFrames = 0;   ///< frames in the WAL when the checkpoint ended
+  std::int64_t framesMoved = 0; ///< frames copied into the database by this checkpoint
+  bool busy = false;            ///< the checkpoint could not finish because of other connections
+};
+
+/// @brief When a MaintenanceScheduler does its work, a zero interval disables the task.
+struct Y2KAOZDATABASE_EXPORT MaintenanceOptions {
+  /// How often the WAL is looked at, a zero interval leaves every task to the members called directly.
+  std::chrono::milliseconds pollInterval{1000};
+  /// A PASSIVE checkpoint runs once that many frames wait in the WAL...
+  std::int64_t checkpointFrames = 1000;
+  /// ...or once the database has not been written for that long and some frames wait.
+  std::chrono::milliseconds idleTime{5000};
+  /// Above that many waiting frames a RESTART checkpoint runs instead, waiting for the readers.
+  std::int64_t restartFrames = 10000;
+  /// Above that WAL file size a TRUNCATE checkpoint runs instead, giving the disk space back.
+  std::uintmax_t walSizeLimit = 64ULL * 1024ULL * 1024ULL;
+  /// How long RESTART and TRUNCATE checkpoints wait for other connections.
+  std::chrono::milliseconds busyTimeout{100};
+  /// How often PRAGMA optimize runs.
+  std::chrono::milliseconds optimizeInterval{std::chrono::hours(1)};
+  /// How often free pages are released by PRAGMA incremental_vacuum, for databases in auto_vacuum=INCREMENTAL.
+  std::chrono::milliseconds vacuumInterval{std::chrono::minutes(10)};
+  /// How many free pages an incremental vacuum releases at most, 0 releases them all.
+  int vacuumPages = 1000;
+  /// Called after every checkpoint, on the thread that ran it.
+  std::function<void(const CheckpointReport&)> onCheckpoint;
+};
+
+/// @brief What a MaintenanceScheduler did so far.
+struct Y2KAOZDATABASE_EXPORT MaintenanceStats {
+  std::uint64_t checkpoints = 0;
+  std::uint64_t busyCheckpoints = 0;
+  std::int64_t framesMoved = 0;
+  std::chrono::nanoseconds checkpointTime{0};
+  std::chrono::nanoseconds maxCheckpointTime{0};
+  std::optional<CheckpointReport> lastCheckpoint;
+  std::uint64_t optimizations = 0;
+  std::uint64_t vacuums = 0;
+  std::int64_t pagesVacuumed = 0;
+  std::uint64_t errors = 0;
+  std::string lastError;
+};
+
+/// @brief Checkpoints the WAL of a database and runs its periodic maintenance on a background connection.
+/// @note Left to sqlite, checkpoints run inside the commit of whichever writer crosses wal_autocheckpoint, and the WAL
+/// keeps growing as long as readers never leave it. Writers should set PRAGMA wal_autocheckpoint=0 and leave the work
+/// to the scheduler, which measures the WAL from the wal-index its connection maps (see the WAL file format of sqlite)
+/// without taking any lock. Errors on the maintenance thread are counted in the stats, the members called directly
+/// throw them.
+class Y2KAOZDATABASE_EXPORT MaintenanceScheduler {
+public:
+  MaintenanceScheduler() = delete;
+  MaintenanceScheduler(const MaintenanceScheduler&) = delete;
+  MaintenanceScheduler(MaintenanceScheduler&&) noexcept;
+  auto operator=(const MaintenanceScheduler&) -> MaintenanceScheduler& = delete;
+  auto operator=(MaintenanceScheduler&&) -> MaintenanceScheduler& = delete;
+
+  /// @brief Opens its own connection to database and starts the maintenance thread
+  explicit MaintenanceScheduler(const std::filesystem::path& database, MaintenanceOptions options = {});
+
+  /// @brief Stops the maintenance thread and waits for it
+  ~MaintenanceScheduler();
+
+  /// @brief Runs a checkpoint now, on the calling thread
+  /// @throws Exception if the checkpoint fails for another reason than other connections being busy
+  auto checkpoint(CheckpointMode mode) -> CheckpointReport;
+
+  /// @brief Runs PRAGMA optimize now, on the calling thread
+  void optimize();
+
+  /// @brief Releases up to vacuumPages free pages now, on the calling thread, and returns how many were released
+  auto incrementalVacuum() -> std::int64_t;
+
+  /// @brief Returns the counters of the work done so far
+  [[nodiscard]] auto stats() const -> MaintenanceStats;
+
+  /// @brief Stops the maintenance thread, the members called directly keep working
+  void stop();
+
+private:
+  struct State;
+  std::unique_ptr<State> state_;
+};
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief The memory allocator of sqlite, installed with installAllocator.
+/// @note sqlite calls it from every thread and requires 8 byte aligned memory. None of the members may throw.
+class Y2KAOZDATABASE_EXPORT Allocator {
+public:
+  Allocator() = default;
+  Allocator(const Allocator&) = delete;
+  Allocator(Allocator&&) = delete;
+  auto operator=(const Allocator&) -> Allocator& = delete;
+  auto operator=(Allocator&&) -> Allocator& = delete;
+  virtual ~Allocator() = default;
+
+  /// @brief Returns size bytes of memory or nullptr
+  [[nodiscard]] virtual auto allocate(std::size_t size) noexcept -> void* = 0;
+  /// @brief Frees memory returned by allocate or reallocate
+  virtual void deallocate(void* memory) noexcept = 0;
+  /// @brief Resizes memory returned by allocate, keeping its content, or returns nullptr and leaves it unchanged
+  [[nodiscard]] virtual auto reallocate(void* memory, std::size_t size) noexcept -> void* = 0;
+  /// @brief Returns the usable size of memory returned by allocate
+  [[nodiscard]] virtual auto size(void* memory) noexcept -> std::size_t = 0;
+  /// @brief Returns the size allocate really reserves for size bytes
+  [[nodiscard]] virtual auto roundUp(std::size_t size) noexcept -> std::size_t;
+};
+
+/// @brief Makes sqlite allocate its memory from allocator, nullptr restores the allocator sqlite was built with
+/// @note sqlite is shut down first: no connection may be open. The allocator is kept alive until it is replaced.
+/// @throws Exception if sqlite refuses the configuration
+Y2KAOZDATABASE_EXPORT void installAllocator(std::shared_ptr<Allocator> allocator);
+
+/// @brief Returns the allocator installed with installAllocator, or nullptr
+[[nodiscard]] Y2KAOZDATABASE_EXPORT auto installedAllocator() noexcept -> std::shared_ptr<Allocator>;
+
+/// @brief Sets the process wide heap size above which sqlite frees cache pages before allocating, 0 removes it
+/// @return the previous limit
+Y2KAOZDATABASE_EXPORT auto setSoftHeapLimit(std::int64_t bytes) noexcept -> std::int64_t;
+
+/// @brief Sets the process wide heap size above which allocations made by sqlite fail with SQLITE_NOMEM, 0 removes it
+/// @return the previous limit
+Y2KAOZDATABASE_EXPORT auto setHardHeapLimit(std::int64_t bytes) noexcept -> std::int64_t;
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
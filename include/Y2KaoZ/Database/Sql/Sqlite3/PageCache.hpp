@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief Counters of the page cache installed with installPageCache.
+struct Y2KAOZDATABASE_EXPORT PageCacheStats {
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;
+  std::uint64_t evictions = 0;
+  std::size_t pages = 0;
+  std::size_t pinned = 0;
+  std::size_t memoryUsed = 0;
+  std::size_t memoryBudget = 0;
+
+  /// @brief Returns hits / (hits + misses), 0 before the first fetch
+  [[nodiscard]] auto hitRatio() const noexcept -> double;
+};
+
+/// @brief Replaces the page cache of sqlite by one whose pages share a single process wide memory budget
+/// @note Every connection still caches its own pages, but they compete for the same budget: the pages of a busy
+/// connection are kept while those of an idle one are evicted, instead of each connection getting a fixed cache_size
+/// (which is then ignored). Eviction is a segmented LRU: pages enter a probation segment and move to the protected one
+/// when they are fetched again, so a large scan only cycles through probation and keeps the hot pages. The pages of
+/// in-memory and temporary databases can not be evicted and are not counted against the budget.
+/// sqlite is shut down first: no connection may be open.
+/// @throws Exception if sqlite refuses the configuration
+Y2KAOZDATABASE_EXPORT void installPageCache(std::size_t budget);
+
+/// @brief Restores the page cache sqlite was built with
+/// @note sqlite is shut down first: no connection may be open.
+/// @throws Exception if sqlite refuses the configuration
+Y2KAOZDATABASE_EXPORT void removePageCache();
+
+/// @brief Tells whether the page cache of installPageCache is installed
+[[nodiscard]] Y2KAOZDATABASE_EXPORT auto pageCacheInstalled() noexcept -> bool;
+
+/// @brief Changes the budget of the installed page cache, evicting unpinned pages until it is met
+Y2KAOZDATABASE_EXPORT void setPageCacheBudget(std::size_t budget);
+
+/// @brief Returns the counters of the installed page cache and optionally sets hits, misses and evictions back to 0
+[[nodiscard]] Y2KAOZDATABASE_EXPORT auto pageCacheStats(bool resetCounters = false) -> PageCacheStats;
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Sql/Sqlite3/Connection.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/QueryPlan.hpp"
+#include "Y2KaoZ/Database/Types.hpp"
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief A result column a PagedQuery orders its pages by.
+struct Y2KAOZDATABASE_EXPORT PageKey {
+  std::string column;
+  bool descending = false;
+};
+
+/// @brief A page of rows returned by a PagedQuery.
+struct Y2KAOZDATABASE_EXPORT Page {
+  std::vector<ResultVector> rows;
+  /// Resumes after the last row, empty on the last page.
+  std::string next;
+  /// Resumes before the first row, empty on the first page.
+  std::string previous;
+};
+
+/// @brief Pages through the rows of a SELECT by keyset instead of by LIMIT and OFFSET.
+/// @note A page resumes from the keys of the row before it, with WHERE (k1, k2) > (?, ?) ORDER BY k1, k2 LIMIT ?, so
+/// an index on the keys makes every page cost the same whatever its depth. The keys must be result columns of select,
+/// never NULL, and unique together: end them with the primary key when the first ones are not. select must not have
+/// its own ORDER BY or LIMIT; it is used as a subquery, which sqlite flattens into the paging statements as long as it
+/// has no aggregate, DISTINCT or compound operator. Tokens are opaque strings holding the keys of a row, they stay
+/// valid across changes to the table: a page starts at the first row after (or before) those keys. The four paging
+/// statements are prepared once by the constructor.
+class Y2KAOZDATABASE_EXPORT PagedQuery {
+public:
+  static constexpr std::size_t DEFAULT_PAGE_SIZE = 100;
+
+  PagedQuery() = delete;
+  PagedQuery(const PagedQuery&) = delete;
+  PagedQuery(PagedQuery&&) noexcept;
+  auto operator=(const PagedQuery&) -> PagedQuery& = delete;
+  auto operator=(PagedQuery&&) -> PagedQuery& = delete;
+
+  /// @brief Prepares the paging statements of select, ordered by keys, pageSize rows at a time
+  explicit PagedQuery(
+    Connection connection,
+    const std::string& select,
+    const std::vector<PageKey>& keys,
+    std::size_t pageSize = DEFAULT_PAGE_SIZE);
+  ~PagedQuery();
+
+  /// @brief Returns the first page, parameters are bound to the parameters of select
+  [[nodiscard]] auto first(const ParamVector& parameters = {}) -> Page;
+
+  /// @brief Returns the last page
+  [[nodiscard]] auto last(const ParamVector& parameters = {}) -> Page;
+
+  /// @brief Returns the page a next or previous token of another page resumes from
+  /// @note An empty page has no tokens, the rows around the token were deleted: start again from first() or last().
+  [[nodiscard]] auto page(std::string_view token, const ParamVector& parameters = {}) -> Page;
+
+  [[nodiscard]] auto pageSize() const noexcept -> std::size_t;
+
+  /// @brief Returns the plan of the statement that resumes forward, to check that the keys are searched by an index
+  [[nodiscard]] auto queryPlan() const -> QueryPlan;
+
+private:
+  struct State;
+  std::unique_ptr<State> state_;
+};
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Types.hpp"
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief An inclusive range of integer keys scanned by a single reader.
+struct Y2KAOZDATABASE_EXPORT ScanPartition {
+  std::int64_t first;
+  std::int64_t last;
+};
+
+/// @brief Strict weak ordering used to merge rows.
+using RowCompare = std::function<bool(const ResultVector&, const ResultVector&)>;
+
+/// @brief Folds the row of a partition into the accumulated row.
+using RowCombine = std::function<ResultVector(ResultVector accumulated, const ResultVector& row)>;
+
+/// @brief Merges row sets that are already sorted by less into a single sorted row set (k-way merge).
+[[nodiscard]] Y2KAOZDATABASE_EXPORT auto mergeOrdered(std::vector<std::vector<ResultVector>> sources, const RowCompare& less)
+  -> std::vector<ResultVector>;
+
+/// @brief Splits a query over an integer key range and runs every partition on its own reader connection.
+/// @note Queries must restrict the key with the ":first" and ":last" parameters, for example:
+/// "SELECT sum(b) FROM t WHERE rowid BETWEEN :first AND :last".
+class Y2KAOZDATABASE_EXPORT ParallelScan {
+public:
+  static constexpr std::size_t DEFAULT_SAMPLES_PER_PARTITION = 32;
+
+  ParallelScan() = delete;
+
+  /// @brief Partitions the key column of table in the database filename, one partition per hardware thread.
+  ParallelScan(std::filesystem::path filename, std::string table, std::string key = "rowid");
+
+  /// @brief Samples the key column and splits it into at most count partitions that cover every possible key.
+  auto partition(std::size_t count, std::size_t samplesPerPartition = DEFAULT_SAMPLES_PER_PARTITION) -> ParallelScan&;
+
+  /// @brief Returns the current partitions ordered by key.
+  [[nodiscard]] auto partitions() const noexcept -> const std::vector<ScanPartition>&;
+
+  /// @brief Runs the query on every partition and concatenates the rows in partition order.
+  [[nodiscard]] auto fetchAll(std::string_view query, const ParamMap& parameters = {}) const
+    -> std::vector<ResultVector>;
+
+  /// @brief Runs the query on every partition and merges the rows, each partition must already be sorted by less.
+  [[nodiscard]] auto fetchAllOrdered(std::string_view query, const RowCompare& less, const ParamMap& parameters = {})
+    const -> std::vector<ResultVector>;
+
+  /// @brief Runs an aggregate query on every partition and folds the partial rows with combine.
+  [[nodiscard]] auto aggregate(std::string_view query, const RowCombine& combine, const ParamMap& parameters = {})
+    const -> std::optional<ResultVector>;
+
+private:
+  [[nodiscard]] auto run(std::string_view query, const ParamMap& parameters) const
+    -> std::vector<std::vector<ResultVector>>;
+
+  std::filesystem::path filename_;
+  std::string table_;
+  std::string key_;
+  std::vector<ScanPartition> partitions_;
+};
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Sql/Sqlite3/Statement.hpp"
+#include "Y2KaoZ/Database/Types.hpp"
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief Steps a statement on a producer thread and hands its rows to the consumer in batches.
+/// @note The producer decodes up to depth batches ahead into reusable row buffers that travel between the two
+/// threads through lock-free rings. It waits when the consumer falls behind (backpressure) and stops between two rows
+/// when the reader is cancelled or destroyed. Errors raised by the producer are rethrown by the fetch methods once the
+/// rows decoded before the error have been consumed. The connection of the statement must not be used by another
+/// thread while the reader runs unless sqlite is in serialized mode.
+class Y2KAOZDATABASE_EXPORT PrefetchingReader {
+public:
+  static constexpr std::size_t DEFAULT_BATCH_SIZE = 256;
+  static constexpr std::size_t DEFAULT_DEPTH = 4;
+
+  PrefetchingReader() = delete;
+  PrefetchingReader(const PrefetchingReader&) = delete;
+  PrefetchingReader(PrefetchingReader&&) noexcept;
+  auto operator=(const PrefetchingReader&) -> PrefetchingReader& = delete;
+  auto operator=(PrefetchingReader&&) -> PrefetchingReader& = delete;
+
+  /// @brief Executes the prepared and bound statement on a new producer thread
+  explicit PrefetchingReader(
+    Statement statement,
+    std::size_t batchSize = DEFAULT_BATCH_SIZE,
+    std::size_t depth = DEFAULT_DEPTH);
+
+  /// @brief Cancels the producer and waits for it
+  ~PrefetchingReader();
+
+  /// @brief Returns the next row, valid until the next call, or nullptr when the result set is exhausted
+  [[nodiscard]] auto next() -> const ResultVector*;
+
+  /// @brief Fetches the next row from the result set using numeric column keys
+  [[nodiscard]] auto fetchVector() -> std::optional<ResultVector>;
+
+  /// @brief Fetches the remaining rows from the result set
+  [[nodiscard]] auto fetchAllVector() -> std::vector<ResultVector>;
+
+  /// @brief Stops the producer after the row it is decoding, the rows not fetched yet are discarded
+  void cancel();
+
+private:
+  struct State;
+  std::unique_ptr<State> state_;
+};
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
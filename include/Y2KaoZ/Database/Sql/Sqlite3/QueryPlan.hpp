@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief A step of a query plan, parsed from a row of EXPLAIN QUERY PLAN.
+struct Y2KAOZDATABASE_EXPORT QueryPlanNode {
+  enum class Kind : std::uint8_t
+  {
+    Other = 0, ///< subqueries, co-routines, compound queries and everything else
+    Scan,      ///< SCAN: every row of the table or of the index is visited
+    Search,    ///< SEARCH: a subset of the rows is found with an index
+    TempBTree  ///< USE TEMP B-TREE: rows are sorted for ORDER BY, GROUP BY or DISTINCT
+  };
+
+  Kind kind = Kind::Other;
+  /// The text reported by sqlite.
+  std::string detail;
+  /// The table, its alias or the subquery that is scanned or searched.
+  std::string table;
+  /// The index used by the scan or search, empty when there is none or when it is automatic.
+  std::string index;
+  bool coveringIndex = false;
+  /// An index built by sqlite for this statement only, every time it runs.
+  bool automaticIndex = false;
+  /// A rowid lookup, "USING INTEGER PRIMARY KEY".
+  bool primaryKey = false;
+  bool virtualTable = false;
+  std::vector<QueryPlanNode> children;
+
+  /// @brief Builds a node from the detail text of EXPLAIN QUERY PLAN
+  [[nodiscard]] static auto parse(std::string detail) -> QueryPlanNode;
+};
+
+/// @brief The tree returned by EXPLAIN QUERY PLAN for a statement.
+class Y2KAOZDATABASE_EXPORT QueryPlan {
+public:
+  /// @brief A row of EXPLAIN QUERY PLAN.
+  struct Row {
+    int id;
+    int parent;
+    std::string detail;
+  };
+
+  QueryPlan() = default;
+
+  /// @brief Builds the tree from the rows of EXPLAIN QUERY PLAN, in the order sqlite returns them
+  explicit QueryPlan(const std::vector<Row>& rows);
+
+  [[nodiscard]] auto roots() const noexcept -> const std::vector<QueryPlanNode>&;
+
+  /// @brief Returns the tables scanned without any index, subqueries and virtual tables excluded
+  [[nodiscard]] auto fullScans() const -> std::vector<std::string>;
+
+  /// @brief Returns the tables searched with an automatic index
+  [[nodiscard]] auto automaticIndexes() const -> std::vector<std::string>;
+
+  /// @brief Returns true if rows are sorted in a temporary b-tree
+  [[nodiscard]] auto usesTempBTree() const -> bool;
+
+  /// @brief Returns the plan indented like the sqlite3 shell shows it
+  [[nodiscard]] auto toString() const -> std::string;
+
+private:
+  std::vector<QueryPlanNode> roots_;
+};
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Types.hpp"
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief How a recorded call was made.
+enum class RecordedKind : std::uint8_t
+{
+  Statement = 0, ///< Statement::execute, with its parameters
+  Script         ///< Connection::execute
+};
+
+/// @brief A call read back from a recording.
+struct Y2KAOZDATABASE_EXPORT RecordedCall {
+  RecordedKind kind = RecordedKind::Statement;
+  /// Time since the recorder was created.
+  std::chrono::nanoseconds time{};
+  /// Dense number of the recording thread, in order of appearance.
+  std::uint32_t thread = 0;
+  /// Index of the SQL text in Recording::statements.
+  std::uint32_t statement = 0;
+  ParamVector parameters;
+};
+
+/// @brief The content of a recording file, each distinct SQL text is stored once.
+struct Y2KAOZDATABASE_EXPORT Recording {
+  std::vector<std::string> statements;
+  std::vector<RecordedCall> calls;
+
+  /// @brief Reads a file written by a Recorder
+  /// @throws Exception if the file is not a recording or is truncated
+  [[nodiscard]] static auto load(const std::filesystem::path& path) -> Recording;
+};
+
+/// @brief Logs the executions of statements into a compact binary file, for replay.
+/// @note Attach it with Connection::record. Every execution is written as its kind, the time since the previous one,
+/// a thread number, the SQL text (the first time, then a number) and the ParamVector of the statement, with integers
+/// as varints. Parameters bound with Statement::bindView are recorded as NULL. A recorder may be shared by connections
+/// used in several threads, entries are buffered and written by the thread that fills the buffer.
+class Y2KAOZDATABASE_EXPORT Recorder {
+public:
+  static constexpr std::size_t DEFAULT_BUFFER_SIZE = 64ULL * 1024ULL;
+
+  Recorder() = delete;
+  Recorder(const Recorder&) = delete;
+  Recorder(Recorder&&) = delete;
+  auto operator=(const Recorder&) -> Recorder& = delete;
+  auto operator=(Recorder&&) -> Recorder& = delete;
+
+  /// @brief Creates or truncates the recording file in path
+  /// @throws Exception if the file can not be opened
+  explicit Recorder(const std::filesystem::path& path, std::size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+  /// @brief Flushes the remaining entries
+  ~Recorder();
+
+  /// @brief Appends a call, made now by the current thread
+  void record(RecordedKind kind, std::string_view sql, const ParamVector& parameters);
+
+  /// @brief Writes the buffered entries to the file
+  void flush();
+
+  /// @brief Returns the number of calls recorded
+  [[nodiscard]] auto calls() const -> std::uint64_t;
+
+private:
+  struct State;
+  std::unique_ptr<State> state_;
+};
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Sql/Sqlite3/Recorder.hpp"
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief How a recording is replayed.
+struct Y2KAOZDATABASE_EXPORT ReplayOptions {
+  static constexpr int DEFAULT_BUSY_TIMEOUT_MS = 5000;
+  /// Replay threads, each with its own connection. The calls of a recorded thread always run on the same one.
+  std::size_t threads = 1;
+  /// Waits until each call is due at the recorded rate instead of running them as fast as possible.
+  bool recordedRate = false;
+  /// Busy timeout of the replay connections.
+  int busyTimeoutMs = DEFAULT_BUSY_TIMEOUT_MS;
+};
+
+/// @brief Latencies of one SQL text, measured from the first step to the last row.
+struct Y2KAOZDATABASE_EXPORT ReplayStatementStats {
+  std::string sql;
+  std::uint64_t calls = 0;
+  std::uint64_t errors = 0;
+  std::chrono::nanoseconds total{};
+  std::chrono::nanoseconds p50{};
+  std::chrono::nanoseconds p90{};
+  std::chrono::nanoseconds p99{};
+  std::chrono::nanoseconds max{};
+};
+
+/// @brief The outcome of a replay.
+struct Y2KAOZDATABASE_EXPORT ReplayReport {
+  std::uint64_t calls = 0;
+  std::uint64_t errors = 0;
+  double seconds = 0.0;
+  /// Sorted by total time, the most expensive first.
+  std::vector<ReplayStatementStats> statements;
+
+  /// @brief Returns calls / seconds, 0 if nothing was measured
+  [[nodiscard]] auto callsPerSecond() const noexcept -> double;
+};
+
+/// @brief Runs the calls of recording against the database in path and measures them
+/// @note The database is modified by the calls that write, replay on a copy. Calls that fail are counted as errors
+/// and the replay goes on.
+Y2KAOZDATABASE_EXPORT auto replay(
+  const std::filesystem::path& database,
+  const Recording& recording,
+  const ReplayOptions& options = {}) -> ReplayReport;
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
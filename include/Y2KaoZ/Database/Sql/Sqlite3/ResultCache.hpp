@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Sql/Sqlite3/Connection.hpp"
+#include "Y2KaoZ/Database/Types.hpp"
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief Counters exported by a ResultCache.
+struct Y2KAOZDATABASE_EXPORT ResultCacheStats {
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;
+  std::uint64_t evictions = 0;
+  std::uint64_t invalidations = 0;
+  std::size_t entries = 0;
+  std::size_t memoryUsed = 0;
+  std::size_t memoryBudget = 0;
+
+  /// @brief Returns hits / (hits + misses), 0 before the first lookup
+  [[nodiscard]] auto hitRatio() const noexcept -> double;
+};
+
+/// @brief An opt-in LRU cache of query results keyed by SQL text and bound parameters.
+/// @note The tables read by each statement are learned with an authorizer of the connection when it is prepared.
+/// Entries are invalidated by table when the update hook of the connection fires (and again if the transaction is
+/// rolled back), and entirely when PRAGMA data_version reveals a commit made by another connection. Statements that
+/// write are executed but never cached, nor are the rows read from tables changed by the transaction in progress. The
+/// STATEMENT_CAPACITY most recently used statements stay prepared, the results of the others are dropped with them.
+/// Like the connection, a cache must not be used by several threads at once.
+class Y2KAOZDATABASE_EXPORT ResultCache {
+public:
+  using Rows = std::shared_ptr<const std::vector<ResultVector>>;
+  static constexpr std::size_t DEFAULT_BUDGET = 64ULL * 1024ULL * 1024ULL;
+  static constexpr std::size_t STATEMENT_CAPACITY = 256;
+
+  ResultCache() = delete;
+  ResultCache(const ResultCache&) = delete;
+  ResultCache(ResultCache&&) noexcept;
+  auto operator=(const ResultCache&) -> ResultCache& = delete;
+  auto operator=(ResultCache&&) -> ResultCache& = delete;
+
+  /// @brief Caches the results of statements run on connection using at most budget bytes
+  explicit ResultCache(Connection connection, std::size_t budget = DEFAULT_BUDGET);
+  ~ResultCache();
+
+  /// @brief Returns every row of the statement, from the cache when possible
+  [[nodiscard]] auto fetchAll(std::string_view statement, const ParamVector& parameters = {}) -> Rows;
+
+  /// @brief Returns the names of the tables and views the statement reads, preparing it if needed
+  /// @note The names stay valid until the statement is no longer among the most recently used ones.
+  [[nodiscard]] auto tables(std::string_view statement) -> const std::vector<std::string>&;
+
+  /// @brief Drops every entry that reads a table with that name, in any schema
+  void invalidate(std::string_view table);
+
+  /// @brief Drops every entry
+  void clear();
+
+  /// @brief Returns the hit ratio and memory counters
+  [[nodiscard]] auto stats() const -> ResultCacheStats;
+
+private:
+  struct State;
+  std::unique_ptr<State> state_;
+};
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
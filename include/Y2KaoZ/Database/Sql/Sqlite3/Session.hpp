@@ -0,0 +1,131 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Sql/Sqlite3/Connection.hpp"
+#include "Y2KaoZ/Database/Types.hpp"
+#include "Y2KaoZ/Database/Visibility.hpp"
+
+#ifdef SQLITE_ENABLE_SESSION
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief Why a change of a changeset could not be applied as is.
+enum class ConflictType : std::uint8_t
+{
+  Data = 0,   ///< the row to update or delete exists but does not hold the expected values
+  NotFound,   ///< the row to update or delete does not exist
+  Conflict,   ///< the row to insert already exists
+  Constraint, ///< the change would violate a constraint
+  ForeignKey  ///< the changeset as a whole leaves foreign keys unsatisfied
+};
+
+/// @brief What applyChangeset does about a conflict.
+enum class ConflictAction : std::uint8_t
+{
+  Omit = 0, ///< skip the change
+  Replace,  ///< apply the change over the existing row, only for Data and Conflict
+  Abort     ///< roll every change of the changeset back
+};
+
+/// @brief A change that conflicts with the database it is applied to.
+struct Y2KAOZDATABASE_EXPORT ChangesetConflict {
+  ConflictType type = ConflictType::Data;
+  std::string table;
+  RowChange change = RowChange::Insert;
+  /// @brief The row before an update or delete, for updates the columns that did not change are null.
+  std::optional<ResultVector> oldValues;
+  /// @brief The row after an insert or update, for updates the columns that did not change are null.
+  std::optional<ResultVector> newValues;
+  /// @brief The row of the database the change conflicts with, for Data and Conflict.
+  std::optional<ResultVector> conflictingValues;
+  /// @brief The number of foreign key violations, for ForeignKey.
+  int foreignKeyViolations = 0;
+};
+
+/// @brief Decides what to do about a conflict, the default aborts.
+using ConflictHandler = std::function<ConflictAction(const ChangesetConflict& conflict)>;
+/// @brief Tells whether the changes of a table are applied, the default applies every table.
+using TableFilter = std::function<bool(std::string_view table)>;
+/// @brief Receives a changeset chunk by chunk.
+using ChangesetOutput = std::function<void(BlobView chunk)>;
+/// @brief Fills buffer with the next bytes of a changeset and returns how many, 0 at the end.
+using ChangesetInput = std::function<std::size_t(std::span<std::byte> buffer)>;
+
+/// @brief Records the changes made to some tables of a database through a connection, as a changeset or a patchset.
+/// @note Wraps the session extension of sqlite, the library and sqlite must be built with SQLITE_ENABLE_SESSION and
+/// SQLITE_ENABLE_PREUPDATE_HOOK. Only tables with a PRIMARY KEY are recorded. A changeset carries the old values of
+/// every changed row so conflicts can be detected, a patchset only the primary key and the new values, it is smaller
+/// but only conflicts on missing or existing rows are detected.
+class Y2KAOZDATABASE_EXPORT Session {
+public:
+  Session() = delete;
+  Session(const Session&) = delete;
+  Session(Session&&) noexcept;
+  auto operator=(const Session&) -> Session& = delete;
+  auto operator=(Session&&) -> Session& = delete;
+
+  /// @brief Starts a session on the database (main, temp or an attached schema) of connection
+  /// @throws Exception if the session can not be created
+  explicit Session(Connection connection, const std::string& database = "main");
+  ~Session();
+
+  /// @brief Records the changes made to table from now on
+  void attach(const std::string& table);
+
+  /// @brief Records the changes made to every table, including those created later
+  void attachAll();
+
+  /// @brief Pauses or resumes the recording
+  void setEnabled(bool enabled);
+  [[nodiscard]] auto enabled() const -> bool;
+
+  /// @brief Marks the changes recorded from now on as indirect, made by triggers or foreign key actions
+  void setIndirect(bool indirect);
+
+  /// @brief Tells whether no change was recorded
+  [[nodiscard]] auto empty() const -> bool;
+
+  /// @brief Returns the changes recorded so far as a changeset
+  [[nodiscard]] auto changeset() const -> BlobType;
+  /// @brief Streams the changes recorded so far as a changeset, without building it in memory
+  void changeset(const ChangesetOutput& output) const;
+
+  /// @brief Returns the changes recorded so far as a patchset
+  [[nodiscard]] auto patchset() const -> BlobType;
+  /// @brief Streams the changes recorded so far as a patchset, without building it in memory
+  void patchset(const ChangesetOutput& output) const;
+
+  /// @brief Returns the changeset and starts recording again from an empty session, for one changeset per batch
+  [[nodiscard]] auto takeChangeset() -> BlobType;
+  /// @brief Returns the patchset and starts recording again from an empty session, for one patchset per batch
+  [[nodiscard]] auto takePatchset() -> BlobType;
+
+private:
+  struct State;
+  std::unique_ptr<State> state_;
+};
+
+/// @brief Applies a changeset or patchset to the database of connection, all or nothing
+/// @throws Exception if the changeset is invalid or was aborted, or what onConflict or filter threw
+Y2KAOZDATABASE_EXPORT void applyChangeset(
+  Connection& connection,
+  BlobView changeset,
+  const ConflictHandler& onConflict = {},
+  const TableFilter& filter = {});
+
+/// @brief Applies a changeset or patchset read chunk by chunk from input, all or nothing
+/// @throws Exception if the changeset is invalid or was aborted, or what input, onConflict or filter threw
+Y2KAOZDATABASE_EXPORT void applyChangeset(
+  Connection& connection,
+  const ChangesetInput& input,
+  const ConflictHandler& onConflict = {},
+  const TableFilter& filter = {});
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
+
+#endif
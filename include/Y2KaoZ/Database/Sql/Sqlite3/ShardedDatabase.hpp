@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Sql/Sqlite3/Connection.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/ParallelScan.hpp"
+#include "Y2KaoZ/Database/Types.hpp"
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief Maps a key to the index of the shard that owns it, given the number of shards.
+using ShardRouter = std::function<std::size_t(const ParamType& key, std::size_t shards)>;
+
+/// @brief A set of database files (shards) with a connection each, every shard has its own write lock.
+class Y2KAOZDATABASE_EXPORT ShardedDatabase {
+public:
+  ShardedDatabase() = delete;
+
+  /// @brief Opens one connection per filename, keys are routed with router.
+  explicit ShardedDatabase(
+    const std::vector<std::filesystem::path>& filenames,
+    ShardRouter router = hashRouter(),
+    std::uint32_t flags = Connection::OPEN_READWRITE | Connection::OPEN_CREATE);
+
+  /// @brief Routes keys by their stable hash (see hashValue).
+  [[nodiscard]] static auto hashRouter() -> ShardRouter;
+
+  /// @brief Routes integer keys by range, shard i owns the keys lower than upperBounds[i] not owned by a previous
+  /// shard and the last shard owns the rest.
+  [[nodiscard]] static auto rangeRouter(std::vector<std::int64_t> upperBounds) -> ShardRouter;
+
+  /// @brief Returns the number of shards
+  [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+  /// @brief Returns the index of the shard that owns key
+  [[nodiscard]] auto shardOf(const ParamType& key) const -> std::size_t;
+
+  /// @brief Returns the connection to shard i
+  [[nodiscard]] auto shard(std::size_t i) -> Connection&;
+
+  /// @brief Returns the connection to the shard that owns key
+  [[nodiscard]] auto route(const ParamType& key) -> Connection&;
+
+  /// @brief Executes semicolon-separated SQL statements on every shard, useful to keep the schema in sync
+  void execute(std::string_view statements);
+
+  /// @brief Runs the same statement on every shard in parallel and returns the rows of each shard
+  [[nodiscard]] auto scatter(std::string_view query, const ParamVector& parameters = {})
+    -> std::vector<std::vector<ResultVector>>;
+
+  /// @brief Runs the same statement on every shard in parallel and concatenates the rows in shard order
+  [[nodiscard]] auto fetchAll(std::string_view query, const ParamVector& parameters = {}) -> std::vector<ResultVector>;
+
+  /// @brief Runs the same statement on every shard in parallel and merges the rows, each shard must already be
+  /// sorted by less
+  [[nodiscard]] auto fetchAllOrdered(std::string_view query, const RowCompare& less, const ParamVector& parameters = {})
+    -> std::vector<ResultVector>;
+
+  /// @brief Attaches every shard to connection as schema prefix0, prefix1... for cross-shard reads in plain SQL
+  /// @note The number of shards must not exceed the SQLITE_LIMIT_ATTACHED of the connection (10 by default).
+  void attach(Connection& connection, std::string_view prefix = "shard") const;
+
+  /// @brief Detaches the shards attached by attach
+  void detach(Connection& connection, std::string_view prefix = "shard") const;
+
+  /// @brief Returns "SELECT columns FROM prefix0.table UNION ALL SELECT columns FROM prefix1.table..."
+  [[nodiscard]] auto unionAll(std::string_view table, std::string_view columns = "*", std::string_view prefix = "shard")
+    const -> std::string;
+
+private:
+  std::vector<std::filesystem::path> filenames_;
+  std::vector<Connection> shards_;
+  ShardRouter router_;
+};
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Sql/Sqlite3/Memory.hpp"
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <memory>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief An Allocator that serves sqlite from free lists of power of two size classes carved out of large slabs.
+/// @note Requests up to MAX_CLASS bytes are rounded up to their class and never return their slab to the system,
+/// which avoids the fragmentation of the many small, similar allocations of sqlite. Larger ones go to malloc. Each
+/// class has its own lock.
+class Y2KAOZDATABASE_EXPORT SizeClassAllocator : public Allocator {
+public:
+  static constexpr std::size_t MIN_CLASS = 16;
+  static constexpr std::size_t MAX_CLASS = 4096;
+  static constexpr std::size_t DEFAULT_SLAB_SIZE = 256ULL * 1024ULL;
+
+  /// @brief Reserves memory from the system slabSize bytes at a time
+  explicit SizeClassAllocator(std::size_t slabSize = DEFAULT_SLAB_SIZE);
+  SizeClassAllocator(const SizeClassAllocator&) = delete;
+  SizeClassAllocator(SizeClassAllocator&&) = delete;
+  auto operator=(const SizeClassAllocator&) -> SizeClassAllocator& = delete;
+  auto operator=(SizeClassAllocator&&) -> SizeClassAllocator& = delete;
+  ~SizeClassAllocator() override;
+
+  [[nodiscard]] auto allocate(std::size_t size) noexcept -> void* override;
+  void deallocate(void* memory) noexcept override;
+  [[nodiscard]] auto reallocate(void* memory, std::size_t size) noexcept -> void* override;
+  [[nodiscard]] auto size(void* memory) noexcept -> std::size_t override;
+  [[nodiscard]] auto roundUp(std::size_t size) noexcept -> std::size_t override;
+
+  /// @brief Returns the usable bytes currently handed out
+  [[nodiscard]] auto bytesInUse() const noexcept -> std::size_t;
+
+  /// @brief Returns the bytes obtained from the system: slabs and large allocations
+  [[nodiscard]] auto bytesReserved() const noexcept -> std::size_t;
+
+private:
+  struct State;
+  std::unique_ptr<State> state_;
+};
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
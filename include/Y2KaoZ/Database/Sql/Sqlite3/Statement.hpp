@@ -1,14 +1,32 @@
 #pragma once
 
+#include "Y2KaoZ/Database/Arrow.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/CancellationToken.hpp"
 #include "Y2KaoZ/Database/Sql/Sqlite3/Connection.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Json.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/QueryPlan.hpp"
+#include "Y2KaoZ/Database/StringPool.hpp"
 #include "Y2KaoZ/Database/Types.hpp"
 #include "Y2KaoZ/Database/Visibility.hpp"
+#include <chrono>
+#include <memory>
 #include <optional>
 
 namespace Y2KaoZ::Database::Sql::Sqlite3 {
 
+/// @brief How the TEXT values of an interned column are returned.
+enum class Interning : std::uint8_t
+{
+  View = 0, ///< TEXT cells borrowing the characters stored in the pool
+  Id        ///< INTEGER cells holding the id of the string in the pool
+};
+
 class Y2KAOZDATABASE_EXPORT Statement {
 public:
+  using Clock = std::chrono::steady_clock;
+  static constexpr std::size_t ARROW_BATCH_SIZE = 65536;
+  static constexpr int DEFAULT_PROGRESS_STEPS = 1000;
+
   Statement() = delete;
   Statement(const Statement&) = delete;
   Statement(Statement&& other) = default;
@@ -21,6 +39,15 @@ public:
   /// @brief Returns the connection used for the creation of this statement.
   [[nodiscard]] auto connection() const -> const Connection&;
 
+  /// @brief Returns the raw sqlite3 statement pointer
+  [[nodiscard]] auto backend() const -> gsl::not_null<sqlite3_stmt*>;
+
+  /// @brief Returns the SQL text the statement was prepared from
+  [[nodiscard]] auto sql() const -> std::string_view;
+
+  /// @brief Runs EXPLAIN QUERY PLAN on the SQL of the statement with its current parameters
+  [[nodiscard]] auto queryPlan() const -> QueryPlan;
+
   /// @brief Returns all parameter bindings
   [[nodiscard]] auto parameters() const noexcept -> const ParamVector&;
 
@@ -33,6 +60,12 @@ public:
   auto bind(const ParamVector& parameters) -> Statement&;
   auto bind(const ParamMap& parameters) -> Statement&;
 
+  /// @brief Binds text or a blob to a parameter without copying it
+  /// @note The memory must stay valid and unchanged until the parameter is bound again or cleared. The value is not
+  /// recorded, parameters() reports NULL for it.
+  auto bindView(std::size_t index, std::string_view value) -> Statement&;
+  auto bindView(std::size_t index, BlobView value) -> Statement&;
+
   /// @brief Executes a prepared statement
   /// @note if The execution has no more rows it will call reset automatically.
   auto execute() -> Statement&;
@@ -43,17 +76,48 @@ public:
   /// @brief Resets all parameter bindings to NULL.
   auto clearParameters() -> Statement&;
 
+  /// @brief Stops execute() and the fetch functions with an InterruptedException once deadline has passed
+  /// @note The deadline is checked before every step and, while sqlite works on a step, by a progress hook registered
+  /// on the connection for the duration of the step, see Connection::addProgressHook. std::nullopt removes it.
+  auto setDeadline(std::optional<Clock::time_point> deadline) -> Statement&;
+
+  /// @brief Stops execute() and the fetch functions with an InterruptedException once token is cancelled
+  auto setCancellationToken(std::optional<CancellationToken> token) -> Statement&;
+
+  /// @brief Sets how many virtual machine instructions run between two checks of the deadline and the token
+  /// @note Lower values react faster at the cost of more checks.
+  auto setProgressSteps(int steps) -> Statement&;
+
+  /// @brief Interns the TEXT values of column i into pool instead of copying them into every fetched cell
+  /// @note Other types are returned unchanged. Rows fetched with Interning::View borrow from the pool, which must
+  /// outlive them, copies of the rows own their characters. Sharing a pool between statements gives the same ids to
+  /// the same strings.
+  auto intern(std::size_t i, std::shared_ptr<StringPool> pool, Interning as = Interning::View) -> Statement&;
+
   /// @brief Returns the number of columns in the result set
   [[nodiscard]] auto columnCount() const -> std::size_t;
 
   /// @brief Returns the column name for column i
   [[nodiscard]] auto columnName(std::size_t i) const -> std::string;
 
+  /// @brief Returns column i of the current row as bytes without copying, std::nullopt if it is NULL or there is no row
+  /// @note The view stays valid until the statement executes again or is reset. TEXT is returned as its UTF-8 bytes.
+  [[nodiscard]] auto columnBlob(std::size_t i) const -> std::optional<BlobView>;
+
+  /// @brief Returns column i of the current row as text without copying, std::nullopt if it is NULL or there is no row
+  /// @note The view stays valid until the statement executes again or is reset.
+  [[nodiscard]] auto columnText(std::size_t i) const -> std::optional<std::string_view>;
+
   /// @brief Fetches the next row from a result set using numeric column keys
   [[nodiscard]] auto fetchVector() -> std::optional<ResultVector>;
+  [[nodiscard]] auto fetchVector(std::pmr::memory_resource* resource) -> std::optional<pmr::ResultVector>;
+
+  /// @brief Fetches the next row into row, reusing its storage, returns false if there are no more rows
+  auto fetchInto(ResultVector& row) -> bool;
 
   /// @brief Fetches the next row from a result set using string column keys
   [[nodiscard]] auto fetchMap() -> std::optional<ResultMap>;
+  [[nodiscard]] auto fetchMap(std::pmr::memory_resource* resource) -> std::optional<pmr::ResultMap>;
 
   /// @brief Returns a single column from the next row of a result set
   [[nodiscard]] auto fetchColumn(std::size_t i) -> std::optional<ResultType>;
@@ -61,13 +125,42 @@ public:
   /// @brief Fetches the remaining rows from a result set as a vector
   [[nodiscard]] auto fetchAllVector() -> std::vector<ResultVector>;
 
+  /// @brief Fetches the remaining rows from a result set as a vector allocated from resource
+  /// @note Pass a std::pmr::monotonic_buffer_resource to release the whole result set in one step.
+  [[nodiscard]] auto fetchAllVector(std::pmr::memory_resource* resource) -> std::pmr::vector<pmr::ResultVector>;
+
   /// @brief Fetches the remaining rows from a result set as a map
   [[nodiscard]] auto fetchAllMap() -> std::vector<ResultMap>;
 
+  /// @brief Fetches the remaining rows from a result set as a map allocated from resource, column names included
+  [[nodiscard]] auto fetchAllMap(std::pmr::memory_resource* resource) -> std::pmr::vector<pmr::ResultMap>;
+
+  /// @brief Exports the remaining rows as Arrow record batches of up to batchSize rows, see exportArrow
+  void exportArrow(ArrowSchema* schema, ArrowArrayStream* stream, std::size_t batchSize = ARROW_BATCH_SIZE);
+
+  /// @brief Writes the remaining rows as JSON to sink or buffer and returns the number of rows, see writeJson
+  auto writeJson(const JsonSink& sink, const JsonOptions& options = {}) -> std::uint64_t;
+  auto writeJson(fmt::memory_buffer& buffer, const JsonOptions& options = {}) -> std::uint64_t;
+
 private:
+  struct Interned {
+    std::shared_ptr<StringPool> pool;
+    Interning as;
+  };
+
+  // Returns why the statement must stop, or nullptr if it may go on.
+  [[nodiscard]] auto interruption() const noexcept -> const char*;
+
+  [[nodiscard]] auto column(int i, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const
+    -> ResultType;
+
   Connection connection_;
   std::unique_ptr<sqlite3_stmt, decltype(&sqlite3_finalize)> stmt_;
   ParamVector parameters_;
+  std::vector<Interned> interned_;
+  std::optional<Clock::time_point> deadline_;
+  std::optional<CancellationToken> token_;
+  int progressSteps_ = DEFAULT_PROGRESS_STEPS;
   bool rows_;
 };
 
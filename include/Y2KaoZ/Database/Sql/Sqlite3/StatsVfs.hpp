@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Sql/Sqlite3/Connection.hpp"
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+/// @brief The files sqlite opens for a database.
+enum class FileKind : std::uint8_t
+{
+  Main = 0, ///< the database file
+  Journal,  ///< the rollback journal and the super-journal
+  Wal,      ///< the write-ahead log
+  Temp      ///< temporary databases, sub-journals, statement journals and transient tables
+};
+
+/// @brief Number, size and duration of one kind of I/O call.
+struct Y2KAOZDATABASE_EXPORT IoCounter {
+  std::uint64_t calls = 0;
+  std::uint64_t bytes = 0;
+  std::chrono::nanoseconds time{0};
+  std::chrono::nanoseconds maxTime{0};
+};
+
+/// @brief The I/O made on one kind of file.
+struct Y2KAOZDATABASE_EXPORT FileIoStats {
+  IoCounter reads;
+  IoCounter writes;
+  IoCounter syncs;
+  IoCounter locks;                  ///< calls to xLock, the time includes waits done by the VFS
+  std::uint64_t readAheads = 0;     ///< read-ahead requests issued
+  std::uint64_t readAheadBytes = 0; ///< bytes requested by read-ahead
+
+  auto operator+=(const FileIoStats& other) -> FileIoStats&;
+};
+
+/// @brief The I/O made through a StatsVfs, by kind of file.
+struct Y2KAOZDATABASE_EXPORT IoStats {
+  static constexpr std::size_t FILE_KINDS = 4;
+  std::array<FileIoStats, FILE_KINDS> files{};
+
+  [[nodiscard]] auto operator[](FileKind kind) const -> const FileIoStats&;
+  /// @brief Returns the I/O made on every kind of file
+  [[nodiscard]] auto total() const -> FileIoStats;
+};
+
+/// @brief A VFS that counts and times the reads, writes, syncs and locks made through another VFS.
+/// @note Connections select it by name (see Connection). The I/O of a connection is attributed to it through the
+/// file names sqlite gives its journal and WAL, temporary files have no name and only appear in the totals.
+/// Sequential reads of a database file can trigger read-ahead: once SEQUENTIAL_READS consecutive reads followed each
+/// other, the next readAhead bytes are announced to the operating system (posix_fadvise) so it reads them in the
+/// background. This goes through the page cache of the system and can never return stale data, on systems without
+/// posix_fadvise it does nothing. The hint goes through one read-only descriptor per database file, shared by the
+/// process and kept open until it exits: sqlite holds its locks as POSIX locks, which the close of any descriptor of
+/// the file drops, even those of connections using another VFS. The VFS must outlive the connections that use it.
+class Y2KAOZDATABASE_EXPORT StatsVfs {
+public:
+  static constexpr const char* DEFAULT_NAME = "y2kaoz-stats";
+  static constexpr std::size_t DEFAULT_READ_AHEAD = 1024ULL * 1024ULL;
+  static constexpr int SEQUENTIAL_READS = 4;
+
+  StatsVfs(const StatsVfs&) = delete;
+  StatsVfs(StatsVfs&&) = delete;
+  auto operator=(const StatsVfs&) -> StatsVfs& = delete;
+  auto operator=(StatsVfs&&) -> StatsVfs& = delete;
+
+  /// @brief Registers the VFS as name on top of the VFS registered as base, the default one if base is empty
+  /// @param readAhead bytes read ahead of sequential reads, 0 disables read-ahead
+  /// @throws Exception if base does not exist or the VFS can not be registered
+  explicit StatsVfs(std::string name = DEFAULT_NAME, std::size_t readAhead = 0, const std::string& base = {});
+  /// @brief Unregisters the VFS
+  ~StatsVfs();
+
+  /// @brief Returns the name connections use to select the VFS
+  [[nodiscard]] auto name() const noexcept -> const std::string&;
+
+  /// @brief Returns the I/O made through the VFS and optionally starts counting again from 0
+  [[nodiscard]] auto stats(bool reset = false) const -> IoStats;
+
+  /// @brief Returns the I/O made by connection and optionally starts counting again from 0
+  /// @throws std::invalid_argument if the connection was not opened through this VFS
+  [[nodiscard]] auto stats(const Connection& connection, bool reset = false) const -> IoStats;
+
+private:
+  struct State;
+  std::unique_ptr<State> state_;
+};
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
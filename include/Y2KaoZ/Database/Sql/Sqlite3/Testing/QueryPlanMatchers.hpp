@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Sql/Sqlite3/QueryPlan.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Statement.hpp"
+#include <algorithm>
+#include <catch2/catch_tostring.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Catch2 matchers guarding the query plans of performance critical statements. This header is not part of the
+// library, it is meant for test suites that already link Catch2:
+//   CHECK_THAT(statement.queryPlan(), UsesIndexes());
+
+template <>
+struct Catch::StringMaker<Y2KaoZ::Database::Sql::Sqlite3::QueryPlan> {
+  static auto convert(const Y2KaoZ::Database::Sql::Sqlite3::QueryPlan& plan) -> std::string {
+    return plan.toString();
+  }
+};
+
+namespace Y2KaoZ::Database::Sql::Sqlite3::Testing {
+
+/// @brief Matches plans that neither scan a table without an index nor build an automatic index.
+class UsesIndexesMatcher : public Catch::Matchers::MatcherBase<QueryPlan> {
+public:
+  explicit UsesIndexesMatcher(std::vector<std::string> allowedScans) : allowedScans_(std::move(allowedScans)) {
+  }
+
+  [[nodiscard]] auto match(const QueryPlan& plan) const -> bool override {
+    auto scans = plan.fullScans();
+    return plan.automaticIndexes().empty() && std::all_of(scans.begin(), scans.end(), [&](const std::string& table) {
+             return std::find(allowedScans_.begin(), allowedScans_.end(), table) != allowedScans_.end();
+           });
+  }
+
+  [[nodiscard]] auto describe() const -> std::string override {
+    std::string description = "uses an index for every table";
+    for (std::size_t i = 0; i < allowedScans_.size(); ++i) {
+      description += (i == 0 ? " but " : ", ") + allowedScans_[i];
+    }
+    return description;
+  }
+
+private:
+  std::vector<std::string> allowedScans_;
+};
+
+/// @brief Fails when the plan scans a table that is not in allowedScans or builds an automatic index
+[[nodiscard]] inline auto UsesIndexes(std::vector<std::string> allowedScans = {}) -> UsesIndexesMatcher {
+  return UsesIndexesMatcher(std::move(allowedScans));
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3::Testing
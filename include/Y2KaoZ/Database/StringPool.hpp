@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Y2KaoZ/Database/Visibility.hpp"
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Y2KaoZ::Database {
+
+/// @brief An append-only dictionary that stores each distinct string once and numbers them densely from 0.
+/// @note The characters live in a monotonic arena, so the views it hands out stay valid until the pool is destroyed.
+/// A pool is not thread safe, share it between statements of the same thread.
+class Y2KAOZDATABASE_EXPORT StringPool {
+public:
+  using Id = std::uint32_t;
+
+  StringPool();
+  StringPool(const StringPool&) = delete;
+  StringPool(StringPool&&) = delete;
+  auto operator=(const StringPool&) -> StringPool& = delete;
+  auto operator=(StringPool&&) -> StringPool& = delete;
+  ~StringPool() = default;
+
+  /// @brief Returns the id of value, adding it to the pool the first time it is seen
+  [[nodiscard]] auto intern(std::string_view value) -> Id;
+
+  /// @brief Returns the id of value if it is already in the pool
+  [[nodiscard]] auto find(std::string_view value) const -> std::optional<Id>;
+
+  /// @brief Returns the string with that id
+  /// @throws std::out_of_range if the id is not in the pool
+  [[nodiscard]] auto view(Id id) const -> std::string_view;
+
+  /// @brief Returns every distinct string, indexed by id
+  [[nodiscard]] auto dictionary() const noexcept -> const std::vector<std::string_view>&;
+
+  /// @brief Returns the number of distinct strings
+  [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+  /// @brief Returns the number of characters stored in the pool
+  [[nodiscard]] auto bytes() const noexcept -> std::size_t;
+
+private:
+  std::pmr::monotonic_buffer_resource arena_;
+  std::vector<std::string_view> dictionary_;
+  std::unordered_map<std::string_view, Id> ids_;
+  std::size_t bytes_ = 0;
+};
+
+} // namespace Y2KaoZ::Database
@@ -1,8 +1,14 @@
 #pragma once
 
 #include "Y2KaoZ/Database/Visibility.hpp"
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <variant>
 #include <vector>
@@ -30,9 +36,16 @@ using ParamType = std::variant<
 using ParamVector = std::vector<ParamType>;
 using ParamMap = std::unordered_map<std::string_view, ParamType>;
 
+/// @brief A read-only view of the bytes of a BLOB result.
+using BlobView = std::span<const std::byte>;
+
+/// @brief A single column value read from a result set.
+/// @note The cell takes 24 bytes: TEXT and BLOB values up to INLINE_CAPACITY bytes are stored inside it and longer
+/// ones in memory obtained from its std::pmr::memory_resource, which makes it usable in std::pmr containers.
 class Y2KAOZDATABASE_EXPORT ResultType {
 public:
   using Value = std::variant<NullType, std::int64_t, double, std::string, BlobType>;
+  using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
   enum class Type : std::uint8_t
   {
     Null = 0,
@@ -42,8 +55,33 @@ public:
     Blob,
     Unknown = static_cast<std::uint8_t>(-1)
   };
-  ResultType() = default;
+  static constexpr std::size_t INLINE_CAPACITY = 14;
+
+  ResultType() noexcept;
+  explicit ResultType(const allocator_type& allocator) noexcept;
   explicit ResultType(Value r);
+  ResultType(Value r, const allocator_type& allocator);
+  ResultType(const ResultType& other);
+  ResultType(const ResultType& other, const allocator_type& allocator);
+  ResultType(ResultType&& other) noexcept;
+  ResultType(ResultType&& other, const allocator_type& allocator);
+  auto operator=(const ResultType& other) -> ResultType&;
+  auto operator=(ResultType&& other) -> ResultType&;
+  ~ResultType();
+
+  /// @brief Makes a TEXT value without going through an intermediate std::string
+  [[nodiscard]] static auto fromText(std::string_view text, const allocator_type& allocator = {}) -> ResultType;
+
+  /// @brief Makes a BLOB value without going through an intermediate BlobType
+  [[nodiscard]] static auto fromBlob(BlobView blob, const allocator_type& allocator = {}) -> ResultType;
+
+  /// @brief Makes a TEXT value that borrows the characters instead of copying them
+  /// @note The characters must outlive the cell and the cells it is moved to, as with the views of a StringPool. Copies
+  /// own their characters.
+  [[nodiscard]] static auto fromView(std::string_view text, const allocator_type& allocator = {}) -> ResultType;
+
+  [[nodiscard]] auto get_allocator() const noexcept -> allocator_type; // NOLINT(readability-identifier-naming)
+
   [[nodiscard]] auto isNull() const noexcept -> bool;
   [[nodiscard]] auto isInteger() const noexcept -> bool;
   [[nodiscard]] auto isReal() const noexcept -> bool;
@@ -60,20 +98,86 @@ public:
   [[nodiscard]] auto asUnsigned32() const -> std::uint32_t;
   [[nodiscard]] auto asInteger64() const -> std::int64_t;
   [[nodiscard]] auto asUnsigned64() const -> std::uint64_t;
+  /// @brief Like the as* conversions but returns an empty optional instead of throwing
+  [[nodiscard]] auto tryAsInteger8() const noexcept -> std::optional<std::int8_t>;
+  [[nodiscard]] auto tryAsUnsigned8() const noexcept -> std::optional<std::uint8_t>;
+  [[nodiscard]] auto tryAsInteger16() const noexcept -> std::optional<std::int16_t>;
+  [[nodiscard]] auto tryAsUnsigned16() const noexcept -> std::optional<std::uint16_t>;
+  [[nodiscard]] auto tryAsInteger32() const noexcept -> std::optional<std::int32_t>;
+  [[nodiscard]] auto tryAsUnsigned32() const noexcept -> std::optional<std::uint32_t>;
+  [[nodiscard]] auto tryAsInteger64() const noexcept -> std::optional<std::int64_t>;
+  [[nodiscard]] auto tryAsUnsigned64() const noexcept -> std::optional<std::uint64_t>;
   [[nodiscard]] auto getReal() const -> const double&;
   [[nodiscard]] auto getReal() -> double&;
   [[nodiscard]] auto asReal() const -> double;
-  [[nodiscard]] auto getString() const -> const std::string&;
+  [[nodiscard]] auto tryAsReal() const noexcept -> std::optional<double>;
+  /// @brief Returns a copy of the TEXT value
+  /// @note Unlike the other const getters it returns by value: a const cell keeps the text as bytes and can not hand
+  /// out a std::string without allocating one. Prefer stringView to read it without a copy.
+  [[nodiscard]] auto getString() const -> std::string;
+  /// @brief Returns the TEXT value as a string that can be modified in place
+  /// @note Only the first call allocates: it moves the value into a std::string owned by the cell, which later calls
+  /// return. Prefer stringView to read it.
   [[nodiscard]] auto getString() -> std::string&;
+  /// @brief Returns a view of the TEXT value, valid as long as the cell is neither modified nor destroyed
+  [[nodiscard]] auto stringView() const -> std::string_view;
   [[nodiscard]] auto asString() const -> std::string;
-  [[nodiscard]] auto getBlob() const -> const BlobType&;
+  /// @brief Returns a copy of the BLOB value
+  /// @note Returns by value for the same reason as getString, prefer blobView to read it without a copy.
+  [[nodiscard]] auto getBlob() const -> BlobType;
+  /// @brief Returns the BLOB value as a vector that can be modified in place
+  /// @note Only the first call allocates: it moves the value into a BlobType owned by the cell, which later calls
+  /// return. Prefer blobView to read it.
   [[nodiscard]] auto getBlob() -> BlobType&;
+  /// @brief Returns a view of the BLOB value, valid as long as the cell is neither modified nor destroyed
+  [[nodiscard]] auto blobView() const -> BlobView;
   [[nodiscard]] auto asBlob() const -> BlobType;
 
 private:
-  Value value_;
+  static constexpr std::uint8_t OUT_OF_LINE = 0xFF;
+  static constexpr std::uint8_t BORROWED = 0xFE;
+  // The payload is a std::string or a BlobType allocated from the memory resource, made by the non-const getters.
+  static constexpr std::uint8_t OBJECT = 0xFD;
+
+  void assign(Type type, const void* data, std::size_t size);
+  void point(Type type, const void* data, std::size_t size, std::uint8_t storage) noexcept;
+  void assign(const Value& value);
+  void assign(const ResultType& other);
+  void steal(ResultType& other) noexcept;
+  void release() noexcept;
+  [[nodiscard]] auto bytes() const noexcept -> BlobView;
+  template <typename T>
+  [[nodiscard]] auto object() const noexcept -> T*;
+  template <typename T>
+  [[nodiscard]] auto promote() -> T&;
+
+  // Integers, reals, the object pointer and the out-of-line or borrowed pointer (followed by its 32 bits size) live at
+  // the start of data_.
+  std::pmr::memory_resource* resource_;
+  alignas(std::int64_t) std::array<std::byte, INLINE_CAPACITY> data_{};
+  std::uint8_t size_ = 0;
+  Type type_ = Type::Null;
 };
 using ResultVector = std::vector<ResultType>;
 using ResultMap = std::unordered_map<std::string, ResultType>;
 
+namespace pmr {
+/// @brief Rows whose storage, including the column-name keys, comes from a std::pmr::memory_resource.
+using ResultVector = std::pmr::vector<ResultType>;
+using ResultMap = std::pmr::unordered_map<std::pmr::string, ResultType>;
+} // namespace pmr
+
+/// @brief Converts column i of every row to an integer, the cells that can not be converted are left empty
+[[nodiscard]] Y2KAOZDATABASE_EXPORT auto columnAsInteger64(const std::vector<ResultVector>& rows, std::size_t column)
+  -> std::vector<std::optional<std::int64_t>>;
+
+/// @brief Converts column i of every row to a real, the cells that can not be converted are left empty
+[[nodiscard]] Y2KAOZDATABASE_EXPORT auto columnAsReal(const std::vector<ResultVector>& rows, std::size_t column)
+  -> std::vector<std::optional<double>>;
+
+/// @brief Returns a stable FNV-1a hash of the value as stored by sqlite, every integer type hashes as an int64 and
+/// every floating point type as a double so a ParamType and the ResultType read back from it hash the same.
+[[nodiscard]] Y2KAOZDATABASE_EXPORT auto hashValue(const ParamType& value) noexcept -> std::uint64_t;
+[[nodiscard]] Y2KAOZDATABASE_EXPORT auto hashValue(const ResultType& value) noexcept -> std::uint64_t;
+
 } // namespace Y2KaoZ::Database
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "Y2KaoZ/Database/MappedFile.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <gsl/gsl_util>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+
+[[noreturn]] void throwErrno(const std::filesystem::path& path) {
+  throw std::system_error(errno, std::generic_category(), path.string());
+}
+
+} // namespace
+
+namespace Y2KaoZ::Database {
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+  auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC); // NOLINT(cppcoreguidelines-pro-type-vararg)
+  if (fd < 0) {
+    throwErrno(path);
+  }
+  auto closeFd = gsl::finally([&]() { ::close(fd); });
+  struct stat status {};
+  if (::fstat(fd, &status) != 0) {
+    throwErrno(path);
+  }
+  size_ = gsl::narrow<std::size_t>(status.st_size);
+  if (size_ == 0) {
+    return;
+  }
+  auto* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (mapping == MAP_FAILED) { // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+    throwErrno(path);
+  }
+  data_ = static_cast<char*>(mapping);
+  ::madvise(data_, size_, MADV_SEQUENTIAL);
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+  : data_(std::exchange(other.data_, nullptr))
+  , size_(std::exchange(other.size_, 0))
+  , released_(std::exchange(other.released_, 0)) {
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    ::munmap(data_, size_);
+  }
+}
+
+auto MappedFile::data() const noexcept -> const char* {
+  return data_;
+}
+
+auto MappedFile::size() const noexcept -> std::size_t {
+  return size_;
+}
+
+auto MappedFile::view() const noexcept -> std::string_view {
+  return {data_, size_};
+}
+
+void MappedFile::release(std::size_t offset) noexcept {
+  static const auto PAGE_SIZE = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  auto end = std::min(offset, size_) / PAGE_SIZE * PAGE_SIZE;
+  if (data_ == nullptr || end <= released_) {
+    return;
+  }
+  // The mapping is read-only and private, dropped pages are read again from the file if they are ever touched.
+  ::madvise(data_ + released_, end - released_, MADV_DONTNEED); // NOLINT(*-pointer-arithmetic)
+  released_ = end;
+}
+
+} // namespace Y2KaoZ::Database
@@ -0,0 +1,335 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/ArrowExport.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <gsl/gsl_util>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Y2KaoZ::Database::Sql::Sqlite3::Statement;
+
+enum class Kind
+{
+  Integer,
+  Real,
+  Text,
+  Blob
+};
+
+struct Column {
+  std::string name;
+  Kind kind;
+};
+
+[[nodiscard]] auto format(Kind kind) noexcept -> const char* {
+  switch (kind) {
+    case Kind::Integer:
+      return "l";
+    case Kind::Real:
+      return "g";
+    case Kind::Blob:
+      return "z";
+    default:
+      return "u";
+  }
+}
+
+// The affinity rules of sqlite, NUMERIC affinity can hold integers and reals so it gives no type.
+[[nodiscard]] auto affinity(const char* declared) -> std::optional<Kind> {
+  if (declared == nullptr) {
+    return {};
+  }
+  std::string type(declared);
+  std::transform(type.begin(), type.end(), type.begin(), [](unsigned char c) { return std::toupper(c); });
+  auto contains = [&](const char* part) { return type.find(part) != std::string::npos; };
+  if (contains("INT")) {
+    return Kind::Integer;
+  }
+  if (contains("CHAR") || contains("CLOB") || contains("TEXT")) {
+    return Kind::Text;
+  }
+  if (contains("BLOB")) {
+    return Kind::Blob;
+  }
+  if (contains("REAL") || contains("FLOA") || contains("DOUB")) {
+    return Kind::Real;
+  }
+  return {};
+}
+
+[[nodiscard]] auto columns(const Statement& statement) -> std::vector<Column> {
+  auto* stmt = statement.backend().get();
+  std::vector<Column> result;
+  for (int i = 0; i < sqlite3_column_count(stmt); ++i) {
+    auto kind = affinity(sqlite3_column_decltype(stmt, i));
+    if (!kind) {
+      switch (statement.rows() ? sqlite3_column_type(stmt, i) : SQLITE_NULL) {
+        case SQLITE_INTEGER:
+          kind = Kind::Integer;
+          break;
+        case SQLITE_FLOAT:
+          kind = Kind::Real;
+          break;
+        case SQLITE_BLOB:
+          kind = Kind::Blob;
+          break;
+        default:
+          kind = Kind::Text;
+          break;
+      }
+    }
+    result.push_back({sqlite3_column_name(stmt, i), *kind});
+  }
+  return result;
+}
+
+// Every schema and array owns its children, which the consumer may also move out and release on their own.
+struct SchemaData {
+  std::string name;
+  std::vector<ArrowSchema> children;
+  std::vector<ArrowSchema*> pointers;
+};
+
+void releaseSchema(ArrowSchema* schema) {
+  auto* data = static_cast<SchemaData*>(schema->private_data);
+  for (auto* child : data->pointers) {
+    if (child->release != nullptr) {
+      child->release(child);
+    }
+  }
+  delete data; // NOLINT(cppcoreguidelines-owning-memory)
+  schema->release = nullptr;
+}
+
+void exportSchema(const std::vector<Column>& columns, ArrowSchema* out) {
+  auto data = std::make_unique<SchemaData>();
+  data->children.resize(columns.size());
+  for (std::size_t i = 0; i < columns.size(); ++i) {
+    auto child = std::make_unique<SchemaData>();
+    child->name = columns[i].name;
+    auto& field = data->children[i];
+    const auto* name = child->name.c_str();
+    field = {format(columns[i].kind), name, nullptr, ARROW_FLAG_NULLABLE, 0, nullptr, nullptr, releaseSchema, nullptr};
+    field.private_data = child.release();
+    data->pointers.push_back(&field);
+  }
+  auto children = gsl::narrow<std::int64_t>(columns.size());
+  *out = {"+s", "", nullptr, 0, children, data->pointers.data(), nullptr, releaseSchema, nullptr};
+  out->private_data = data.release();
+}
+
+struct ArrayData {
+  std::vector<std::uint8_t> validity;
+  std::vector<std::int64_t> integers;
+  std::vector<double> reals;
+  std::vector<std::int32_t> offsets;
+  std::vector<std::uint8_t> bytes;
+  std::vector<const void*> buffers;
+  std::vector<ArrowArray> children;
+  std::vector<ArrowArray*> pointers;
+};
+
+void releaseArray(ArrowArray* array) {
+  auto* data = static_cast<ArrayData*>(array->private_data);
+  for (auto* child : data->pointers) {
+    if (child->release != nullptr) {
+      child->release(child);
+    }
+  }
+  delete data; // NOLINT(cppcoreguidelines-owning-memory)
+  array->release = nullptr;
+}
+
+// Appends the values of one column straight from sqlite into the buffers of its Arrow array.
+class ColumnBuilder {
+public:
+  ColumnBuilder(Kind kind, std::size_t reserve) : kind_(kind), data_(std::make_unique<ArrayData>()) {
+    data_->validity.reserve((reserve + 7) / 8);
+    if (kind_ == Kind::Integer) {
+      data_->integers.reserve(reserve);
+    } else if (kind_ == Kind::Real) {
+      data_->reals.reserve(reserve);
+    } else {
+      data_->offsets.reserve(reserve + 1);
+      data_->offsets.push_back(0);
+    }
+  }
+
+  // Tells whether the value of the current row would overflow the 32 bit offsets.
+  [[nodiscard]] auto full(sqlite3_stmt* stmt, int i) const -> bool {
+    if (kind_ == Kind::Integer || kind_ == Kind::Real) {
+      return false;
+    }
+    auto size = data_->bytes.size() + static_cast<std::size_t>(sqlite3_column_bytes(stmt, i));
+    return size > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max());
+  }
+
+  void append(sqlite3_stmt* stmt, int i) {
+    auto valid = sqlite3_column_type(stmt, i) != SQLITE_NULL;
+    if (length_ % 8 == 0) {
+      data_->validity.push_back(0);
+    }
+    if (valid) {
+      data_->validity.back() = static_cast<std::uint8_t>(data_->validity.back() | (1U << (length_ % 8)));
+    } else {
+      ++nulls_;
+    }
+    ++length_;
+    switch (kind_) {
+      case Kind::Integer:
+        data_->integers.push_back(valid ? sqlite3_column_int64(stmt, i) : 0);
+        break;
+      case Kind::Real:
+        data_->reals.push_back(valid ? sqlite3_column_double(stmt, i) : 0.0);
+        break;
+      default: {
+        if (valid) {
+          const void* value =
+            kind_ == Kind::Text ? static_cast<const void*>(sqlite3_column_text(stmt, i)) : sqlite3_column_blob(stmt, i);
+          auto size = static_cast<std::size_t>(sqlite3_column_bytes(stmt, i));
+          if (size > 0) {
+            auto offset = data_->bytes.size();
+            data_->bytes.resize(offset + size);
+            std::memcpy(&data_->bytes[offset], value, size);
+          }
+        }
+        data_->offsets.push_back(gsl::narrow<std::int32_t>(data_->bytes.size()));
+      } break;
+    }
+  }
+
+  // Hands the buffers over to out, the builder must not be used afterwards.
+  void finish(ArrowArray* out) {
+    auto& data = *data_;
+    const void* validity = nulls_ == 0 ? nullptr : data.validity.data();
+    switch (kind_) {
+      case Kind::Integer:
+        data.buffers = {validity, data.integers.data()};
+        break;
+      case Kind::Real:
+        data.buffers = {validity, data.reals.data()};
+        break;
+      default:
+        data.buffers = {validity, data.offsets.data(), data.bytes.data()};
+        break;
+    }
+    auto n = gsl::narrow<std::int64_t>(data.buffers.size());
+    *out = {length_, nulls_, 0, n, 0, data.buffers.data(), nullptr, nullptr, nullptr, nullptr};
+    out->private_data = data_.release();
+    out->release = releaseArray;
+  }
+
+private:
+  Kind kind_;
+  std::unique_ptr<ArrayData> data_;
+  std::int64_t length_ = 0;
+  std::int64_t nulls_ = 0;
+};
+
+struct StreamData {
+  Statement* statement;
+  std::vector<Column> columns;
+  std::size_t batchSize;
+  std::string error;
+};
+
+void nextBatch(StreamData& stream, ArrowArray* out) {
+  auto& statement = *stream.statement;
+  if (!statement.rows()) {
+    out->release = nullptr;
+    return;
+  }
+  auto* stmt = statement.backend().get();
+  std::vector<ColumnBuilder> builders;
+  builders.reserve(stream.columns.size());
+  for (const auto& column : stream.columns) {
+    builders.emplace_back(column.kind, stream.batchSize);
+  }
+  auto count = gsl::narrow<int>(builders.size());
+  auto full = [&]() {
+    for (int i = 0; i < count; ++i) {
+      if (builders[static_cast<std::size_t>(i)].full(stmt, i)) {
+        return true;
+      }
+    }
+    return false;
+  };
+  std::int64_t length = 0;
+  while (statement.rows() && static_cast<std::size_t>(length) < stream.batchSize && (length == 0 || !full())) {
+    for (int i = 0; i < count; ++i) {
+      builders[static_cast<std::size_t>(i)].append(stmt, i);
+    }
+    ++length;
+    statement.execute();
+  }
+
+  auto data = std::make_unique<ArrayData>();
+  data->buffers = {nullptr};
+  data->children.resize(builders.size());
+  for (std::size_t i = 0; i < builders.size(); ++i) {
+    builders[i].finish(&data->children[i]);
+    data->pointers.push_back(&data->children[i]);
+  }
+  auto children = gsl::narrow<std::int64_t>(builders.size());
+  *out = {length, 0, 0, 1, children, data->buffers.data(), data->pointers.data(), nullptr, nullptr, nullptr};
+  out->private_data = data.release();
+  out->release = releaseArray;
+}
+
+// The callbacks are called from C, errors are reported with an errno code and get_last_error.
+auto getSchema(ArrowArrayStream* stream, ArrowSchema* out) noexcept -> int {
+  auto& data = *static_cast<StreamData*>(stream->private_data);
+  try {
+    exportSchema(data.columns, out);
+    return 0;
+  } catch (const std::exception& e) {
+    data.error = e.what();
+    return ENOMEM;
+  }
+}
+
+auto getNext(ArrowArrayStream* stream, ArrowArray* out) noexcept -> int {
+  auto& data = *static_cast<StreamData*>(stream->private_data);
+  try {
+    nextBatch(data, out);
+    return 0;
+  } catch (const std::bad_alloc& e) {
+    data.error = e.what();
+    return ENOMEM;
+  } catch (const std::exception& e) {
+    data.error = e.what();
+    return EIO;
+  }
+}
+
+auto getLastError(ArrowArrayStream* stream) noexcept -> const char* {
+  const auto& error = static_cast<StreamData*>(stream->private_data)->error;
+  return error.empty() ? nullptr : error.c_str();
+}
+
+void releaseStream(ArrowArrayStream* stream) noexcept {
+  delete static_cast<StreamData*>(stream->private_data); // NOLINT(cppcoreguidelines-owning-memory)
+  stream->release = nullptr;
+}
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+void exportArrow(Statement& statement, ArrowSchema* schema, ArrowArrayStream* stream, std::size_t batchSize) {
+  if (schema == nullptr || stream == nullptr || batchSize == 0) {
+    throw std::invalid_argument("exportArrow needs a schema, a stream and a positive batch size.");
+  }
+  auto data = std::make_unique<StreamData>(StreamData{&statement, ::columns(statement), batchSize, {}});
+  ::exportSchema(data->columns, schema);
+  *stream = {::getSchema, ::getNext, ::getLastError, ::releaseStream, data.release()};
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,20 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/CancellationToken.hpp"
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+CancellationToken::CancellationToken() : cancelled_(std::make_shared<std::atomic<bool>>(false)) {
+}
+
+void CancellationToken::cancel() noexcept {
+  cancelled_->store(true, std::memory_order_relaxed);
+}
+
+auto CancellationToken::cancelled() const noexcept -> bool {
+  return cancelled_->load(std::memory_order_relaxed);
+}
+
+void CancellationToken::reset() noexcept {
+  cancelled_->store(false, std::memory_order_relaxed);
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
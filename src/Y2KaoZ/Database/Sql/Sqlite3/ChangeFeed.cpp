@@ -0,0 +1,166 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/ChangeFeed.hpp"
+#include <algorithm>
+#include <gsl/gsl_util>
+#include <iterator>
+
+namespace {
+
+#ifdef SQLITE_ENABLE_PREUPDATE_HOOK
+
+using Y2KaoZ::Database::ResultType;
+using Y2KaoZ::Database::ResultVector;
+
+[[nodiscard]] auto toResult(sqlite3_value* value) -> ResultType {
+  switch (sqlite3_value_type(value)) {
+    case SQLITE_INTEGER:
+      return ResultType(sqlite3_value_int64(value));
+    case SQLITE_FLOAT:
+      return ResultType(sqlite3_value_double(value));
+    case SQLITE_TEXT: {
+      const auto* text = reinterpret_cast<const char*>(sqlite3_value_text(value)); // NOLINT
+      return ResultType::fromText({text, gsl::narrow<std::size_t>(sqlite3_value_bytes(value))});
+    }
+    case SQLITE_BLOB: {
+      const auto* blob = static_cast<const std::byte*>(sqlite3_value_blob(value));
+      return ResultType::fromBlob({blob, gsl::narrow<std::size_t>(sqlite3_value_bytes(value))});
+    }
+    default:
+      return ResultType{};
+  }
+}
+
+[[nodiscard]] auto preUpdateRow(sqlite3* db, bool old) -> ResultVector {
+  auto count = sqlite3_preupdate_count(db);
+  ResultVector row;
+  row.reserve(gsl::narrow<std::size_t>(count));
+  for (int i = 0; i < count; ++i) {
+    sqlite3_value* value = nullptr;
+    if ((old ? sqlite3_preupdate_old(db, i, &value) : sqlite3_preupdate_new(db, i, &value)) == SQLITE_OK) {
+      row.emplace_back(toResult(value));
+    } else {
+      row.emplace_back();
+    }
+  }
+  return row;
+}
+
+#endif
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+ChangeFeed::State::State(Connection c, std::size_t capacity) : connection(std::move(c)), ring(capacity) {
+}
+
+void ChangeFeed::State::onSavepoint(SavepointChange change, std::string_view name) {
+  auto undo = [this](std::size_t mark) { pending.resize(std::min(mark, pending.size())); };
+  if (name.empty()) {
+    if (change == SavepointChange::Begin) {
+      statementMark = pending.size();
+    } else if (change == SavepointChange::RollbackTo) {
+      undo(statementMark);
+    }
+    return;
+  }
+  if (change == SavepointChange::Begin) {
+    savepoints.emplace_back(name, pending.size());
+    return;
+  }
+  // Savepoint names are case insensitive, the innermost one with that name is meant.
+  auto savepoint = std::find_if(savepoints.rbegin(), savepoints.rend(), [&](const auto& open) {
+    return open.first.size() == name.size() &&
+           sqlite3_strnicmp(open.first.data(), name.data(), gsl::narrow<int>(name.size())) == 0;
+  });
+  if (savepoint == savepoints.rend()) {
+    return;
+  }
+  if (change == SavepointChange::RollbackTo) {
+    // The savepoint stays open after ROLLBACK TO, the ones nested in it are gone.
+    undo(savepoint->second);
+    savepoints.erase(savepoint.base(), savepoints.end());
+  } else {
+    savepoints.erase(std::prev(savepoint.base()), savepoints.end());
+  }
+}
+
+ChangeFeed::ChangeFeed(Connection connection, std::size_t capacity)
+  : state_(std::make_unique<State>(std::move(connection), capacity)) {
+  auto* state = state_.get();
+#ifdef SQLITE_ENABLE_PREUPDATE_HOOK
+  state->hooks.emplace_back(state->connection.addPreUpdateHook(
+    [state](
+      RowChange change,
+      std::string_view database,
+      std::string_view table,
+      std::int64_t oldRowid,
+      std::int64_t newRowid) {
+      auto* db = state->connection.backend().get();
+      auto& event = state->pending.emplace_back();
+      event.change = change;
+      event.database = database;
+      event.table = table;
+      event.rowid = change == RowChange::Delete ? oldRowid : newRowid;
+      if (change != RowChange::Insert) {
+        event.oldValues = ::preUpdateRow(db, true);
+      }
+      if (change != RowChange::Delete) {
+        event.newValues = ::preUpdateRow(db, false);
+      }
+    }));
+#else
+  state->hooks.emplace_back(state->connection.addUpdateHook(
+    [state](RowChange change, std::string_view database, std::string_view table, std::int64_t rowid) {
+      state->pending.push_back({change, std::string(database), std::string(table), rowid, {}, {}});
+    }));
+#endif
+  state->hooks.emplace_back(state->connection.addCommitHook([state]() {
+    for (auto& event : state->pending) {
+      if (!state->ring.tryPush(std::move(event))) {
+        state->dropped.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    state->pending.clear();
+    state->savepoints.clear();
+  }));
+  state->hooks.emplace_back(state->connection.addRollbackHook([state]() {
+    state->pending.clear();
+    state->savepoints.clear();
+  }));
+  state->hooks.emplace_back(state->connection.addSavepointHook(
+    [state](SavepointChange change, std::string_view name) { state->onSavepoint(change, name); }));
+}
+
+ChangeFeed::~ChangeFeed() {
+  if (state_) {
+    for (auto id : state_->hooks) {
+      state_->connection.removeHook(id);
+    }
+  }
+}
+
+auto ChangeFeed::capacity() const noexcept -> std::size_t {
+  return state_->ring.capacity();
+}
+
+auto ChangeFeed::dropped() const noexcept -> std::uint64_t {
+  return state_->dropped.load(std::memory_order_relaxed);
+}
+
+auto ChangeFeed::tryPop() -> std::optional<ChangeEvent> {
+  return state_->ring.tryPop();
+}
+
+auto ChangeFeed::drain(std::size_t max) -> std::vector<ChangeEvent> {
+  std::vector<ChangeEvent> result;
+  while (result.size() < max) {
+    auto event = state_->ring.tryPop();
+    if (!event) {
+      break;
+    }
+    result.emplace_back(std::move(*event));
+  }
+  return result;
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
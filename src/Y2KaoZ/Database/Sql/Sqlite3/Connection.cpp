@@ -1,44 +1,536 @@
 #include "Y2KaoZ/Database/Sql/Sqlite3/Connection.hpp"
+#include "Y2KaoZ/Database/MappedFile.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/ChangeFeed.hpp"
 #include "Y2KaoZ/Database/Sql/Sqlite3/Exception.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Recorder.hpp"
 #include "Y2KaoZ/Database/Sql/Sqlite3/Statement.hpp"
 #include "Y2KaoZ/Database/Sql/Sqlite3/Transaction.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
 #include <cstddef>
 #include <fmt/format.h>
 #include <gsl/gsl_util>
+#include <optional>
+#include <stdexcept>
+#include <vector>
 
 namespace {
 
-[[nodiscard]] auto connect(const std::string_view& filename, std::uint32_t flags) -> gsl::not_null<sqlite3*> {
+[[nodiscard]] auto connect(const std::string_view& filename, std::uint32_t flags, const std::string& vfs = {})
+  -> gsl::not_null<sqlite3*> {
   using Y2KaoZ::Database::Sql::Sqlite3::Exception;
   sqlite3* db = nullptr;
-  if (sqlite3_open_v2(filename.data(), &db, gsl::narrow<int>(flags), nullptr) != SQLITE_OK) {
-    gsl::finally([&]() { sqlite3_close(db); });
+  const auto* name = vfs.empty() ? nullptr : vfs.c_str();
+  if (sqlite3_open_v2(filename.data(), &db, gsl::narrow<int>(flags), name) != SQLITE_OK) {
+    auto close = gsl::finally([&]() { sqlite3_close(db); });
     throw Exception(sqlite3_errmsg(db));
   }
   return db;
 }
 
+[[nodiscard]] auto toRowChange(int operation) -> Y2KaoZ::Database::Sql::Sqlite3::RowChange {
+  using Y2KaoZ::Database::Sql::Sqlite3::RowChange;
+  switch (operation) {
+    case SQLITE_INSERT:
+      return RowChange::Insert;
+    case SQLITE_DELETE:
+      return RowChange::Delete;
+    default:
+      return RowChange::Update;
+  }
+}
+
+// Skips whitespace and comments, then returns the first keyword of the statement.
+[[nodiscard]] auto firstKeyword(std::string_view sql) -> std::string_view {
+  std::size_t i = 0;
+  while (i < sql.size()) {
+    if (std::isspace(static_cast<unsigned char>(sql[i])) != 0) {
+      ++i;
+    } else if (sql.substr(i, 2) == "--") {
+      i = std::min(sql.find('\n', i), sql.size());
+    } else if (sql.substr(i, 2) == "/*") {
+      auto end = sql.find("*/", i + 2);
+      i = end == std::string_view::npos ? sql.size() : end + 2;
+    } else {
+      break;
+    }
+  }
+  auto start = i;
+  while (i < sql.size() && std::isalpha(static_cast<unsigned char>(sql[i])) != 0) {
+    ++i;
+  }
+  return sql.substr(start, i - start);
+}
+
+// Returns the next keyword or identifier of sql and consumes it, without its quotes. Stops at anything else.
+[[nodiscard]] auto nextToken(std::string_view& sql) -> std::pair<std::string, bool> {
+  sql.remove_prefix(gsl::narrow<std::size_t>(firstKeyword(sql).data() - sql.data()));
+  if (sql.empty()) {
+    return {};
+  }
+  static constexpr std::string_view OPENING = "\"[`'";
+  static constexpr std::string_view CLOSING = "\"]`'";
+  if (auto quote = OPENING.find(sql.front()); quote != std::string_view::npos) {
+    std::string token;
+    std::size_t i = 1;
+    for (; i < sql.size(); ++i) {
+      if (sql[i] == CLOSING[quote]) {
+        // Quotes other than brackets are escaped by doubling them.
+        if (quote == 1 || i + 1 == sql.size() || sql[i + 1] != CLOSING[quote]) {
+          break;
+        }
+        ++i;
+      }
+      token += sql[i];
+    }
+    sql.remove_prefix(std::min(i + 1, sql.size()));
+    return {token, true};
+  }
+  std::size_t i = 0;
+  while (i < sql.size() && (std::isalnum(static_cast<unsigned char>(sql[i])) != 0 || sql[i] == '_' ||
+                            static_cast<unsigned char>(sql[i]) >= 0x80)) {
+    ++i;
+  }
+  std::string token(sql.substr(0, i));
+  sql.remove_prefix(i);
+  return {token, false};
+}
+
+[[nodiscard]] auto isKeyword(const std::pair<std::string, bool>& token, std::string_view keyword) -> bool {
+  return !token.second && token.first.size() == keyword.size() &&
+         sqlite3_strnicmp(token.first.data(), keyword.data(), gsl::narrow<int>(keyword.size())) == 0;
+}
+
+// Recognizes SAVEPOINT name, RELEASE [SAVEPOINT] name and ROLLBACK [TRANSACTION] TO [SAVEPOINT] name.
+[[nodiscard]] auto savepointOf(std::string_view sql)
+  -> std::optional<std::pair<Y2KaoZ::Database::Sql::Sqlite3::SavepointChange, std::string>> {
+  using Y2KaoZ::Database::Sql::Sqlite3::SavepointChange;
+  auto keyword = nextToken(sql);
+  if (isKeyword(keyword, "SAVEPOINT")) {
+    return std::pair{SavepointChange::Begin, nextToken(sql).first};
+  }
+  if (isKeyword(keyword, "RELEASE")) {
+    auto name = nextToken(sql);
+    return std::pair{SavepointChange::Release, isKeyword(name, "SAVEPOINT") ? nextToken(sql).first : name.first};
+  }
+  if (isKeyword(keyword, "ROLLBACK")) {
+    auto token = nextToken(sql);
+    if (isKeyword(token, "TRANSACTION")) {
+      token = nextToken(sql);
+    }
+    if (!isKeyword(token, "TO")) {
+      return {};
+    }
+    auto name = nextToken(sql);
+    return std::pair{SavepointChange::RollbackTo, isKeyword(name, "SAVEPOINT") ? nextToken(sql).first : name.first};
+  }
+  return {};
+}
+
+// Statements that control transactions or can not run inside one (or would be ignored there, like some pragmas).
+[[nodiscard]] auto runsAlone(sqlite3_stmt* stmt) -> bool {
+  static const std::array<std::string_view, 10> KEYWORDS{
+    "ATTACH", "BEGIN", "COMMIT", "DETACH", "END", "PRAGMA", "RELEASE", "ROLLBACK", "SAVEPOINT", "VACUUM"};
+  auto keyword = firstKeyword(sqlite3_sql(stmt));
+  return std::any_of(KEYWORDS.begin(), KEYWORDS.end(), [&](std::string_view candidate) {
+    return keyword.size() == candidate.size() &&
+           sqlite3_strnicmp(keyword.data(), candidate.data(), gsl::narrow<int>(candidate.size())) == 0;
+  });
+}
+
+// The kinds of tokens told apart by sqlite3_complete.
+enum class CompleteToken : std::uint8_t
+{
+  Semicolon = 0,
+  Space,
+  Other,
+  Explain,
+  Create,
+  Temp,
+  Trigger,
+  End
+};
+
+// Classifies the next token of text like sqlite3_complete does and consumes it. Returns nullopt if text ends inside a
+// literal or a comment.
+[[nodiscard]] auto completeToken(std::string_view& text) -> std::optional<CompleteToken> {
+  auto consume = [&](std::size_t size, std::optional<CompleteToken> token) {
+    text.remove_prefix(std::min(size, text.size()));
+    return token;
+  };
+  auto until = [&](std::string_view end, std::size_t from) -> std::optional<CompleteToken> {
+    auto found = text.find(end, from);
+    if (found == std::string_view::npos) {
+      return std::nullopt;
+    }
+    return consume(found + end.size(), end == "*/" || end == "\n" ? CompleteToken::Space : CompleteToken::Other);
+  };
+  auto first = static_cast<unsigned char>(text.front());
+  switch (first) {
+    case ';':
+      return consume(1, CompleteToken::Semicolon);
+    case ' ':
+    case '\t':
+    case '\n':
+    case '\f':
+    case '\r':
+      return consume(1, CompleteToken::Space);
+    case '/':
+      return text.starts_with("/*") ? until("*/", 2) : consume(1, CompleteToken::Other);
+    case '-':
+      return text.starts_with("--") ? until("\n", 2) : consume(1, CompleteToken::Other);
+    case '[':
+      return until("]", 1);
+    case '`':
+    case '"':
+    case '\'':
+      // A doubled quote reads as two literals in a row, both Other.
+      return until(text.substr(0, 1), 1);
+    default:
+      break;
+  }
+  auto isIdentifier = [](unsigned char c) { return std::isalnum(c) != 0 || c == '_' || c == '$' || c >= 0x80; };
+  if (!isIdentifier(first)) {
+    return consume(1, CompleteToken::Other);
+  }
+  std::size_t size = 1;
+  while (size < text.size() && isIdentifier(static_cast<unsigned char>(text[size]))) {
+    ++size;
+  }
+  static constexpr std::array<std::pair<std::string_view, CompleteToken>, 6> KEYWORDS{{
+    {"CREATE", CompleteToken::Create},
+    {"TRIGGER", CompleteToken::Trigger},
+    {"TEMP", CompleteToken::Temp},
+    {"TEMPORARY", CompleteToken::Temp},
+    {"END", CompleteToken::End},
+    {"EXPLAIN", CompleteToken::Explain},
+  }};
+  auto word = text.substr(0, size);
+  for (const auto& [keyword, token] : KEYWORDS) {
+    if (word.size() == keyword.size() && sqlite3_strnicmp(word.data(), keyword.data(), gsl::narrow<int>(size)) == 0) {
+      return consume(size, token);
+    }
+  }
+  return consume(size, CompleteToken::Other);
+}
+
+// Whether text starts with a complete statement, the text after its semicolon may be cut anywhere. Runs the state
+// machine of sqlite3_complete in one pass over text (which needs no null terminator), stopping at the first semicolon
+// that ends a statement: the semicolons of a trigger body only end it after END.
+[[nodiscard]] auto startsWithStatement(std::string_view text) -> bool {
+  // The states are Invalid, Start, Normal, Explain, Create, Trigger, Semicolon and End, the columns are the tokens.
+  static constexpr std::uint8_t START = 1;
+  static constexpr std::array<std::array<std::uint8_t, 8>, 8> TRANSITIONS{{
+    {1, 0, 2, 3, 4, 2, 2, 2},
+    {1, 1, 2, 3, 4, 2, 2, 2},
+    {1, 2, 2, 2, 2, 2, 2, 2},
+    {1, 3, 3, 2, 4, 2, 2, 2},
+    {1, 4, 2, 2, 2, 4, 5, 2},
+    {6, 5, 5, 5, 5, 5, 5, 5},
+    {6, 6, 5, 5, 5, 5, 5, 7},
+    {1, 7, 5, 5, 5, 5, 5, 5},
+  }};
+  std::uint8_t state = 0;
+  while (!text.empty()) {
+    auto token = completeToken(text);
+    if (!token) {
+      return false;
+    }
+    state = TRANSITIONS.at(state).at(static_cast<std::size_t>(*token));
+    if (state == START && *token == CompleteToken::Semicolon) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Walks a script one statement at a time with sqlite3_prepare_v3 and its tail pointer. The script does not need to be
+// null-terminated: sqlite copies the nByte characters it is given in that case, so each statement is prepared from a
+// small window that only grows when the statement does not fit in it.
+class ScriptRunner {
+public:
+  using Consumed = std::function<void(std::size_t offset)>;
+  using Failed = std::function<void()>;
+
+  ScriptRunner(
+    sqlite3* db,
+    const Y2KaoZ::Database::Sql::Sqlite3::ScriptOptions& options,
+    Consumed consumed,
+    Failed failed)
+    : db_(db)
+    , options_(options)
+    , consumed_(std::move(consumed))
+    , failed_(std::move(failed)) {
+  }
+
+  auto run(std::string_view script) -> Y2KaoZ::Database::Sql::Sqlite3::ScriptProgress {
+    progress_.totalBytes = script.size();
+    const auto limit = gsl::narrow<std::size_t>(sqlite3_limit(db_, SQLITE_LIMIT_SQL_LENGTH, -1)) + 1;
+    std::size_t position = 0;
+    std::size_t window = INITIAL_WINDOW;
+    while (position < script.size()) {
+      auto remaining = script.size() - position;
+      auto length = std::min({window, remaining, limit});
+      const auto* start = script.data() + position; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      sqlite3_stmt* stmt = nullptr;
+      const char* tail = nullptr;
+      auto rc = sqlite3_prepare_v3(db_, start, gsl::narrow<int>(length), 0, &stmt, &tail);
+      std::unique_ptr<sqlite3_stmt, decltype(&sqlite3_finalize)> statement(stmt, sqlite3_finalize);
+      auto used = rc == SQLITE_OK ? gsl::narrow<std::size_t>(tail - start) : length;
+      if (length < remaining && length < limit) {
+        // The window may have cut the statement short: it ends the window, or it failed to prepare without its end.
+        auto cut = rc == SQLITE_OK ? used == length : !::startsWithStatement({start, length});
+        if (cut) {
+          window *= 2;
+          continue;
+        }
+      }
+      if (rc != SQLITE_OK) {
+        fail({start, length});
+      }
+      window = INITIAL_WINDOW;
+      if (statement) {
+        execute(statement.get(), {start, used});
+      }
+      position += used;
+      progress_.bytes = position;
+    }
+    commit();
+    report();
+    return progress_;
+  }
+
+private:
+  static constexpr std::size_t INITIAL_WINDOW = 4096;
+  static constexpr std::size_t QUOTED_LENGTH = 200;
+
+  void execute(sqlite3_stmt* stmt, std::string_view sql) {
+    if (runsAlone(stmt)) {
+      commit();
+    } else if (!inBatch_ && options_.batchSize > 0 && sqlite3_get_autocommit(db_) != 0) {
+      exec("BEGIN");
+      inBatch_ = true;
+    }
+    int rc = SQLITE_ROW;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+    }
+    if (rc != SQLITE_DONE) {
+      failed_();
+      fail(sql);
+    }
+    ++progress_.statements;
+    if (++sinceReport_ >= std::max<std::size_t>(options_.batchSize, 1)) {
+      commit();
+      report();
+    }
+  }
+
+  void exec(const char* sql) {
+    if (sqlite3_exec(db_, sql, nullptr, nullptr, nullptr) != SQLITE_OK) {
+      fail(sql);
+    }
+  }
+
+  void commit() {
+    if (inBatch_) {
+      inBatch_ = false;
+      exec("COMMIT");
+    }
+  }
+
+  void report() {
+    sinceReport_ = 0;
+    if (consumed_) {
+      consumed_(progress_.bytes);
+    }
+    if (options_.progress) {
+      options_.progress(progress_);
+    }
+  }
+
+  [[noreturn]] void fail(std::string_view sql) {
+    std::string message = sqlite3_errmsg(db_);
+    if (inBatch_) {
+      inBatch_ = false;
+      sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
+    }
+    throw Y2KaoZ::Database::Sql::Sqlite3::Exception(fmt::format(
+      R"(Error at byte {} in "{}": "{}")",
+      progress_.bytes,
+      sql.substr(0, QUOTED_LENGTH),
+      message));
+  }
+
+  sqlite3* db_;
+  const Y2KaoZ::Database::Sql::Sqlite3::ScriptOptions& options_;
+  Consumed consumed_;
+  Failed failed_;
+  Y2KaoZ::Database::Sql::Sqlite3::ScriptProgress progress_;
+  std::size_t sinceReport_ = 0;
+  bool inBatch_ = false;
+};
+
 } // namespace
 
 namespace Y2KaoZ::Database::Sql::Sqlite3 {
 
-Connection::Connection() : db_(connect(":memory:", OPEN_READWRITE | OPEN_CREATE).get(), sqlite3_close) {
+struct Connection::Context {
+  template <typename Hook>
+  using Hooks = std::vector<std::pair<HookId, Hook>>;
+
+  HookId next = 0;
+  Hooks<UpdateHook> update;
+  Hooks<CommitHook> commit;
+  Hooks<RollbackHook> rollback;
+  Hooks<SavepointHook> savepoint;
+  Hooks<std::pair<int, ProgressHook>> progress;
+  Hooks<Authorizer> authorizer;
+#ifdef SQLITE_ENABLE_PREUPDATE_HOOK
+  Hooks<PreUpdateHook> preUpdate;
+#endif
+  std::shared_ptr<Recorder> recorder;
+  // sqlite3_total_changes64 when the last statement started, a failed statement left it unchanged if it was undone.
+  std::int64_t statementChanges = 0;
+
+  static void onUpdate(void* self, int operation, const char* database, const char* table, sqlite3_int64 rowid) {
+    for (const auto& [id, hook] : static_cast<Context*>(self)->update) {
+      hook(toRowChange(operation), database, table, rowid);
+    }
+  }
+  static auto onCommit(void* self) -> int {
+    for (const auto& [id, hook] : static_cast<Context*>(self)->commit) {
+      hook();
+    }
+    return 0;
+  }
+  static void onRollback(void* self) {
+    for (const auto& [id, hook] : static_cast<Context*>(self)->rollback) {
+      hook();
+    }
+  }
+  static auto onTrace(unsigned /*type*/, void* self, void* stmt, void* sql) -> int {
+    auto* context = static_cast<Context*>(self);
+    std::string_view text = static_cast<const char*>(sql);
+    // The statements of triggers are traced as comments naming the trigger, instead of the SQL of the statement.
+    if (text.starts_with("--") && text != std::string_view(sqlite3_sql(static_cast<sqlite3_stmt*>(stmt)))) {
+      return 0;
+    }
+    context->statementChanges = sqlite3_total_changes64(sqlite3_db_handle(static_cast<sqlite3_stmt*>(stmt)));
+    context->notify(SavepointChange::Begin, {});
+    if (auto savepoint = savepointOf(text)) {
+      context->notify(savepoint->first, savepoint->second);
+    }
+    return 0;
+  }
+  static auto onProgress(void* self) -> int {
+    auto interrupt = false;
+    for (const auto& [id, hook] : static_cast<Context*>(self)->progress) {
+      interrupt = hook.second() || interrupt;
+    }
+    return interrupt ? 1 : 0;
+  }
+  static auto onAuthorize(
+    void* self,
+    int action,
+    const char* first,
+    const char* second,
+    const char* database,
+    const char* trigger) -> int {
+    auto view = [](const char* name) { return name == nullptr ? std::string_view{} : std::string_view{name}; };
+    auto result = SQLITE_OK;
+    // Every hook is asked, even once the action is denied, so those that only observe see every action.
+    for (const auto& [id, hook] : static_cast<Context*>(self)->authorizer) {
+      auto rc = hook(action, view(first), view(second), view(database), view(trigger));
+      if (rc == SQLITE_DENY || (rc == SQLITE_IGNORE && result == SQLITE_OK)) {
+        result = rc;
+      }
+    }
+    return result;
+  }
+  // The single progress handler of sqlite runs as often as the most frequent hook needs.
+  void installProgress(sqlite3* db) {
+    if (progress.empty()) {
+      sqlite3_progress_handler(db, 0, nullptr, nullptr);
+      return;
+    }
+    auto steps = std::min_element(progress.begin(), progress.end(), [](const auto& a, const auto& b) {
+                   return a.second.first < b.second.first;
+                 })->second.first;
+    sqlite3_progress_handler(db, steps, &Context::onProgress, this);
+  }
+  void notify(SavepointChange change, std::string_view name) const {
+    for (const auto& [id, hook] : savepoint) {
+      hook(change, name);
+    }
+  }
+#ifdef SQLITE_ENABLE_PREUPDATE_HOOK
+  static void onPreUpdate(
+    void* self,
+    sqlite3* /*db*/,
+    int operation,
+    const char* database,
+    const char* table,
+    sqlite3_int64 oldRowid,
+    sqlite3_int64 newRowid) {
+    for (const auto& [id, hook] : static_cast<Context*>(self)->preUpdate) {
+      hook(toRowChange(operation), database, table, oldRowid, newRowid);
+    }
+  }
+#endif
+};
+
+Connection::Connection()
+  : context_(std::make_shared<Context>())
+  , db_(connect(":memory:", OPEN_READWRITE | OPEN_CREATE).get(), sqlite3_close) {
+}
+
+Connection::Connection(const std::filesystem::path& filename, std::uint32_t flags, const std::string& vfs)
+  : context_(std::make_shared<Context>())
+  , db_(connect(filename.string(), flags, vfs).get(), sqlite3_close) {
 }
 
-Connection::Connection(const std::filesystem::path& filename, std::uint32_t flags)
-  : db_(connect(filename.string(), flags).get(), sqlite3_close) {
+auto Connection::quoteIdentifier(std::string_view identifier) -> std::string {
+  std::string result;
+  result.reserve(identifier.size() + 2);
+  result += '"';
+  for (auto c : identifier) {
+    if (c == '"') {
+      result += '"';
+    }
+    result += c;
+  }
+  result += '"';
+  return result;
 }
 
 auto Connection::backend() const -> gsl::not_null<sqlite3*> {
   return db_.get();
 }
 
-void Connection::execute(std::string_view statement) const {
-  char* errmsg = nullptr;
-  if (sqlite3_exec(db_.get(), statement.data(), nullptr, nullptr, &errmsg) != SQLITE_OK) {
-    gsl::finally([&]() { sqlite3_free(errmsg); });
-    throw Exception(fmt::format(R"(Error in "{}": "{}")", statement, errmsg));
+auto Connection::filename() const -> std::filesystem::path {
+  const char* filename = sqlite3_db_filename(db_.get(), "main");
+  return filename == nullptr ? std::filesystem::path{} : std::filesystem::path{filename};
+}
+
+void Connection::execute(std::string_view statements) const {
+  if (context_->recorder) {
+    context_->recorder->record(RecordedKind::Script, statements, {});
   }
+  ScriptOptions options;
+  options.batchSize = 0;
+  ScriptRunner(db_.get(), options, nullptr, [this]() { statementFailed(); }).run(statements);
+}
+
+auto Connection::executeFile(const std::filesystem::path& path, const ScriptOptions& options) const
+  -> ScriptProgress {
+  MappedFile file(path);
+  return ScriptRunner(
+           db_.get(),
+           options,
+           [&file](std::size_t offset) { file.release(offset); },
+           [this]() { statementFailed(); })
+    .run(file.view());
 }
 
 auto Connection::rowCount() const -> std::size_t {
@@ -49,6 +541,10 @@ auto Connection::lastInsertRowId() const -> std::int64_t {
   return sqlite3_last_insert_rowid(db_.get());
 }
 
+void Connection::interrupt() const noexcept {
+  sqlite3_interrupt(db_.get());
+}
+
 auto Connection::prepare(std::string_view statement) -> Statement {
   return {*this, statement};
 }
@@ -57,4 +553,158 @@ auto Connection::beginTransaction() -> Transaction {
   return Transaction{*this};
 }
 
+auto Connection::changeFeed(std::size_t capacity) -> ChangeFeed {
+  return ChangeFeed{*this, capacity};
+}
+
+auto Connection::addUpdateHook(UpdateHook hook) -> HookId {
+  if (context_->update.empty()) {
+    sqlite3_update_hook(db_.get(), &Context::onUpdate, context_.get());
+  }
+  context_->update.emplace_back(++context_->next, std::move(hook));
+  return context_->next;
+}
+
+auto Connection::addCommitHook(CommitHook hook) -> HookId {
+  if (context_->commit.empty()) {
+    sqlite3_commit_hook(db_.get(), &Context::onCommit, context_.get());
+  }
+  context_->commit.emplace_back(++context_->next, std::move(hook));
+  return context_->next;
+}
+
+auto Connection::addRollbackHook(RollbackHook hook) -> HookId {
+  if (context_->rollback.empty()) {
+    sqlite3_rollback_hook(db_.get(), &Context::onRollback, context_.get());
+  }
+  context_->rollback.emplace_back(++context_->next, std::move(hook));
+  return context_->next;
+}
+
+#ifdef SQLITE_ENABLE_PREUPDATE_HOOK
+auto Connection::addPreUpdateHook(PreUpdateHook hook) -> HookId {
+  if (context_->preUpdate.empty()) {
+    sqlite3_preupdate_hook(db_.get(), &Context::onPreUpdate, context_.get());
+  }
+  context_->preUpdate.emplace_back(++context_->next, std::move(hook));
+  return context_->next;
+}
+#endif
+
+auto Connection::addSavepointHook(SavepointHook hook) -> HookId {
+  if (context_->savepoint.empty()) {
+    sqlite3_trace_v2(db_.get(), SQLITE_TRACE_STMT, &Context::onTrace, context_.get());
+  }
+  context_->savepoint.emplace_back(++context_->next, std::move(hook));
+  return context_->next;
+}
+
+auto Connection::addProgressHook(ProgressHook hook, int steps) -> HookId {
+  if (steps <= 0) {
+    throw std::invalid_argument("The number of progress steps must be positive.");
+  }
+  context_->progress.emplace_back(++context_->next, std::pair{steps, std::move(hook)});
+  context_->installProgress(db_.get());
+  return context_->next;
+}
+
+auto Connection::addAuthorizer(Authorizer hook) -> HookId {
+  if (context_->authorizer.empty()) {
+    sqlite3_set_authorizer(db_.get(), &Context::onAuthorize, context_.get());
+  }
+  context_->authorizer.emplace_back(++context_->next, std::move(hook));
+  return context_->next;
+}
+
+void Connection::statementFailed() const {
+  // A statement that fails with OR FAIL keeps the changes it made before the error, which count as changes.
+  if (!context_->savepoint.empty() && sqlite3_total_changes64(db_.get()) == context_->statementChanges) {
+    context_->notify(SavepointChange::RollbackTo, {});
+  }
+}
+
+auto Connection::memoryStats(bool resetCounters) const -> MemoryStats {
+  auto* db = db_.get();
+  auto reset = resetCounters ? 1 : 0;
+  auto status = [&](int op, bool highwater = false) {
+    int current = 0;
+    int high = 0;
+    sqlite3_db_status(db, op, &current, &high, reset);
+    return static_cast<std::int64_t>(highwater ? high : current);
+  };
+  MemoryStats stats;
+  stats.cacheUsed = status(SQLITE_DBSTATUS_CACHE_USED);
+  stats.cacheUsedShared = status(SQLITE_DBSTATUS_CACHE_USED_SHARED);
+  stats.schemaUsed = status(SQLITE_DBSTATUS_SCHEMA_USED);
+  stats.statementUsed = status(SQLITE_DBSTATUS_STMT_USED);
+  stats.lookasideUsed = status(SQLITE_DBSTATUS_LOOKASIDE_USED);
+  // The lookaside and cache counters are reported in the high-water value or the current one depending on the kind.
+  stats.lookasideHits = status(SQLITE_DBSTATUS_LOOKASIDE_HIT, true);
+  stats.lookasideMissSize = status(SQLITE_DBSTATUS_LOOKASIDE_MISS_SIZE, true);
+  stats.lookasideMissFull = status(SQLITE_DBSTATUS_LOOKASIDE_MISS_FULL, true);
+  stats.cacheHits = status(SQLITE_DBSTATUS_CACHE_HIT);
+  stats.cacheMisses = status(SQLITE_DBSTATUS_CACHE_MISS);
+  stats.cacheWrites = status(SQLITE_DBSTATUS_CACHE_WRITE);
+  stats.cacheSpills = status(SQLITE_DBSTATUS_CACHE_SPILL);
+
+  sqlite3_int64 current = 0;
+  sqlite3_int64 high = 0;
+  sqlite3_status64(SQLITE_STATUS_MEMORY_USED, &current, &high, reset);
+  stats.memoryUsed = current;
+  stats.memoryHighwater = high;
+  sqlite3_status64(SQLITE_STATUS_MALLOC_COUNT, &current, &high, reset);
+  stats.mallocCount = current;
+  sqlite3_status64(SQLITE_STATUS_MALLOC_SIZE, &current, &high, reset);
+  stats.largestAllocation = high;
+  sqlite3_status64(SQLITE_STATUS_PAGECACHE_OVERFLOW, &current, &high, reset);
+  stats.pageCacheOverflow = current;
+  stats.softHeapLimit = sqlite3_soft_heap_limit64(-1);
+  return stats;
+}
+
+void Connection::setLookaside(int slotSize, int slotCount) {
+  if (sqlite3_db_config(db_.get(), SQLITE_DBCONFIG_LOOKASIDE, nullptr, slotSize, slotCount) != SQLITE_OK) {
+    throw Exception("The lookaside memory of the connection is in use.");
+  }
+}
+
+void Connection::record(std::shared_ptr<Recorder> recorder) {
+  context_->recorder = std::move(recorder);
+}
+
+auto Connection::recorder() const noexcept -> Recorder* {
+  return context_->recorder.get();
+}
+
+void Connection::removeHook(HookId id) {
+  // Only uninstalls the callback of sqlite when the last hook of its kind is removed.
+  auto erase = [id](auto& hooks) {
+    return std::erase_if(hooks, [id](const auto& hook) { return hook.first == id; }) > 0 && hooks.empty();
+  };
+  if (erase(context_->update)) {
+    sqlite3_update_hook(db_.get(), nullptr, nullptr);
+  }
+  if (erase(context_->commit)) {
+    sqlite3_commit_hook(db_.get(), nullptr, nullptr);
+  }
+  if (erase(context_->rollback)) {
+    sqlite3_rollback_hook(db_.get(), nullptr, nullptr);
+  }
+  if (erase(context_->savepoint)) {
+    sqlite3_trace_v2(db_.get(), 0, nullptr, nullptr);
+  }
+  if (erase(context_->authorizer)) {
+    sqlite3_set_authorizer(db_.get(), nullptr, nullptr);
+  }
+  // The interval of the handler depends on every progress hook, not only on whether one is left.
+  if (std::erase_if(context_->progress, [id](const auto& hook) { return hook.first == id; }) > 0) {
+    context_->installProgress(db_.get());
+  }
+#ifdef SQLITE_ENABLE_PREUPDATE_HOOK
+  if (erase(context_->preUpdate)) {
+    sqlite3_preupdate_hook(db_.get(), nullptr, nullptr);
+  }
+#endif
+}
+
 } // namespace Y2KaoZ::Database::Sql::Sqlite3
\ No newline at end of file
@@ -0,0 +1,411 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/Csv.hpp"
+#include "Y2KaoZ/Database/MappedFile.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Exception.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Transaction.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <fmt/format.h>
+#include <fstream>
+#include <future>
+#include <gsl/gsl_util>
+#include <optional>
+#include <thread>
+
+namespace {
+
+using Y2KaoZ::Database::Sql::Sqlite3::CsvOptions;
+using Y2KaoZ::Database::Sql::Sqlite3::Exception;
+
+constexpr std::uint64_t LOWS = 0x7F7F7F7F7F7F7F7FULL;
+constexpr std::uint64_t ONES = 0x0101010101010101ULL;
+
+[[nodiscard]] constexpr auto broadcast(char c) noexcept -> std::uint64_t {
+  return ONES * static_cast<unsigned char>(c);
+}
+
+// Sets the high bit of every byte of word that equals the broadcast byte, exactly (SWAR).
+[[nodiscard]] constexpr auto matches(std::uint64_t word, std::uint64_t pattern) noexcept -> std::uint64_t {
+  auto x = word ^ pattern;
+  return ~(((x & LOWS) + LOWS) | x | LOWS);
+}
+
+[[nodiscard]] auto load(const char* p) noexcept -> std::uint64_t {
+  std::uint64_t word = 0;
+  std::memcpy(&word, p, sizeof(word));
+  return word;
+}
+
+// Finds the first of up to three characters, 8 bytes at a time.
+class Finder {
+public:
+  Finder(char a, char b, char c) noexcept
+    : chars_{a, b, c}
+    , patterns_{broadcast(a), broadcast(b), broadcast(c)} {
+  }
+
+  [[nodiscard]] auto operator()(const char* first, const char* last) const noexcept -> const char* {
+    if constexpr (std::endian::native == std::endian::little) {
+      while (last - first >= 8) {
+        auto word = load(first);
+        auto mask = matches(word, patterns_[0]) | matches(word, patterns_[1]) | matches(word, patterns_[2]);
+        if (mask != 0) {
+          return first + std::countr_zero(mask) / 8; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        }
+        first += 8; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      }
+    }
+    for (; first != last; ++first) { // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      if (*first == chars_[0] || *first == chars_[1] || *first == chars_[2]) {
+        return first;
+      }
+    }
+    return last;
+  }
+
+private:
+  std::array<char, 3> chars_;
+  std::array<std::uint64_t, 3> patterns_;
+};
+
+// Counts the quote characters of a range, 8 bytes at a time.
+[[nodiscard]] auto countQuotes(const char* first, const char* last, char quote) noexcept -> std::size_t {
+  std::size_t count = 0;
+  auto pattern = broadcast(quote);
+  while (last - first >= 8) {
+    count += static_cast<std::size_t>(std::popcount(matches(load(first), pattern)));
+    first += 8; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  }
+  return count + static_cast<std::size_t>(std::count(first, last, quote));
+}
+
+// Returns the start of the first record at or after position. Whether position is inside a quoted field is known from
+// the parity of the quotes before it, as quotes are always paired in valid CSV (escaped quotes are doubled).
+[[nodiscard]] auto nextRecord(const char* position, const char* last, bool quoted, char quote) noexcept
+  -> const char* {
+  Finder find(quote, '\n', '\n');
+  while ((position = find(position, last)) != last) {
+    if (*position == quote) {
+      quoted = !quoted;
+    } else if (!quoted) {
+      return position + 1; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    ++position; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  }
+  return last;
+}
+
+struct Chunk {
+  // The fields of every record, the widths tell how many belong to each record.
+  std::vector<std::string_view> fields;
+  std::vector<std::uint32_t> widths;
+  // Fields with escaped quotes can not point into the input, they are unescaped here.
+  std::deque<std::string> unescaped;
+};
+
+// NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+[[nodiscard]] auto parse(const char* p, const char* last, const CsvOptions& options) -> Chunk {
+  const auto quote = options.quote;
+  const auto delimiter = options.delimiter;
+  Finder separator(delimiter, '\n', '\r');
+  Finder closing(quote, quote, quote);
+  Chunk chunk;
+  while (p != last) {
+    if (*p == '\n' || *p == '\r') {
+      ++p;
+      continue;
+    }
+    std::uint32_t width = 0;
+    for (;;) {
+      if (p != last && *p == quote) {
+        const auto* start = ++p;
+        bool escaped = false;
+        while ((p = closing(p, last)) != last && p + 1 != last && p[1] == quote) {
+          escaped = true;
+          p += 2;
+        }
+        std::string_view field{start, static_cast<std::size_t>(p - start)};
+        if (escaped) {
+          auto& copy = chunk.unescaped.emplace_back();
+          copy.reserve(field.size());
+          for (std::size_t i = 0; i < field.size(); ++i) {
+            copy += field[i];
+            i += field[i] == quote ? 1 : 0;
+          }
+          field = copy;
+        }
+        chunk.fields.emplace_back(field);
+        // Characters between the closing quote and the separator are malformed, they are skipped.
+        p = separator(p == last ? p : p + 1, last);
+      } else {
+        const auto* start = p;
+        p = separator(p, last);
+        chunk.fields.emplace_back(start, static_cast<std::size_t>(p - start));
+      }
+      ++width;
+      if (p != last && *p == delimiter) {
+        ++p;
+        continue;
+      }
+      break;
+    }
+    chunk.widths.push_back(width);
+  }
+  return chunk;
+}
+// NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+[[nodiscard]] auto threadCount(const CsvOptions& options) -> std::size_t {
+  return options.threads != 0 ? options.threads : std::max(1U, std::thread::hardware_concurrency());
+}
+
+[[nodiscard]] auto secondsSince(std::chrono::steady_clock::time_point start) -> double {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+class BufferedWriter {
+public:
+  static constexpr std::size_t FLUSH_SIZE = 1024ULL * 1024ULL;
+
+  explicit BufferedWriter(const std::filesystem::path& path) : file_(path, std::ios::binary | std::ios::trunc) {
+    if (!file_) {
+      throw Exception(fmt::format(R"(Can not open "{}" for writing)", path.string()));
+    }
+  }
+
+  void append(std::string_view text) {
+    buffer_.append(text.data(), text.data() + text.size()); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  }
+  void append(char c) {
+    buffer_.push_back(c);
+  }
+  template <typename T>
+  void number(T value) {
+    const std::size_t BUFFER_SIZE = 32;
+    std::array<char, BUFFER_SIZE> digits{};
+    auto [end, ec] = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+    buffer_.append(digits.data(), end);
+  }
+  void endRecord() {
+    buffer_.push_back('\n');
+    if (buffer_.size() >= FLUSH_SIZE) {
+      flush();
+    }
+  }
+  void flush() {
+    file_.write(buffer_.data(), gsl::narrow<std::streamsize>(buffer_.size()));
+    written_ += buffer_.size();
+    buffer_.clear();
+    if (!file_) {
+      throw Exception("Error while writing the CSV file");
+    }
+  }
+  [[nodiscard]] auto written() const noexcept -> std::size_t {
+    return written_;
+  }
+
+private:
+  std::ofstream file_;
+  fmt::memory_buffer buffer_;
+  std::size_t written_ = 0;
+};
+
+void writeField(BufferedWriter& writer, std::string_view field, const CsvOptions& options, const Finder& special) {
+  const auto* end = field.data() + field.size(); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  if (special(field.data(), end) == end && field.find('\r') == std::string_view::npos) {
+    writer.append(field);
+    return;
+  }
+  writer.append(options.quote);
+  for (auto c : field) {
+    if (c == options.quote) {
+      writer.append(c);
+    }
+    writer.append(c);
+  }
+  writer.append(options.quote);
+}
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+auto CsvStats::rowsPerSecond() const noexcept -> double {
+  return seconds > 0.0 ? static_cast<double>(rows) / seconds : 0.0;
+}
+
+auto importCsv(
+  Connection& connection,
+  const std::filesystem::path& path,
+  std::string_view table,
+  const CsvOptions& options) -> CsvStats {
+  auto start = std::chrono::steady_clock::now();
+  MappedFile file(path);
+  const auto* first = file.data();
+  const auto* last = first + file.size(); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  const auto quote = options.quote;
+
+  // The first record gives the column names, or the number of columns.
+  auto firstEnd = ::nextRecord(first, last, false, quote);
+  auto head = ::parse(first, firstEnd, options);
+  std::vector<std::string> names;
+  if (!head.widths.empty()) {
+    for (std::size_t i = 0; i < head.widths.front(); ++i) {
+      names.emplace_back(options.header ? std::string(head.fields[i]) : fmt::format("c{}", i + 1));
+    }
+  }
+  const auto* data = options.header ? firstEnd : first;
+
+  auto quoted = Connection::quoteIdentifier(table);
+  auto tableInfo = connection.prepare("SELECT count(*) FROM pragma_table_info(?);");
+  auto columns = gsl::narrow<std::size_t>(tableInfo.bind(1, std::string(table)).execute().fetchColumn(0)->getInteger());
+  if (columns == 0) {
+    if (names.empty()) {
+      return CsvStats{0, file.size(), secondsSince(start)};
+    }
+    std::string create = fmt::format("CREATE TABLE {} (", quoted);
+    for (std::size_t i = 0; i < names.size(); ++i) {
+      create += fmt::format("{}{} TEXT", i == 0 ? "" : ", ", Connection::quoteIdentifier(names[i]));
+    }
+    connection.execute(create + ");");
+    columns = names.size();
+  }
+  std::string insert = fmt::format("INSERT INTO {} VALUES (?", quoted);
+  for (std::size_t i = 1; i < columns; ++i) {
+    insert += ", ?";
+  }
+  auto statement = connection.prepare(insert + ");");
+
+  // Chunk k starts at the first record boundary after its nominal offset, which depends on the quote parity there.
+  const auto chunkSize = std::max<std::size_t>(options.chunkSize, 1);
+  const auto size = static_cast<std::size_t>(last - data);
+  const auto chunks = std::max<std::size_t>((size + chunkSize - 1) / chunkSize, 1);
+  const auto threads = threadCount(options);
+  auto offset = [&](std::size_t k) { return data + std::min(k * chunkSize, size); }; // NOLINT(*-pointer-arithmetic)
+  std::vector<std::size_t> quotes(chunks);
+  {
+    std::vector<std::future<void>> counters;
+    for (std::size_t t = 0; t < std::min(threads, chunks); ++t) {
+      counters.emplace_back(std::async(std::launch::async, [&, t]() {
+        for (auto k = t; k < chunks; k += threads) {
+          quotes[k] = ::countQuotes(offset(k), offset(k + 1), quote);
+        }
+      }));
+    }
+    for (auto& counter : counters) {
+      counter.get();
+    }
+  }
+  std::vector<bool> parity(chunks + 1, false);
+  for (std::size_t k = 0; k < chunks; ++k) {
+    parity[k + 1] = parity[k] != (quotes[k] % 2 == 1);
+  }
+  auto boundary = [&](std::size_t k) {
+    return k == 0 ? data : k == chunks ? last : ::nextRecord(offset(k), last, parity[k], quote);
+  };
+
+  std::deque<std::future<Chunk>> pending;
+  std::size_t launched = 0;
+  auto launch = [&]() {
+    while (launched < chunks && pending.size() < threads) {
+      pending.emplace_back(std::async(std::launch::async, [&, k = launched]() {
+        const auto* begin = boundary(k);
+        const auto* end = boundary(k + 1);
+        return begin < end ? ::parse(begin, end, options) : Chunk{};
+      }));
+      ++launched;
+    }
+  };
+
+  CsvStats stats;
+  std::optional<Transaction> transaction;
+  std::size_t inBatch = 0;
+  launch();
+  while (!pending.empty()) {
+    auto chunk = pending.front().get();
+    pending.pop_front();
+    launch();
+    std::size_t field = 0;
+    for (auto width : chunk.widths) {
+      if (width != columns) {
+        throw Exception(fmt::format("Record {} has {} fields, {} expected", stats.rows + 1, width, columns));
+      }
+      if (!transaction) {
+        transaction.emplace(connection);
+      }
+      for (std::size_t i = 0; i < columns; ++i) {
+        statement.bindView(i + 1, chunk.fields[field++]);
+      }
+      statement.execute();
+      ++stats.rows;
+      if (++inBatch >= options.batchSize) {
+        transaction->commit();
+        transaction.reset();
+        inBatch = 0;
+      }
+    }
+  }
+  if (transaction) {
+    transaction->commit();
+  }
+  stats.bytes = file.size();
+  stats.seconds = secondsSince(start);
+  return stats;
+}
+
+auto exportCsv(Statement& statement, const std::filesystem::path& path, const CsvOptions& options) -> CsvStats {
+  auto start = std::chrono::steady_clock::now();
+  BufferedWriter writer(path);
+  Finder special(options.delimiter, options.quote, '\n');
+  auto columns = statement.columnCount();
+  if (options.header) {
+    for (std::size_t i = 0; i < columns; ++i) {
+      if (i != 0) {
+        writer.append(options.delimiter);
+      }
+      writeField(writer, statement.columnName(i), options, special);
+    }
+    writer.endRecord();
+  }
+
+  CsvStats stats;
+  ResultVector row;
+  statement.execute();
+  while (statement.fetchInto(row)) {
+    for (std::size_t i = 0; i < row.size(); ++i) {
+      if (i != 0) {
+        writer.append(options.delimiter);
+      }
+      const auto& cell = row[i];
+      switch (cell.getType()) {
+        case ResultType::Type::Integer:
+          writer.number(cell.getInteger());
+          break;
+        case ResultType::Type::Real:
+          writer.number(cell.getReal());
+          break;
+        case ResultType::Type::String:
+          writeField(writer, cell.stringView(), options, special);
+          break;
+        case ResultType::Type::Blob: {
+          auto blob = cell.blobView();
+          writeField(writer, {reinterpret_cast<const char*>(blob.data()), blob.size()}, options, special); // NOLINT
+        } break;
+        default:
+          break;
+      }
+    }
+    writer.endRecord();
+    ++stats.rows;
+  }
+  writer.flush();
+  stats.bytes = writer.written();
+  stats.seconds = secondsSince(start);
+  return stats;
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -5,4 +5,7 @@ namespace Y2KaoZ::Database::Sql::Sqlite3 {
 Exception::Exception(const std::string& what) : std::runtime_error(what) {
 }
 
+InterruptedException::InterruptedException(const std::string& what) : Exception(what) {
+}
+
 } // namespace Y2KaoZ::Database::Sql::Sqlite3
\ No newline at end of file
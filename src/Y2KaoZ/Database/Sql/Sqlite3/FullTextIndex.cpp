@@ -0,0 +1,293 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/FullTextIndex.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Exception.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Statement.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Transaction.hpp"
+#include <algorithm>
+#include <fmt/format.h>
+#include <gsl/gsl_util>
+#include <stdexcept>
+
+namespace {
+
+using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+
+[[nodiscard]] auto quoteLiteral(std::string_view text) -> std::string {
+  std::string result;
+  result.reserve(text.size() + 2);
+  result += '\'';
+  for (auto c : text) {
+    if (c == '\'') {
+      result += '\'';
+    }
+    result += c;
+  }
+  result += '\'';
+  return result;
+}
+
+// Joins the quoted columns, each preceded by prefix.
+[[nodiscard]] auto join(const std::vector<std::string>& columns, std::string_view prefix) -> std::string {
+  std::string result;
+  for (const auto& column : columns) {
+    if (!result.empty()) {
+      result += ", ";
+    }
+    result += prefix;
+    result += Connection::quoteIdentifier(column);
+  }
+  return result;
+}
+
+[[nodiscard]] auto exists(Connection& connection, std::string_view type, std::string_view name) -> bool {
+  auto statement = connection.prepare("SELECT 1 FROM main.sqlite_schema WHERE type = ?1 AND name = ?2;");
+  return statement.bindView(1, type).bindView(2, name).execute().rows();
+}
+
+// Throws unless every column is a column of table, compared like sqlite compares identifiers.
+void requireColumns(Connection& connection, const std::string& table, const std::vector<std::string>& columns) {
+  auto info = connection.prepare("SELECT name FROM pragma_table_xinfo(?1, 'main');");
+  std::vector<std::string> names;
+  info.bind(1, table).execute();
+  while (auto name = info.fetchColumn(0)) {
+    names.emplace_back(name->asString());
+  }
+  for (const auto& column : columns) {
+    auto found = std::any_of(names.begin(), names.end(), [&](const std::string& name) {
+      return sqlite3_stricmp(name.c_str(), column.c_str()) == 0;
+    });
+    if (!found) {
+      throw Y2KaoZ::Database::Sql::Sqlite3::Exception(
+        "The column '" + column + "' does not exist in the table '" + table + "'.");
+    }
+  }
+}
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+struct FullTextIndex::State {
+  State(
+    Connection c,
+    const std::string& table,
+    const std::vector<std::string>& columns,
+    const FullTextOptions& options,
+    std::string index)
+    : connection(std::move(c))
+    , name(std::move(index))
+    , quoted("main." + Connection::quoteIdentifier(name)) {
+    if (columns.empty()) {
+      throw std::invalid_argument("A full-text index needs at least one column.");
+    }
+    if (!::exists(connection, "table", table)) {
+      throw Exception("The table '" + table + "' does not exist.");
+    }
+    ::requireColumns(connection, table, columns);
+    auto alias = [&](const char* rowid) { return sqlite3_stricmp(options.rowid.c_str(), rowid) == 0; };
+    if (!alias("rowid") && !alias("oid") && !alias("_rowid_")) {
+      ::requireColumns(connection, table, {options.rowid});
+    }
+    auto created = !::exists(connection, "table", name);
+    std::string arguments = ::join(columns, "");
+    arguments += fmt::format(", content={}", ::quoteLiteral(table));
+    arguments += fmt::format(", content_rowid={}", ::quoteLiteral(options.rowid));
+    arguments += fmt::format(", tokenize={}", ::quoteLiteral(options.tokenizer));
+    if (!options.prefix.empty()) {
+      arguments += fmt::format(", prefix={}", ::quoteLiteral(options.prefix));
+    }
+    auto rowid = Connection::quoteIdentifier(options.rowid);
+    auto list = fmt::format("rowid, {}", ::join(columns, ""));
+    auto inserted = fmt::format("new.{}, {}", rowid, ::join(columns, "new."));
+    auto deleted = fmt::format("'delete', old.{}, {}", rowid, ::join(columns, "old."));
+    std::string changed = fmt::format("old.{0} IS NOT new.{0}", rowid);
+    for (const auto& column : columns) {
+      changed += fmt::format(" OR old.{0} IS NOT new.{0}", Connection::quoteIdentifier(column));
+    }
+    auto content = "main." + Connection::quoteIdentifier(table);
+    auto trigger = [&](const char* suffix) { return "main." + Connection::quoteIdentifier(name + "_" + suffix); };
+    // Triggers can only write to tables of their own schema, unqualified. Only updates of the indexed columns or of the
+    // rowid touch the index.
+    createTriggers = fmt::format(
+      "CREATE TRIGGER IF NOT EXISTS {1} AFTER INSERT ON {0} BEGIN "
+      "INSERT INTO {4} ({5}) VALUES ({6}); END;"
+      "CREATE TRIGGER IF NOT EXISTS {2} AFTER DELETE ON {0} BEGIN "
+      "INSERT INTO {4} ({4}, {5}) VALUES ({7}); END;"
+      "CREATE TRIGGER IF NOT EXISTS {3} AFTER UPDATE ON {0} WHEN {8} BEGIN "
+      "INSERT INTO {4} ({4}, {5}) VALUES ({7}); INSERT INTO {4} ({5}) VALUES ({6}); END;",
+      content,
+      trigger("ai"),
+      trigger("ad"),
+      trigger("au"),
+      Connection::quoteIdentifier(name),
+      list,
+      inserted,
+      deleted,
+      changed);
+    dropTriggers = fmt::format(
+      "DROP TRIGGER IF EXISTS {}; DROP TRIGGER IF EXISTS {}; DROP TRIGGER IF EXISTS {};",
+      trigger("ai"),
+      trigger("ad"),
+      trigger("au"));
+
+    // The index, its triggers and its configuration are created together or not at all.
+    connection.execute("SAVEPOINT y2kaoz_full_text_index;");
+    try {
+      connection.execute(fmt::format("CREATE VIRTUAL TABLE IF NOT EXISTS {} USING fts5({});", quoted, arguments));
+      connection.execute(createTriggers);
+      if (!options.weights.empty()) {
+        std::string weights;
+        for (auto weight : options.weights) {
+          weights += fmt::format("{}{}", weights.empty() ? "" : ", ", weight);
+        }
+        command("rank", ::quoteLiteral(fmt::format("bm25({})", weights)));
+      }
+      if (created && connection.prepare(fmt::format("SELECT 1 FROM {} LIMIT 1;", content)).execute().rows()) {
+        command("rebuild");
+      }
+    } catch (...) {
+      connection.execute("ROLLBACK TO y2kaoz_full_text_index; RELEASE y2kaoz_full_text_index;");
+      throw;
+    }
+    connection.execute("RELEASE y2kaoz_full_text_index;");
+    // The rank column orders by bm25 with the weights configured above, which FTS5 sorts without a temporary b-tree.
+    search = std::make_unique<Statement>(connection.prepare(fmt::format(
+      "SELECT rowid, rank, snippet({0}, ?2, ?3, ?4, ?5, ?6) FROM {1} WHERE {0} MATCH ?1 ORDER BY rank LIMIT ?7;",
+      Connection::quoteIdentifier(name),
+      quoted)));
+    rowids = std::make_unique<Statement>(connection.prepare(fmt::format(
+      "SELECT rowid, rank FROM {1} WHERE {0} MATCH ?1 ORDER BY rank LIMIT ?2;",
+      Connection::quoteIdentifier(name),
+      quoted)));
+  }
+
+  // Runs one of the special INSERT commands of FTS5, with its argument as an SQL value if it takes one.
+  void command(std::string_view command, const std::string& argument = {}) {
+    auto column = Connection::quoteIdentifier(name);
+    if (argument.empty()) {
+      connection.execute(fmt::format("INSERT INTO {} ({}) VALUES ('{}');", quoted, column, command));
+    } else {
+      connection.execute(
+        fmt::format("INSERT INTO {} ({}, rank) VALUES ('{}', {});", quoted, column, command, argument));
+    }
+  }
+
+  Connection connection;
+  std::string name;
+  std::string quoted;
+  std::string createTriggers;
+  std::string dropTriggers;
+  std::unique_ptr<Statement> search;
+  std::unique_ptr<Statement> rowids;
+};
+
+FullTextIndex::FullTextIndex(
+  Connection connection,
+  const std::string& table,
+  const std::vector<std::string>& columns,
+  const FullTextOptions& options,
+  const std::string& index)
+  : state_(std::make_unique<State>(
+      std::move(connection),
+      table,
+      columns,
+      options,
+      index.empty() ? table + "_fts" : index)) {
+}
+
+FullTextIndex::FullTextIndex(FullTextIndex&&) noexcept = default;
+
+FullTextIndex::~FullTextIndex() = default;
+
+auto FullTextIndex::name() const -> const std::string& {
+  return state_->name;
+}
+
+void FullTextIndex::bulkLoad(const std::function<void()>& load) {
+  Transaction transaction(state_->connection);
+  state_->connection.execute(state_->dropTriggers);
+  load();
+  state_->command("rebuild");
+  state_->connection.execute(state_->createTriggers);
+  transaction.commit();
+}
+
+void FullTextIndex::rebuild() {
+  state_->command("rebuild");
+}
+
+void FullTextIndex::optimize() {
+  state_->command("optimize");
+}
+
+auto FullTextIndex::merge(int pages) -> bool {
+  auto* db = state_->connection.backend().get();
+  auto before = sqlite3_total_changes64(db);
+  state_->command("merge", std::to_string(pages));
+  // FTS5 reports one change when the merge found nothing to do.
+  return sqlite3_total_changes64(db) - before >= 2;
+}
+
+void FullTextIndex::setAutomerge(int segments) {
+  state_->command("automerge", std::to_string(segments));
+}
+
+void FullTextIndex::check() {
+  state_->command("integrity-check");
+}
+
+auto FullTextIndex::search(
+  std::string_view query,
+  std::size_t limit,
+  const HitVisitor& visitor,
+  const SnippetOptions& snippet) -> std::size_t {
+  auto& statement = snippet.tokens > 0 ? *state_->search : *state_->rowids;
+  statement.bindView(1, query);
+  if (snippet.tokens > 0) {
+    statement.bind(2, snippet.column)
+      .bindView(3, std::string_view(snippet.before))
+      .bindView(4, std::string_view(snippet.after))
+      .bindView(5, std::string_view(snippet.ellipsis))
+      .bind(6, snippet.tokens)
+      .bind(7, gsl::narrow<std::int64_t>(limit));
+  } else {
+    statement.bind(2, gsl::narrow<std::int64_t>(limit));
+  }
+  std::size_t hits = 0;
+  try {
+    for (statement.execute(); statement.rows(); statement.execute()) {
+      FullTextHit hit;
+      hit.rowid = sqlite3_column_int64(statement.backend(), 0);
+      hit.score = sqlite3_column_double(statement.backend(), 1);
+      hit.snippet = snippet.tokens > 0 ? statement.columnText(2).value_or(std::string_view{}) : std::string_view{};
+      ++hits;
+      if (!visitor(hit)) {
+        statement.reset();
+        break;
+      }
+    }
+  } catch (...) {
+    statement.reset();
+    throw;
+  }
+  return hits;
+}
+
+auto FullTextIndex::search(std::string_view query, std::size_t limit) -> std::vector<std::int64_t> {
+  std::vector<std::int64_t> rowids;
+  static_cast<void>(search(
+    query,
+    limit,
+    [&](const FullTextHit& hit) {
+      rowids.push_back(hit.rowid);
+      return true;
+    },
+    SnippetOptions{.tokens = 0}));
+  return rowids;
+}
+
+void FullTextIndex::drop() {
+  state_->connection.execute(state_->dropTriggers);
+  state_->connection.execute(fmt::format("DROP TABLE IF EXISTS {};", state_->quoted));
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,239 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/Json.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Exception.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Statement.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <gsl/gsl_util>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Y2KaoZ::Database::Sql::Sqlite3::JsonBlobs;
+using Y2KaoZ::Database::Sql::Sqlite3::JsonLayout;
+using Y2KaoZ::Database::Sql::Sqlite3::JsonOptions;
+using Y2KaoZ::Database::Sql::Sqlite3::JsonSink;
+using Y2KaoZ::Database::Sql::Sqlite3::Statement;
+
+constexpr std::int64_t MAX_SAFE_INTEGER = (1LL << 53) - 1;
+constexpr std::string_view HEX_DIGITS = "0123456789abcdef";
+
+void append(fmt::memory_buffer& out, std::string_view text) {
+  out.append(text.data(), text.data() + text.size()); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
+
+// Writes text as a JSON string, copying the runs that need no escape in one go.
+void appendString(fmt::memory_buffer& out, std::string_view text) {
+  out.push_back('"');
+  std::size_t run = 0;
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    auto c = static_cast<unsigned char>(text[i]);
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+    append(out, text.substr(run, i - run));
+    run = i + 1;
+    switch (c) {
+      case '"':
+        append(out, "\\\"");
+        break;
+      case '\\':
+        append(out, "\\\\");
+        break;
+      case '\n':
+        append(out, "\\n");
+        break;
+      case '\r':
+        append(out, "\\r");
+        break;
+      case '\t':
+        append(out, "\\t");
+        break;
+      default:
+        append(out, "\\u00");
+        out.push_back(HEX_DIGITS[c >> 4U]);
+        out.push_back(HEX_DIGITS[c & 0xfU]);
+    }
+  }
+  append(out, text.substr(run));
+  out.push_back('"');
+}
+
+void appendBase64(fmt::memory_buffer& out, const unsigned char* data, std::size_t size) {
+  constexpr std::string_view DIGITS = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::span bytes(data, size);
+  std::size_t i = 0;
+  for (; i + 3 <= size; i += 3) {
+    auto triple = (std::uint32_t{bytes[i]} << 16U) | (std::uint32_t{bytes[i + 1]} << 8U) | bytes[i + 2];
+    out.push_back(DIGITS[(triple >> 18U) & 0x3fU]);
+    out.push_back(DIGITS[(triple >> 12U) & 0x3fU]);
+    out.push_back(DIGITS[(triple >> 6U) & 0x3fU]);
+    out.push_back(DIGITS[triple & 0x3fU]);
+  }
+  if (auto rest = size - i; rest > 0) {
+    auto triple = (std::uint32_t{bytes[i]} << 16U) | (rest == 2 ? std::uint32_t{bytes[i + 1]} << 8U : 0U);
+    out.push_back(DIGITS[(triple >> 18U) & 0x3fU]);
+    out.push_back(DIGITS[(triple >> 12U) & 0x3fU]);
+    out.push_back(rest == 2 ? DIGITS[(triple >> 6U) & 0x3fU] : '=');
+    out.push_back('=');
+  }
+}
+
+void appendBlob(fmt::memory_buffer& out, const void* blob, std::size_t size, JsonBlobs encoding) {
+  const auto* data = static_cast<const unsigned char*>(blob);
+  out.push_back('"');
+  if (encoding == JsonBlobs::Hex) {
+    for (auto byte : std::span(data, size)) {
+      out.push_back(HEX_DIGITS[byte >> 4U]);
+      out.push_back(HEX_DIGITS[byte & 0xfU]);
+    }
+  } else {
+    appendBase64(out, data, size);
+  }
+  out.push_back('"');
+}
+
+// Integers and reals of at most max_digits10 significant digits, like -1.2345678901234567e-308, fit in the buffer.
+template <typename... Format>
+void appendNumber(fmt::memory_buffer& out, auto value, Format... format) {
+  constexpr std::size_t BUFFER_SIZE = 32;
+  std::array<char, BUFFER_SIZE> digits{};
+  auto [end, ec] = std::to_chars(digits.data(), digits.data() + digits.size(), value, format...);
+  if (ec != std::errc{}) {
+    throw Y2KaoZ::Database::Sql::Sqlite3::Exception("A number does not fit in the JSON number buffer.");
+  }
+  out.append(digits.data(), end);
+}
+
+class Writer {
+public:
+  Writer(Statement& statement, fmt::memory_buffer& out, const JsonSink* sink, const JsonOptions& options)
+    : statement_(statement)
+    , out_(out)
+    , sink_(sink)
+    , options_(options)
+    , objects_(options.layout == JsonLayout::Objects || options.layout == JsonLayout::ObjectLines)
+    , lines_(options.layout == JsonLayout::ObjectLines || options.layout == JsonLayout::ArrayLines)
+    , columns_(gsl::narrow<int>(statement.columnCount())) {
+    if (objects_) {
+      keys_.reserve(static_cast<std::size_t>(columns_));
+      for (int i = 0; i < columns_; ++i) {
+        fmt::memory_buffer key;
+        appendString(key, statement.columnName(static_cast<std::size_t>(i)));
+        key.push_back(':');
+        keys_.emplace_back(key.data(), key.size());
+      }
+    }
+  }
+
+  auto write() -> std::uint64_t {
+    std::uint64_t rows = 0;
+    if (!lines_) {
+      out_.push_back('[');
+    }
+    for (; statement_.rows(); statement_.execute()) {
+      if (rows++ > 0 && !lines_) {
+        out_.push_back(',');
+      }
+      row();
+      if (lines_) {
+        out_.push_back('\n');
+      }
+      if (sink_ != nullptr && out_.size() >= options_.flushSize) {
+        flush();
+      }
+    }
+    if (!lines_) {
+      out_.push_back(']');
+    }
+    if (sink_ != nullptr) {
+      flush();
+    }
+    return rows;
+  }
+
+private:
+  void row() {
+    auto* stmt = statement_.backend().get();
+    out_.push_back(objects_ ? '{' : '[');
+    for (int i = 0; i < columns_; ++i) {
+      if (i > 0) {
+        out_.push_back(',');
+      }
+      if (objects_) {
+        append(out_, keys_[static_cast<std::size_t>(i)]);
+      }
+      switch (sqlite3_column_type(stmt, i)) {
+        case SQLITE_INTEGER: {
+          auto value = sqlite3_column_int64(stmt, i);
+          auto quote = options_.bigIntegersAsStrings && (value > MAX_SAFE_INTEGER || value < -MAX_SAFE_INTEGER);
+          if (quote) {
+            out_.push_back('"');
+          }
+          appendNumber(out_, value);
+          if (quote) {
+            out_.push_back('"');
+          }
+        } break;
+        case SQLITE_FLOAT: {
+          auto value = sqlite3_column_double(stmt, i);
+          if (!std::isfinite(value)) {
+            append(out_, "null");
+          } else if (options_.realPrecision > 0) {
+            // More digits than max_digits10 only spell out the binary value further, they are not significant.
+            auto precision = std::min(options_.realPrecision, std::numeric_limits<double>::max_digits10);
+            appendNumber(out_, value, std::chars_format::general, precision);
+          } else {
+            appendNumber(out_, value);
+          }
+        } break;
+        case SQLITE_TEXT: {
+          const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, i)); // NOLINT
+          appendString(out_, {text, gsl::narrow<std::size_t>(sqlite3_column_bytes(stmt, i))});
+        } break;
+        case SQLITE_BLOB: {
+          const auto* blob = sqlite3_column_blob(stmt, i);
+          appendBlob(out_, blob, gsl::narrow<std::size_t>(sqlite3_column_bytes(stmt, i)), options_.blobs);
+        } break;
+        default:
+          append(out_, "null");
+      }
+    }
+    out_.push_back(objects_ ? '}' : ']');
+  }
+
+  void flush() {
+    if (out_.size() > 0) {
+      (*sink_)({out_.data(), out_.size()});
+      out_.clear();
+    }
+  }
+
+  Statement& statement_;
+  fmt::memory_buffer& out_;
+  const JsonSink* sink_;
+  const JsonOptions& options_;
+  bool objects_;
+  bool lines_;
+  int columns_;
+  // The "name": prefixes of the members of an object, escaped once.
+  std::vector<std::string> keys_;
+};
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+auto writeJson(Statement& statement, const JsonSink& sink, const JsonOptions& options) -> std::uint64_t {
+  fmt::memory_buffer buffer;
+  return ::Writer(statement, buffer, &sink, options).write();
+}
+
+auto writeJson(Statement& statement, fmt::memory_buffer& buffer, const JsonOptions& options) -> std::uint64_t {
+  return ::Writer(statement, buffer, nullptr, options).write();
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
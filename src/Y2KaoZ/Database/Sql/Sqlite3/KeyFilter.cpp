@@ -0,0 +1,413 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/KeyFilter.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Exception.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/ParallelScan.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Statement.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fmt/format.h>
+#include <functional>
+#include <gsl/gsl_util>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+using Y2KaoZ::Database::BlobView;
+using Y2KaoZ::Database::ResultType;
+using Y2KaoZ::Database::Sql::Sqlite3::Statement;
+
+constexpr std::uint64_t TEXT_SEED = 0x9e3779b97f4a7c15ULL;
+constexpr std::uint64_t BLOB_SEED = 0xc2b2ae3d27d4eb4fULL;
+constexpr std::uint64_t REAL_SEED = 0x165667b19e3779f9ULL;
+
+// The finalizer of splitmix64.
+[[nodiscard]] constexpr auto mix(std::uint64_t x) noexcept -> std::uint64_t {
+  x = (x ^ (x >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27U)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31U);
+}
+
+[[nodiscard]] auto hashBytes(std::string_view bytes, std::uint64_t seed) noexcept -> std::uint64_t {
+  return mix(std::hash<std::string_view>{}(bytes) ^ seed);
+}
+
+// Every type hashes differently, except REAL values with an integral value which sqlite finds by their INTEGER value.
+[[nodiscard]] auto hashKey(std::int64_t key) noexcept -> std::uint64_t {
+  return mix(static_cast<std::uint64_t>(key));
+}
+
+[[nodiscard]] auto hashKey(std::string_view key) noexcept -> std::uint64_t {
+  return hashBytes(key, TEXT_SEED);
+}
+
+[[nodiscard]] auto hashKey(BlobView key) noexcept -> std::uint64_t {
+  return hashBytes({reinterpret_cast<const char*>(key.data()), key.size()}, BLOB_SEED); // NOLINT
+}
+
+[[nodiscard]] auto hashKey(double key) noexcept -> std::uint64_t {
+  constexpr auto LIMIT = 9.2e18;
+  if (std::trunc(key) == key && std::abs(key) < LIMIT) {
+    return hashKey(static_cast<std::int64_t>(key));
+  }
+  return hashBytes({reinterpret_cast<const char*>(&key), sizeof(key)}, REAL_SEED); // NOLINT
+}
+
+[[nodiscard]] auto hashColumn(sqlite3_stmt* stmt, int i) -> std::optional<std::uint64_t> {
+  switch (sqlite3_column_type(stmt, i)) {
+    case SQLITE_INTEGER:
+      return hashKey(static_cast<std::int64_t>(sqlite3_column_int64(stmt, i)));
+    case SQLITE_FLOAT:
+      return hashKey(sqlite3_column_double(stmt, i));
+    case SQLITE_TEXT: {
+      const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, i)); // NOLINT
+      return hashKey(std::string_view{text, gsl::narrow<std::size_t>(sqlite3_column_bytes(stmt, i))});
+    }
+    case SQLITE_BLOB: {
+      const auto* blob = static_cast<const std::byte*>(sqlite3_column_blob(stmt, i));
+      return hashKey(BlobView{blob, gsl::narrow<std::size_t>(sqlite3_column_bytes(stmt, i))});
+    }
+    default:
+      return {};
+  }
+}
+
+[[nodiscard]] auto hashResult(const ResultType& value) -> std::optional<std::uint64_t> {
+  switch (value.getType()) {
+    case ResultType::Type::Integer:
+      return hashKey(static_cast<std::int64_t>(value.getInteger()));
+    case ResultType::Type::Real:
+      return hashKey(value.getReal());
+    case ResultType::Type::String:
+      return hashKey(value.stringView());
+    case ResultType::Type::Blob:
+      return hashKey(value.blobView());
+    default:
+      return {};
+  }
+}
+
+// Keys are hashed by their bytes, which only finds the keys sqlite finds when the column compares them byte by byte.
+void requireBinary(sqlite3* db, const std::string& table, const std::string& column) {
+  const char* collation = nullptr;
+  if (sqlite3_table_column_metadata(
+        db, "main", table.c_str(), column.c_str(), nullptr, &collation, nullptr, nullptr, nullptr) != SQLITE_OK) {
+    throw Y2KaoZ::Database::Sql::Sqlite3::Exception(sqlite3_errmsg(db));
+  }
+  if (collation != nullptr && sqlite3_stricmp(collation, "BINARY") != 0) {
+    throw std::invalid_argument(fmt::format(
+      "The key column '{}' uses the collation {}, a key filter needs the BINARY collation.", column, collation));
+  }
+}
+
+void bindKey(Statement& statement, std::int64_t key) {
+  statement.bind(1, key);
+}
+
+void bindKey(Statement& statement, std::string_view key) {
+  statement.bindView(1, key);
+}
+
+void bindKey(Statement& statement, BlobView key) {
+  statement.bindView(1, key);
+}
+
+// A Bloom filter probed with double hashing, every key sets hashes bits derived from a single 64 bit hash.
+class Bloom {
+public:
+  void reset(std::size_t capacity, double falsePositiveRate) {
+    constexpr std::uint64_t WORD_BITS = 64;
+    auto ln2 = std::log(2.0);
+    auto wanted = -static_cast<double>(capacity) * std::log(falsePositiveRate) / (ln2 * ln2);
+    auto words = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(wanted / WORD_BITS)));
+    bits_ = words * WORD_BITS;
+    hashes_ = std::max<std::uint64_t>(
+      1,
+      static_cast<std::uint64_t>(std::lround(static_cast<double>(bits_) / static_cast<double>(capacity) * ln2)));
+    words_.assign(words, 0);
+  }
+
+  void add(std::uint64_t hash) noexcept {
+    auto step = mix(hash) | 1U;
+    for (std::uint64_t i = 0; i < hashes_; ++i, hash += step) {
+      auto bit = hash % bits_;
+      words_[bit / 64] |= std::uint64_t{1} << (bit % 64);
+    }
+  }
+
+  [[nodiscard]] auto test(std::uint64_t hash) const noexcept -> bool {
+    auto step = mix(hash) | 1U;
+    for (std::uint64_t i = 0; i < hashes_; ++i, hash += step) {
+      auto bit = hash % bits_;
+      if ((words_[bit / 64] & (std::uint64_t{1} << (bit % 64))) == 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  [[nodiscard]] auto bits() const noexcept -> std::uint64_t {
+    return bits_;
+  }
+
+  [[nodiscard]] auto hashes() const noexcept -> std::uint64_t {
+    return hashes_;
+  }
+
+private:
+  std::vector<std::uint64_t> words_;
+  std::uint64_t bits_ = 0;
+  std::uint64_t hashes_ = 0;
+};
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+auto KeyFilterStats::falsePositiveRate() const noexcept -> double {
+  auto negatives = filtered + falsePositives;
+  return negatives > 0 ? static_cast<double>(falsePositives) / static_cast<double>(negatives) : 0.0;
+}
+
+auto KeyFilterStats::expectedFalsePositiveRate() const noexcept -> double {
+  if (bits == 0) {
+    return 0.0;
+  }
+  auto k = static_cast<double>(hashes);
+  return std::pow(1.0 - std::exp(-k * static_cast<double>(keys) / static_cast<double>(bits)), k);
+}
+
+struct KeyFilter::State {
+  State(Connection c, const std::string& t, const std::string& column, const KeyFilterOptions& o)
+    : connection(std::move(c))
+    , table(t)
+    , quoted("main." + Connection::quoteIdentifier(t))
+    , options(o)
+    , keyOfRow(connection.prepare(
+        fmt::format("SELECT {} FROM {} WHERE rowid = ?1;", Connection::quoteIdentifier(column), quoted)))
+    , exists(connection.prepare(
+        fmt::format("SELECT 1 FROM {} WHERE {} = ?1 LIMIT 1;", quoted, Connection::quoteIdentifier(column))))
+    , scan(connection.prepare(fmt::format("SELECT {} FROM {};", Connection::quoteIdentifier(column), quoted)))
+    , count(connection.prepare(fmt::format("SELECT count(*) FROM {};", quoted)))
+    , dataVersion(connection.prepare("PRAGMA main.data_version;"))
+    , partitionQuery(fmt::format(
+        "SELECT {} FROM {} WHERE rowid BETWEEN :first AND :last;",
+        Connection::quoteIdentifier(column),
+        Connection::quoteIdentifier(t))) {
+    ::requireBinary(connection.backend(), table, column);
+    build();
+    hook = connection.addUpdateHook([this](RowChange change, auto database, auto name, std::int64_t rowid) {
+      if (database != "main" || sqlite3_stricmp(std::string(name).c_str(), table.c_str()) != 0) {
+        return;
+      }
+      if (change != RowChange::Insert) {
+        ++stale;
+      }
+      if (change != RowChange::Delete) {
+        pending.push_back(rowid);
+      }
+    });
+    // A ROLLBACK TO brings back rows a build inside the transaction did not see, without any update hook.
+    savepointHook = connection.addSavepointHook([this](SavepointChange change, std::string_view name) {
+      if (change == SavepointChange::RollbackTo && !name.empty()) {
+        undone = true;
+      }
+    });
+  }
+
+  State(const State&) = delete;
+  State(State&&) = delete;
+  auto operator=(const State&) -> State& = delete;
+  auto operator=(State&&) -> State& = delete;
+
+  ~State() {
+    connection.removeHook(hook);
+    connection.removeHook(savepointHook);
+  }
+
+  [[nodiscard]] auto version() -> std::int64_t {
+    return dataVersion.execute().fetchColumn(0).value_or(ResultType{}).asInteger64();
+  }
+
+  void build() {
+    pending.clear();
+    stale = 0;
+    keys = 0;
+    undone = false;
+    inTransaction = sqlite3_get_autocommit(connection.backend()) == 0;
+    auto rows = gsl::narrow<std::size_t>(count.execute().fetchColumn(0).value_or(ResultType{}).asInteger64());
+    capacity = std::max({options.capacity, 2 * rows, KeyFilterOptions::MINIMUM_CAPACITY});
+    bloom.reset(capacity, options.falsePositiveRate);
+    // Read before the scan, so that a commit made during the scan causes another build.
+    lastVersion = version();
+    auto filename = connection.filename();
+    // Other connections do not see the changes of a transaction in progress, it is scanned through this connection.
+    if (!filename.empty() && sqlite3_get_autocommit(connection.backend()) != 0) {
+      ParallelScan parallel(filename, table);
+      for (const auto& row : parallel.fetchAll(partitionQuery)) {
+        add(::hashResult(row.at(0)));
+      }
+    } else {
+      for (scan.execute(); scan.rows(); scan.execute()) {
+        add(::hashColumn(scan.backend(), 0));
+      }
+    }
+  }
+
+  void add(std::optional<std::uint64_t> hash) {
+    if (hash) {
+      bloom.add(*hash);
+      ++keys;
+    }
+  }
+
+  // Brings the filter up to date with the changes made since the last lookup.
+  void refresh() {
+    auto limit = options.rebuildRatio * static_cast<double>(std::max(keys, std::size_t{1}));
+    // A filter built inside a transaction misses the rows it deleted, which a rollback brings back.
+    auto transactionEnded = inTransaction && (undone || sqlite3_get_autocommit(connection.backend()) != 0);
+    auto outdated = transactionEnded || version() != lastVersion || keys + pending.size() > capacity ||
+                    static_cast<double>(stale) > limit;
+    if (outdated) {
+      build();
+      ++stats.rebuilds;
+      return;
+    }
+    for (auto rowid : pending) {
+      keyOfRow.bind(1, rowid).execute();
+      if (keyOfRow.rows()) {
+        add(::hashColumn(keyOfRow.backend(), 0));
+        keyOfRow.reset();
+      }
+    }
+    pending.clear();
+  }
+
+  template <typename Key>
+  [[nodiscard]] auto mayContain(Key key) -> bool {
+    refresh();
+    ++stats.lookups;
+    if (!bloom.test(::hashKey(key))) {
+      ++stats.filtered;
+      return false;
+    }
+    return true;
+  }
+
+  template <typename Key>
+  auto lookup(Key key, Statement& statement) -> bool {
+    if (statement.rows()) {
+      statement.reset();
+    }
+    if (!mayContain(key)) {
+      return false;
+    }
+    ::bindKey(statement, key);
+    statement.execute();
+    if (!statement.rows()) {
+      ++stats.falsePositives;
+      return false;
+    }
+    return true;
+  }
+
+  template <typename Key>
+  auto contains(Key key) -> bool {
+    auto found = lookup(key, exists);
+    if (found) {
+      exists.reset();
+    }
+    return found;
+  }
+
+  Connection connection;
+  std::string table;
+  std::string quoted;
+  KeyFilterOptions options;
+  Statement keyOfRow;
+  Statement exists;
+  Statement scan;
+  Statement count;
+  Statement dataVersion;
+  std::string partitionQuery;
+  Bloom bloom;
+  std::size_t capacity = 0;
+  std::size_t keys = 0;
+  std::int64_t lastVersion = 0;
+  // Filled by the update hook, which must not run statements itself.
+  std::vector<std::int64_t> pending;
+  std::size_t stale = 0;
+  // Whether the last build saw the changes of a transaction in progress, and whether some were rolled back since.
+  bool inTransaction = false;
+  bool undone = false;
+  KeyFilterStats stats;
+  Connection::HookId hook = 0;
+  Connection::HookId savepointHook = 0;
+};
+
+KeyFilter::KeyFilter(
+  Connection connection,
+  const std::string& table,
+  const std::string& column,
+  const KeyFilterOptions& options)
+  : state_(std::make_unique<State>(std::move(connection), table, column, options)) {
+}
+
+KeyFilter::KeyFilter(KeyFilter&&) noexcept = default;
+
+KeyFilter::~KeyFilter() = default;
+
+auto KeyFilter::mayContain(std::int64_t key) -> bool {
+  return state_->mayContain(key);
+}
+
+auto KeyFilter::mayContain(std::string_view key) -> bool {
+  return state_->mayContain(key);
+}
+
+auto KeyFilter::mayContain(BlobView key) -> bool {
+  return state_->mayContain(key);
+}
+
+auto KeyFilter::contains(std::int64_t key) -> bool {
+  return state_->contains(key);
+}
+
+auto KeyFilter::contains(std::string_view key) -> bool {
+  return state_->contains(key);
+}
+
+auto KeyFilter::contains(BlobView key) -> bool {
+  return state_->contains(key);
+}
+
+auto KeyFilter::lookup(std::int64_t key, Statement& statement) -> bool {
+  return state_->lookup(key, statement);
+}
+
+auto KeyFilter::lookup(std::string_view key, Statement& statement) -> bool {
+  return state_->lookup(key, statement);
+}
+
+auto KeyFilter::lookup(BlobView key, Statement& statement) -> bool {
+  return state_->lookup(key, statement);
+}
+
+void KeyFilter::rebuild() {
+  state_->build();
+  ++state_->stats.rebuilds;
+}
+
+auto KeyFilter::stats(bool resetCounters) -> KeyFilterStats {
+  auto result = state_->stats;
+  result.keys = state_->keys;
+  result.capacity = state_->capacity;
+  result.bits = state_->bloom.bits();
+  result.hashes = state_->bloom.hashes();
+  if (resetCounters) {
+    state_->stats = KeyFilterStats{.rebuilds = state_->stats.rebuilds};
+  }
+  return result;
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,216 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/KvStore.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Statement.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Transaction.hpp"
+#include <fmt/format.h>
+
+namespace {
+
+using Y2KaoZ::Database::BlobType;
+using Y2KaoZ::Database::BlobView;
+using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+using Y2KaoZ::Database::Sql::Sqlite3::KvStore;
+using Y2KaoZ::Database::Sql::Sqlite3::Statement;
+
+[[nodiscard]] auto create(Connection connection, const std::string& name) -> Connection {
+  connection.execute(fmt::format(
+    "CREATE TABLE IF NOT EXISTS {} (key BLOB NOT NULL PRIMARY KEY, value BLOB NOT NULL) WITHOUT ROWID;",
+    name));
+  return connection;
+}
+
+// Returns the smallest key greater than every key starting with prefix, std::nullopt if there is none.
+[[nodiscard]] auto successor(BlobView prefix) -> std::optional<BlobType> {
+  BlobType upper(prefix.begin(), prefix.end());
+  while (!upper.empty() && upper.back() == std::byte{0xff}) {
+    upper.pop_back();
+  }
+  if (upper.empty()) {
+    return {};
+  }
+  upper.back() = static_cast<std::byte>(static_cast<unsigned char>(upper.back()) + 1U);
+  return upper;
+}
+
+void scan(Statement& statement, const KvStore::ScanVisitor& visitor) {
+  try {
+    for (statement.execute(); statement.rows(); statement.execute()) {
+      if (!visitor(*statement.columnBlob(0), *statement.columnBlob(1))) {
+        statement.reset();
+        return;
+      }
+    }
+  } catch (...) {
+    statement.reset();
+    throw;
+  }
+}
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+struct KvStore::State {
+  State(Connection c, const std::string& table)
+    : name("main." + Connection::quoteIdentifier(table))
+    , connection(::create(std::move(c), name))
+    , get(connection.prepare(fmt::format("SELECT value FROM {} WHERE key = ?1;", name)))
+    , put(connection.prepare(fmt::format(
+        "INSERT INTO {} (key, value) VALUES (?1, ?2) ON CONFLICT (key) DO UPDATE SET value = excluded.value;",
+        name)))
+    , erase(connection.prepare(fmt::format("DELETE FROM {} WHERE key = ?1;", name)))
+    , from(connection.prepare(fmt::format("SELECT key, value FROM {} WHERE key >= ?1 ORDER BY key;", name)))
+    , range(
+        connection.prepare(fmt::format("SELECT key, value FROM {} WHERE key >= ?1 AND key < ?2 ORDER BY key;", name)))
+    , count(connection.prepare(fmt::format("SELECT count(*) FROM {};", name))) {
+  }
+
+  auto lookup(BlobView key) -> std::optional<BlobView> {
+    release();
+    get.bindView(1, key).execute();
+    return get.columnBlob(0);
+  }
+
+  void release() {
+    if (get.rows()) {
+      get.reset();
+    }
+  }
+
+  // Starts a transaction for a batch unless the connection is in one already.
+  [[nodiscard]] auto batch() -> std::optional<Transaction> {
+    if (sqlite3_get_autocommit(connection.backend()) == 0) {
+      return {};
+    }
+    return std::optional<Transaction>(std::in_place, connection);
+  }
+
+  std::string name;
+  Connection connection;
+  Statement get;
+  Statement put;
+  Statement erase;
+  Statement from;
+  Statement range;
+  Statement count;
+};
+
+KvStore::KvStore(Connection connection, const std::string& table)
+  : state_(std::make_unique<State>(std::move(connection), table)) {
+}
+
+KvStore::KvStore(KvStore&&) noexcept = default;
+
+KvStore::~KvStore() = default;
+
+auto KvStore::bytes(std::string_view text) noexcept -> BlobView {
+  return std::as_bytes(std::span(text.data(), text.size()));
+}
+
+auto KvStore::text(BlobView bytes) noexcept -> std::string_view {
+  return {reinterpret_cast<const char*>(bytes.data()), bytes.size()}; // NOLINT
+}
+
+auto KvStore::get(BlobView key) -> std::optional<BlobView> {
+  return state_->lookup(key);
+}
+
+auto KvStore::get(std::string_view key) -> std::optional<std::string_view> {
+  if (auto value = state_->lookup(bytes(key))) {
+    return text(*value);
+  }
+  return {};
+}
+
+auto KvStore::contains(BlobView key) -> bool {
+  auto found = state_->lookup(key).has_value();
+  state_->release();
+  return found;
+}
+
+void KvStore::release() {
+  state_->release();
+}
+
+void KvStore::put(BlobView key, BlobView value) {
+  state_->release();
+  state_->put.bindView(1, key).bindView(2, value).execute();
+}
+
+void KvStore::put(std::string_view key, std::string_view value) {
+  put(bytes(key), bytes(value));
+}
+
+auto KvStore::erase(BlobView key) -> bool {
+  state_->release();
+  state_->erase.bindView(1, key).execute();
+  return state_->connection.rowCount() > 0;
+}
+
+auto KvStore::erase(std::string_view key) -> bool {
+  return erase(bytes(key));
+}
+
+void KvStore::multiGet(std::span<const BlobView> keys, const GetVisitor& visitor) {
+  state_->release();
+  auto transaction = state_->batch();
+  try {
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+      visitor(i, state_->lookup(keys[i]));
+    }
+  } catch (...) {
+    state_->release();
+    throw;
+  }
+  state_->release();
+  if (transaction) {
+    transaction->commit();
+  }
+}
+
+void KvStore::multiPut(std::span<const KvEntry> entries) {
+  state_->release();
+  auto transaction = state_->batch();
+  // Inside a transaction a savepoint undoes the entries put before a failure, without ending the transaction.
+  if (!transaction) {
+    state_->connection.execute("SAVEPOINT y2kaoz_kv_multi_put;");
+  }
+  try {
+    for (const auto& [key, value] : entries) {
+      state_->put.bindView(1, key).bindView(2, value).execute();
+    }
+  } catch (...) {
+    // Some errors make sqlite roll the whole transaction back, the savepoint with it.
+    if (!transaction && sqlite3_get_autocommit(state_->connection.backend()) == 0) {
+      state_->connection.execute("ROLLBACK TO y2kaoz_kv_multi_put; RELEASE y2kaoz_kv_multi_put;");
+    }
+    throw;
+  }
+  if (transaction) {
+    transaction->commit();
+  } else {
+    state_->connection.execute("RELEASE y2kaoz_kv_multi_put;");
+  }
+}
+
+void KvStore::scanPrefix(BlobView prefix, const ScanVisitor& visitor) {
+  auto upper = ::successor(prefix);
+  scanRange(prefix, upper ? std::optional<BlobView>(*upper) : std::nullopt, visitor);
+}
+
+void KvStore::scanRange(BlobView from, std::optional<BlobView> to, const ScanVisitor& visitor) {
+  state_->release();
+  if (to) {
+    state_->range.bindView(1, from).bindView(2, *to);
+    ::scan(state_->range, visitor);
+  } else {
+    state_->from.bindView(1, from);
+    ::scan(state_->from, visitor);
+  }
+}
+
+auto KvStore::size() -> std::int64_t {
+  state_->release();
+  return state_->count.execute().fetchColumn(0).value_or(ResultType{}).asInteger64();
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,291 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/MaintenanceScheduler.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Connection.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Exception.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Statement.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <fmt/format.h>
+#include <gsl/gsl_util>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+using Y2KaoZ::Database::Sql::Sqlite3::CheckpointMode;
+using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+using Clock = std::chrono::steady_clock;
+
+struct Wal {
+  std::int64_t frames = 0;
+  std::int64_t backfilled = 0;
+  std::uintmax_t bytes = 0;
+};
+
+// Reads mxFrame from the first copy of the wal-index header and nBackfill from the checkpoint information that follows
+// both copies, as laid out by the WAL file format of sqlite. The values are in native byte order. The header is read
+// from the mapping of the wal-index the connection already holds, through its own VFS: opening the -shm file again
+// and closing it would drop the locks the process holds on it. A torn read only delays or hastens a checkpoint.
+[[nodiscard]] auto measure(Connection& connection, const std::filesystem::path& database) -> Wal {
+  constexpr std::size_t MX_FRAME = 16;
+  constexpr std::size_t N_BACKFILL = 96;
+  constexpr int REGION_SIZE = 32768;
+  Wal wal;
+  std::error_code error;
+  auto bytes = std::filesystem::file_size(database.string() + "-wal", error);
+  wal.bytes = error ? 0 : bytes;
+  if (wal.bytes == 0) {
+    return wal;
+  }
+  // The connection only opens the WAL once it has read the database.
+  connection.execute("PRAGMA schema_version;");
+  auto mode = connection.prepare("PRAGMA journal_mode;").execute().fetchColumn(0);
+  if (!mode || !mode->isString() || mode->stringView() != "wal") {
+    return wal;
+  }
+  auto* db = connection.backend().get();
+  sqlite3_file* file = nullptr;
+  if (sqlite3_file_control(db, "main", SQLITE_FCNTL_FILE_POINTER, &file) != SQLITE_OK || file == nullptr ||
+      file->pMethods == nullptr || file->pMethods->iVersion < 2) {
+    return wal;
+  }
+  volatile void* region = nullptr;
+  if (file->pMethods->xShmMap(file, 0, REGION_SIZE, 0, &region) != SQLITE_OK || region == nullptr) {
+    return wal;
+  }
+  const auto* index = static_cast<const volatile std::uint32_t*>(region);
+  std::uint32_t frames = index[MX_FRAME / sizeof(std::uint32_t)];       // NOLINT
+  std::uint32_t backfilled = index[N_BACKFILL / sizeof(std::uint32_t)]; // NOLINT
+  wal.frames = frames;
+  wal.backfilled = std::min(backfilled, frames);
+  return wal;
+}
+
+[[nodiscard]] auto toSqlite(CheckpointMode mode) -> int {
+  switch (mode) {
+    case CheckpointMode::Full:
+      return SQLITE_CHECKPOINT_FULL;
+    case CheckpointMode::Restart:
+      return SQLITE_CHECKPOINT_RESTART;
+    case CheckpointMode::Truncate:
+      return SQLITE_CHECKPOINT_TRUNCATE;
+    default:
+      return SQLITE_CHECKPOINT_PASSIVE;
+  }
+}
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+struct MaintenanceScheduler::State {
+  State(const std::filesystem::path& path, MaintenanceOptions o)
+    : database(path)
+    , options(std::move(o))
+    , connection(path)
+    , lastWrite(Clock::now())
+    , lastOptimize(lastWrite)
+    , lastVacuum(lastWrite) {
+    sqlite3_busy_timeout(connection.backend(), gsl::narrow<int>(options.busyTimeout.count()));
+  }
+
+  auto checkpoint(CheckpointMode mode) -> CheckpointReport {
+    CheckpointReport report;
+    report.mode = mode;
+    {
+      std::scoped_lock lock(connectionMutex);
+      auto before = ::measure(connection, database);
+      int frames = 0;
+      int checkpointed = 0;
+      auto* db = connection.backend().get();
+      auto start = Clock::now();
+      auto rc = sqlite3_wal_checkpoint_v2(db, nullptr, ::toSqlite(mode), &frames, &checkpointed);
+      report.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+      if (rc != SQLITE_OK && rc != SQLITE_BUSY) {
+        throw Exception(sqlite3_errmsg(db));
+      }
+      report.busy = rc == SQLITE_BUSY;
+      report.walFrames = std::max(frames, 0);
+      // A truncated WAL reports no frame at all, what it held was moved first.
+      report.framesMoved = frames == 0 && !report.busy ? before.frames - before.backfilled
+                                                       : std::max<std::int64_t>(checkpointed - before.backfilled, 0);
+      checkpointedFrames = before.frames;
+    }
+    {
+      std::scoped_lock lock(statsMutex);
+      ++stats.checkpoints;
+      stats.busyCheckpoints += report.busy ? 1 : 0;
+      stats.framesMoved += report.framesMoved;
+      stats.checkpointTime += report.duration;
+      stats.maxCheckpointTime = std::max(stats.maxCheckpointTime, report.duration);
+      stats.lastCheckpoint = report;
+    }
+    if (options.onCheckpoint) {
+      options.onCheckpoint(report);
+    }
+    return report;
+  }
+
+  void optimize() {
+    {
+      std::scoped_lock lock(connectionMutex);
+      connection.execute("PRAGMA optimize;");
+    }
+    std::scoped_lock lock(statsMutex);
+    ++stats.optimizations;
+  }
+
+  auto incrementalVacuum() -> std::int64_t {
+    constexpr std::int64_t INCREMENTAL = 2;
+    std::int64_t released = 0;
+    {
+      std::scoped_lock lock(connectionMutex);
+      auto pragma = [&](const char* sql) {
+        return connection.prepare(sql).execute().fetchColumn(0).value_or(ResultType{}).asInteger64();
+      };
+      if (pragma("PRAGMA auto_vacuum;") != INCREMENTAL) {
+        return 0;
+      }
+      auto before = pragma("PRAGMA freelist_count;");
+      if (before == 0) {
+        return 0;
+      }
+      connection.execute(fmt::format("PRAGMA incremental_vacuum({});", options.vacuumPages));
+      released = before - pragma("PRAGMA freelist_count;");
+    }
+    std::scoped_lock lock(statsMutex);
+    ++stats.vacuums;
+    stats.pagesVacuumed += released;
+    return released;
+  }
+
+  [[nodiscard]] auto measure() -> Wal {
+    std::scoped_lock lock(connectionMutex);
+    return ::measure(connection, database);
+  }
+
+  // Decides what the WAL needs: the least intrusive checkpoint that brings it back under the limits.
+  [[nodiscard]] auto due(const Wal& wal, Clock::time_point now) -> std::optional<CheckpointMode> {
+    if (wal.frames != lastFrames) {
+      lastFrames = wal.frames;
+      lastWrite = now;
+    }
+    auto waiting = wal.frames - wal.backfilled;
+    if (options.walSizeLimit > 0 && wal.bytes > options.walSizeLimit) {
+      return CheckpointMode::Truncate;
+    }
+    if (options.restartFrames > 0 && waiting >= options.restartFrames) {
+      return CheckpointMode::Restart;
+    }
+    // Frames a passive checkpoint already left behind (readers still need them) are only retried after a write.
+    auto full = options.checkpointFrames > 0 && waiting >= options.checkpointFrames;
+    auto idle = options.idleTime.count() > 0 && waiting > 0 && now - lastWrite >= options.idleTime;
+    if ((full || idle) && wal.frames != checkpointedFrames) {
+      return CheckpointMode::Passive;
+    }
+    return {};
+  }
+
+  void tick() {
+    auto now = Clock::now();
+    attempt([&]() {
+      if (auto mode = due(measure(), now)) {
+        static_cast<void>(checkpoint(*mode));
+      }
+    });
+    if (options.optimizeInterval.count() > 0 && now - lastOptimize >= options.optimizeInterval) {
+      lastOptimize = now;
+      attempt([&]() { optimize(); });
+    }
+    if (options.vacuumInterval.count() > 0 && now - lastVacuum >= options.vacuumInterval) {
+      lastVacuum = now;
+      attempt([&]() { static_cast<void>(incrementalVacuum()); });
+    }
+  }
+
+  template <typename Task>
+  void attempt(Task task) {
+    try {
+      task();
+    } catch (const std::exception& e) {
+      std::scoped_lock lock(statsMutex);
+      ++stats.errors;
+      stats.lastError = e.what();
+    }
+  }
+
+  void run() {
+    std::unique_lock lock(wakeMutex);
+    while (!wake.wait_for(lock, options.pollInterval, [this]() { return stopping; })) {
+      lock.unlock();
+      tick();
+      lock.lock();
+    }
+  }
+
+  void stop() {
+    {
+      std::scoped_lock lock(wakeMutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+
+  std::filesystem::path database;
+  MaintenanceOptions options;
+  std::mutex connectionMutex;
+  Connection connection;
+  mutable std::mutex statsMutex;
+  MaintenanceStats stats;
+  // The WAL frames when the last checkpoint started, the rest of the schedule is only used by the maintenance thread.
+  std::atomic<std::int64_t> checkpointedFrames{-1};
+  std::int64_t lastFrames = 0;
+  Clock::time_point lastWrite;
+  Clock::time_point lastOptimize;
+  Clock::time_point lastVacuum;
+  std::mutex wakeMutex;
+  std::condition_variable wake;
+  bool stopping = false;
+  std::thread worker;
+};
+
+MaintenanceScheduler::MaintenanceScheduler(const std::filesystem::path& database, MaintenanceOptions options)
+  : state_(std::make_unique<State>(database, std::move(options))) {
+  if (state_->options.pollInterval.count() > 0) {
+    state_->worker = std::thread([state = state_.get()]() { state->run(); });
+  }
+}
+
+MaintenanceScheduler::MaintenanceScheduler(MaintenanceScheduler&&) noexcept = default;
+
+MaintenanceScheduler::~MaintenanceScheduler() {
+  if (state_) {
+    state_->stop();
+  }
+}
+
+auto MaintenanceScheduler::checkpoint(CheckpointMode mode) -> CheckpointReport {
+  return state_->checkpoint(mode);
+}
+
+void MaintenanceScheduler::optimize() {
+  state_->optimize();
+}
+
+auto MaintenanceScheduler::incrementalVacuum() -> std::int64_t {
+  return state_->incrementalVacuum();
+}
+
+auto MaintenanceScheduler::stats() const -> MaintenanceStats {
+  std::scoped_lock lock(state_->statsMutex);
+  return state_->stats;
+}
+
+void MaintenanceScheduler::stop() {
+  state_->stop();
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
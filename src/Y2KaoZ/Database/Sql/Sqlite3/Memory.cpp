@@ -0,0 +1,94 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/Memory.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Exception.hpp"
+#include <gsl/gsl_util>
+#include <mutex>
+#include <sqlite3.h>
+
+namespace {
+
+using Y2KaoZ::Database::Sql::Sqlite3::Allocator;
+
+// sqlite gives no context to its allocation functions, so the installed allocator is global.
+std::mutex installMutex;                 // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+std::shared_ptr<Allocator> installed;    // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+Allocator* current = nullptr;            // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+sqlite3_mem_methods defaults{};          // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+bool defaultsSaved = false;              // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+auto allocate(int size) -> void* {
+  return current->allocate(static_cast<std::size_t>(size));
+}
+
+void deallocate(void* memory) {
+  current->deallocate(memory);
+}
+
+auto reallocate(void* memory, int size) -> void* {
+  return current->reallocate(memory, static_cast<std::size_t>(size));
+}
+
+auto size(void* memory) -> int {
+  return gsl::narrow_cast<int>(current->size(memory));
+}
+
+auto roundUp(int size) -> int {
+  return gsl::narrow_cast<int>(current->roundUp(static_cast<std::size_t>(size)));
+}
+
+auto init(void* /*unused*/) -> int {
+  return SQLITE_OK;
+}
+
+void shutdown(void* /*unused*/) {
+}
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+auto Allocator::roundUp(std::size_t size) noexcept -> std::size_t {
+  constexpr std::size_t ALIGNMENT = 8;
+  return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+void installAllocator(std::shared_ptr<Allocator> allocator) {
+  std::scoped_lock lock(installMutex);
+  if (sqlite3_shutdown() != SQLITE_OK) {
+    throw Exception("sqlite can not be shut down to change its allocator.");
+  }
+  if (!defaultsSaved) {
+    if (sqlite3_config(SQLITE_CONFIG_GETMALLOC, &defaults) != SQLITE_OK) {
+      throw Exception("The allocator of sqlite can not be read.");
+    }
+    defaultsSaved = true;
+  }
+  int rc = SQLITE_OK;
+  if (allocator) {
+    static const sqlite3_mem_methods methods{
+      ::allocate, ::deallocate, ::reallocate, ::size, ::roundUp, ::init, ::shutdown, nullptr};
+    rc = sqlite3_config(SQLITE_CONFIG_MALLOC, &methods);
+  } else {
+    rc = sqlite3_config(SQLITE_CONFIG_MALLOC, &defaults);
+  }
+  if (rc != SQLITE_OK) {
+    throw Exception("sqlite refused the allocator.");
+  }
+  // Nothing is allocated until sqlite is initialized again, by the next connection.
+  installed = std::move(allocator);
+  current = installed.get();
+}
+
+auto installedAllocator() noexcept -> std::shared_ptr<Allocator> {
+  std::scoped_lock lock(installMutex);
+  return installed;
+}
+
+auto setSoftHeapLimit(std::int64_t bytes) noexcept -> std::int64_t {
+  return sqlite3_soft_heap_limit64(bytes);
+}
+
+auto setHardHeapLimit(std::int64_t bytes) noexcept -> std::int64_t {
+  return sqlite3_hard_heap_limit64(bytes);
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,372 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/PageCache.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Exception.hpp"
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <sqlite3.h>
+#include <unordered_map>
+
+namespace {
+
+struct Cache;
+
+enum class Segment
+{
+  None,
+  Probation,
+  Protected
+};
+
+// The header of every page, sqlite only sees base and the buffers that follow the header.
+struct Page {
+  sqlite3_pcache_page base;
+  Cache* cache;
+  unsigned key;
+  bool pinned;
+  bool referenced;
+  Segment segment;
+  Page* previous;
+  Page* next;
+};
+
+// An intrusive LRU list of unpinned pages, the most recently used first.
+struct List {
+  Page* head = nullptr;
+  Page* tail = nullptr;
+  std::size_t bytes = 0;
+
+  void pushFront(Page* page, std::size_t cost) noexcept {
+    page->previous = nullptr;
+    page->next = head;
+    (head != nullptr ? head->previous : tail) = page;
+    head = page;
+    bytes += cost;
+  }
+
+  void remove(Page* page, std::size_t cost) noexcept {
+    (page->previous != nullptr ? page->previous->next : head) = page->next;
+    (page->next != nullptr ? page->next->previous : tail) = page->previous;
+    page->previous = nullptr;
+    page->next = nullptr;
+    bytes -= cost;
+  }
+};
+
+struct Cache {
+  std::size_t pageSize;
+  std::size_t extraSize;
+  bool purgeable;
+  std::unordered_map<unsigned, Page*> pages;
+
+  [[nodiscard]] auto cost() const noexcept -> std::size_t {
+    return sizeof(Page) + pageSize + extraSize;
+  }
+};
+
+// sqlite calls the page cache of different connections from different threads, every cache shares this state.
+struct Shared {
+  std::mutex mutex;
+  std::size_t budget = 0;
+  std::size_t used = 0;
+  std::size_t pages = 0;
+  std::size_t pinned = 0;
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;
+  std::uint64_t evictions = 0;
+  List probation;
+  List protectedPages;
+
+  // The protected segment may take that share of the budget, the rest is left to the probation segment.
+  static constexpr std::size_t PROTECTED_SHARE = 4;
+
+  [[nodiscard]] auto list(Segment segment) noexcept -> List& {
+    return segment == Segment::Protected ? protectedPages : probation;
+  }
+
+  void unlink(Page* page) noexcept {
+    if (page->segment != Segment::None) {
+      list(page->segment).remove(page, page->cache->cost());
+      page->segment = Segment::None;
+    }
+  }
+
+  void link(Page* page, Segment segment) noexcept {
+    list(segment).pushFront(page, page->cache->cost());
+    page->segment = segment;
+  }
+
+  void free(Page* page) noexcept {
+    auto& cache = *page->cache;
+    unlink(page);
+    cache.pages.erase(page->key);
+    if (cache.purgeable) {
+      used -= cache.cost();
+    }
+    if (page->pinned) {
+      --pinned;
+    }
+    --pages;
+    sqlite3_free(page);
+  }
+
+  auto evict() noexcept -> bool {
+    auto* victim = probation.tail != nullptr ? probation.tail : protectedPages.tail;
+    if (victim == nullptr) {
+      return false;
+    }
+    ++evictions;
+    free(victim);
+    return true;
+  }
+
+  void enforceBudget() noexcept {
+    while (used > budget && evict()) {
+    }
+  }
+
+  // Demotes the least recently used protected pages once the segment outgrows its share.
+  void balance() noexcept {
+    auto limit = budget - budget / PROTECTED_SHARE;
+    while (protectedPages.bytes > limit && protectedPages.tail != nullptr) {
+      auto* page = protectedPages.tail;
+      unlink(page);
+      page->referenced = false;
+      link(page, Segment::Probation);
+    }
+  }
+};
+
+Shared shared;                      // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+std::mutex installMutex;            // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+sqlite3_pcache_methods2 defaults{}; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+bool defaultsSaved = false;         // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+bool installed = false;             // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+auto init(void* /*unused*/) -> int {
+  return SQLITE_OK;
+}
+
+void shutdown(void* /*unused*/) {
+}
+
+auto create(int pageSize, int extraSize, int purgeable) -> sqlite3_pcache* {
+  auto* cache = new (std::nothrow) Cache{ // NOLINT(cppcoreguidelines-owning-memory)
+    static_cast<std::size_t>(pageSize),
+    static_cast<std::size_t>(extraSize),
+    purgeable != 0,
+    {}};
+  return reinterpret_cast<sqlite3_pcache*>(cache); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+[[nodiscard]] auto toCache(sqlite3_pcache* cache) -> Cache& {
+  return *reinterpret_cast<Cache*>(cache); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+[[nodiscard]] auto toPage(sqlite3_pcache_page* page) -> Page* {
+  return reinterpret_cast<Page*>(page); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+// The budget is global, cache_size is ignored.
+void cacheSize(sqlite3_pcache* /*cache*/, int /*size*/) {
+}
+
+auto pageCount(sqlite3_pcache* cache) -> int {
+  std::scoped_lock lock(shared.mutex);
+  return static_cast<int>(toCache(cache).pages.size());
+}
+
+auto fetch(sqlite3_pcache* pcache, unsigned key, int createFlag) -> sqlite3_pcache_page* {
+  auto& cache = toCache(pcache);
+  std::scoped_lock lock(shared.mutex);
+  auto found = cache.pages.find(key);
+  if (found != cache.pages.end()) {
+    auto* page = found->second;
+    ++shared.hits;
+    if (!page->pinned) {
+      // Fetching an unpinned page again is what earns it the protected segment, fetches under the same pin do not.
+      page->referenced = true;
+      shared.unlink(page);
+      page->pinned = true;
+      ++shared.pinned;
+    }
+    return &page->base;
+  }
+  if (createFlag == 0) {
+    return nullptr;
+  }
+  if (cache.purgeable) {
+    while (shared.used + cache.cost() > shared.budget && shared.evict()) {
+    }
+    // sqlite answers a refusal by spilling its dirty pages and asks again, insisting this time.
+    if (shared.used + cache.cost() > shared.budget && createFlag == 1) {
+      return nullptr;
+    }
+  }
+  auto* page = static_cast<Page*>(sqlite3_malloc64(cache.cost()));
+  if (page == nullptr) {
+    return nullptr;
+  }
+  try {
+    cache.pages.emplace(key, page);
+  } catch (const std::bad_alloc&) {
+    sqlite3_free(page);
+    return nullptr;
+  }
+  auto* buffer = reinterpret_cast<unsigned char*>(page + 1); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  *page = {{buffer, buffer + cache.pageSize}, &cache, key, true, false, Segment::None, nullptr, nullptr};
+  std::memset(page->base.pExtra, 0, cache.extraSize);
+  if (cache.purgeable) {
+    shared.used += cache.cost();
+  }
+  ++shared.pages;
+  ++shared.pinned;
+  ++shared.misses;
+  return &page->base;
+}
+
+void unpin(sqlite3_pcache* pcache, sqlite3_pcache_page* base, int discard) {
+  auto& cache = toCache(pcache);
+  auto* page = toPage(base);
+  std::scoped_lock lock(shared.mutex);
+  if (discard != 0) {
+    shared.free(page);
+    return;
+  }
+  page->pinned = false;
+  --shared.pinned;
+  if (!cache.purgeable) {
+    return;
+  }
+  shared.link(page, page->referenced ? Segment::Protected : Segment::Probation);
+  shared.balance();
+  shared.enforceBudget();
+}
+
+void rekey(sqlite3_pcache* pcache, sqlite3_pcache_page* base, unsigned oldKey, unsigned newKey) {
+  auto& cache = toCache(pcache);
+  auto* page = toPage(base);
+  std::scoped_lock lock(shared.mutex);
+  auto found = cache.pages.find(newKey);
+  if (found != cache.pages.end()) {
+    shared.free(found->second);
+  }
+  cache.pages.erase(oldKey);
+  page->key = newKey;
+  cache.pages.emplace(newKey, page);
+}
+
+void truncate(sqlite3_pcache* pcache, unsigned limit) {
+  auto& cache = toCache(pcache);
+  std::scoped_lock lock(shared.mutex);
+  for (auto it = cache.pages.begin(); it != cache.pages.end();) {
+    auto* page = (it++)->second;
+    if (page->key >= limit) {
+      shared.free(page);
+    }
+  }
+}
+
+void destroy(sqlite3_pcache* pcache) {
+  auto* cache = &toCache(pcache);
+  {
+    std::scoped_lock lock(shared.mutex);
+    while (!cache->pages.empty()) {
+      shared.free(cache->pages.begin()->second);
+    }
+  }
+  delete cache; // NOLINT(cppcoreguidelines-owning-memory)
+}
+
+void shrink(sqlite3_pcache* pcache) {
+  auto& cache = toCache(pcache);
+  std::scoped_lock lock(shared.mutex);
+  for (auto it = cache.pages.begin(); it != cache.pages.end();) {
+    auto* page = (it++)->second;
+    if (!page->pinned) {
+      shared.free(page);
+    }
+  }
+}
+
+void configure(const sqlite3_pcache_methods2* methods) {
+  if (sqlite3_shutdown() != SQLITE_OK) {
+    throw Y2KaoZ::Database::Sql::Sqlite3::Exception("sqlite can not be shut down to change its page cache.");
+  }
+  if (!defaultsSaved) {
+    if (sqlite3_config(SQLITE_CONFIG_GETPCACHE2, &defaults) != SQLITE_OK) {
+      throw Y2KaoZ::Database::Sql::Sqlite3::Exception("The page cache of sqlite can not be read.");
+    }
+    defaultsSaved = true;
+  }
+  if (sqlite3_config(SQLITE_CONFIG_PCACHE2, methods != nullptr ? methods : &defaults) != SQLITE_OK) {
+    throw Y2KaoZ::Database::Sql::Sqlite3::Exception("sqlite refused the page cache.");
+  }
+}
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+auto PageCacheStats::hitRatio() const noexcept -> double {
+  auto fetches = hits + misses;
+  return fetches == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(fetches);
+}
+
+void installPageCache(std::size_t budget) {
+  std::scoped_lock lock(installMutex);
+  static const sqlite3_pcache_methods2 methods{
+    1,
+    nullptr,
+    ::init,
+    ::shutdown,
+    ::create,
+    ::cacheSize,
+    ::pageCount,
+    ::fetch,
+    ::unpin,
+    ::rekey,
+    ::truncate,
+    ::destroy,
+    ::shrink};
+  ::configure(&methods);
+  setPageCacheBudget(budget);
+  installed = true;
+}
+
+void removePageCache() {
+  std::scoped_lock lock(installMutex);
+  ::configure(nullptr);
+  installed = false;
+}
+
+auto pageCacheInstalled() noexcept -> bool {
+  std::scoped_lock lock(installMutex);
+  return installed;
+}
+
+void setPageCacheBudget(std::size_t budget) {
+  std::scoped_lock lock(shared.mutex);
+  shared.budget = budget;
+  shared.balance();
+  shared.enforceBudget();
+}
+
+auto pageCacheStats(bool resetCounters) -> PageCacheStats {
+  std::scoped_lock lock(shared.mutex);
+  PageCacheStats stats;
+  stats.hits = shared.hits;
+  stats.misses = shared.misses;
+  stats.evictions = shared.evictions;
+  stats.pages = shared.pages;
+  stats.pinned = shared.pinned;
+  stats.memoryUsed = shared.used;
+  stats.memoryBudget = shared.budget;
+  if (resetCounters) {
+    shared.hits = 0;
+    shared.misses = 0;
+    shared.evictions = 0;
+  }
+  return stats;
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
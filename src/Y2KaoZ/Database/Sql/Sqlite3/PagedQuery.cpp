@@ -0,0 +1,319 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/PagedQuery.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Exception.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Statement.hpp"
+#include <algorithm>
+#include <bit>
+#include <fmt/format.h>
+#include <gsl/gsl_util>
+#include <span>
+#include <stdexcept>
+
+namespace {
+
+using Y2KaoZ::Database::BlobType;
+using Y2KaoZ::Database::ParamVector;
+using Y2KaoZ::Database::ResultType;
+using Y2KaoZ::Database::ResultVector;
+using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+using Y2KaoZ::Database::Sql::Sqlite3::PageKey;
+
+constexpr std::string_view HEX_DIGITS = "0123456789abcdef";
+constexpr char AFTER = 'a';
+constexpr char BEFORE = 'b';
+
+// The direction a page is read in, Backward reads the rows before a token in reverse order.
+enum class Direction : std::uint8_t
+{
+  Forward = 0,
+  Backward
+};
+
+// Orders the keys by direction, and compares them to the parameters first..first + keys - 1 when resume is true.
+[[nodiscard]] auto pagingSql(
+  std::string_view select,
+  const std::vector<PageKey>& keys,
+  Direction direction,
+  bool resume,
+  std::size_t first) -> std::string {
+  if (keys.empty()) {
+    throw std::invalid_argument("A paged query needs at least one key.");
+  }
+  std::vector<std::string> columns;
+  std::vector<bool> ascending;
+  for (const auto& key : keys) {
+    columns.push_back(Connection::quoteIdentifier(key.column));
+    ascending.push_back(key.descending == (direction == Direction::Backward));
+  }
+  std::string where;
+  if (resume) {
+    auto uniform = std::all_of(ascending.begin(), ascending.end(), [&](bool a) { return a == ascending.front(); });
+    if (uniform) {
+      // A row value comparison, which sqlite turns into a range search on an index of the keys.
+      std::string parameters;
+      for (std::size_t i = 0; i < keys.size(); ++i) {
+        where += fmt::format("{}{}", i > 0 ? ", " : " WHERE (", columns[i]);
+        parameters += fmt::format("{}?{}", i > 0 ? ", " : "", first + i);
+      }
+      where += fmt::format(") {} ({})", ascending.front() ? '>' : '<', parameters);
+    } else {
+      // Mixed directions can not be compared as a row value, the comparison is spelled out key by key.
+      for (std::size_t i = 0; i < keys.size(); ++i) {
+        where += i > 0 ? " OR (" : " WHERE (";
+        for (std::size_t j = 0; j < i; ++j) {
+          where += fmt::format("{} = ?{} AND ", columns[j], first + j);
+        }
+        where += fmt::format("{} {} ?{})", columns[i], ascending[i] ? '>' : '<', first + i);
+      }
+    }
+  }
+  std::string order;
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    order += fmt::format("{}{} {}", i > 0 ? ", " : "", columns[i], ascending[i] ? "ASC" : "DESC");
+  }
+  return fmt::format("SELECT * FROM ({}){} ORDER BY {} LIMIT ?{};", select, where, order, first + keys.size());
+}
+
+void appendBytes(std::string& out, const void* data, std::size_t size) {
+  for (auto byte : std::span(static_cast<const unsigned char*>(data), size)) {
+    out += HEX_DIGITS[byte >> 4U];
+    out += HEX_DIGITS[byte & 0xfU];
+  }
+}
+
+template <typename Integer>
+void appendInteger(std::string& out, Integer value) {
+  appendBytes(out, &value, sizeof(value));
+}
+
+// A token is the direction followed by the keys of a row, each a type tag and its value, in hexadecimal.
+[[nodiscard]] auto makeToken(char direction, const ResultVector& row, const std::vector<std::size_t>& keys)
+  -> std::string {
+  std::string token(1, direction);
+  for (auto i : keys) {
+    const auto& value = row.at(i);
+    switch (value.getType()) {
+      case ResultType::Type::Integer:
+        token += 'i';
+        appendInteger(token, value.getInteger());
+        break;
+      case ResultType::Type::Real:
+        token += 'r';
+        appendInteger(token, std::bit_cast<std::uint64_t>(value.getReal()));
+        break;
+      case ResultType::Type::String:
+        token += 's';
+        appendInteger(token, gsl::narrow<std::uint32_t>(value.stringView().size()));
+        appendBytes(token, value.stringView().data(), value.stringView().size());
+        break;
+      case ResultType::Type::Blob:
+        token += 'b';
+        appendInteger(token, gsl::narrow<std::uint32_t>(value.blobView().size()));
+        appendBytes(token, value.blobView().data(), value.blobView().size());
+        break;
+      default:
+        throw Y2KaoZ::Database::Sql::Sqlite3::Exception("A key of a paged query is NULL, keys must not be NULL.");
+    }
+  }
+  return token;
+}
+
+// Reads what makeToken wrote, throwing std::invalid_argument when the token was not made for keys keys.
+class TokenReader {
+public:
+  explicit TokenReader(std::string_view token)
+    : token_(token) {
+  }
+
+  [[nodiscard]] auto read(std::size_t keys) -> std::pair<char, ParamVector> {
+    if (token_.empty() || (token_.front() != AFTER && token_.front() != BEFORE)) {
+      fail();
+    }
+    auto direction = token_.front();
+    token_.remove_prefix(1);
+    ParamVector values;
+    while (!token_.empty()) {
+      auto tag = token_.front();
+      token_.remove_prefix(1);
+      switch (tag) {
+        case 'i':
+          values.emplace_back(integer<std::int64_t>());
+          break;
+        case 'r':
+          values.emplace_back(std::bit_cast<double>(integer<std::uint64_t>()));
+          break;
+        case 's': {
+          std::string text(length(), '\0');
+          bytes(text.data(), text.size());
+          values.emplace_back(std::move(text));
+        } break;
+        case 'b': {
+          BlobType blob(length());
+          bytes(blob.data(), blob.size());
+          values.emplace_back(std::move(blob));
+        } break;
+        default:
+          fail();
+      }
+    }
+    if (values.size() != keys) {
+      fail();
+    }
+    return {direction, std::move(values)};
+  }
+
+private:
+  [[noreturn]] static void fail() {
+    throw std::invalid_argument("The token was not made by this paged query.");
+  }
+
+  [[nodiscard]] static auto digit(char c) -> unsigned {
+    auto position = HEX_DIGITS.find(c);
+    if (position == std::string_view::npos) {
+      fail();
+    }
+    return static_cast<unsigned>(position);
+  }
+
+  void bytes(void* data, std::size_t size) {
+    if (token_.size() / 2 < size) {
+      fail();
+    }
+    for (auto& byte : std::span(static_cast<unsigned char*>(data), size)) {
+      byte = static_cast<unsigned char>((digit(token_[0]) << 4U) | digit(token_[1]));
+      token_.remove_prefix(2);
+    }
+  }
+
+  // The length of a text or blob key, checked against what is left of the token before anything is allocated for it.
+  [[nodiscard]] auto length() -> std::size_t {
+    auto size = static_cast<std::size_t>(integer<std::uint32_t>());
+    if (token_.size() / 2 < size) {
+      fail();
+    }
+    return size;
+  }
+
+  template <typename Integer>
+  [[nodiscard]] auto integer() -> Integer {
+    Integer value{};
+    bytes(&value, sizeof(value));
+    return value;
+  }
+
+  std::string_view token_;
+};
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+struct PagedQuery::State {
+  State(Connection c, const std::string& s, const std::vector<PageKey>& k, std::size_t size)
+    : connection(std::move(c))
+    , select(s.substr(0, s.find_last_not_of(" \t\r\n;") + 1))
+    , pageSize(size)
+    , base(connection.prepare(select))
+    , parameters(gsl::narrow<std::size_t>(sqlite3_bind_parameter_count(base.backend())))
+    , first(connection.prepare(::pagingSql(select, k, ::Direction::Forward, false, parameters + 1)))
+    , after(connection.prepare(::pagingSql(select, k, ::Direction::Forward, true, parameters + 1)))
+    , last(connection.prepare(::pagingSql(select, k, ::Direction::Backward, false, parameters + 1)))
+    , before(connection.prepare(::pagingSql(select, k, ::Direction::Backward, true, parameters + 1))) {
+    if (pageSize == 0) {
+      throw std::invalid_argument("The page size of a paged query must not be 0.");
+    }
+    for (const auto& key : k) {
+      std::size_t i = 0;
+      while (i < base.columnCount() && base.columnName(i) != key.column) {
+        ++i;
+      }
+      if (i == base.columnCount()) {
+        throw std::invalid_argument("The key '" + key.column + "' is not a result column of the query.");
+      }
+      keys.push_back(i);
+    }
+  }
+
+  // Runs statement with the keys of a token, if any, and returns its rows in page order.
+  auto fetch(Statement& statement, const ParamVector& values, const ParamVector& bound, ::Direction direction)
+    -> Page {
+    if (bound.size() > parameters) {
+      throw std::out_of_range("More parameters were given than the query has.");
+    }
+    statement.clearParameters().bind(bound);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      statement.bind(parameters + 1 + i, values[i]);
+    }
+    // One more row than the page tells whether there is another page in that direction.
+    statement.bind(parameters + 1 + keys.size(), gsl::narrow<std::int64_t>(pageSize + 1));
+    Page page;
+    page.rows = statement.execute().fetchAllVector();
+    auto more = page.rows.size() > pageSize;
+    if (more) {
+      page.rows.pop_back();
+    }
+    if (direction == ::Direction::Backward) {
+      std::reverse(page.rows.begin(), page.rows.end());
+    }
+    if (page.rows.empty()) {
+      return page;
+    }
+    // Resuming from a token, the rows of the token are on the other side of the page.
+    auto forward = direction == ::Direction::Forward;
+    if (forward ? more : !values.empty()) {
+      page.next = ::makeToken(::AFTER, page.rows.back(), keys);
+    }
+    if (forward ? !values.empty() : more) {
+      page.previous = ::makeToken(::BEFORE, page.rows.front(), keys);
+    }
+    return page;
+  }
+
+  Connection connection;
+  std::string select;
+  std::size_t pageSize;
+  Statement base;
+  std::size_t parameters;
+  std::vector<std::size_t> keys;
+  Statement first;
+  Statement after;
+  Statement last;
+  Statement before;
+};
+
+PagedQuery::PagedQuery(
+  Connection connection,
+  const std::string& select,
+  const std::vector<PageKey>& keys,
+  std::size_t pageSize)
+  : state_(std::make_unique<State>(std::move(connection), select, keys, pageSize)) {
+}
+
+PagedQuery::PagedQuery(PagedQuery&&) noexcept = default;
+
+PagedQuery::~PagedQuery() = default;
+
+auto PagedQuery::first(const ParamVector& parameters) -> Page {
+  return state_->fetch(state_->first, {}, parameters, ::Direction::Forward);
+}
+
+auto PagedQuery::last(const ParamVector& parameters) -> Page {
+  return state_->fetch(state_->last, {}, parameters, ::Direction::Backward);
+}
+
+auto PagedQuery::page(std::string_view token, const ParamVector& parameters) -> Page {
+  auto [direction, values] = ::TokenReader(token).read(state_->keys.size());
+  if (direction == ::AFTER) {
+    return state_->fetch(state_->after, values, parameters, ::Direction::Forward);
+  }
+  return state_->fetch(state_->before, values, parameters, ::Direction::Backward);
+}
+
+auto PagedQuery::pageSize() const noexcept -> std::size_t {
+  return state_->pageSize;
+}
+
+auto PagedQuery::queryPlan() const -> QueryPlan {
+  return state_->after.queryPlan();
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
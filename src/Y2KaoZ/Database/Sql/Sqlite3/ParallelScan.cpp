@@ -0,0 +1,176 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/ParallelScan.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Connection.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Statement.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Transaction.hpp"
+#include <algorithm>
+#include <fmt/format.h>
+#include <future>
+#include <limits>
+#include <queue>
+#include <thread>
+
+namespace {
+
+using Y2KaoZ::Database::ParamMap;
+using Y2KaoZ::Database::ResultVector;
+using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+using Y2KaoZ::Database::Sql::Sqlite3::ScanPartition;
+using Y2KaoZ::Database::Sql::Sqlite3::Statement;
+
+[[nodiscard]] auto scanPartition(Connection reader, std::string_view query, const ParamMap& parameters, ScanPartition p)
+  -> std::vector<ResultVector> {
+  Statement statement = reader.prepare(query);
+  statement.bind(parameters);
+  statement.bind(":first", p.first);
+  statement.bind(":last", p.last);
+  statement.execute();
+  return statement.fetchAllVector();
+}
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+auto mergeOrdered(std::vector<std::vector<ResultVector>> sources, const RowCompare& less) -> std::vector<ResultVector> {
+  using Cursor = std::pair<std::size_t, std::size_t>;
+  auto greater = [&](const Cursor& a, const Cursor& b) {
+    return less(sources[b.first][b.second], sources[a.first][a.second]);
+  };
+  std::priority_queue<Cursor, std::vector<Cursor>, decltype(greater)> heads(greater);
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < sources.size(); ++i) {
+    total += sources[i].size();
+    if (!sources[i].empty()) {
+      heads.emplace(i, 0);
+    }
+  }
+  std::vector<ResultVector> result;
+  result.reserve(total);
+  while (!heads.empty()) {
+    auto [source, row] = heads.top();
+    heads.pop();
+    result.emplace_back(std::move(sources[source][row]));
+    if (row + 1 < sources[source].size()) {
+      heads.emplace(source, row + 1);
+    }
+  }
+  return result;
+}
+
+ParallelScan::ParallelScan(std::filesystem::path filename, std::string table, std::string key)
+  : filename_(std::move(filename))
+  , table_(std::move(table))
+  , key_(std::move(key)) {
+  partition(std::max(1U, std::thread::hardware_concurrency()));
+}
+
+auto ParallelScan::partition(std::size_t count, std::size_t samplesPerPartition) -> ParallelScan& {
+  const auto min = std::numeric_limits<std::int64_t>::min();
+  const auto max = std::numeric_limits<std::int64_t>::max();
+  Connection reader{filename_, Connection::OPEN_READONLY};
+  auto rows = reader.prepare(fmt::format("SELECT count(*) FROM {};", Connection::quoteIdentifier(table_)))
+                .execute()
+                .fetchColumn(0)
+                .value_or(ResultType{})
+                .asInteger64();
+  count = std::clamp<std::size_t>(count, 1, std::max<std::size_t>(1, static_cast<std::size_t>(rows)));
+
+  std::vector<std::int64_t> samples;
+  if (count > 1) {
+    // Bernoulli sample of the keys, the sorted sample approximates the key distribution quantiles.
+    auto wanted = std::max<std::size_t>(count * samplesPerPartition, 1);
+    auto rate = std::max<std::int64_t>(1, rows / static_cast<std::int64_t>(wanted));
+    auto sample = reader.prepare(fmt::format(
+      "SELECT {0} FROM {1} WHERE random() % ?1 = 0 ORDER BY {0};",
+      Connection::quoteIdentifier(key_),
+      Connection::quoteIdentifier(table_)));
+    sample.bind(1, rate).execute();
+    while (auto key = sample.fetchColumn(0)) {
+      samples.emplace_back(key->asInteger64());
+    }
+  }
+
+  std::vector<std::int64_t> boundaries;
+  for (std::size_t i = 1; i < count && !samples.empty(); ++i) {
+    auto boundary = samples[i * samples.size() / count];
+    if (boundary != min && (boundaries.empty() || boundaries.back() < boundary)) {
+      boundaries.emplace_back(boundary);
+    }
+  }
+
+  partitions_.clear();
+  auto first = min;
+  for (auto boundary : boundaries) {
+    partitions_.push_back({first, boundary - 1});
+    first = boundary;
+  }
+  partitions_.push_back({first, max});
+  return *this;
+}
+
+auto ParallelScan::partitions() const noexcept -> const std::vector<ScanPartition>& {
+  return partitions_;
+}
+
+auto ParallelScan::fetchAll(std::string_view query, const ParamMap& parameters) const -> std::vector<ResultVector> {
+  auto parts = run(query, parameters);
+  std::size_t total = 0;
+  for (const auto& part : parts) {
+    total += part.size();
+  }
+  std::vector<ResultVector> result;
+  result.reserve(total);
+  for (auto& part : parts) {
+    std::move(part.begin(), part.end(), std::back_inserter(result));
+  }
+  return result;
+}
+
+auto ParallelScan::fetchAllOrdered(std::string_view query, const RowCompare& less, const ParamMap& parameters) const
+  -> std::vector<ResultVector> {
+  return mergeOrdered(run(query, parameters), less);
+}
+
+auto ParallelScan::aggregate(std::string_view query, const RowCombine& combine, const ParamMap& parameters) const
+  -> std::optional<ResultVector> {
+  std::optional<ResultVector> result;
+  for (auto& part : run(query, parameters)) {
+    for (auto& row : part) {
+      result = result ? combine(std::move(*result), row) : std::move(row);
+    }
+  }
+  return result;
+}
+
+auto ParallelScan::run(std::string_view query, const ParamMap& parameters) const
+  -> std::vector<std::vector<ResultVector>> {
+  // Every reader opens its read transaction before any partition is scanned so that all of them observe the
+  // database as close to the same point in time as possible (exactly the same one in WAL mode without writers).
+  std::vector<Connection> readers;
+  std::vector<Transaction> transactions;
+  readers.reserve(partitions_.size());
+  transactions.reserve(partitions_.size());
+  for (std::size_t i = 0; i < partitions_.size(); ++i) {
+    auto& reader = readers.emplace_back(filename_, Connection::OPEN_READONLY);
+    transactions.emplace_back(reader);
+    reader.execute("SELECT 1 FROM sqlite_master LIMIT 1;");
+  }
+
+  std::vector<std::future<std::vector<ResultVector>>> futures;
+  futures.reserve(partitions_.size());
+  for (std::size_t i = 0; i < partitions_.size(); ++i) {
+    futures.emplace_back(
+      std::async(std::launch::async, ::scanPartition, readers[i], query, parameters, partitions_[i]));
+  }
+  std::vector<std::vector<ResultVector>> result;
+  result.reserve(futures.size());
+  for (auto& future : futures) {
+    future.wait();
+  }
+  for (auto& future : futures) {
+    result.emplace_back(future.get());
+  }
+  return result;
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
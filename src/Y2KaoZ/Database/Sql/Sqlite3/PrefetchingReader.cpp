@@ -0,0 +1,168 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/PrefetchingReader.hpp"
+#include "Y2KaoZ/Database/RingBuffer.hpp"
+#include <atomic>
+#include <exception>
+#include <semaphore>
+#include <thread>
+#include <utility>
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+struct PrefetchingReader::State {
+  struct Batch {
+    // Rows past size keep their buffers for the next time the batch is filled.
+    std::vector<ResultVector> rows;
+    std::size_t size = 0;
+  };
+
+  State(Statement s, std::size_t b, std::size_t depth)
+    : statement(std::move(s))
+    , batchSize(b == 0 ? 1 : b)
+    , free(depth == 0 ? 1 : depth)
+    , full(depth == 0 ? 1 : depth)
+    , freeCount(0)
+    , fullCount(0) {
+    for (std::size_t i = 0; i < (depth == 0 ? 1 : depth); ++i) {
+      static_cast<void>(free.tryPush(Batch{}));
+      freeCount.release();
+    }
+  }
+
+  void produce() {
+    try {
+      statement.execute();
+      while (statement.rows()) {
+        freeCount.acquire();
+        if (cancelled.load(std::memory_order_acquire)) {
+          break;
+        }
+        auto batch = std::move(*free.tryPop());
+        batch.size = 0;
+        try {
+          fill(batch);
+        } catch (...) {
+          // The rows decoded before the error are still delivered.
+          publish(std::move(batch));
+          throw;
+        }
+        publish(std::move(batch));
+      }
+    } catch (...) {
+      error = std::current_exception();
+    }
+    // The extra token tells the consumer that no batch will follow the ones already in the ring.
+    fullCount.release();
+  }
+
+  void fill(Batch& batch) {
+    while (batch.size < batchSize && !cancelled.load(std::memory_order_relaxed)) {
+      if (batch.rows.size() == batch.size) {
+        batch.rows.emplace_back();
+      }
+      if (!statement.fetchInto(batch.rows[batch.size])) {
+        break;
+      }
+      ++batch.size;
+    }
+  }
+
+  void publish(Batch&& batch) {
+    static_cast<void>(full.tryPush(std::move(batch)));
+    fullCount.release();
+  }
+
+  // Returns the current batch to the producer and waits for the next one, false at the end of the result set.
+  auto advance() -> bool {
+    if (done) {
+      return false;
+    }
+    if (current) {
+      static_cast<void>(free.tryPush(std::move(*current)));
+      current.reset();
+      freeCount.release();
+    }
+    fullCount.acquire();
+    current = full.tryPop();
+    position = 0;
+    if (!current) {
+      // The producer is finished and every batch has been consumed.
+      done = true;
+      if (error) {
+        std::rethrow_exception(std::exchange(error, nullptr));
+      }
+      return false;
+    }
+    return true;
+  }
+
+  auto next() -> ResultVector* {
+    while (!current || position == current->size) {
+      if (!advance()) {
+        return nullptr;
+      }
+    }
+    return &current->rows[position++];
+  }
+
+  void stop() {
+    if (producer.joinable()) {
+      cancelled.store(true, std::memory_order_release);
+      freeCount.release();
+      producer.join();
+    }
+    done = true;
+  }
+
+  Statement statement;
+  std::size_t batchSize;
+  RingBuffer<Batch> free;
+  RingBuffer<Batch> full;
+  std::counting_semaphore<> freeCount;
+  std::counting_semaphore<> fullCount;
+  std::atomic<bool> cancelled{false};
+  std::exception_ptr error;
+  std::optional<Batch> current;
+  std::size_t position = 0;
+  bool done = false;
+  std::thread producer;
+};
+
+PrefetchingReader::PrefetchingReader(Statement statement, std::size_t batchSize, std::size_t depth)
+  : state_(std::make_unique<State>(std::move(statement), batchSize, depth)) {
+  state_->producer = std::thread([state = state_.get()]() { state->produce(); });
+}
+
+PrefetchingReader::PrefetchingReader(PrefetchingReader&&) noexcept = default;
+
+PrefetchingReader::~PrefetchingReader() {
+  if (state_) {
+    state_->stop();
+  }
+}
+
+auto PrefetchingReader::next() -> const ResultVector* {
+  return state_->next();
+}
+
+auto PrefetchingReader::fetchVector() -> std::optional<ResultVector> {
+  auto* row = state_->next();
+  if (row == nullptr) {
+    return {};
+  }
+  // Moving leaves the producer to allocate the buffer again, away from the consumer thread.
+  return std::move(*row);
+}
+
+auto PrefetchingReader::fetchAllVector() -> std::vector<ResultVector> {
+  std::vector<ResultVector> result;
+  while (auto* row = state_->next()) {
+    result.emplace_back(std::move(*row));
+  }
+  return result;
+}
+
+void PrefetchingReader::cancel() {
+  state_->stop();
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,157 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/QueryPlan.hpp"
+#include <algorithm>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+using Y2KaoZ::Database::Sql::Sqlite3::QueryPlanNode;
+
+[[nodiscard]] auto consume(std::string_view& text, std::string_view prefix) -> bool {
+  if (text.substr(0, prefix.size()) != prefix) {
+    return false;
+  }
+  text.remove_prefix(prefix.size());
+  return true;
+}
+
+[[nodiscard]] auto word(std::string_view& text) -> std::string_view {
+  auto end = std::min(text.find(' '), text.size());
+  auto result = text.substr(0, end);
+  text.remove_prefix(std::min(end + 1, text.size()));
+  return result;
+}
+
+void visit(const std::vector<QueryPlanNode>& nodes, const std::function<void(const QueryPlanNode&)>& visitor) {
+  for (const auto& node : nodes) {
+    visitor(node);
+    visit(node.children, visitor);
+  }
+}
+
+void print(const std::vector<QueryPlanNode>& nodes, const std::string& indent, std::string& out) {
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    auto last = i + 1 == nodes.size();
+    out += indent + (last ? "`--" : "|--") + nodes[i].detail + "\n";
+    print(nodes[i].children, indent + (last ? "   " : "|  "), out);
+  }
+}
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+auto QueryPlanNode::parse(std::string detail) -> QueryPlanNode {
+  QueryPlanNode node;
+  node.detail = std::move(detail);
+  std::string_view text = node.detail;
+  if (consume(text, "USE TEMP B-TREE")) {
+    node.kind = Kind::TempBTree;
+    return node;
+  }
+  if (consume(text, "CO-ROUTINE ") || consume(text, "MATERIALIZE ")) {
+    node.table = text;
+    return node;
+  }
+  if (consume(text, "SCAN ")) {
+    node.kind = Kind::Scan;
+  } else if (consume(text, "SEARCH ")) {
+    node.kind = Kind::Search;
+  } else {
+    return node;
+  }
+  // Versions before 3.36 wrote "SCAN TABLE t AS alias".
+  if (consume(text, "TABLE ")) {
+    node.table = word(text);
+    if (consume(text, "AS ")) {
+      node.table = word(text);
+    }
+  } else if (consume(text, "CONSTANT ROW")) {
+    return node;
+  } else {
+    node.table = word(text);
+  }
+  node.virtualTable = consume(text, "VIRTUAL TABLE");
+  if (!consume(text, "USING ")) {
+    return node;
+  }
+  node.primaryKey = consume(text, "INTEGER PRIMARY KEY");
+  node.automaticIndex = consume(text, "AUTOMATIC ");
+  (void)consume(text, "PARTIAL ");
+  node.coveringIndex = consume(text, "COVERING ");
+  if (consume(text, "INDEX ") && !node.automaticIndex && !text.empty() && text.front() != '(') {
+    node.index = word(text);
+  }
+  return node;
+}
+
+QueryPlan::QueryPlan(const std::vector<Row>& rows) {
+  // Parents always come before their children, the nodes are attached once every row has been parsed.
+  std::vector<QueryPlanNode> nodes;
+  std::unordered_map<int, std::size_t> positions;
+  for (const auto& row : rows) {
+    positions.emplace(row.id, nodes.size());
+    nodes.emplace_back(QueryPlanNode::parse(row.detail));
+  }
+  for (std::size_t i = rows.size(); i-- > 0;) {
+    auto parent = positions.find(rows[i].parent);
+    if (parent != positions.end() && parent->second < i) {
+      auto& children = nodes[parent->second].children;
+      children.insert(children.begin(), std::move(nodes[i]));
+    }
+  }
+  for (std::size_t i = 0; i < rows.size(); ++i) {
+    auto parent = positions.find(rows[i].parent);
+    if (parent == positions.end() || parent->second >= i) {
+      roots_.emplace_back(std::move(nodes[i]));
+    }
+  }
+}
+
+auto QueryPlan::roots() const noexcept -> const std::vector<QueryPlanNode>& {
+  return roots_;
+}
+
+auto QueryPlan::fullScans() const -> std::vector<std::string> {
+  std::unordered_set<std::string> subqueries;
+  ::visit(roots_, [&](const QueryPlanNode& node) {
+    if (node.kind == QueryPlanNode::Kind::Other && !node.table.empty()) {
+      subqueries.emplace(node.table);
+    }
+  });
+  std::vector<std::string> tables;
+  ::visit(roots_, [&](const QueryPlanNode& node) {
+    if (
+      node.kind == QueryPlanNode::Kind::Scan && node.index.empty() && !node.virtualTable && !node.table.empty() &&
+      node.table.front() != '(' && !subqueries.contains(node.table)) {
+      tables.emplace_back(node.table);
+    }
+  });
+  return tables;
+}
+
+auto QueryPlan::automaticIndexes() const -> std::vector<std::string> {
+  std::vector<std::string> tables;
+  ::visit(roots_, [&](const QueryPlanNode& node) {
+    if (node.automaticIndex) {
+      tables.emplace_back(node.table);
+    }
+  });
+  return tables;
+}
+
+auto QueryPlan::usesTempBTree() const -> bool {
+  bool found = false;
+  ::visit(roots_, [&](const QueryPlanNode& node) { found = found || node.kind == QueryPlanNode::Kind::TempBTree; });
+  return found;
+}
+
+auto QueryPlan::toString() const -> std::string {
+  std::string out = "QUERY PLAN\n";
+  ::print(roots_, "", out);
+  return out;
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,272 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/Recorder.hpp"
+#include "Y2KaoZ/Database/MappedFile.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Exception.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fmt/format.h>
+#include <fstream>
+#include <gsl/gsl_util>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+
+namespace {
+
+using Y2KaoZ::Database::BlobType;
+using Y2KaoZ::Database::ParamType;
+using Y2KaoZ::Database::Sql::Sqlite3::Exception;
+
+constexpr std::string_view MAGIC{"Y2KREC\x01\n", 8};
+
+void putVarint(std::string& out, std::uint64_t value) {
+  constexpr std::uint64_t LOW = 0x7F;
+  constexpr std::uint64_t MORE = 0x80;
+  while (value > LOW) {
+    out += static_cast<char>((value & LOW) | MORE);
+    value >>= 7U;
+  }
+  out += static_cast<char>(value);
+}
+
+void putBytes(std::string& out, const void* data, std::size_t size) {
+  putVarint(out, size);
+  out.append(static_cast<const char*>(data), size);
+}
+
+[[nodiscard]] auto zigzag(std::int64_t value) -> std::uint64_t {
+  return (static_cast<std::uint64_t>(value) << 1U) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+[[nodiscard]] auto unzigzag(std::uint64_t value) -> std::int64_t {
+  return static_cast<std::int64_t>(value >> 1U) ^ -static_cast<std::int64_t>(value & 1U);
+}
+
+// Entries use the index of the ParamType alternative as tag.
+void putParameter(std::string& out, const ParamType& parameter) {
+  out += static_cast<char>(parameter.index());
+  std::visit(
+    [&](const auto& value) {
+      using T = std::decay_t<decltype(value)>;
+      if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, BlobType>) {
+        putBytes(out, value.data(), value.size());
+      } else if constexpr (std::is_floating_point_v<T>) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value)); // NOLINT
+      } else if constexpr (std::is_same_v<T, std::uint64_t>) {
+        putVarint(out, value);
+      } else if constexpr (std::is_integral_v<T>) {
+        putVarint(out, zigzag(value));
+      }
+    },
+    parameter);
+}
+
+class Reader {
+public:
+  explicit Reader(std::string_view data) : data_(data) {
+  }
+
+  [[nodiscard]] auto done() const noexcept -> bool {
+    return data_.empty();
+  }
+
+  [[nodiscard]] auto byte() -> std::uint8_t {
+    return static_cast<std::uint8_t>(take(1).front());
+  }
+
+  [[nodiscard]] auto varint() -> std::uint64_t {
+    constexpr unsigned MAX_SHIFT = 63;
+    std::uint64_t value = 0;
+    for (unsigned shift = 0;; shift += 7) {
+      auto b = byte();
+      value |= static_cast<std::uint64_t>(b & 0x7FU) << shift;
+      if ((b & 0x80U) == 0) {
+        return value;
+      }
+      if (shift >= MAX_SHIFT) {
+        throw Exception("Corrupted recording: a varint is too long.");
+      }
+    }
+  }
+
+  [[nodiscard]] auto take(std::size_t size) -> std::string_view {
+    if (size > data_.size()) {
+      throw Exception("Truncated recording.");
+    }
+    auto result = data_.substr(0, size);
+    data_.remove_prefix(size);
+    return result;
+  }
+
+  template <typename T>
+  [[nodiscard]] auto raw() -> T {
+    T value{};
+    std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+    return value;
+  }
+
+  template <typename T>
+  [[nodiscard]] auto integer() -> T {
+    if constexpr (std::is_same_v<T, std::uint64_t>) {
+      return varint();
+    } else {
+      return gsl::narrow<T>(unzigzag(varint()));
+    }
+  }
+
+  [[nodiscard]] auto parameter() -> ParamType {
+    auto tag = byte();
+    switch (tag) {
+      case 0:
+        return Y2KaoZ::Database::NullValue;
+      case 1:
+        return integer<std::int8_t>();
+      case 2:
+        return integer<std::uint8_t>();
+      case 3:
+        return integer<std::int16_t>();
+      case 4:
+        return integer<std::uint16_t>();
+      case 5:
+        return integer<std::int32_t>();
+      case 6:
+        return integer<std::uint32_t>();
+      case 7:
+        return integer<std::int64_t>();
+      case 8:
+        return integer<std::uint64_t>();
+      case 9:
+        return raw<float>();
+      case 10:
+        return raw<double>();
+      case 11:
+        return std::string(take(gsl::narrow<std::size_t>(varint())));
+      case 12: {
+        auto bytes = take(gsl::narrow<std::size_t>(varint()));
+        const auto* first = reinterpret_cast<const std::byte*>(bytes.data()); // NOLINT
+        return BlobType(first, first + bytes.size()); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      }
+      default:
+        throw Exception(fmt::format("Corrupted recording: unknown parameter type {}.", tag));
+    }
+  }
+
+private:
+  std::string_view data_;
+};
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+struct Recorder::State {
+  std::mutex mutex;
+  std::ofstream file;
+  std::string buffer;
+  std::size_t bufferSize;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::chrono::nanoseconds last{};
+  std::unordered_map<std::string, std::uint32_t> statements;
+  std::unordered_map<std::thread::id, std::uint32_t> threads;
+  std::uint64_t calls = 0;
+
+  void write() {
+    file.write(buffer.data(), gsl::narrow<std::streamsize>(buffer.size()));
+    file.flush();
+    buffer.clear();
+    if (!file) {
+      throw Exception("Error while writing the recording.");
+    }
+  }
+};
+
+Recorder::Recorder(const std::filesystem::path& path, std::size_t bufferSize) : state_(std::make_unique<State>()) {
+  state_->file.open(path, std::ios::binary | std::ios::trunc);
+  if (!state_->file) {
+    throw Exception(fmt::format(R"(Can not open "{}" for writing)", path.string()));
+  }
+  state_->bufferSize = bufferSize;
+  state_->buffer.reserve(bufferSize);
+  state_->buffer.append(MAGIC);
+}
+
+Recorder::~Recorder() {
+  try {
+    flush();
+  } catch (const Exception&) { // NOLINT(bugprone-empty-catch)
+    // Destructors must not throw, entries that could not be written are lost.
+  }
+}
+
+void Recorder::record(RecordedKind kind, std::string_view sql, const ParamVector& parameters) {
+  auto& state = *state_;
+  std::scoped_lock lock(state.mutex);
+  // Taken under the lock so that the times of the entries never decrease.
+  auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - state.start);
+  auto& out = state.buffer;
+  out += static_cast<char>(kind);
+  putVarint(out, static_cast<std::uint64_t>((time - state.last).count()));
+  state.last = time;
+  auto thread = state.threads.try_emplace(std::this_thread::get_id(), state.threads.size()).first->second;
+  putVarint(out, thread);
+  // A new text takes the next number and is written after it, known ones are only written as their number.
+  auto [statement, added] = state.statements.try_emplace(std::string(sql), state.statements.size());
+  putVarint(out, statement->second);
+  if (added) {
+    putBytes(out, sql.data(), sql.size());
+  }
+  putVarint(out, parameters.size());
+  for (const auto& parameter : parameters) {
+    putParameter(out, parameter);
+  }
+  ++state.calls;
+  if (out.size() >= state.bufferSize) {
+    state.write();
+  }
+}
+
+void Recorder::flush() {
+  std::scoped_lock lock(state_->mutex);
+  state_->write();
+}
+
+auto Recorder::calls() const -> std::uint64_t {
+  std::scoped_lock lock(state_->mutex);
+  return state_->calls;
+}
+
+auto Recording::load(const std::filesystem::path& path) -> Recording {
+  MappedFile file(path);
+  if (file.view().substr(0, MAGIC.size()) != MAGIC) {
+    throw Exception(fmt::format(R"("{}" is not a recording.)", path.string()));
+  }
+  Reader reader(file.view().substr(MAGIC.size()));
+  Recording recording;
+  std::chrono::nanoseconds time{};
+  while (!reader.done()) {
+    auto& call = recording.calls.emplace_back();
+    auto kind = reader.byte();
+    if (kind > static_cast<std::uint8_t>(RecordedKind::Script)) {
+      throw Exception(fmt::format("Corrupted recording: unknown call kind {}.", kind));
+    }
+    call.kind = static_cast<RecordedKind>(kind);
+    time += std::chrono::nanoseconds(reader.varint());
+    call.time = time;
+    call.thread = gsl::narrow<std::uint32_t>(reader.varint());
+    call.statement = gsl::narrow<std::uint32_t>(reader.varint());
+    if (call.statement == recording.statements.size()) {
+      recording.statements.emplace_back(reader.take(gsl::narrow<std::size_t>(reader.varint())));
+    } else if (call.statement > recording.statements.size()) {
+      throw Exception("Corrupted recording: unknown statement.");
+    }
+    auto count = gsl::narrow<std::size_t>(reader.varint());
+    constexpr std::size_t MAX_RESERVE = 1024;
+    call.parameters.reserve(std::min(count, MAX_RESERVE));
+    for (std::size_t i = 0; i < count; ++i) {
+      call.parameters.emplace_back(reader.parameter());
+    }
+  }
+  return recording;
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
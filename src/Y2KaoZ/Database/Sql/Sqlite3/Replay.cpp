@@ -0,0 +1,143 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/Replay.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Connection.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Exception.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Statement.hpp"
+#include <algorithm>
+#include <future>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+using Y2KaoZ::Database::Sql::Sqlite3::RecordedCall;
+using Y2KaoZ::Database::Sql::Sqlite3::RecordedKind;
+using Y2KaoZ::Database::Sql::Sqlite3::Recording;
+using Y2KaoZ::Database::Sql::Sqlite3::ReplayOptions;
+using Y2KaoZ::Database::Sql::Sqlite3::Statement;
+
+struct Measures {
+  std::vector<std::vector<std::chrono::nanoseconds>> latencies;
+  std::vector<std::uint64_t> errors;
+};
+
+[[nodiscard]] auto run(
+  const std::filesystem::path& database,
+  const Recording& recording,
+  const std::vector<const RecordedCall*>& calls,
+  const ReplayOptions& options,
+  Clock::time_point start) -> Measures {
+  Connection connection{database};
+  sqlite3_busy_timeout(connection.backend(), options.busyTimeoutMs);
+  std::unordered_map<std::uint32_t, Statement> prepared;
+  Measures measures;
+  measures.latencies.resize(recording.statements.size());
+  measures.errors.resize(recording.statements.size());
+  auto origin = calls.empty() ? std::chrono::nanoseconds{} : recording.calls.front().time;
+  for (const auto* call : calls) {
+    if (options.recordedRate) {
+      std::this_thread::sleep_until(start + (call->time - origin));
+    }
+    const auto& sql = recording.statements[call->statement];
+    auto begin = Clock::now();
+    try {
+      if (call->kind == RecordedKind::Script) {
+        connection.execute(sql);
+      } else {
+        auto found = prepared.find(call->statement);
+        if (found == prepared.end()) {
+          found = prepared.emplace(call->statement, connection.prepare(sql)).first;
+        }
+        auto& statement = found->second;
+        statement.clearParameters().bind(call->parameters).execute();
+        while (statement.rows()) {
+          statement.execute();
+        }
+      }
+    } catch (const std::exception&) {
+      ++measures.errors[call->statement];
+      continue;
+    }
+    measures.latencies[call->statement].emplace_back(Clock::now() - begin);
+  }
+  return measures;
+}
+
+[[nodiscard]] auto percentile(const std::vector<std::chrono::nanoseconds>& sorted, double p)
+  -> std::chrono::nanoseconds {
+  if (sorted.empty()) {
+    return {};
+  }
+  auto rank = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+  return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+auto ReplayReport::callsPerSecond() const noexcept -> double {
+  return seconds > 0.0 ? static_cast<double>(calls) / seconds : 0.0;
+}
+
+auto replay(const std::filesystem::path& database, const Recording& recording, const ReplayOptions& options)
+  -> ReplayReport {
+  auto threads = std::max<std::size_t>(options.threads, 1);
+  std::vector<std::vector<const RecordedCall*>> shares(threads);
+  for (const auto& call : recording.calls) {
+    if (call.statement >= recording.statements.size()) {
+      throw Exception("The recording refers to an unknown statement.");
+    }
+    shares[call.thread % threads].push_back(&call);
+  }
+
+  auto start = Clock::now();
+  std::vector<std::future<Measures>> workers;
+  for (const auto& share : shares) {
+    workers.emplace_back(std::async(std::launch::async, [&, start]() {
+      return ::run(database, recording, share, options, start);
+    }));
+  }
+  std::vector<Measures> measures;
+  for (auto& worker : workers) {
+    measures.emplace_back(worker.get());
+  }
+
+  ReplayReport report;
+  report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  for (std::size_t s = 0; s < recording.statements.size(); ++s) {
+    ReplayStatementStats stats;
+    std::vector<std::chrono::nanoseconds> latencies;
+    for (auto& measure : measures) {
+      stats.errors += measure.errors[s];
+      latencies.insert(latencies.end(), measure.latencies[s].begin(), measure.latencies[s].end());
+    }
+    if (latencies.empty() && stats.errors == 0) {
+      continue;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    stats.sql = recording.statements[s];
+    stats.calls = latencies.size() + stats.errors;
+    for (auto latency : latencies) {
+      stats.total += latency;
+    }
+    constexpr double P50 = 0.5;
+    constexpr double P90 = 0.9;
+    constexpr double P99 = 0.99;
+    stats.p50 = ::percentile(latencies, P50);
+    stats.p90 = ::percentile(latencies, P90);
+    stats.p99 = ::percentile(latencies, P99);
+    stats.max = latencies.empty() ? std::chrono::nanoseconds{} : latencies.back();
+    report.calls += stats.calls;
+    report.errors += stats.errors;
+    report.statements.emplace_back(std::move(stats));
+  }
+  std::sort(report.statements.begin(), report.statements.end(), [](const auto& a, const auto& b) {
+    return a.total > b.total;
+  });
+  return report;
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,329 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/ResultCache.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Statement.hpp"
+#include <algorithm>
+#include <gsl/gsl_util>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+using Y2KaoZ::Database::ParamVector;
+using Y2KaoZ::Database::ResultType;
+using Y2KaoZ::Database::ResultVector;
+
+struct KeyView {
+  std::string_view statement;
+  const ParamVector* parameters;
+};
+
+struct Key {
+  std::string statement;
+  ParamVector parameters;
+  [[nodiscard]] auto view() const -> KeyView {
+    return {statement, &parameters};
+  }
+};
+
+struct KeyHash {
+  [[nodiscard]] auto operator()(const KeyView& key) const noexcept -> std::size_t {
+    static const std::size_t PRIME = 0x100000001b3ULL;
+    auto hash = std::hash<std::string_view>{}(key.statement);
+    for (const auto& parameter : *key.parameters) {
+      hash = (hash ^ static_cast<std::size_t>(Y2KaoZ::Database::hashValue(parameter))) * PRIME;
+    }
+    return hash;
+  }
+};
+
+struct KeyEqual {
+  [[nodiscard]] auto operator()(const KeyView& a, const KeyView& b) const -> bool {
+    return a.statement == b.statement && *a.parameters == *b.parameters;
+  }
+};
+
+struct StringHash {
+  using is_transparent = void;
+  [[nodiscard]] auto operator()(std::string_view s) const noexcept -> std::size_t {
+    return std::hash<std::string_view>{}(s);
+  }
+};
+
+[[nodiscard]] auto estimateSize(const std::vector<ResultVector>& rows) -> std::size_t {
+  auto size = sizeof(rows) + rows.capacity() * sizeof(ResultVector);
+  for (const auto& row : rows) {
+    size += row.capacity() * sizeof(ResultType);
+    for (const auto& cell : row) {
+      if (cell.isString() && cell.stringView().size() > ResultType::INLINE_CAPACITY) {
+        size += cell.stringView().size();
+      } else if (cell.isBlob() && cell.blobView().size() > ResultType::INLINE_CAPACITY) {
+        size += cell.blobView().size();
+      }
+    }
+  }
+  return size;
+}
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+auto ResultCacheStats::hitRatio() const noexcept -> double {
+  auto lookups = hits + misses;
+  return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+}
+
+struct ResultCache::State {
+  struct Entry;
+  struct Prepared {
+    Statement statement;
+    std::vector<std::string> tables;
+    bool cacheable;
+    std::list<std::string_view>::iterator recent;
+    // The cached results of the statement, dropped with it.
+    std::unordered_set<Entry*> entries;
+  };
+  struct Entry {
+    Key key;
+    Rows rows;
+    std::size_t size;
+    Prepared* prepared;
+  };
+  using Statements = std::unordered_map<std::string, Prepared, StringHash, std::equal_to<>>;
+  using Lru = std::list<Entry>;
+
+  State(Connection c, std::size_t b)
+    : connection(std::move(c))
+    , budget(b)
+    , lastChanges(sqlite3_total_changes64(connection.backend())) {
+  }
+
+  // The tables read by a statement are recorded while it is being prepared. The schema is not always reported (for
+  // example when no column is read, as in count(*)), so tables are only identified by name.
+  auto prepare(std::string_view text) -> Prepared& {
+    auto found = statements.find(text);
+    if (found != statements.end()) {
+      recent.splice(recent.begin(), recent, found->second.recent);
+      return found->second;
+    }
+    std::vector<std::string> tables;
+    auto authorizer = connection.addAuthorizer(
+      [&](int action, std::string_view table, std::string_view /*column*/, std::string_view, std::string_view) {
+        if (action == SQLITE_READ && !table.empty() && std::find(tables.begin(), tables.end(), table) == tables.end()) {
+          tables.emplace_back(table);
+        }
+        return SQLITE_OK;
+      });
+    auto remove = gsl::finally([&]() { connection.removeHook(authorizer); });
+    auto statement = connection.prepare(text);
+    auto cacheable = sqlite3_stmt_readonly(statement.backend()) != 0 && statement.columnCount() > 0;
+    if (statements.size() >= STATEMENT_CAPACITY) {
+      forget(statements.find(recent.back()));
+    }
+    auto& [key, prepared] =
+      *statements.emplace(std::string(text), Prepared{std::move(statement), std::move(tables), cacheable, {}, {}})
+         .first;
+    prepared.recent = recent.insert(recent.begin(), key);
+    return prepared;
+  }
+
+  // Finalizes the least recently used statement along with its cached results.
+  void forget(Statements::iterator statement) {
+    auto entries = std::move(statement->second.entries);
+    for (auto* entry : entries) {
+      erase(index.find(entry->key.view())->second);
+    }
+    recent.erase(statement->second.recent);
+    statements.erase(statement);
+  }
+
+  void erase(Lru::iterator entry) {
+    entry->prepared->entries.erase(&*entry);
+    for (const auto& table : entry->prepared->tables) {
+      auto found = byTable.find(table);
+      if (found != byTable.end()) {
+        found->second.erase(&*entry);
+      }
+    }
+    used -= entry->size;
+    index.erase(entry->key.view());
+    lru.erase(entry);
+  }
+
+  void invalidate(std::string_view table) {
+    auto found = byTable.find(table);
+    if (found == byTable.end()) {
+      return;
+    }
+    auto entries = std::move(found->second);
+    byTable.erase(found);
+    for (auto* entry : entries) {
+      auto position = index.find(entry->key.view());
+      if (position != index.end()) {
+        ++invalidations;
+        erase(position->second);
+      }
+    }
+  }
+
+  void clear() {
+    for (auto& [text, prepared] : statements) {
+      prepared.entries.clear();
+    }
+    invalidations += lru.size();
+    lru.clear();
+    index.clear();
+    byTable.clear();
+    used = 0;
+  }
+
+  // Detects changes that escaped the update hook: commits made by other connections (data_version) and changes
+  // made by this one that sqlite does not report to the hook, like the truncate optimization or WITHOUT ROWID tables.
+  void checkVersion() {
+    if (!dataVersion) {
+      dataVersion.emplace(connection.prepare("PRAGMA data_version;"));
+    }
+    auto version = dataVersion->execute().fetchColumn(0).value_or(ResultType{}).asInteger64();
+    dataVersion->reset();
+    auto changes = sqlite3_total_changes64(connection.backend());
+    auto unhooked = changes - lastChanges > hookedChanges;
+    if (version != lastVersion || unhooked) {
+      clear();
+    }
+    // The tables of those changes are unknown, a rollback could undo any of them.
+    unhookedChanges = unhookedChanges || (unhooked && sqlite3_get_autocommit(connection.backend()) == 0);
+    lastVersion = version;
+    lastChanges = changes;
+    hookedChanges = 0;
+  }
+
+  // Tells whether tables were changed by the transaction in progress, which is assumed of every table once it made
+  // changes the update hook did not see. Their rows are not cached: a ROLLBACK TO or a failed statement can undo those
+  // changes without changing data_version or total_changes.
+  [[nodiscard]] auto uncommitted(const std::vector<std::string>& tables) const -> bool {
+    return sqlite3_get_autocommit(connection.backend()) == 0 &&
+           (unhookedChanges ||
+            std::any_of(tables.begin(), tables.end(), [&](const auto& table) { return dirty.contains(table); }));
+  }
+
+  Connection connection;
+  std::size_t budget;
+  std::size_t used = 0;
+  Statements statements;
+  // The statements from the most to the least recently used, the keys point into statements.
+  std::list<std::string_view> recent;
+  Lru lru;
+  // The keys point into the entries of the LRU list.
+  std::unordered_map<KeyView, Lru::iterator, KeyHash, KeyEqual> index;
+  std::unordered_map<std::string, std::unordered_set<Entry*>, StringHash, std::equal_to<>> byTable;
+  std::unordered_set<std::string> dirty;
+  bool unhookedChanges = false;
+  std::optional<Statement> dataVersion;
+  std::int64_t lastVersion = -1;
+  std::int64_t lastChanges = 0;
+  std::int64_t hookedChanges = 0;
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;
+  std::uint64_t evictions = 0;
+  std::uint64_t invalidations = 0;
+  std::vector<Connection::HookId> hooks;
+};
+
+ResultCache::ResultCache(Connection connection, std::size_t budget)
+  : state_(std::make_unique<State>(std::move(connection), budget)) {
+  auto* state = state_.get();
+  state->hooks.emplace_back(state->connection.addUpdateHook(
+    [state](RowChange /*change*/, std::string_view /*database*/, std::string_view table, std::int64_t /*rowid*/) {
+      state->invalidate(table);
+      state->dirty.emplace(table);
+      ++state->hookedChanges;
+    }));
+  state->hooks.emplace_back(state->connection.addCommitHook([state]() {
+    state->dirty.clear();
+    state->unhookedChanges = false;
+  }));
+  // Rows read inside the rolled back transaction may have been cached with the changes that are now gone.
+  state->hooks.emplace_back(state->connection.addRollbackHook([state]() {
+    for (const auto& table : state->dirty) {
+      state->invalidate(table);
+    }
+    state->dirty.clear();
+    state->unhookedChanges = false;
+  }));
+}
+
+ResultCache::ResultCache(ResultCache&&) noexcept = default;
+
+ResultCache::~ResultCache() {
+  if (state_) {
+    for (auto id : state_->hooks) {
+      state_->connection.removeHook(id);
+    }
+  }
+}
+
+auto ResultCache::fetchAll(std::string_view statement, const ParamVector& parameters) -> Rows {
+  auto& state = *state_;
+  state.checkVersion();
+  auto& prepared = state.prepare(statement);
+  if (prepared.cacheable) {
+    auto found = state.index.find(KeyView{statement, &parameters});
+    if (found != state.index.end()) {
+      ++state.hits;
+      state.lru.splice(state.lru.begin(), state.lru, found->second);
+      return found->second->rows;
+    }
+    ++state.misses;
+  }
+
+  prepared.statement.clearParameters().bind(parameters).execute();
+  Rows rows = std::make_shared<const std::vector<ResultVector>>(prepared.statement.fetchAllVector());
+  if (!prepared.cacheable || state.uncommitted(prepared.tables)) {
+    return rows;
+  }
+
+  auto size = statement.size() + ::estimateSize(*rows);
+  if (size > state.budget) {
+    return rows;
+  }
+  while (!state.lru.empty() && state.used + size > state.budget) {
+    ++state.evictions;
+    state.erase(std::prev(state.lru.end()));
+  }
+  state.lru.push_front(State::Entry{Key{std::string(statement), parameters}, rows, size, &prepared});
+  auto& entry = state.lru.front();
+  prepared.entries.emplace(&entry);
+  state.index.emplace(entry.key.view(), state.lru.begin());
+  for (const auto& table : prepared.tables) {
+    state.byTable[table].emplace(&entry);
+  }
+  state.used += size;
+  return rows;
+}
+
+auto ResultCache::tables(std::string_view statement) -> const std::vector<std::string>& {
+  return state_->prepare(statement).tables;
+}
+
+void ResultCache::invalidate(std::string_view table) {
+  state_->invalidate(table);
+}
+
+void ResultCache::clear() {
+  state_->clear();
+}
+
+auto ResultCache::stats() const -> ResultCacheStats {
+  ResultCacheStats stats;
+  stats.hits = state_->hits;
+  stats.misses = state_->misses;
+  stats.evictions = state_->evictions;
+  stats.invalidations = state_->invalidations;
+  stats.entries = state_->lru.size();
+  stats.memoryUsed = state_->used;
+  stats.memoryBudget = state_->budget;
+  return stats;
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
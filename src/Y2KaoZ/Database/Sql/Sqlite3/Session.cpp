@@ -0,0 +1,371 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/Session.hpp"
+
+#ifdef SQLITE_ENABLE_SESSION
+
+#include "Y2KaoZ/Database/Sql/Sqlite3/Exception.hpp"
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <gsl/gsl_util>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+using Y2KaoZ::Database::BlobType;
+using Y2KaoZ::Database::ResultType;
+using Y2KaoZ::Database::ResultVector;
+using Y2KaoZ::Database::Sql::Sqlite3::ChangesetConflict;
+using Y2KaoZ::Database::Sql::Sqlite3::ConflictAction;
+using Y2KaoZ::Database::Sql::Sqlite3::ConflictHandler;
+using Y2KaoZ::Database::Sql::Sqlite3::ConflictType;
+using Y2KaoZ::Database::Sql::Sqlite3::Exception;
+using Y2KaoZ::Database::Sql::Sqlite3::RowChange;
+using Y2KaoZ::Database::Sql::Sqlite3::TableFilter;
+
+[[nodiscard]] auto toResult(sqlite3_value* value) -> ResultType {
+  if (value == nullptr) {
+    return ResultType{};
+  }
+  switch (sqlite3_value_type(value)) {
+    case SQLITE_INTEGER:
+      return ResultType(sqlite3_value_int64(value));
+    case SQLITE_FLOAT:
+      return ResultType(sqlite3_value_double(value));
+    case SQLITE_TEXT: {
+      const auto* text = reinterpret_cast<const char*>(sqlite3_value_text(value)); // NOLINT
+      return ResultType::fromText({text, gsl::narrow<std::size_t>(sqlite3_value_bytes(value))});
+    }
+    case SQLITE_BLOB: {
+      const auto* blob = static_cast<const std::byte*>(sqlite3_value_blob(value));
+      return ResultType::fromBlob({blob, gsl::narrow<std::size_t>(sqlite3_value_bytes(value))});
+    }
+    default:
+      return ResultType{};
+  }
+}
+
+using ValueGetter = int (*)(sqlite3_changeset_iter*, int, sqlite3_value**);
+
+[[nodiscard]] auto row(sqlite3_changeset_iter* iterator, int columns, ValueGetter get) -> ResultVector {
+  ResultVector values;
+  values.reserve(gsl::narrow<std::size_t>(columns));
+  for (int i = 0; i < columns; ++i) {
+    sqlite3_value* value = nullptr;
+    values.emplace_back(get(iterator, i, &value) == SQLITE_OK ? toResult(value) : ResultType{});
+  }
+  return values;
+}
+
+[[nodiscard]] auto toConflictType(int type) -> ConflictType {
+  switch (type) {
+    case SQLITE_CHANGESET_NOTFOUND:
+      return ConflictType::NotFound;
+    case SQLITE_CHANGESET_CONFLICT:
+      return ConflictType::Conflict;
+    case SQLITE_CHANGESET_CONSTRAINT:
+      return ConflictType::Constraint;
+    case SQLITE_CHANGESET_FOREIGN_KEY:
+      return ConflictType::ForeignKey;
+    default:
+      return ConflictType::Data;
+  }
+}
+
+[[nodiscard]] auto describe(sqlite3_changeset_iter* iterator, int type) -> ChangesetConflict {
+  ChangesetConflict conflict;
+  conflict.type = toConflictType(type);
+  if (conflict.type == ConflictType::ForeignKey) {
+    sqlite3changeset_fk_conflicts(iterator, &conflict.foreignKeyViolations);
+    return conflict;
+  }
+  const char* table = nullptr;
+  int columns = 0;
+  int operation = 0;
+  int indirect = 0;
+  sqlite3changeset_op(iterator, &table, &columns, &operation, &indirect);
+  conflict.table = table;
+  conflict.change = operation == SQLITE_INSERT   ? RowChange::Insert
+                    : operation == SQLITE_DELETE ? RowChange::Delete
+                                                 : RowChange::Update;
+  if (operation != SQLITE_INSERT) {
+    conflict.oldValues = row(iterator, columns, sqlite3changeset_old);
+  }
+  if (operation != SQLITE_DELETE) {
+    conflict.newValues = row(iterator, columns, sqlite3changeset_new);
+  }
+  if (conflict.type == ConflictType::Data || conflict.type == ConflictType::Conflict) {
+    conflict.conflictingValues = row(iterator, columns, sqlite3changeset_conflict);
+  }
+  return conflict;
+}
+
+// The callbacks run inside sqlite, the first exception they throw aborts the changeset and is rethrown afterwards.
+struct ApplyContext {
+  const ConflictHandler& onConflict;
+  const TableFilter& filter;
+  const Y2KaoZ::Database::Sql::Sqlite3::ChangesetInput* input;
+  std::exception_ptr error;
+};
+
+auto filter(void* context, const char* table) -> int {
+  auto& apply = *static_cast<ApplyContext*>(context);
+  try {
+    return !apply.filter || apply.filter(table) ? 1 : 0;
+  } catch (...) {
+    apply.error = std::current_exception();
+    return 0;
+  }
+}
+
+auto conflict(void* context, int type, sqlite3_changeset_iter* iterator) -> int {
+  auto& apply = *static_cast<ApplyContext*>(context);
+  if (apply.error || !apply.onConflict) {
+    return SQLITE_CHANGESET_ABORT;
+  }
+  try {
+    switch (apply.onConflict(describe(iterator, type))) {
+      case ConflictAction::Omit:
+        return SQLITE_CHANGESET_OMIT;
+      case ConflictAction::Replace:
+        if (type == SQLITE_CHANGESET_DATA || type == SQLITE_CHANGESET_CONFLICT) {
+          return SQLITE_CHANGESET_REPLACE;
+        }
+        throw std::invalid_argument("Only Data and Conflict conflicts can be replaced.");
+      default:
+        return SQLITE_CHANGESET_ABORT;
+    }
+  } catch (...) {
+    apply.error = std::current_exception();
+    return SQLITE_CHANGESET_ABORT;
+  }
+}
+
+auto input(void* context, void* data, int* size) -> int {
+  auto& apply = *static_cast<ApplyContext*>(context);
+  try {
+    *size = gsl::narrow<int>((*apply.input)({static_cast<std::byte*>(data), gsl::narrow<std::size_t>(*size)}));
+    return SQLITE_OK;
+  } catch (...) {
+    apply.error = std::current_exception();
+    return SQLITE_IOERR;
+  }
+}
+
+void check(int rc, const ApplyContext& apply) {
+  if (apply.error) {
+    std::rethrow_exception(apply.error);
+  }
+  if (rc != SQLITE_OK) {
+    throw Exception(rc == SQLITE_ABORT ? "The changeset was aborted by a conflict." : sqlite3_errstr(rc));
+  }
+}
+
+// Runs apply inside a savepoint, rolled back when a callback threw: sqlite only stops for errors it sees itself, a
+// table skipped because its filter threw leaves the changes of the other tables applied.
+template <typename Apply>
+void applyAtomically(Y2KaoZ::Database::Sql::Sqlite3::Connection& connection, ApplyContext& context, Apply apply) {
+  connection.execute("SAVEPOINT y2kaoz_apply_changeset;");
+  auto rc = apply();
+  if (context.error || rc != SQLITE_OK) {
+    connection.execute("ROLLBACK TO y2kaoz_apply_changeset; RELEASE y2kaoz_apply_changeset;");
+  } else {
+    connection.execute("RELEASE y2kaoz_apply_changeset;");
+  }
+  ::check(rc, context);
+}
+
+struct OutputContext {
+  const Y2KaoZ::Database::Sql::Sqlite3::ChangesetOutput& output;
+  std::exception_ptr error;
+};
+
+auto output(void* context, const void* data, int size) -> int {
+  auto& out = *static_cast<OutputContext*>(context);
+  try {
+    out.output({static_cast<const std::byte*>(data), gsl::narrow<std::size_t>(size)});
+    return SQLITE_OK;
+  } catch (...) {
+    out.error = std::current_exception();
+    return SQLITE_IOERR;
+  }
+}
+
+using Generator = int (*)(sqlite3_session*, int*, void**);
+using StreamGenerator = int (*)(sqlite3_session*, int (*)(void*, const void*, int), void*);
+
+[[nodiscard]] auto generate(sqlite3_session* session, Generator generator) -> BlobType {
+  int size = 0;
+  void* data = nullptr;
+  auto rc = generator(session, &size, &data);
+  auto release = gsl::finally([&]() { sqlite3_free(data); });
+  if (rc != SQLITE_OK) {
+    throw Exception(sqlite3_errstr(rc));
+  }
+  const auto* bytes = static_cast<const std::byte*>(data);
+  return {bytes, bytes + size}; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
+
+void stream(
+  sqlite3_session* session,
+  StreamGenerator generator,
+  const Y2KaoZ::Database::Sql::Sqlite3::ChangesetOutput& out) {
+  OutputContext context{out, nullptr};
+  auto rc = generator(session, ::output, &context);
+  if (context.error) {
+    std::rethrow_exception(context.error);
+  }
+  if (rc != SQLITE_OK) {
+    throw Exception(sqlite3_errstr(rc));
+  }
+}
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+struct Session::State {
+  State(Connection c, std::string d) : connection(std::move(c)), database(std::move(d)) {
+    open();
+  }
+
+  State(const State&) = delete;
+  State(State&&) = delete;
+  auto operator=(const State&) -> State& = delete;
+  auto operator=(State&&) -> State& = delete;
+
+  ~State() {
+    if (session != nullptr) {
+      sqlite3session_delete(session);
+    }
+  }
+
+  void open() {
+    sqlite3_session* created = nullptr;
+    auto rc = sqlite3session_create(connection.backend(), database.c_str(), &created);
+    if (rc != SQLITE_OK) {
+      throw Exception(sqlite3_errstr(rc));
+    }
+    if (session != nullptr) {
+      sqlite3session_delete(session);
+    }
+    session = created;
+    sqlite3session_enable(session, enabled ? 1 : 0);
+    sqlite3session_indirect(session, indirect ? 1 : 0);
+    if (all) {
+      attach(nullptr);
+    }
+    for (const auto& table : tables) {
+      attach(table.c_str());
+    }
+  }
+
+  void attach(const char* table) const {
+    auto rc = sqlite3session_attach(session, table);
+    if (rc != SQLITE_OK) {
+      throw Exception(sqlite3_errstr(rc));
+    }
+  }
+
+  Connection connection;
+  std::string database;
+  sqlite3_session* session = nullptr;
+  // Kept to start the session again after a take.
+  std::vector<std::string> tables;
+  bool all = false;
+  bool enabled = true;
+  bool indirect = false;
+};
+
+Session::Session(Connection connection, const std::string& database)
+  : state_(std::make_unique<State>(std::move(connection), database)) {
+}
+
+Session::Session(Session&&) noexcept = default;
+
+Session::~Session() = default;
+
+void Session::attach(const std::string& table) {
+  state_->attach(table.c_str());
+  state_->tables.push_back(table);
+}
+
+void Session::attachAll() {
+  state_->attach(nullptr);
+  state_->all = true;
+}
+
+void Session::setEnabled(bool enabled) {
+  sqlite3session_enable(state_->session, enabled ? 1 : 0);
+  state_->enabled = enabled;
+}
+
+auto Session::enabled() const -> bool {
+  return state_->enabled;
+}
+
+void Session::setIndirect(bool indirect) {
+  sqlite3session_indirect(state_->session, indirect ? 1 : 0);
+  state_->indirect = indirect;
+}
+
+auto Session::empty() const -> bool {
+  return sqlite3session_isempty(state_->session) != 0;
+}
+
+auto Session::changeset() const -> BlobType {
+  return ::generate(state_->session, sqlite3session_changeset);
+}
+
+void Session::changeset(const ChangesetOutput& output) const {
+  ::stream(state_->session, sqlite3session_changeset_strm, output);
+}
+
+auto Session::patchset() const -> BlobType {
+  return ::generate(state_->session, sqlite3session_patchset);
+}
+
+void Session::patchset(const ChangesetOutput& output) const {
+  ::stream(state_->session, sqlite3session_patchset_strm, output);
+}
+
+auto Session::takeChangeset() -> BlobType {
+  auto result = changeset();
+  state_->open();
+  return result;
+}
+
+auto Session::takePatchset() -> BlobType {
+  auto result = patchset();
+  state_->open();
+  return result;
+}
+
+void applyChangeset(
+  Connection& connection,
+  BlobView changeset,
+  const ConflictHandler& onConflict,
+  const TableFilter& filter) {
+  ApplyContext context{onConflict, filter, nullptr, nullptr};
+  // sqlite does not modify the changeset, it only lacks a const qualifier.
+  auto* data = const_cast<std::byte*>(changeset.data()); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+  auto size = gsl::narrow<int>(changeset.size());
+  ::applyAtomically(connection, context, [&]() {
+    return sqlite3changeset_apply(connection.backend(), size, data, ::filter, ::conflict, &context);
+  });
+}
+
+void applyChangeset(
+  Connection& connection,
+  const ChangesetInput& input,
+  const ConflictHandler& onConflict,
+  const TableFilter& filter) {
+  ApplyContext context{onConflict, filter, &input, nullptr};
+  ::applyAtomically(connection, context, [&]() {
+    return sqlite3changeset_apply_strm(connection.backend(), ::input, &context, ::filter, ::conflict, &context);
+  });
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
+
+#endif
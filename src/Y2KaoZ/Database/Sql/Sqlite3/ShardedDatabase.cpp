@@ -0,0 +1,162 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/ShardedDatabase.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Exception.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Statement.hpp"
+#include <algorithm>
+#include <fmt/format.h>
+#include <future>
+#include <utility>
+
+namespace {
+
+using Y2KaoZ::Database::ParamVector;
+using Y2KaoZ::Database::ResultVector;
+using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+
+[[nodiscard]] auto fetchShard(Connection shard, std::string_view query, const ParamVector& parameters)
+  -> std::vector<ResultVector> {
+  auto statement = shard.prepare(query);
+  statement.bind(parameters);
+  statement.execute();
+  return statement.fetchAllVector();
+}
+
+[[nodiscard]] auto schemaName(std::string_view prefix, std::size_t i) -> std::string {
+  return fmt::format("{}{}", prefix, i);
+}
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+ShardedDatabase::ShardedDatabase(
+  const std::vector<std::filesystem::path>& filenames,
+  ShardRouter router,
+  std::uint32_t flags)
+  : filenames_(filenames)
+  , router_(std::move(router)) {
+  if (filenames_.empty()) {
+    throw std::invalid_argument("A sharded database needs at least one shard.");
+  }
+  shards_.reserve(filenames_.size());
+  for (const auto& filename : filenames_) {
+    shards_.emplace_back(filename, flags);
+  }
+}
+
+auto ShardedDatabase::hashRouter() -> ShardRouter {
+  return [](const ParamType& key, std::size_t shards) {
+    return static_cast<std::size_t>(hashValue(key) % shards);
+  };
+}
+
+auto ShardedDatabase::rangeRouter(std::vector<std::int64_t> upperBounds) -> ShardRouter {
+  std::sort(upperBounds.begin(), upperBounds.end());
+  return [upperBounds = std::move(upperBounds)](const ParamType& key, std::size_t shards) {
+    auto value = std::visit(
+      [](const auto& v) -> std::int64_t {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_arithmetic_v<T>) {
+          return static_cast<std::int64_t>(v);
+        } else {
+          throw std::invalid_argument("The range router only accepts numeric keys.");
+        }
+      },
+      key);
+    auto shard = static_cast<std::size_t>(std::upper_bound(upperBounds.begin(), upperBounds.end(), value) -
+                                          upperBounds.begin());
+    return std::min(shard, shards - 1);
+  };
+}
+
+auto ShardedDatabase::size() const noexcept -> std::size_t {
+  return shards_.size();
+}
+
+auto ShardedDatabase::shardOf(const ParamType& key) const -> std::size_t {
+  auto i = router_(key, shards_.size());
+  if (i >= shards_.size()) {
+    throw std::out_of_range("The router returned the shard '" + std::to_string(i) + "' which does not exist.");
+  }
+  return i;
+}
+
+auto ShardedDatabase::shard(std::size_t i) -> Connection& {
+  return shards_.at(i);
+}
+
+auto ShardedDatabase::route(const ParamType& key) -> Connection& {
+  return shards_[shardOf(key)];
+}
+
+void ShardedDatabase::execute(std::string_view statements) {
+  for (auto& shard : shards_) {
+    shard.execute(statements);
+  }
+}
+
+auto ShardedDatabase::scatter(std::string_view query, const ParamVector& parameters)
+  -> std::vector<std::vector<ResultVector>> {
+  std::vector<std::future<std::vector<ResultVector>>> futures;
+  futures.reserve(shards_.size());
+  for (auto& shard : shards_) {
+    futures.emplace_back(std::async(std::launch::async, ::fetchShard, shard, query, std::cref(parameters)));
+  }
+  for (auto& future : futures) {
+    future.wait();
+  }
+  std::vector<std::vector<ResultVector>> result;
+  result.reserve(futures.size());
+  for (auto& future : futures) {
+    result.emplace_back(future.get());
+  }
+  return result;
+}
+
+auto ShardedDatabase::fetchAll(std::string_view query, const ParamVector& parameters) -> std::vector<ResultVector> {
+  std::vector<ResultVector> result;
+  for (auto& rows : scatter(query, parameters)) {
+    std::move(rows.begin(), rows.end(), std::back_inserter(result));
+  }
+  return result;
+}
+
+auto ShardedDatabase::fetchAllOrdered(std::string_view query, const RowCompare& less, const ParamVector& parameters)
+  -> std::vector<ResultVector> {
+  return mergeOrdered(scatter(query, parameters), less);
+}
+
+void ShardedDatabase::attach(Connection& connection, std::string_view prefix) const {
+  auto limit = sqlite3_limit(connection.backend(), SQLITE_LIMIT_ATTACHED, -1);
+  if (std::cmp_greater(shards_.size(), limit)) {
+    throw Exception(fmt::format("Can not attach {} shards, the connection allows {}.", shards_.size(), limit));
+  }
+  auto statement = connection.prepare("ATTACH DATABASE ? AS ?;");
+  for (std::size_t i = 0; i < filenames_.size(); ++i) {
+    statement.bind(ParamVector{filenames_[i].string(), ::schemaName(prefix, i)}).execute();
+  }
+}
+
+void ShardedDatabase::detach(Connection& connection, std::string_view prefix) const {
+  auto statement = connection.prepare("DETACH DATABASE ?;");
+  for (std::size_t i = 0; i < filenames_.size(); ++i) {
+    statement.bind(1, ::schemaName(prefix, i)).execute();
+  }
+}
+
+auto ShardedDatabase::unionAll(std::string_view table, std::string_view columns, std::string_view prefix) const
+  -> std::string {
+  std::string result;
+  for (std::size_t i = 0; i < shards_.size(); ++i) {
+    if (i != 0) {
+      result += " UNION ALL ";
+    }
+    result += fmt::format(
+      "SELECT {} FROM {}.{}",
+      columns,
+      Connection::quoteIdentifier(::schemaName(prefix, i)),
+      Connection::quoteIdentifier(table));
+  }
+  return result;
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,161 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/SizeClassAllocator.hpp"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+using Y2KaoZ::Database::Sql::Sqlite3::SizeClassAllocator;
+
+// Every block is preceded by its usable size, sqlite only needs 8 byte alignment.
+constexpr std::size_t HEADER = 8;
+constexpr std::size_t CLASSES = std::countr_zero(SizeClassAllocator::MAX_CLASS) -
+                                std::countr_zero(SizeClassAllocator::MIN_CLASS) + 1;
+
+[[nodiscard]] auto classSize(std::size_t size) noexcept -> std::size_t {
+  return std::max(SizeClassAllocator::MIN_CLASS, std::bit_ceil(size));
+}
+
+[[nodiscard]] auto classIndex(std::size_t classSize) noexcept -> std::size_t {
+  return static_cast<std::size_t>(
+    std::countr_zero(classSize) - std::countr_zero(SizeClassAllocator::MIN_CLASS));
+}
+
+[[nodiscard]] auto header(void* memory) noexcept -> std::size_t* {
+  return static_cast<std::size_t*>(memory) - 1; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+struct SizeClassAllocator::State {
+  struct SizeClass {
+    std::mutex mutex;
+    // The free blocks are linked through their first bytes.
+    void* free = nullptr;
+    std::vector<void*> slabs;
+  };
+
+  explicit State(std::size_t s) : slabSize(s) {
+  }
+
+  std::size_t slabSize;
+  std::array<SizeClass, CLASSES> classes;
+  std::atomic<std::size_t> inUse = 0;
+  std::atomic<std::size_t> reserved = 0;
+};
+
+SizeClassAllocator::SizeClassAllocator(std::size_t slabSize)
+  : state_(std::make_unique<State>(std::max(slabSize, MAX_CLASS + HEADER))) {
+}
+
+SizeClassAllocator::~SizeClassAllocator() {
+  for (auto& sizeClass : state_->classes) {
+    for (auto* slab : sizeClass.slabs) {
+      std::free(slab); // NOLINT(cppcoreguidelines-no-malloc)
+    }
+  }
+}
+
+auto SizeClassAllocator::allocate(std::size_t size) noexcept -> void* {
+  auto& state = *state_;
+  if (size > MAX_CLASS) {
+    auto usable = Allocator::roundUp(size);
+    auto* base = static_cast<std::size_t*>(std::malloc(usable + HEADER)); // NOLINT(cppcoreguidelines-no-malloc)
+    if (base == nullptr) {
+      return nullptr;
+    }
+    *base = usable;
+    state.inUse += usable;
+    state.reserved += usable + HEADER;
+    return base + 1; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  }
+  auto usable = classSize(size);
+  auto& sizeClass = state.classes[classIndex(usable)];
+  void* block = nullptr;
+  {
+    std::scoped_lock lock(sizeClass.mutex);
+    if (sizeClass.free == nullptr) {
+      auto* slab = static_cast<char*>(std::malloc(state.slabSize)); // NOLINT(cppcoreguidelines-no-malloc)
+      if (slab == nullptr) {
+        return nullptr;
+      }
+      try {
+        sizeClass.slabs.push_back(slab);
+      } catch (const std::bad_alloc&) {
+        std::free(slab); // NOLINT(cppcoreguidelines-no-malloc)
+        return nullptr;
+      }
+      state.reserved += state.slabSize;
+      auto stride = usable + HEADER;
+      for (std::size_t offset = 0; offset + stride <= state.slabSize; offset += stride) {
+        void* free = slab + offset + HEADER; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        std::memcpy(free, &sizeClass.free, sizeof(void*));
+        sizeClass.free = free;
+      }
+    }
+    block = sizeClass.free;
+    std::memcpy(&sizeClass.free, block, sizeof(void*));
+  }
+  *header(block) = usable;
+  state.inUse += usable;
+  return block;
+}
+
+void SizeClassAllocator::deallocate(void* memory) noexcept {
+  if (memory == nullptr) {
+    return;
+  }
+  auto& state = *state_;
+  auto usable = *header(memory);
+  state.inUse -= usable;
+  if (usable > MAX_CLASS) {
+    state.reserved -= usable + HEADER;
+    std::free(header(memory)); // NOLINT(cppcoreguidelines-no-malloc)
+    return;
+  }
+  auto& sizeClass = state.classes[classIndex(usable)];
+  std::scoped_lock lock(sizeClass.mutex);
+  std::memcpy(memory, &sizeClass.free, sizeof(void*));
+  sizeClass.free = memory;
+}
+
+auto SizeClassAllocator::reallocate(void* memory, std::size_t size) noexcept -> void* {
+  if (memory == nullptr) {
+    return allocate(size);
+  }
+  auto usable = *header(memory);
+  if (size <= usable && (usable > MAX_CLASS ? size > MAX_CLASS : classSize(size) == usable)) {
+    return memory;
+  }
+  auto* moved = allocate(size);
+  if (moved == nullptr) {
+    return nullptr;
+  }
+  std::memcpy(moved, memory, std::min(size, usable));
+  deallocate(memory);
+  return moved;
+}
+
+auto SizeClassAllocator::size(void* memory) noexcept -> std::size_t {
+  return memory == nullptr ? 0 : *header(memory);
+}
+
+auto SizeClassAllocator::roundUp(std::size_t size) noexcept -> std::size_t {
+  return size > MAX_CLASS ? Allocator::roundUp(size) : classSize(size);
+}
+
+auto SizeClassAllocator::bytesInUse() const noexcept -> std::size_t {
+  return state_->inUse.load(std::memory_order_relaxed);
+}
+
+auto SizeClassAllocator::bytesReserved() const noexcept -> std::size_t {
+  return state_->reserved.load(std::memory_order_relaxed);
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
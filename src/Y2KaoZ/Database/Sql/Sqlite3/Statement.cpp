@@ -1,23 +1,26 @@
 #include "Y2KaoZ/Database/Sql/Sqlite3/Statement.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/ArrowExport.hpp"
 #include "Y2KaoZ/Database/Sql/Sqlite3/Exception.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Recorder.hpp"
 #include "Y2KaoZ/Database/Types.hpp"
 #include <cstring>
 #include <gsl/gsl_util>
+#include <stdexcept>
 
 namespace {
 
 using Y2KaoZ::Database::Sql::Sqlite3::Exception;
 using NullType = Y2KaoZ::Database::NullType;
 using BlobType = Y2KaoZ::Database::BlobType;
+using BlobView = Y2KaoZ::Database::BlobView;
 using ResultType = Y2KaoZ::Database::ResultType;
-using ResultTypeValue = ResultType::Value;
 
 [[nodiscard]] auto prepareSqlite3(gsl::not_null<sqlite3*> db, const std::string_view& statement)
   -> gsl::not_null<sqlite3_stmt*> {
 
   sqlite3_stmt* stmt = nullptr;
-  if (sqlite3_prepare_v2(db, statement.data(), -1, &stmt, nullptr) != SQLITE_OK) {
-    gsl::finally([&]() { sqlite3_finalize(stmt); });
+  if (sqlite3_prepare_v2(db, statement.data(), gsl::narrow<int>(statement.size()), &stmt, nullptr) != SQLITE_OK) {
+    auto finalize = gsl::finally([&]() { sqlite3_finalize(stmt); });
     throw Exception("Error in '" + std::string(statement) + "': " + sqlite3_errmsg(db));
   }
   return stmt;
@@ -67,6 +70,18 @@ struct StmtValueBinder {
     const int size = gsl::narrow<int>(v.size());
     resultCode(sqlite3_bind_blob(stmt, i, v.data(), size, SQLITE_STATIC));
   }
+  void operator()(std::string_view v) const {
+    // A null pointer would bind NULL instead of an empty string.
+    const auto* data = v.data() != nullptr ? v.data() : "";
+    resultCode(sqlite3_bind_text(stmt, i, data, gsl::narrow<int>(v.size()), SQLITE_STATIC));
+  }
+  void operator()(BlobView v) const {
+    if (v.data() == nullptr) {
+      resultCode(sqlite3_bind_zeroblob(stmt, i, 0));
+    } else {
+      resultCode(sqlite3_bind_blob(stmt, i, v.data(), gsl::narrow<int>(v.size()), SQLITE_STATIC));
+    }
+  }
 
 private:
   void resultCode(int rc) const {
@@ -78,38 +93,39 @@ private:
   int i;
 };
 
-[[nodiscard]] auto getColumn(gsl::not_null<sqlite3_stmt*> stmt, int i) -> ResultTypeValue {
+// Builds the cell straight from the memory owned by sqlite, short values are stored inline and the longer ones are
+// copied once into memory from the resource.
+[[nodiscard]] auto getColumn(
+  gsl::not_null<sqlite3_stmt*> stmt,
+  int i,
+  std::pmr::memory_resource* resource = std::pmr::get_default_resource()) -> ResultType {
 
   auto type = sqlite3_column_type(stmt, i);
   switch (type) {
     case SQLITE_INTEGER: {
-      return sqlite3_column_int64(stmt, i);
+      return ResultType(sqlite3_column_int64(stmt, i), resource);
     } break;
     case SQLITE_FLOAT: {
-      return sqlite3_column_double(stmt, i);
+      return ResultType(sqlite3_column_double(stmt, i), resource);
     } break;
     case SQLITE_TEXT: {
-      const auto* const text = sqlite3_column_text(stmt, i);
+      const auto* const text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, i)); // NOLINT
       if (text == nullptr) {
-        return std::string{};
+        return ResultType::fromText({}, resource);
       }
       auto size = gsl::narrow<std::size_t>(sqlite3_column_bytes(stmt, i));
-      std::string result(size, 0);
-      std::memcpy(result.data(), text, result.size());
-      return result;
+      return ResultType::fromText({text, size}, resource);
     } break;
     case SQLITE_BLOB: {
-      const auto* const blob = sqlite3_column_blob(stmt, i);
+      const auto* const blob = static_cast<const std::byte*>(sqlite3_column_blob(stmt, i));
       if (blob == nullptr) {
-        return BlobType{};
+        return ResultType::fromBlob({}, resource);
       }
       auto size = gsl::narrow<std::size_t>(sqlite3_column_bytes(stmt, i));
-      BlobType result(size);
-      std::memcpy(result.data(), blob, result.size());
-      return result;
+      return ResultType::fromBlob({blob, size}, resource);
     } break;
     case SQLITE_NULL: {
-      return NullType{};
+      return ResultType(resource);
     } break;
     default: {
       // this should never happen
@@ -134,6 +150,26 @@ auto Statement::connection() const -> const Connection& {
   return connection_;
 }
 
+auto Statement::backend() const -> gsl::not_null<sqlite3_stmt*> {
+  return stmt_.get();
+}
+
+auto Statement::sql() const -> std::string_view {
+  return sqlite3_sql(stmt_.get());
+}
+
+auto Statement::queryPlan() const -> QueryPlan {
+  auto connection = connection_;
+  auto explain = connection.prepare("EXPLAIN QUERY PLAN " + std::string(sql()));
+  explain.bind(parameters_).execute();
+  std::vector<QueryPlan::Row> rows;
+  while (auto row = explain.fetchVector()) {
+    rows.push_back({gsl::narrow<int>(row->at(0).getInteger()), gsl::narrow<int>(row->at(1).getInteger()), {}});
+    rows.back().detail = row->at(3).stringView();
+  }
+  return QueryPlan(rows);
+}
+
 auto Statement::parameters() const noexcept -> const ParamVector& {
   return parameters_;
 }
@@ -151,6 +187,24 @@ auto Statement::bind(std::size_t index, const ParamType& value) -> Statement& {
   return *this;
 }
 
+auto Statement::bindView(std::size_t index, std::string_view value) -> Statement& {
+  if (index < 1 || index > parameters_.size()) {
+    throw std::out_of_range("The index '" + std::to_string(index) + "' is not in the statement.");
+  }
+  parameters_[index - 1] = NullValue;
+  StmtValueBinder(stmt_.get(), gsl::narrow<int>(index))(value);
+  return *this;
+}
+
+auto Statement::bindView(std::size_t index, BlobView value) -> Statement& {
+  if (index < 1 || index > parameters_.size()) {
+    throw std::out_of_range("The index '" + std::to_string(index) + "' is not in the statement.");
+  }
+  parameters_[index - 1] = NullValue;
+  StmtValueBinder(stmt_.get(), gsl::narrow<int>(index))(value);
+  return *this;
+}
+
 auto Statement::bind(std::string_view name, const ParamType& value) -> Statement& {
   auto index = gsl::narrow<std::size_t>(sqlite3_bind_parameter_index(stmt_.get(), name.data()));
   if (index < 1 || index > parameters_.size()) {
@@ -191,7 +245,23 @@ auto Statement::bind(const ParamMap& parameters) -> Statement& {
 }
 
 auto Statement::execute() -> Statement& {
-  int rc = sqlite3_step(stmt_.get());
+  auto* db = sqlite3_db_handle(stmt_.get());
+  // Only the first step of an execution is recorded, the next ones fetch its rows.
+  if (auto* recorder = connection_.recorder(); recorder != nullptr && !rows_) {
+    recorder->record(RecordedKind::Statement, sql(), parameters_);
+  }
+  const auto* reason = interruption();
+  int rc = SQLITE_INTERRUPT;
+  auto stepped = reason == nullptr;
+  if (reason == nullptr && (deadline_ || token_)) {
+    // The handler belongs to the connection, the hook of this statement is only registered while it steps.
+    auto hook = connection_.addProgressHook([this]() { return interruption() != nullptr; }, progressSteps_);
+    rc = sqlite3_step(stmt_.get());
+    connection_.removeHook(hook);
+    reason = rc == SQLITE_INTERRUPT ? interruption() : nullptr;
+  } else if (reason == nullptr) {
+    rc = sqlite3_step(stmt_.get());
+  }
   switch (rc) {
     case SQLITE_DONE:
     case SQLITE_OK: {
@@ -200,13 +270,18 @@ auto Statement::execute() -> Statement& {
     case SQLITE_ROW:
       rows_ = true;
       break;
-    default:
-      gsl::finally([&]() {
-        sqlite3_reset(stmt_.get());
-        rows_ = false;
-      });
-      throw Exception(sqlite3_errmsg(sqlite3_db_handle(stmt_.get())));
-      break;
+    default: {
+      std::string message = reason != nullptr ? reason : sqlite3_errmsg(db);
+      if (stepped) {
+        connection_.statementFailed();
+      }
+      sqlite3_reset(stmt_.get());
+      rows_ = false;
+      if (rc == SQLITE_INTERRUPT) {
+        throw InterruptedException(message);
+      }
+      throw Exception(message);
+    } break;
   }
   return *this;
 }
@@ -227,6 +302,62 @@ auto Statement::clearParameters() -> Statement& {
   return *this;
 }
 
+auto Statement::setDeadline(std::optional<Clock::time_point> deadline) -> Statement& {
+  deadline_ = deadline;
+  return *this;
+}
+
+auto Statement::setCancellationToken(std::optional<CancellationToken> token) -> Statement& {
+  token_ = std::move(token);
+  return *this;
+}
+
+auto Statement::setProgressSteps(int steps) -> Statement& {
+  if (steps < 1) {
+    throw std::invalid_argument("The number of progress steps must be positive.");
+  }
+  progressSteps_ = steps;
+  return *this;
+}
+
+auto Statement::interruption() const noexcept -> const char* {
+  if (token_ && token_->cancelled()) {
+    return "The statement was cancelled.";
+  }
+  if (deadline_ && Clock::now() >= *deadline_) {
+    return "The statement deadline has passed.";
+  }
+  return nullptr;
+}
+
+auto Statement::intern(std::size_t i, std::shared_ptr<StringPool> pool, Interning as) -> Statement& {
+  if (i >= columnCount()) {
+    throw std::out_of_range("The column index is out of bounds.");
+  }
+  if (interned_.size() <= i) {
+    interned_.resize(i + 1);
+  }
+  interned_[i] = Interned{std::move(pool), as};
+  return *this;
+}
+
+auto Statement::column(int i, std::pmr::memory_resource* resource) const -> ResultType {
+  auto index = static_cast<std::size_t>(i);
+  if (index < interned_.size() && interned_[index].pool && sqlite3_column_type(stmt_.get(), i) == SQLITE_TEXT) {
+    const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt_.get(), i)); // NOLINT
+    if (text != nullptr) {
+      const auto& [pool, as] = interned_[index];
+      auto size = gsl::narrow<std::size_t>(sqlite3_column_bytes(stmt_.get(), i));
+      auto id = pool->intern({text, size});
+      if (as == Interning::Id) {
+        return ResultType(static_cast<std::int64_t>(id), resource);
+      }
+      return ResultType::fromView(pool->view(id), resource);
+    }
+  }
+  return ::getColumn(stmt_.get(), i, resource);
+}
+
 auto Statement::columnCount() const -> std::size_t {
   return static_cast<std::size_t>(sqlite3_column_count(stmt_.get()));
 }
@@ -235,6 +366,25 @@ auto Statement::columnName(std::size_t i) const -> std::string {
   return sqlite3_column_name(stmt_.get(), gsl::narrow<int>(i));
 }
 
+auto Statement::columnBlob(std::size_t i) const -> std::optional<BlobView> {
+  auto index = gsl::narrow<int>(i);
+  if (!rows_ || sqlite3_column_type(stmt_.get(), index) == SQLITE_NULL) {
+    return {};
+  }
+  // The blob must be read before its size, an empty blob has no data.
+  const auto* data = static_cast<const std::byte*>(sqlite3_column_blob(stmt_.get(), index));
+  return BlobView{data, gsl::narrow<std::size_t>(sqlite3_column_bytes(stmt_.get(), index))};
+}
+
+auto Statement::columnText(std::size_t i) const -> std::optional<std::string_view> {
+  auto index = gsl::narrow<int>(i);
+  if (!rows_ || sqlite3_column_type(stmt_.get(), index) == SQLITE_NULL) {
+    return {};
+  }
+  const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt_.get(), index)); // NOLINT
+  return std::string_view{text, gsl::narrow<std::size_t>(sqlite3_column_bytes(stmt_.get(), index))};
+}
+
 auto Statement::fetchVector() -> std::optional<ResultVector> {
   if (!rows_) {
     return {};
@@ -243,12 +393,39 @@ auto Statement::fetchVector() -> std::optional<ResultVector> {
   ResultVector result;
   result.reserve(static_cast<std::size_t>(count));
   for (int i = 0; i < count; ++i) {
-    result.emplace_back(::getColumn(stmt_.get(), i));
+    result.emplace_back(column(i));
   }
   execute();
   return result;
 }
 
+auto Statement::fetchVector(std::pmr::memory_resource* resource) -> std::optional<pmr::ResultVector> {
+  if (!rows_) {
+    return {};
+  }
+  int count = gsl::narrow<int>(columnCount());
+  pmr::ResultVector result(resource);
+  result.reserve(static_cast<std::size_t>(count));
+  for (int i = 0; i < count; ++i) {
+    result.emplace_back(column(i, resource));
+  }
+  execute();
+  return result;
+}
+
+auto Statement::fetchInto(ResultVector& row) -> bool {
+  if (!rows_) {
+    return false;
+  }
+  int count = gsl::narrow<int>(columnCount());
+  row.resize(static_cast<std::size_t>(count));
+  for (int i = 0; i < count; ++i) {
+    row[static_cast<std::size_t>(i)] = column(i);
+  }
+  execute();
+  return true;
+}
+
 auto Statement::fetchMap() -> std::optional<ResultMap> {
   if (!rows_) {
     return {};
@@ -256,7 +433,20 @@ auto Statement::fetchMap() -> std::optional<ResultMap> {
   int count = gsl::narrow<int>(columnCount());
   ResultMap result;
   for (int i = 0; i < count; ++i) {
-    result[columnName(static_cast<std::size_t>(i))] = ResultType(::getColumn(stmt_.get(), i));
+    result.insert_or_assign(sqlite3_column_name(stmt_.get(), i), column(i));
+  }
+  execute();
+  return result;
+}
+
+auto Statement::fetchMap(std::pmr::memory_resource* resource) -> std::optional<pmr::ResultMap> {
+  if (!rows_) {
+    return {};
+  }
+  int count = gsl::narrow<int>(columnCount());
+  pmr::ResultMap result(resource);
+  for (int i = 0; i < count; ++i) {
+    result.insert_or_assign(sqlite3_column_name(stmt_.get(), i), column(i, resource));
   }
   execute();
   return result;
@@ -269,7 +459,7 @@ auto Statement::fetchColumn(std::size_t i) -> std::optional<ResultType> {
   if (i >= columnCount()) {
     throw std::out_of_range("The column index is out of bounds.");
   }
-  ResultType result(::getColumn(stmt_.get(), gsl::narrow<int>(i)));
+  auto result = column(gsl::narrow<int>(i));
   execute();
   return result;
 }
@@ -277,7 +467,22 @@ auto Statement::fetchColumn(std::size_t i) -> std::optional<ResultType> {
 auto Statement::fetchAllVector() -> std::vector<ResultVector> {
   std::vector<ResultVector> result;
   while (auto row = fetchVector()) {
-    result.emplace_back(*row);
+    result.emplace_back(std::move(*row));
+  }
+  return result;
+}
+
+auto Statement::fetchAllVector(std::pmr::memory_resource* resource) -> std::pmr::vector<pmr::ResultVector> {
+  std::pmr::vector<pmr::ResultVector> result(resource);
+  auto count = columnCount();
+  while (rows_) {
+    // The rows are constructed in place so they share the allocator of the outer vector.
+    auto& row = result.emplace_back();
+    row.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      row.emplace_back(column(static_cast<int>(i), resource));
+    }
+    execute();
   }
   return result;
 }
@@ -285,9 +490,34 @@ auto Statement::fetchAllVector() -> std::vector<ResultVector> {
 auto Statement::fetchAllMap() -> std::vector<ResultMap> {
   std::vector<ResultMap> result;
   while (auto row = fetchMap()) {
-    result.emplace_back(*row);
+    result.emplace_back(std::move(*row));
+  }
+  return result;
+}
+
+auto Statement::fetchAllMap(std::pmr::memory_resource* resource) -> std::pmr::vector<pmr::ResultMap> {
+  std::pmr::vector<pmr::ResultMap> result(resource);
+  auto count = gsl::narrow<int>(columnCount());
+  while (rows_) {
+    auto& row = result.emplace_back();
+    for (int i = 0; i < count; ++i) {
+      row.insert_or_assign(sqlite3_column_name(stmt_.get(), i), column(i, resource));
+    }
+    execute();
   }
   return result;
 }
 
-} // namespace Y2KaoZ::Database::Sql::Sqlite3
\ No newline at end of file
+void Statement::exportArrow(ArrowSchema* schema, ArrowArrayStream* stream, std::size_t batchSize) {
+  Sqlite3::exportArrow(*this, schema, stream, batchSize);
+}
+
+auto Statement::writeJson(const JsonSink& sink, const JsonOptions& options) -> std::uint64_t {
+  return Sqlite3::writeJson(*this, sink, options);
+}
+
+auto Statement::writeJson(fmt::memory_buffer& buffer, const JsonOptions& options) -> std::uint64_t {
+  return Sqlite3::writeJson(*this, buffer, options);
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
@@ -0,0 +1,560 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/StatsVfs.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Exception.hpp"
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#if __has_include(<fcntl.h>)
+#include <fcntl.h>
+#endif
+#ifdef POSIX_FADV_WILLNEED
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using Y2KaoZ::Database::Sql::Sqlite3::FileIoStats;
+using Y2KaoZ::Database::Sql::Sqlite3::FileKind;
+using Y2KaoZ::Database::Sql::Sqlite3::IoCounter;
+using Y2KaoZ::Database::Sql::Sqlite3::IoStats;
+
+// Connections read their counters from other threads while sqlite updates them.
+struct AtomicCounter {
+  std::atomic<std::uint64_t> calls{0};
+  std::atomic<std::uint64_t> bytes{0};
+  std::atomic<std::uint64_t> nanoseconds{0};
+  std::atomic<std::uint64_t> maxNanoseconds{0};
+
+  void add(std::uint64_t size, std::uint64_t elapsed) noexcept {
+    calls.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+    nanoseconds.fetch_add(elapsed, std::memory_order_relaxed);
+    auto max = maxNanoseconds.load(std::memory_order_relaxed);
+    while (elapsed > max && !maxNanoseconds.compare_exchange_weak(max, elapsed, std::memory_order_relaxed)) {
+    }
+  }
+
+  [[nodiscard]] auto read(bool reset) noexcept -> IoCounter {
+    auto take = [reset](std::atomic<std::uint64_t>& value) {
+      return reset ? value.exchange(0, std::memory_order_relaxed) : value.load(std::memory_order_relaxed);
+    };
+    IoCounter counter;
+    counter.calls = take(calls);
+    counter.bytes = take(bytes);
+    counter.time = std::chrono::nanoseconds(take(nanoseconds));
+    counter.maxTime = std::chrono::nanoseconds(take(maxNanoseconds));
+    return counter;
+  }
+};
+
+struct AtomicFileStats {
+  AtomicCounter reads;
+  AtomicCounter writes;
+  AtomicCounter syncs;
+  AtomicCounter locks;
+  std::atomic<std::uint64_t> readAheads{0};
+  std::atomic<std::uint64_t> readAheadBytes{0};
+};
+
+// The I/O of a connection, or of the whole VFS.
+struct Group {
+  std::array<AtomicFileStats, IoStats::FILE_KINDS> files;
+
+  [[nodiscard]] auto read(bool reset) -> IoStats {
+    IoStats stats;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+      auto& file = files.at(i);
+      auto& out = stats.files.at(i);
+      out.reads = file.reads.read(reset);
+      out.writes = file.writes.read(reset);
+      out.syncs = file.syncs.read(reset);
+      out.locks = file.locks.read(reset);
+      out.readAheads = reset ? file.readAheads.exchange(0) : file.readAheads.load();
+      out.readAheadBytes = reset ? file.readAheadBytes.exchange(0) : file.readAheadBytes.load();
+    }
+    return stats;
+  }
+};
+
+struct VfsData {
+  sqlite3_vfs* base;
+  std::size_t readAhead;
+  Group total;
+  std::mutex mutex;
+  // The groups of the open database files, by the name sqlite gave them (see sqlite3_filename_database).
+  std::unordered_map<const char*, std::shared_ptr<Group>> groups;
+};
+
+// A file by device and inode number.
+using InodeKey = std::pair<std::uint64_t, std::uint64_t>;
+
+// The real file of the base VFS is allocated right after this one.
+struct File {
+  sqlite3_file base;
+  VfsData* vfs;
+  FileKind kind;
+  const char* name;
+  std::shared_ptr<Group> group;
+  int descriptor;
+  int sequential;
+  sqlite3_int64 nextOffset;
+  sqlite3_int64 readAheadEnd;
+
+  [[nodiscard]] auto real() noexcept -> sqlite3_file* {
+    return reinterpret_cast<sqlite3_file*>(this + 1); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+};
+
+[[nodiscard]] auto toFile(sqlite3_file* file) -> File& {
+  return *reinterpret_cast<File*>(file); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+[[nodiscard]] auto toVfs(sqlite3_vfs* vfs) -> VfsData& {
+  return *static_cast<VfsData*>(vfs->pAppData);
+}
+
+[[nodiscard]] auto base(sqlite3_vfs* vfs) -> sqlite3_vfs* {
+  return toVfs(vfs).base;
+}
+
+[[nodiscard]] auto kindOf(int flags) -> FileKind {
+  if ((flags & SQLITE_OPEN_MAIN_DB) != 0) {
+    return FileKind::Main;
+  }
+  if ((flags & (SQLITE_OPEN_MAIN_JOURNAL | SQLITE_OPEN_SUPER_JOURNAL)) != 0) {
+    return FileKind::Journal;
+  }
+  if ((flags & SQLITE_OPEN_WAL) != 0) {
+    return FileKind::Wal;
+  }
+  return FileKind::Temp;
+}
+
+// Runs an I/O call of the real file and accounts for it in the VFS and in the connection owning the file.
+template <typename Call>
+auto timed(File& file, AtomicCounter AtomicFileStats::*counter, std::uint64_t bytes, Call call) -> int {
+  auto start = std::chrono::steady_clock::now();
+  auto rc = call(file.real());
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  auto nanoseconds = static_cast<std::uint64_t>(elapsed.count());
+  auto kind = static_cast<std::size_t>(file.kind);
+  (file.vfs->total.files.at(kind).*counter).add(bytes, nanoseconds);
+  if (file.group) {
+    (file.group->files.at(kind).*counter).add(bytes, nanoseconds);
+  }
+  return rc;
+}
+
+#ifdef POSIX_FADV_WILLNEED
+// Read-ahead needs a descriptor of the database file, which the base VFS does not expose. Closing any descriptor of a
+// file releases every POSIX lock the process holds on it, including the locks of connections using other VFSes that
+// this one cannot see, so one descriptor per inode is shared by the whole process and never closed. It also keeps the
+// inode from being reused by another file.
+struct SharedDescriptors {
+  std::mutex mutex;
+  std::map<InodeKey, int> inodes;
+};
+
+[[nodiscard]] auto acquireDescriptor(const char* name) -> int {
+  struct stat status {};
+  if (::stat(name, &status) != 0) {
+    return -1;
+  }
+  static SharedDescriptors shared;
+  std::scoped_lock lock(shared.mutex);
+  auto [found, inserted] = shared.inodes.try_emplace(InodeKey{status.st_dev, status.st_ino}, -1);
+  if (inserted) {
+    found->second = ::open(name, O_RDONLY | O_CLOEXEC); // NOLINT(cppcoreguidelines-pro-type-vararg)
+    if (found->second < 0) {
+      shared.inodes.erase(found);
+      return -1;
+    }
+  }
+  return found->second;
+}
+#endif
+
+void readAhead(File& file, sqlite3_int64 offset, int amount) {
+  auto end = offset + amount;
+  file.sequential = offset == file.nextOffset ? file.sequential + 1 : 0;
+  file.nextOffset = end;
+  if (file.descriptor < 0 || file.sequential < Y2KaoZ::Database::Sql::Sqlite3::StatsVfs::SEQUENTIAL_READS) {
+    return;
+  }
+  // Announce the next window once half of the previous one has been read.
+  auto window = static_cast<sqlite3_int64>(file.vfs->readAhead);
+  if (end + window / 2 < file.readAheadEnd) {
+    return;
+  }
+  auto start = std::max(end, file.readAheadEnd);
+  auto length = end + window - start;
+#ifdef POSIX_FADV_WILLNEED
+  if (::posix_fadvise(file.descriptor, start, length, POSIX_FADV_WILLNEED) != 0) {
+    return;
+  }
+#endif
+  file.readAheadEnd = start + length;
+  auto kind = static_cast<std::size_t>(file.kind);
+  for (auto* group : {&file.vfs->total, file.group.get()}) {
+    if (group != nullptr) {
+      group->files.at(kind).readAheads.fetch_add(1, std::memory_order_relaxed);
+      group->files.at(kind).readAheadBytes.fetch_add(static_cast<std::uint64_t>(length), std::memory_order_relaxed);
+    }
+  }
+}
+
+auto fileClose(sqlite3_file* handle) -> int {
+  auto& file = toFile(handle);
+  auto rc = file.real()->pMethods->xClose(file.real());
+  if (file.kind == FileKind::Main && file.name != nullptr) {
+    std::scoped_lock lock(file.vfs->mutex);
+    file.vfs->groups.erase(file.name);
+  }
+  file.~File();
+  return rc;
+}
+
+auto fileRead(sqlite3_file* handle, void* buffer, int amount, sqlite3_int64 offset) -> int {
+  auto& file = toFile(handle);
+  auto rc = ::timed(file, &AtomicFileStats::reads, static_cast<std::uint64_t>(amount), [&](sqlite3_file* real) {
+    return real->pMethods->xRead(real, buffer, amount, offset);
+  });
+  if (file.kind == FileKind::Main && file.vfs->readAhead > 0) {
+    ::readAhead(file, offset, amount);
+  }
+  return rc;
+}
+
+auto fileWrite(sqlite3_file* handle, const void* buffer, int amount, sqlite3_int64 offset) -> int {
+  return ::timed(
+    toFile(handle),
+    &AtomicFileStats::writes,
+    static_cast<std::uint64_t>(amount),
+    [&](sqlite3_file* real) { return real->pMethods->xWrite(real, buffer, amount, offset); });
+}
+
+auto fileTruncate(sqlite3_file* handle, sqlite3_int64 size) -> int {
+  auto* real = toFile(handle).real();
+  return real->pMethods->xTruncate(real, size);
+}
+
+auto fileSync(sqlite3_file* handle, int flags) -> int {
+  return ::timed(toFile(handle), &AtomicFileStats::syncs, 0, [&](sqlite3_file* real) {
+    return real->pMethods->xSync(real, flags);
+  });
+}
+
+auto fileSize(sqlite3_file* handle, sqlite3_int64* size) -> int {
+  auto* real = toFile(handle).real();
+  return real->pMethods->xFileSize(real, size);
+}
+
+auto fileLock(sqlite3_file* handle, int level) -> int {
+  return ::timed(toFile(handle), &AtomicFileStats::locks, 0, [&](sqlite3_file* real) {
+    return real->pMethods->xLock(real, level);
+  });
+}
+
+auto fileUnlock(sqlite3_file* handle, int level) -> int {
+  auto* real = toFile(handle).real();
+  return real->pMethods->xUnlock(real, level);
+}
+
+auto fileCheckReservedLock(sqlite3_file* handle, int* reserved) -> int {
+  auto* real = toFile(handle).real();
+  return real->pMethods->xCheckReservedLock(real, reserved);
+}
+
+auto fileControl(sqlite3_file* handle, int operation, void* argument) -> int {
+  auto* real = toFile(handle).real();
+  return real->pMethods->xFileControl(real, operation, argument);
+}
+
+auto fileSectorSize(sqlite3_file* handle) -> int {
+  auto* real = toFile(handle).real();
+  return real->pMethods->xSectorSize(real);
+}
+
+auto fileDeviceCharacteristics(sqlite3_file* handle) -> int {
+  auto* real = toFile(handle).real();
+  return real->pMethods->xDeviceCharacteristics(real);
+}
+
+auto fileShmMap(sqlite3_file* handle, int page, int pageSize, int extend, void volatile** memory) -> int {
+  auto* real = toFile(handle).real();
+  return real->pMethods->xShmMap(real, page, pageSize, extend, memory);
+}
+
+auto fileShmLock(sqlite3_file* handle, int offset, int n, int flags) -> int {
+  auto* real = toFile(handle).real();
+  return real->pMethods->xShmLock(real, offset, n, flags);
+}
+
+void fileShmBarrier(sqlite3_file* handle) {
+  auto* real = toFile(handle).real();
+  real->pMethods->xShmBarrier(real);
+}
+
+auto fileShmUnmap(sqlite3_file* handle, int deleteFlag) -> int {
+  auto* real = toFile(handle).real();
+  return real->pMethods->xShmUnmap(real, deleteFlag);
+}
+
+auto fileFetch(sqlite3_file* handle, sqlite3_int64 offset, int amount, void** memory) -> int {
+  auto* real = toFile(handle).real();
+  return real->pMethods->xFetch(real, offset, amount, memory);
+}
+
+auto fileUnfetch(sqlite3_file* handle, sqlite3_int64 offset, void* memory) -> int {
+  auto* real = toFile(handle).real();
+  return real->pMethods->xUnfetch(real, offset, memory);
+}
+
+// sqlite only calls the members the version of the methods announces, so the version of the real file is kept.
+[[nodiscard]] auto ioMethods(int version) -> const sqlite3_io_methods* {
+  static const auto METHODS = []() {
+    std::array<sqlite3_io_methods, 3> methods{};
+    for (std::size_t i = 0; i < methods.size(); ++i) {
+      auto& m = methods.at(i);
+      m.iVersion = static_cast<int>(i) + 1;
+      m.xClose = ::fileClose;
+      m.xRead = ::fileRead;
+      m.xWrite = ::fileWrite;
+      m.xTruncate = ::fileTruncate;
+      m.xSync = ::fileSync;
+      m.xFileSize = ::fileSize;
+      m.xLock = ::fileLock;
+      m.xUnlock = ::fileUnlock;
+      m.xCheckReservedLock = ::fileCheckReservedLock;
+      m.xFileControl = ::fileControl;
+      m.xSectorSize = ::fileSectorSize;
+      m.xDeviceCharacteristics = ::fileDeviceCharacteristics;
+      if (m.iVersion >= 2) {
+        m.xShmMap = ::fileShmMap;
+        m.xShmLock = ::fileShmLock;
+        m.xShmBarrier = ::fileShmBarrier;
+        m.xShmUnmap = ::fileShmUnmap;
+      }
+      if (m.iVersion >= 3) {
+        m.xFetch = ::fileFetch;
+        m.xUnfetch = ::fileUnfetch;
+      }
+    }
+    return methods;
+  }();
+  return &METHODS.at(static_cast<std::size_t>(std::clamp(version, 1, 3) - 1));
+}
+
+[[nodiscard]] auto isStatsFile(sqlite3_file* file) -> bool {
+  return file != nullptr && file->pMethods != nullptr &&
+         std::any_of(
+           ::ioMethods(1), ::ioMethods(3) + 1, [&](const sqlite3_io_methods& m) { return file->pMethods == &m; });
+}
+
+auto vfsOpen(sqlite3_vfs* vfs, const char* name, sqlite3_file* handle, int flags, int* outFlags) -> int {
+  auto& data = toVfs(vfs);
+  auto kind = ::kindOf(flags);
+  std::shared_ptr<Group> group;
+  try {
+    if (name != nullptr) {
+      std::scoped_lock lock(data.mutex);
+      if (kind == FileKind::Main) {
+        group = data.groups.emplace(name, std::make_shared<Group>()).first->second;
+      } else {
+        auto found = data.groups.find(sqlite3_filename_database(name));
+        if (found != data.groups.end()) {
+          group = found->second;
+        }
+      }
+    }
+  } catch (const std::bad_alloc&) {
+    return SQLITE_NOMEM;
+  }
+  auto* file = new (handle) File{{nullptr}, &data, kind, name, std::move(group), -1, 0, -1, 0};
+  auto rc = data.base->xOpen(data.base, name, file->real(), flags, outFlags);
+  if (rc != SQLITE_OK || file->real()->pMethods == nullptr) {
+    if (kind == FileKind::Main && name != nullptr) {
+      std::scoped_lock lock(data.mutex);
+      data.groups.erase(name);
+    }
+    file->~File();
+    handle->pMethods = nullptr;
+    return rc;
+  }
+#ifdef POSIX_FADV_WILLNEED
+  if (kind == FileKind::Main && name != nullptr && data.readAhead > 0) {
+    try {
+      file->descriptor = ::acquireDescriptor(name);
+    } catch (const std::bad_alloc&) {
+      file->descriptor = -1;
+    }
+  }
+#endif
+  handle->pMethods = ::ioMethods(file->real()->pMethods->iVersion);
+  return rc;
+}
+
+auto vfsRemove(sqlite3_vfs* vfs, const char* name, int syncDirectory) -> int {
+  return base(vfs)->xDelete(base(vfs), name, syncDirectory);
+}
+
+auto vfsAccess(sqlite3_vfs* vfs, const char* name, int flags, int* result) -> int {
+  return base(vfs)->xAccess(base(vfs), name, flags, result);
+}
+
+auto vfsFullPathname(sqlite3_vfs* vfs, const char* name, int size, char* out) -> int {
+  return base(vfs)->xFullPathname(base(vfs), name, size, out);
+}
+
+auto vfsDlOpen(sqlite3_vfs* vfs, const char* name) -> void* {
+  return base(vfs)->xDlOpen(base(vfs), name);
+}
+
+void vfsDlError(sqlite3_vfs* vfs, int size, char* message) {
+  base(vfs)->xDlError(base(vfs), size, message);
+}
+
+auto vfsDlSym(sqlite3_vfs* vfs, void* library, const char* symbol) -> void (*)() {
+  return base(vfs)->xDlSym(base(vfs), library, symbol);
+}
+
+void vfsDlClose(sqlite3_vfs* vfs, void* library) {
+  base(vfs)->xDlClose(base(vfs), library);
+}
+
+auto vfsRandomness(sqlite3_vfs* vfs, int size, char* out) -> int {
+  return base(vfs)->xRandomness(base(vfs), size, out);
+}
+
+auto vfsSleep(sqlite3_vfs* vfs, int microseconds) -> int {
+  return base(vfs)->xSleep(base(vfs), microseconds);
+}
+
+auto vfsCurrentTime(sqlite3_vfs* vfs, double* now) -> int {
+  return base(vfs)->xCurrentTime(base(vfs), now);
+}
+
+auto vfsGetLastError(sqlite3_vfs* vfs, int size, char* message) -> int {
+  return base(vfs)->xGetLastError(base(vfs), size, message);
+}
+
+auto vfsCurrentTimeInt64(sqlite3_vfs* vfs, sqlite3_int64* now) -> int {
+  return base(vfs)->xCurrentTimeInt64(base(vfs), now);
+}
+
+auto vfsSetSystemCall(sqlite3_vfs* vfs, const char* name, sqlite3_syscall_ptr call) -> int {
+  return base(vfs)->xSetSystemCall(base(vfs), name, call);
+}
+
+auto vfsGetSystemCall(sqlite3_vfs* vfs, const char* name) -> sqlite3_syscall_ptr {
+  return base(vfs)->xGetSystemCall(base(vfs), name);
+}
+
+auto vfsNextSystemCall(sqlite3_vfs* vfs, const char* name) -> const char* {
+  return base(vfs)->xNextSystemCall(base(vfs), name);
+}
+
+} // namespace
+
+namespace Y2KaoZ::Database::Sql::Sqlite3 {
+
+auto FileIoStats::operator+=(const FileIoStats& other) -> FileIoStats& {
+  auto add = [](IoCounter& a, const IoCounter& b) {
+    a.calls += b.calls;
+    a.bytes += b.bytes;
+    a.time += b.time;
+    a.maxTime = std::max(a.maxTime, b.maxTime);
+  };
+  add(reads, other.reads);
+  add(writes, other.writes);
+  add(syncs, other.syncs);
+  add(locks, other.locks);
+  readAheads += other.readAheads;
+  readAheadBytes += other.readAheadBytes;
+  return *this;
+}
+
+auto IoStats::operator[](FileKind kind) const -> const FileIoStats& {
+  return files.at(static_cast<std::size_t>(kind));
+}
+
+auto IoStats::total() const -> FileIoStats {
+  FileIoStats result;
+  for (const auto& file : files) {
+    result += file;
+  }
+  return result;
+}
+
+struct StatsVfs::State {
+  std::string name;
+  VfsData data;
+  sqlite3_vfs vfs{};
+};
+
+StatsVfs::StatsVfs(std::string name, std::size_t readAhead, const std::string& base)
+  : state_(std::make_unique<State>()) {
+  auto* real = sqlite3_vfs_find(base.empty() ? nullptr : base.c_str());
+  if (real == nullptr) {
+    throw Exception("The base VFS does not exist.");
+  }
+  state_->name = std::move(name);
+  state_->data.base = real;
+  state_->data.readAhead = readAhead;
+  auto& vfs = state_->vfs;
+  // The versions of the VFS and of its files follow those of the base VFS.
+  vfs.iVersion = std::min(real->iVersion, 3);
+  vfs.szOsFile = static_cast<int>(sizeof(File)) + real->szOsFile;
+  vfs.mxPathname = real->mxPathname;
+  vfs.zName = state_->name.c_str();
+  vfs.pAppData = &state_->data;
+  vfs.xOpen = ::vfsOpen;
+  vfs.xDelete = ::vfsRemove;
+  vfs.xAccess = ::vfsAccess;
+  vfs.xFullPathname = ::vfsFullPathname;
+  vfs.xDlOpen = ::vfsDlOpen;
+  vfs.xDlError = ::vfsDlError;
+  vfs.xDlSym = ::vfsDlSym;
+  vfs.xDlClose = ::vfsDlClose;
+  vfs.xRandomness = ::vfsRandomness;
+  vfs.xSleep = ::vfsSleep;
+  vfs.xCurrentTime = ::vfsCurrentTime;
+  vfs.xGetLastError = ::vfsGetLastError;
+  if (vfs.iVersion >= 2) {
+    vfs.xCurrentTimeInt64 = ::vfsCurrentTimeInt64;
+  }
+  if (vfs.iVersion >= 3) {
+    vfs.xSetSystemCall = ::vfsSetSystemCall;
+    vfs.xGetSystemCall = ::vfsGetSystemCall;
+    vfs.xNextSystemCall = ::vfsNextSystemCall;
+  }
+  if (sqlite3_vfs_register(&vfs, 0) != SQLITE_OK) {
+    throw Exception("The VFS can not be registered.");
+  }
+}
+
+StatsVfs::~StatsVfs() {
+  sqlite3_vfs_unregister(&state_->vfs);
+}
+
+auto StatsVfs::name() const noexcept -> const std::string& {
+  return state_->name;
+}
+
+auto StatsVfs::stats(bool reset) const -> IoStats {
+  return state_->data.total.read(reset);
+}
+
+auto StatsVfs::stats(const Connection& connection, bool reset) const -> IoStats {
+  sqlite3_file* file = nullptr;
+  sqlite3_file_control(connection.backend(), "main", SQLITE_FCNTL_FILE_POINTER, static_cast<void*>(&file));
+  if (!::isStatsFile(file) || toFile(file).vfs != &state_->data || !toFile(file).group) {
+    throw std::invalid_argument("The connection was not opened through this VFS.");
+  }
+  return toFile(file).group->read(reset);
+}
+
+} // namespace Y2KaoZ::Database::Sql::Sqlite3
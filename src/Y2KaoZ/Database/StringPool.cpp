@@ -0,0 +1,55 @@
+#include "Y2KaoZ/Database/StringPool.hpp"
+#include <cstring>
+#include <gsl/gsl_util>
+#include <limits>
+#include <stdexcept>
+
+namespace Y2KaoZ::Database {
+
+StringPool::StringPool() = default;
+
+auto StringPool::intern(std::string_view value) -> Id {
+  auto found = ids_.find(value);
+  if (found != ids_.end()) {
+    return found->second;
+  }
+  if (dictionary_.size() == std::numeric_limits<Id>::max()) {
+    throw std::length_error("The string pool is full");
+  }
+  auto* copy = static_cast<char*>(arena_.allocate(value.empty() ? 1 : value.size(), 1));
+  if (!value.empty()) {
+    std::memcpy(copy, value.data(), value.size());
+  }
+  std::string_view stored{copy, value.size()};
+  auto id = gsl::narrow<Id>(dictionary_.size());
+  dictionary_.emplace_back(stored);
+  ids_.emplace(stored, id);
+  bytes_ += value.size();
+  return id;
+}
+
+auto StringPool::find(std::string_view value) const -> std::optional<Id> {
+  auto found = ids_.find(value);
+  if (found == ids_.end()) {
+    return {};
+  }
+  return found->second;
+}
+
+auto StringPool::view(Id id) const -> std::string_view {
+  return dictionary_.at(id);
+}
+
+auto StringPool::dictionary() const noexcept -> const std::vector<std::string_view>& {
+  return dictionary_;
+}
+
+auto StringPool::size() const noexcept -> std::size_t {
+  return dictionary_.size();
+}
+
+auto StringPool::bytes() const noexcept -> std::size_t {
+  return bytes_;
+}
+
+} // namespace Y2KaoZ::Database
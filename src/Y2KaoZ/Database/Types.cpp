@@ -1,54 +1,551 @@
 #include "Y2KaoZ/Database/Types.hpp"
 
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cmath>
 #include <cstring>
 #include <gsl/gsl_util>
+#include <limits>
+#include <new>
 #include <stdexcept>
 
+namespace {
+
+using Y2KaoZ::Database::BlobView;
+using Y2KaoZ::Database::ResultType;
+
+enum class Status : std::uint8_t
+{
+  Ok = 0,
+  Invalid,
+  OutOfRange
+};
+
+template <typename T>
+struct Converted {
+  T value{};
+  Status status = Status::Ok;
+  const char* error = nullptr;
+};
+
+[[nodiscard]] constexpr auto isSpace(char c) noexcept -> bool {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+[[nodiscard]] constexpr auto isDigit(char c) noexcept -> bool {
+  return c >= '0' && c <= '9';
+}
+
+[[nodiscard]] constexpr auto isHexDigit(char c) noexcept -> bool {
+  return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// A "0x" or "0X" prefix followed by at least one hexadecimal digit.
+[[nodiscard]] auto hasHexPrefix(const char* first, const char* last) noexcept -> bool {
+  return last - first > 2 && first[0] == '0' && (first[1] == 'x' || first[1] == 'X') && isHexDigit(first[2]);
+}
+
+[[nodiscard]] auto loadWord(const char* first) noexcept -> std::uint64_t {
+  std::uint64_t word = 0;
+  std::memcpy(&word, first, sizeof(word));
+  return word;
+}
+
+// Checks that the 8 bytes of a word are ASCII digits, without branching per character.
+[[nodiscard]] constexpr auto isEightDigits(std::uint64_t word) noexcept -> bool {
+  return ((word & 0xF0F0F0F0F0F0F0F0ULL) | (((word + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+         0x3333333333333333ULL;
+}
+
+// Parses 8 ASCII digits at once (SWAR), the first digit must be in the lowest byte.
+[[nodiscard]] constexpr auto parseEightDigits(std::uint64_t word) noexcept -> std::uint64_t {
+  const std::uint64_t mask = 0x000000FF000000FFULL;
+  const std::uint64_t mul1 = 100 + (1000000ULL << 32);
+  const std::uint64_t mul2 = 1 + (10000ULL << 32);
+  word -= 0x3030303030303030ULL;
+  word = (word * 10) + (word >> 8);
+  return (((word & mask) * mul1) + (((word >> 16) & mask) * mul2)) >> 32;
+}
+
+// Parses up to 19 decimal digits (which always fit in an uint64), 8 at a time when possible.
+[[nodiscard]] auto parseDecimal(const char* first, const char* last) noexcept -> std::uint64_t {
+  std::uint64_t result = 0;
+  if constexpr (std::endian::native == std::endian::little) {
+    const std::uint64_t EIGHT_DIGITS = 100000000ULL;
+    while (last - first >= 8) {
+      result = result * EIGHT_DIGITS + parseEightDigits(loadWord(first));
+      first += 8; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+  }
+  for (; first != last; ++first) { // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    result = result * 10 + static_cast<std::uint64_t>(*first - '0');
+  }
+  return result;
+}
+
+// Same rules as std::strtoll with base 0: leading whitespace, an optional sign, a "0x" prefix for hexadecimal or a
+// "0" prefix for octal, trailing characters are ignored. It neither depends on the locale nor allocates.
+[[nodiscard]] auto parseInteger(std::string_view text) noexcept -> Converted<std::int64_t> {
+  const auto* first = text.data();
+  const auto* last = text.data() + text.size(); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  while (first != last && isSpace(*first)) {
+    ++first; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  }
+  bool negative = false;
+  if (first != last && (*first == '-' || *first == '+')) {
+    negative = *first == '-';
+    ++first; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  }
+  int base = 10;
+  if (hasHexPrefix(first, last)) {
+    base = 16;
+    first += 2; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  } else if (last - first >= 2 && first[0] == '0' && isDigit(first[1])) {
+    base = 8;
+  }
+
+  std::uint64_t magnitude = 0;
+  if (base == 10) {
+    const auto* digits = first;
+    if constexpr (std::endian::native == std::endian::little) {
+      while (last - digits >= 8 && isEightDigits(loadWord(digits))) {
+        digits += 8; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      }
+    }
+    while (digits != last && isDigit(*digits)) {
+      ++digits; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    if (digits == first) {
+      return {0, Status::Invalid, "The string is not an integer"};
+    }
+    const std::ptrdiff_t SAFE_DIGITS = 19;
+    if (digits - first <= SAFE_DIGITS) {
+      magnitude = parseDecimal(first, digits);
+    } else if (std::from_chars(first, digits, magnitude).ec != std::errc{}) {
+      return {0, Status::OutOfRange, "The integer is out of range"};
+    }
+  } else {
+    auto [end, ec] = std::from_chars(first, last, magnitude, base);
+    if (ec == std::errc::invalid_argument) {
+      return {0, Status::Invalid, "The string is not an integer"};
+    }
+    if (ec == std::errc::result_out_of_range) {
+      return {0, Status::OutOfRange, "The integer is out of range"};
+    }
+  }
+
+  const auto limit = static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max());
+  if (negative) {
+    if (magnitude > limit + 1) {
+      return {0, Status::OutOfRange, "The integer is out of range"};
+    }
+    return {static_cast<std::int64_t>(~magnitude + 1)};
+  }
+  if (magnitude > limit) {
+    return {0, Status::OutOfRange, "The integer is out of range"};
+  }
+  return {static_cast<std::int64_t>(magnitude)};
+}
+
+// Same rules as std::strtod: leading whitespace, an optional sign, decimal or "0x" hexadecimal notation, infinity and
+// nan, trailing characters are ignored. It neither depends on the locale nor allocates.
+[[nodiscard]] auto parseReal(std::string_view text) noexcept -> Converted<double> {
+  const auto* first = text.data();
+  const auto* last = text.data() + text.size(); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  while (first != last && isSpace(*first)) {
+    ++first; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  }
+  bool negative = false;
+  if (first != last && (*first == '-' || *first == '+')) {
+    negative = *first == '-';
+    ++first; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  }
+  auto format = std::chars_format::general;
+  if (hasHexPrefix(first, last)) {
+    format = std::chars_format::hex;
+    first += 2; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  }
+  // from_chars accepts a minus sign of its own, which would make "--5" or "+-5" numbers.
+  if (first != last && (*first == '-' || *first == '+')) {
+    return {0, Status::Invalid, "The string is not a number"};
+  }
+  double result = 0;
+  auto [end, ec] = std::from_chars(first, last, result, format);
+  if (ec == std::errc::invalid_argument) {
+    return {0, Status::Invalid, "The string is not a number"};
+  }
+  if (ec == std::errc::result_out_of_range) {
+    return {0, Status::OutOfRange, "The number is out of range"};
+  }
+  return {negative ? -result : result};
+}
+
+template <typename T>
+[[nodiscard]] auto loadBlob(BlobView blob) noexcept -> T {
+  T result = 0;
+  std::memcpy(&result, blob.data(), sizeof(result));
+  return result;
+}
+
+[[nodiscard]] auto toInteger64(const ResultType& value) noexcept -> Converted<std::int64_t> {
+  switch (value.getType()) {
+    case ResultType::Type::Null:
+      return {0};
+    case ResultType::Type::Integer:
+      return {value.getInteger()};
+    case ResultType::Type::String:
+      return parseInteger(value.stringView());
+    case ResultType::Type::Real: {
+      // 2^63 is exactly representable, every double in [-2^63, 2^63) converts without overflow.
+      const double LIMIT = 9223372036854775808.0;
+      auto real = value.getReal();
+      if (!(real >= -LIMIT && real < LIMIT)) {
+        return {0, Status::OutOfRange, "The real is out of range"};
+      }
+      return {static_cast<std::int64_t>(real)};
+    }
+    case ResultType::Type::Blob: {
+      auto blob = value.blobView();
+      switch (blob.size()) {
+        case sizeof(std::int8_t):
+          return {loadBlob<std::int8_t>(blob)};
+        case sizeof(std::int16_t):
+          return {loadBlob<std::int16_t>(blob)};
+        case sizeof(std::int32_t):
+          return {loadBlob<std::int32_t>(blob)};
+        case sizeof(std::int64_t):
+          return {loadBlob<std::int64_t>(blob)};
+        default:
+          return {0, Status::OutOfRange, "The blob is too big"};
+      }
+    }
+    default:
+      return {0, Status::Invalid, "Unknown type"};
+  }
+}
+
+[[nodiscard]] auto toReal(const ResultType& value) noexcept -> Converted<double> {
+  switch (value.getType()) {
+    case ResultType::Type::Null:
+      return {0.0};
+    case ResultType::Type::Real:
+      return {value.getReal()};
+    case ResultType::Type::String:
+      return parseReal(value.stringView());
+    case ResultType::Type::Integer:
+      return {static_cast<double>(value.getInteger())};
+    case ResultType::Type::Blob: {
+      auto blob = value.blobView();
+      switch (blob.size()) {
+        case sizeof(float):
+          return {loadBlob<float>(blob)};
+        case sizeof(double):
+          return {loadBlob<double>(blob)};
+        default:
+          return {0.0, Status::OutOfRange, "The blob is too big"};
+      }
+    }
+    default:
+      return {0.0, Status::Invalid, "Unknown type"};
+  }
+}
+
+template <typename T>
+[[nodiscard]] auto valueOrThrow(const Converted<T>& converted) -> T {
+  switch (converted.status) {
+    case Status::Invalid:
+      throw std::invalid_argument(converted.error);
+    case Status::OutOfRange:
+      throw std::out_of_range(converted.error);
+    default:
+      return converted.value;
+  }
+}
+
+template <typename T>
+[[nodiscard]] auto narrowed(const Converted<std::int64_t>& converted) noexcept -> std::optional<T> {
+  if (converted.status != Status::Ok || !std::in_range<T>(converted.value)) {
+    return {};
+  }
+  return static_cast<T>(converted.value);
+}
+
+template <typename T>
+[[nodiscard]] auto toChars(T value) -> std::string {
+  const std::size_t BUFFER_SIZE = 32;
+  std::array<char, BUFFER_SIZE> buffer{};
+  auto [end, ec] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+  return {buffer.data(), end};
+}
+
+// Out-of-line and borrowed payloads store their size on 32 bits, sqlite values are never longer than 2^31 - 1.
+void checkLength(std::size_t size) {
+  if (size > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::length_error("The value is too long");
+  }
+}
+
+class Fnv1a {
+public:
+  void tag(std::uint8_t value) noexcept {
+    byte(value);
+  }
+  void integer(std::int64_t value) noexcept {
+    tag(1);
+    auto bits = static_cast<std::uint64_t>(value);
+    for (int i = 0; i < 8; ++i) {
+      byte(static_cast<std::uint8_t>(bits >> (i * 8)));
+    }
+  }
+  void real(double value) noexcept {
+    std::uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    tag(2);
+    for (int i = 0; i < 8; ++i) {
+      byte(static_cast<std::uint8_t>(bits >> (i * 8)));
+    }
+  }
+  void bytes(std::uint8_t kind, const void* data, std::size_t size) noexcept {
+    tag(kind);
+    const auto* begin = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+      byte(begin[i]); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+  }
+  [[nodiscard]] auto value() const noexcept -> std::uint64_t {
+    return hash_;
+  }
+
+private:
+  void byte(std::uint8_t value) noexcept {
+    static const std::uint64_t PRIME = 0x100000001b3ULL;
+    hash_ = (hash_ ^ value) * PRIME;
+  }
+  std::uint64_t hash_ = 0xcbf29ce484222325ULL;
+};
+
+} // namespace
+
 namespace Y2KaoZ::Database {
 
-ResultType::ResultType(Value r) : value_(std::move(r)) {
+static_assert(sizeof(ResultType) == 24);
+
+ResultType::ResultType() noexcept : resource_(std::pmr::get_default_resource()) {
+}
+ResultType::ResultType(const allocator_type& allocator) noexcept : resource_(allocator.resource()) {
+}
+ResultType::ResultType(Value r) : ResultType() {
+  assign(r);
+}
+ResultType::ResultType(Value r, const allocator_type& allocator) : ResultType(allocator) {
+  assign(r);
 }
+ResultType::ResultType(const ResultType& other) : ResultType() {
+  assign(other);
+}
+ResultType::ResultType(const ResultType& other, const allocator_type& allocator) : ResultType(allocator) {
+  assign(other);
+}
+ResultType::ResultType(ResultType&& other) noexcept : resource_(other.resource_) {
+  steal(other);
+}
+ResultType::ResultType(ResultType&& other, const allocator_type& allocator) : ResultType(allocator) {
+  if (*resource_ == *other.resource_) {
+    steal(other);
+  } else {
+    assign(other);
+  }
+}
+auto ResultType::operator=(const ResultType& other) -> ResultType& {
+  if (this != &other) {
+    release();
+    assign(other);
+  }
+  return *this;
+}
+auto ResultType::operator=(ResultType&& other) -> ResultType& {
+  if (this != &other) {
+    release();
+    if (*resource_ == *other.resource_) {
+      steal(other);
+    } else {
+      assign(other);
+    }
+  }
+  return *this;
+}
+ResultType::~ResultType() {
+  release();
+}
+
+auto ResultType::fromText(std::string_view text, const allocator_type& allocator) -> ResultType {
+  ResultType result(allocator);
+  result.assign(Type::String, text.data(), text.size());
+  return result;
+}
+auto ResultType::fromBlob(BlobView blob, const allocator_type& allocator) -> ResultType {
+  ResultType result(allocator);
+  result.assign(Type::Blob, blob.data(), blob.size());
+  return result;
+}
+auto ResultType::fromView(std::string_view text, const allocator_type& allocator) -> ResultType {
+  checkLength(text.size());
+  ResultType result(allocator);
+  result.point(Type::String, text.data(), text.size(), BORROWED);
+  return result;
+}
+auto ResultType::get_allocator() const noexcept -> allocator_type {
+  return resource_;
+}
+
+void ResultType::assign(Type type, const void* data, std::size_t size) {
+  if (size <= INLINE_CAPACITY) {
+    if (size != 0) {
+      std::memcpy(data_.data(), data, size);
+    }
+    size_ = static_cast<std::uint8_t>(size);
+    type_ = type;
+  } else {
+    checkLength(size);
+    auto* copy = resource_->allocate(size, 1);
+    std::memcpy(copy, data, size);
+    point(type, copy, size, OUT_OF_LINE);
+  }
+}
+void ResultType::point(Type type, const void* data, std::size_t size, std::uint8_t storage) noexcept {
+  auto length = static_cast<std::uint32_t>(size);
+  ::new (data_.data()) const std::byte*(static_cast<const std::byte*>(data));
+  std::memcpy(data_.data() + sizeof(data), &length, sizeof(length)); // NOLINT(*-pointer-arithmetic)
+  size_ = storage;
+  type_ = type;
+}
+void ResultType::assign(const Value& value) {
+  std::visit(
+    [this](const auto& v) {
+      using T = std::decay_t<decltype(v)>;
+      if constexpr (std::is_same_v<T, NullType>) {
+        type_ = Type::Null;
+      } else if constexpr (std::is_same_v<T, std::int64_t>) {
+        ::new (data_.data()) std::int64_t(v);
+        type_ = Type::Integer;
+      } else if constexpr (std::is_same_v<T, double>) {
+        ::new (data_.data()) double(v);
+        type_ = Type::Real;
+      } else if constexpr (std::is_same_v<T, std::string>) {
+        assign(Type::String, v.data(), v.size());
+      } else {
+        assign(Type::Blob, v.data(), v.size());
+      }
+    },
+    value);
+}
+void ResultType::assign(const ResultType& other) {
+  if (other.size_ == OUT_OF_LINE || other.size_ == OBJECT || other.size_ == BORROWED) {
+    // A copy owns its characters, the ones a borrowed view points to may not outlive it.
+    auto payload = other.bytes();
+    assign(other.type_, payload.data(), payload.size());
+  } else {
+    // Inline payloads, integers and reals are plain bytes.
+    std::memcpy(data_.data(), other.data_.data(), data_.size());
+    size_ = other.size_;
+    type_ = other.type_;
+  }
+}
+void ResultType::steal(ResultType& other) noexcept {
+  std::memcpy(data_.data(), other.data_.data(), data_.size());
+  size_ = other.size_;
+  type_ = other.type_;
+  other.size_ = 0;
+  other.type_ = Type::Null;
+}
+void ResultType::release() noexcept {
+  if (size_ == OUT_OF_LINE) {
+    auto payload = bytes();
+    resource_->deallocate(const_cast<std::byte*>(payload.data()), payload.size(), 1); // NOLINT
+  } else if (size_ == OBJECT) {
+    std::pmr::polymorphic_allocator<> allocator(resource_);
+    if (type_ == Type::String) {
+      allocator.delete_object(object<std::string>());
+    } else {
+      allocator.delete_object(object<BlobType>());
+    }
+  }
+  size_ = 0;
+  type_ = Type::Null;
+}
+auto ResultType::bytes() const noexcept -> BlobView {
+  if (size_ == OBJECT) {
+    if (type_ == Type::String) {
+      const auto& text = *object<std::string>();
+      return {reinterpret_cast<const std::byte*>(text.data()), text.size()}; // NOLINT
+    }
+    const auto& blob = *object<BlobType>();
+    return {blob.data(), blob.size()};
+  }
+  if (size_ != OUT_OF_LINE && size_ != BORROWED) {
+    return {data_.data(), size_};
+  }
+  std::uint32_t length = 0;
+  std::memcpy(&length, data_.data() + sizeof(std::byte*), sizeof(length)); // NOLINT(*-pointer-arithmetic)
+  return {*std::launder(reinterpret_cast<const std::byte* const*>(data_.data())), length}; // NOLINT
+}
+
+template <typename T>
+auto ResultType::object() const noexcept -> T* {
+  return *std::launder(reinterpret_cast<T* const*>(data_.data())); // NOLINT
+}
+template <typename T>
+auto ResultType::promote() -> T& {
+  // Only the first call allocates, the cell then stores the object and later calls return it.
+  if (size_ == OBJECT) {
+    return *object<T>();
+  }
+  auto payload = bytes();
+  std::pmr::polymorphic_allocator<> allocator(resource_);
+  T* value = nullptr;
+  if constexpr (std::is_same_v<T, std::string>) {
+    value = allocator.new_object<T>(reinterpret_cast<const char*>(payload.data()), payload.size()); // NOLINT
+  } else {
+    value = allocator.new_object<T>(payload.begin(), payload.end());
+  }
+  auto type = type_;
+  release();
+  ::new (data_.data()) T*(value);
+  size_ = OBJECT;
+  type_ = type;
+  return *value;
+}
+
 auto ResultType::isNull() const noexcept -> bool {
-  return std::holds_alternative<NullType>(value_);
+  return type_ == Type::Null;
 }
 auto ResultType::isInteger() const noexcept -> bool {
-  return std::holds_alternative<std::int64_t>(value_);
+  return type_ == Type::Integer;
 }
 auto ResultType::isReal() const noexcept -> bool {
-  return std::holds_alternative<double>(value_);
+  return type_ == Type::Real;
 }
 auto ResultType::isString() const noexcept -> bool {
-  return std::holds_alternative<std::string>(value_);
+  return type_ == Type::String;
 }
 auto ResultType::isBlob() const noexcept -> bool {
-  return std::holds_alternative<BlobType>(value_);
+  return type_ == Type::Blob;
 }
 auto ResultType::getType() const noexcept -> ResultType::Type {
-  switch (value_.index()) {
-    case 0:
-      static_assert(std::is_same_v<NullType, std::variant_alternative_t<0, Value>>);
-      return Type::Null;
-    case 1:
-      static_assert(std::is_same_v<std::int64_t, std::variant_alternative_t<1, Value>>);
-      return Type::Integer;
-    case 2:
-      static_assert(std::is_same_v<double, std::variant_alternative_t<2, Value>>);
-      return Type::Real;
-    case 3:
-      static_assert(std::is_same_v<std::string, std::variant_alternative_t<3, Value>>);
-      return Type::String;
-    case 4:
-      static_assert(std::is_same_v<BlobType, std::variant_alternative_t<4, Value>>);
-      return Type::Blob;
-    default:
-      return Type::Unknown;
-  }
+  return type_;
 }
 auto ResultType::getInteger() const -> const std::int64_t& {
-  return std::get<std::int64_t>(value_);
+  if (!isInteger()) {
+    throw std::bad_variant_access{};
+  }
+  return *std::launder(reinterpret_cast<const std::int64_t*>(data_.data())); // NOLINT
 }
 auto ResultType::getInteger() -> std::int64_t& {
-  return std::get<std::int64_t>(value_);
+  if (!isInteger()) {
+    throw std::bad_variant_access{};
+  }
+  return *std::launder(reinterpret_cast<std::int64_t*>(data_.data())); // NOLINT
 }
 auto ResultType::asInteger8() const -> std::int8_t {
   return gsl::narrow<std::int8_t>(asInteger64());
@@ -69,103 +566,103 @@ auto ResultType::asUnsigned32() const -> std::uint32_t {
   return gsl::narrow<std::uint32_t>(asInteger64());
 }
 auto ResultType::asInteger64() const -> std::int64_t {
-  switch (getType()) {
-    case Type::Null:
-      return 0;
-    case Type::String:
-      return std::stol(getString(), nullptr, 0);
-    case Type::Real:
-      return static_cast<std::int64_t>(getReal());
-    case Type::Blob: {
-      if (getBlob().size() == sizeof(std::int8_t)) {
-        std::int8_t result = 0;
-        std::memcpy(&result, getBlob().data(), sizeof(result));
-        return result;
-      }
-      if (getBlob().size() == sizeof(std::int16_t)) {
-        std::int16_t result = 0;
-        std::memcpy(&result, getBlob().data(), sizeof(result));
-        return result;
-      }
-      if (getBlob().size() == sizeof(std::int32_t)) {
-        std::int32_t result = 0;
-        std::memcpy(&result, getBlob().data(), sizeof(result));
-        return result;
-      }
-      if (getBlob().size() == sizeof(std::int64_t)) {
-        std::int64_t result = 0;
-        std::memcpy(&result, getBlob().data(), sizeof(result));
-        return result;
-      }
-      throw std::out_of_range("The blob is too big");
-    }
-    default:
-      return std::get<std::int64_t>(value_);
-  }
+  return valueOrThrow(toInteger64(*this));
 }
 auto ResultType::asUnsigned64() const -> std::uint64_t {
   return gsl::narrow<std::uint64_t>(asInteger64());
 }
+auto ResultType::tryAsInteger8() const noexcept -> std::optional<std::int8_t> {
+  return narrowed<std::int8_t>(toInteger64(*this));
+}
+auto ResultType::tryAsUnsigned8() const noexcept -> std::optional<std::uint8_t> {
+  return narrowed<std::uint8_t>(toInteger64(*this));
+}
+auto ResultType::tryAsInteger16() const noexcept -> std::optional<std::int16_t> {
+  return narrowed<std::int16_t>(toInteger64(*this));
+}
+auto ResultType::tryAsUnsigned16() const noexcept -> std::optional<std::uint16_t> {
+  return narrowed<std::uint16_t>(toInteger64(*this));
+}
+auto ResultType::tryAsInteger32() const noexcept -> std::optional<std::int32_t> {
+  return narrowed<std::int32_t>(toInteger64(*this));
+}
+auto ResultType::tryAsUnsigned32() const noexcept -> std::optional<std::uint32_t> {
+  return narrowed<std::uint32_t>(toInteger64(*this));
+}
+auto ResultType::tryAsInteger64() const noexcept -> std::optional<std::int64_t> {
+  return narrowed<std::int64_t>(toInteger64(*this));
+}
+auto ResultType::tryAsUnsigned64() const noexcept -> std::optional<std::uint64_t> {
+  return narrowed<std::uint64_t>(toInteger64(*this));
+}
 auto ResultType::getReal() const -> const double& {
-  return std::get<double>(value_);
+  if (!isReal()) {
+    throw std::bad_variant_access{};
+  }
+  return *std::launder(reinterpret_cast<const double*>(data_.data())); // NOLINT
 }
 auto ResultType::getReal() -> double& {
-  return std::get<double>(value_);
+  if (!isReal()) {
+    throw std::bad_variant_access{};
+  }
+  return *std::launder(reinterpret_cast<double*>(data_.data())); // NOLINT
 }
 auto ResultType::asReal() const -> double {
-  switch (getType()) {
-    case Type::Null:
-      return 0.0;
-    case Type::String:
-      return std::stod(getString(), nullptr);
-    case Type::Integer:
-      return static_cast<double>(getInteger());
-    case Type::Blob: {
-      if (getBlob().size() == sizeof(float)) {
-        float result = 0;
-        std::memcpy(&result, getBlob().data(), sizeof(result));
-        return result;
-      }
-      if (getBlob().size() == sizeof(double)) {
-        double result = 0;
-        std::memcpy(&result, getBlob().data(), sizeof(result));
-        return result;
-      }
-      throw std::out_of_range("The blob is too big");
-    }
-    default:
-      return std::get<double>(value_);
+  return valueOrThrow(toReal(*this));
+}
+auto ResultType::tryAsReal() const noexcept -> std::optional<double> {
+  auto converted = toReal(*this);
+  if (converted.status != Status::Ok) {
+    return {};
   }
+  return converted.value;
 }
 
-auto ResultType::getString() const -> const std::string& {
-  return std::get<std::string>(value_);
+auto ResultType::getString() const -> std::string {
+  return std::string(stringView());
 }
 auto ResultType::getString() -> std::string& {
-  return std::get<std::string>(value_);
+  if (!isString()) {
+    throw std::bad_variant_access{};
+  }
+  return promote<std::string>();
+}
+auto ResultType::stringView() const -> std::string_view {
+  if (!isString()) {
+    throw std::bad_variant_access{};
+  }
+  auto payload = bytes();
+  return {reinterpret_cast<const char*>(payload.data()), payload.size()}; // NOLINT
 }
 auto ResultType::asString() const -> std::string {
   switch (getType()) {
     case Type::Null:
       return std::string{};
     case Type::Integer:
-      return std::to_string(getInteger());
+      return toChars(getInteger());
     case Type::Real:
-      return std::to_string(getReal());
-    case Type::Blob: {
-      std::string result(getBlob().size(), 0);
-      std::memcpy(result.data(), getBlob().data(), result.size());
-      return result;
+      return toChars(getReal());
+    default: {
+      auto payload = bytes();
+      return {reinterpret_cast<const char*>(payload.data()), payload.size()}; // NOLINT
     }
-    default:
-      return std::get<std::string>(value_);
   }
 }
-auto ResultType::getBlob() const -> const BlobType& {
-  return std::get<BlobType>(value_);
+auto ResultType::getBlob() const -> BlobType {
+  auto blob = blobView();
+  return {blob.begin(), blob.end()};
 }
 auto ResultType::getBlob() -> BlobType& {
-  return std::get<BlobType>(value_);
+  if (!isBlob()) {
+    throw std::bad_variant_access{};
+  }
+  return promote<BlobType>();
+}
+auto ResultType::blobView() const -> BlobView {
+  if (!isBlob()) {
+    throw std::bad_variant_access{};
+  }
+  return bytes();
 }
 auto ResultType::asBlob() const -> BlobType {
   switch (getType()) {
@@ -183,15 +680,73 @@ auto ResultType::asBlob() const -> BlobType {
       std::memcpy(result.data(), &value, result.size());
       return result;
     }
-    case Type::String: {
-      auto value = getString();
-      BlobType result(value.size());
-      std::memcpy(result.data(), value.data(), result.size());
-      return result;
+    default: {
+      auto payload = bytes();
+      return {payload.begin(), payload.end()};
     }
+  }
+}
+
+auto hashValue(const ParamType& value) noexcept -> std::uint64_t {
+  Fnv1a hash;
+  std::visit(
+    [&](const auto& v) {
+      using T = std::decay_t<decltype(v)>;
+      if constexpr (std::is_same_v<T, NullType>) {
+        hash.tag(0);
+      } else if constexpr (std::is_floating_point_v<T>) {
+        hash.real(v);
+      } else if constexpr (std::is_integral_v<T>) {
+        hash.integer(static_cast<std::int64_t>(v));
+      } else if constexpr (std::is_same_v<T, std::string>) {
+        hash.bytes(3, v.data(), v.size());
+      } else {
+        hash.bytes(4, v.data(), v.size());
+      }
+    },
+    value);
+  return hash.value();
+}
+
+auto hashValue(const ResultType& value) noexcept -> std::uint64_t {
+  Fnv1a hash;
+  switch (value.getType()) {
+    case ResultType::Type::Integer:
+      hash.integer(value.getInteger());
+      break;
+    case ResultType::Type::Real:
+      hash.real(value.getReal());
+      break;
+    case ResultType::Type::String:
+      hash.bytes(3, value.stringView().data(), value.stringView().size());
+      break;
+    case ResultType::Type::Blob:
+      hash.bytes(4, value.blobView().data(), value.blobView().size());
+      break;
     default:
-      return std::get<BlobType>(value_);
+      hash.tag(0);
+      break;
+  }
+  return hash.value();
+}
+
+auto columnAsInteger64(const std::vector<ResultVector>& rows, std::size_t column)
+  -> std::vector<std::optional<std::int64_t>> {
+  std::vector<std::optional<std::int64_t>> result;
+  result.reserve(rows.size());
+  for (const auto& row : rows) {
+    result.emplace_back(row.at(column).tryAsInteger64());
+  }
+  return result;
+}
+
+auto columnAsReal(const std::vector<ResultVector>& rows, std::size_t column) -> std::vector<std::optional<double>> {
+  std::vector<std::optional<double>> result;
+  result.reserve(rows.size());
+  for (const auto& row : rows) {
+    result.emplace_back(row.at(column).tryAsReal());
   }
+  return result;
 }
 
 } // namespace Y2KaoZ::Database
\ No newline at end of file
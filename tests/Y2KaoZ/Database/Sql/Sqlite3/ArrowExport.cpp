@@ -0,0 +1,167 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <catch2/catch_all.hpp>
+#include <cstring>
+
+namespace {
+
+// Checks the layout the Arrow specification gives to the arrays of a batch.
+void checkLayout(const ArrowSchema& schema, const ArrowArray& batch) {
+  REQUIRE(std::strcmp(schema.format, "+s") == 0);
+  REQUIRE(batch.release != nullptr);
+  REQUIRE(batch.n_buffers == 1);
+  CHECK(batch.buffers[0] == nullptr);
+  CHECK(batch.offset == 0);
+  CHECK(batch.null_count == 0);
+  REQUIRE(batch.n_children == schema.n_children);
+  for (std::int64_t c = 0; c < batch.n_children; ++c) {
+    const auto& field = *schema.children[c];
+    const auto& array = *batch.children[c];
+    REQUIRE(array.release != nullptr);
+    CHECK(field.flags == ARROW_FLAG_NULLABLE);
+    CHECK(array.length == batch.length);
+    CHECK(array.offset == 0);
+    CHECK(array.n_children == 0);
+    const auto* validity = static_cast<const std::uint8_t*>(array.buffers[0]);
+    std::int64_t nulls = 0;
+    for (std::int64_t i = 0; validity != nullptr && i < array.length; ++i) {
+      nulls += (validity[i / 8] >> (i % 8) & 1) == 0 ? 1 : 0;
+    }
+    CHECK(nulls == array.null_count);
+    std::string format = field.format;
+    if (format == "l" || format == "g") {
+      REQUIRE(array.n_buffers == 2);
+      CHECK(reinterpret_cast<std::uintptr_t>(array.buffers[1]) % 8 == 0); // NOLINT
+    } else {
+      REQUIRE((format == "u" || format == "z"));
+      REQUIRE(array.n_buffers == 3);
+      const auto* offsets = static_cast<const std::int32_t*>(array.buffers[1]);
+      CHECK(offsets[0] == 0);
+      for (std::int64_t i = 0; i < array.length; ++i) {
+        CHECK(offsets[i] <= offsets[i + 1]);
+      }
+    }
+  }
+}
+
+[[nodiscard]] auto text(const ArrowArray& array, std::int64_t i) -> std::string {
+  const auto* offsets = static_cast<const std::int32_t*>(array.buffers[1]);
+  const auto* data = static_cast<const char*>(array.buffers[2]);
+  return {data + offsets[i], static_cast<std::size_t>(offsets[i + 1] - offsets[i])};
+}
+
+[[nodiscard]] auto isNull(const ArrowArray& array, std::int64_t i) -> bool {
+  const auto* validity = static_cast<const std::uint8_t*>(array.buffers[0]);
+  return validity != nullptr && (validity[i / 8] >> (i % 8) & 1) == 0;
+}
+
+} // namespace
+
+TEST_CASE("Arrow export") { // NOLINT
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+
+  Connection connection{};
+  connection.execute("CREATE TABLE valid (a INTEGER, b REAL, c TEXT, d BLOB, e);"
+                     "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 10)"
+                     "INSERT INTO valid SELECT i, i / 2.0, CASE WHEN i % 3 = 0 THEN NULL ELSE 'row ' || i END,"
+                     "CAST('b' || i AS BLOB), i * 10 FROM n;");
+
+  SECTION("The schema follows the column types") {
+    auto statement = connection.prepare("SELECT a, b, c, d, e, 1.5 AS f, NULL AS g FROM valid;");
+    statement.execute();
+    ArrowSchema schema{};
+    ArrowArrayStream stream{};
+    statement.exportArrow(&schema, &stream);
+    REQUIRE(schema.n_children == 7);
+    std::string formats;
+    for (std::int64_t i = 0; i < schema.n_children; ++i) {
+      formats += schema.children[i]->format;
+    }
+    CHECK(formats == "lguzlgu");
+    CHECK(std::string(schema.children[0]->name) == "a");
+    CHECK(std::string(schema.children[5]->name) == "f");
+
+    ArrowSchema copy{};
+    REQUIRE(stream.get_schema(&stream, &copy) == 0);
+    CHECK(copy.n_children == 7);
+    copy.release(&copy);
+    CHECK(copy.release == nullptr);
+    schema.release(&schema);
+    stream.release(&stream);
+    CHECK(stream.release == nullptr);
+  }
+
+  SECTION("Rows are split into record batches") {
+    auto statement = connection.prepare("SELECT a, b, c, d FROM valid ORDER BY a;");
+    statement.execute();
+    ArrowSchema schema{};
+    ArrowArrayStream stream{};
+    statement.exportArrow(&schema, &stream, 4);
+    std::vector<std::int64_t> lengths;
+    std::int64_t row = 0;
+    for (;;) {
+      ArrowArray batch{};
+      REQUIRE(stream.get_next(&stream, &batch) == 0);
+      if (batch.release == nullptr) {
+        break;
+      }
+      checkLayout(schema, batch);
+      lengths.push_back(batch.length);
+      const auto& integers = *batch.children[0];
+      const auto& reals = *batch.children[1];
+      const auto& texts = *batch.children[2];
+      const auto& blobs = *batch.children[3];
+      for (std::int64_t i = 0; i < batch.length; ++i, ++row) {
+        CHECK(static_cast<const std::int64_t*>(integers.buffers[1])[i] == row + 1);
+        CHECK(static_cast<const double*>(reals.buffers[1])[i] == Catch::Approx(static_cast<double>(row + 1) / 2.0));
+        CHECK(isNull(texts, i) == ((row + 1) % 3 == 0));
+        if (!isNull(texts, i)) {
+          CHECK(text(texts, i) == "row " + std::to_string(row + 1));
+        }
+        CHECK(text(blobs, i) == "b" + std::to_string(row + 1));
+      }
+      batch.release(&batch);
+      CHECK(batch.release == nullptr);
+    }
+    CHECK(lengths == std::vector<std::int64_t>{4, 4, 2});
+    CHECK(!statement.rows());
+    schema.release(&schema);
+    stream.release(&stream);
+  }
+
+  SECTION("Children can be moved out and released on their own") {
+    auto statement = connection.prepare("SELECT c FROM valid;");
+    statement.execute();
+    ArrowSchema schema{};
+    ArrowArrayStream stream{};
+    statement.exportArrow(&schema, &stream);
+    ArrowArray batch{};
+    REQUIRE(stream.get_next(&stream, &batch) == 0);
+    checkLayout(schema, batch);
+    CHECK(batch.children[0]->null_count == 3);
+    ArrowArray child = *batch.children[0];
+    batch.children[0]->release = nullptr;
+    batch.release(&batch);
+    CHECK(text(child, 0) == "row 1");
+    child.release(&child);
+    ArrowArray end{};
+    REQUIRE(stream.get_next(&stream, &end) == 0);
+    CHECK(end.release == nullptr);
+    CHECK(stream.get_last_error(&stream) == nullptr);
+    schema.release(&schema);
+    stream.release(&stream);
+  }
+
+  SECTION("Empty results give a schema and no batch") {
+    auto statement = connection.prepare("SELECT a, c FROM valid WHERE a < 0;");
+    statement.execute();
+    ArrowSchema schema{};
+    ArrowArrayStream stream{};
+    statement.exportArrow(&schema, &stream);
+    CHECK(std::string(schema.children[1]->format) == "u");
+    ArrowArray batch{};
+    REQUIRE(stream.get_next(&stream, &batch) == 0);
+    CHECK(batch.release == nullptr);
+    schema.release(&schema);
+    stream.release(&stream);
+  }
+}
@@ -0,0 +1,106 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <atomic>
+#include <catch2/catch_all.hpp>
+#include <thread>
+
+TEST_CASE("Cancelling statements") { // NOLINT
+  using Y2KaoZ::Database::Sql::Sqlite3::CancellationToken;
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::InterruptedException;
+  using Y2KaoZ::Database::Sql::Sqlite3::Statement;
+  using namespace std::chrono_literals;
+
+  Connection connection{};
+  connection.execute("CREATE TABLE valid (a INTEGER PRIMARY KEY);"
+                     "INSERT INTO valid VALUES (1), (2), (3);");
+  // Counts up to the bound parameter, slow enough to be stopped for large values.
+  auto statement = connection.prepare("WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < ?)"
+                                      "SELECT count(*) FROM n;");
+  constexpr std::int64_t FOREVER = 1000000000000;
+  auto reusable = [](Statement& statement) {
+    statement.setDeadline(std::nullopt).setCancellationToken(std::nullopt).bind(1, 10).execute();
+    CHECK(statement.fetchColumn(0)->getInteger() == 10);
+  };
+
+  SECTION("Tokens copy their state") {
+    CancellationToken token;
+    auto copy = token;
+    CHECK(!copy.cancelled());
+    token.cancel();
+    CHECK(copy.cancelled());
+    copy.reset();
+    CHECK(!token.cancelled());
+  }
+
+  SECTION("Deadlines stop runaway queries") {
+    statement.bind(1, FOREVER).setDeadline(Statement::Clock::now() + 50ms);
+    auto start = Statement::Clock::now();
+    CHECK_THROWS_AS(statement.execute(), InterruptedException);
+    CHECK(Statement::Clock::now() - start < 10s);
+    CHECK(!statement.rows());
+    reusable(statement);
+  }
+
+  SECTION("Passed deadlines stop the statement before it steps") {
+    auto select = connection.prepare("SELECT a FROM valid ORDER BY a;");
+    select.setDeadline(Statement::Clock::now() - 1s);
+    CHECK_THROWS_WITH(select.execute(), "The statement deadline has passed.");
+    select.setDeadline(Statement::Clock::now() + 1h).execute();
+    CHECK(select.fetchColumn(0)->getInteger() == 1);
+    select.setDeadline(Statement::Clock::now() - 1s);
+    CHECK_THROWS_AS(select.fetchVector(), InterruptedException);
+    CHECK(!select.rows());
+    CHECK(select.setDeadline(std::nullopt).execute().fetchAllVector().size() == 3);
+  }
+
+  SECTION("Tokens cancel statements from another thread") {
+    CancellationToken token;
+    statement.bind(1, FOREVER).setCancellationToken(token).setProgressSteps(100);
+    std::thread canceller([token]() mutable {
+      std::this_thread::sleep_for(20ms);
+      token.cancel();
+    });
+    CHECK_THROWS_WITH(statement.execute(), "The statement was cancelled.");
+    canceller.join();
+    reusable(statement);
+  }
+
+  SECTION("Connections are interrupted from another thread") {
+    std::atomic<bool> done = false;
+    std::thread interrupter([&done, copy = connection]() {
+      while (!done) {
+        copy.interrupt();
+        std::this_thread::sleep_for(1ms);
+      }
+    });
+    statement.bind(1, FOREVER);
+    CHECK_THROWS_AS(statement.execute(), InterruptedException);
+    done = true;
+    interrupter.join();
+    reusable(statement);
+  }
+
+  SECTION("Progress hooks of the connection outlive the steps of statements with a deadline") {
+    std::size_t calls = 0;
+    auto hook = connection.addProgressHook([&calls]() { return ++calls == 0; }, 1000);
+    statement.bind(1, 100000).setDeadline(Statement::Clock::now() + 1h).execute();
+    CHECK(statement.fetchColumn(0)->getInteger() == 100000);
+    auto during = calls;
+    CHECK(during > 0);
+    CHECK(statement.setDeadline(std::nullopt).execute().fetchColumn(0)->getInteger() == 100000);
+    CHECK(calls > during);
+
+    auto stop = connection.addProgressHook([]() { return true; }, 1000);
+    CHECK_THROWS_AS(statement.execute(), InterruptedException);
+    connection.removeHook(stop);
+    connection.removeHook(hook);
+    during = calls;
+    reusable(statement);
+    CHECK(calls == during);
+  }
+
+  SECTION("Progress steps must be positive") {
+    CHECK_THROWS_AS(statement.setProgressSteps(0), std::invalid_argument);
+    CHECK_THROWS_AS(connection.addProgressHook([]() { return false; }, 0), std::invalid_argument);
+  }
+}
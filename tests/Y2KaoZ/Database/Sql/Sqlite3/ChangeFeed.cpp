@@ -0,0 +1,147 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <catch2/catch_all.hpp>
+#include <thread>
+
+TEST_CASE("Change feeds") { // NOLINT
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::RowChange;
+  Connection connection{};
+  connection.execute("CREATE TABLE valid (a INTEGER PRIMARY KEY, b);");
+
+  SECTION("Autocommit changes are published") {
+    auto feed = connection.changeFeed(16);
+    CHECK(!feed.tryPop());
+    connection.execute("INSERT INTO valid VALUES (1, 'one');");
+    auto event = feed.tryPop();
+    REQUIRE(event);
+    CHECK(event->change == RowChange::Insert);
+    CHECK(event->database == "main");
+    CHECK(event->table == "valid");
+    CHECK(event->rowid == 1);
+#ifdef SQLITE_ENABLE_PREUPDATE_HOOK
+    REQUIRE(event->newValues);
+    CHECK(event->newValues->at(1).getString() == "one");
+    CHECK(!event->oldValues);
+#endif
+    CHECK(!feed.tryPop());
+  }
+
+  SECTION("Changes are buffered until commit") {
+    auto feed = connection.changeFeed(16);
+    auto transaction = connection.beginTransaction();
+    connection.execute("INSERT INTO valid VALUES (1, 'one'), (2, 'two');"
+                       "UPDATE valid SET b = 'uno' WHERE a = 1;"
+                       "DELETE FROM valid WHERE a = 2;");
+    CHECK(!feed.tryPop());
+    transaction.commit();
+    auto events = feed.drain();
+    REQUIRE(events.size() == 4);
+    CHECK(events[0].change == RowChange::Insert);
+    CHECK(events[1].change == RowChange::Insert);
+    CHECK(events[2].change == RowChange::Update);
+    CHECK(events[2].rowid == 1);
+    CHECK(events[3].change == RowChange::Delete);
+    CHECK(events[3].rowid == 2);
+#ifdef SQLITE_ENABLE_PREUPDATE_HOOK
+    REQUIRE(events[2].oldValues);
+    CHECK(events[2].oldValues->at(1).getString() == "one");
+    REQUIRE(events[2].newValues);
+    CHECK(events[2].newValues->at(1).getString() == "uno");
+#endif
+  }
+
+  SECTION("Rolled back changes are discarded") {
+    auto feed = connection.changeFeed(16);
+    {
+      auto transaction = connection.beginTransaction();
+      connection.execute("INSERT INTO valid VALUES (1, 'one');");
+    }
+    CHECK(!feed.tryPop());
+    connection.execute("INSERT INTO valid VALUES (2, 'two');");
+    auto events = feed.drain();
+    REQUIRE(events.size() == 1);
+    CHECK(events[0].rowid == 2);
+  }
+
+  SECTION("Changes undone by ROLLBACK TO are discarded") {
+    auto feed = connection.changeFeed(16);
+    auto transaction = connection.beginTransaction();
+    connection.execute("INSERT INTO valid VALUES (1, 'one');"
+                       "SAVEPOINT s; INSERT INTO valid VALUES (2, 'two');"
+                       "SAVEPOINT \"Inner\"; UPDATE valid SET b = 'uno' WHERE a = 1;"
+                       "ROLLBACK TO s; INSERT INTO valid VALUES (3, 'three');"
+                       "SAVEPOINT t; DELETE FROM valid WHERE a = 3; RELEASE t;"
+                       "SAVEPOINT u; INSERT INTO valid VALUES (4, 'four'); RELEASE SAVEPOINT u;"
+                       "ROLLBACK TRANSACTION TO SAVEPOINT S;"
+                       "INSERT INTO valid VALUES (5, 'five'); RELEASE s;");
+    transaction.commit();
+    auto events = feed.drain();
+    REQUIRE(events.size() == 2);
+    CHECK(events[0].rowid == 1);
+    CHECK(events[1].rowid == 5);
+  }
+
+  SECTION("Statements starting with a comment are not taken for triggers") {
+    auto feed = connection.changeFeed(16);
+    auto transaction = connection.beginTransaction();
+    connection.execute("SAVEPOINT a; INSERT INTO valid VALUES (1, 'one');");
+    connection.prepare("-- undo\nROLLBACK TO a;").execute();
+    connection.execute("/* keep */ INSERT INTO valid VALUES (2, 'two'); RELEASE a;");
+    transaction.commit();
+    CHECK(connection.prepare("SELECT count(*) FROM valid;").execute().fetchColumn(0)->getInteger() == 1);
+    auto events = feed.drain();
+    REQUIRE(events.size() == 1);
+    CHECK(events[0].rowid == 2);
+  }
+
+  SECTION("Changes of failed statements are discarded") {
+    connection.execute("CREATE UNIQUE INDEX valid_b ON valid (b);");
+    auto feed = connection.changeFeed(16);
+    auto transaction = connection.beginTransaction();
+    connection.execute("INSERT INTO valid VALUES (1, 'one');");
+    CHECK_THROWS_AS(
+      connection.execute("INSERT INTO valid VALUES (2, 'two'), (3, 'one');"),
+      Y2KaoZ::Database::Sql::Sqlite3::Exception);
+    auto insert = connection.prepare("INSERT INTO valid VALUES (?1, ?2);");
+    CHECK_THROWS_AS(insert.bind(1, std::int64_t{4}).bind(2, std::string("one")).execute(), std::exception);
+    // OR FAIL keeps the rows inserted before the error.
+    CHECK_THROWS(connection.execute("INSERT OR FAIL INTO valid VALUES (6, 'six'), (7, 'one');"));
+    transaction.commit();
+    CHECK(connection.prepare("SELECT count(*) FROM valid;").execute().fetchColumn(0)->getInteger() == 2);
+    auto events = feed.drain();
+    REQUIRE(events.size() == 2);
+    CHECK(events[0].rowid == 1);
+    CHECK(events[1].rowid == 6);
+  }
+
+  SECTION("A full ring drops events instead of blocking the writer") {
+    auto feed = connection.changeFeed(4);
+    REQUIRE(feed.capacity() == 4);
+    connection.execute("WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 10)"
+                       "INSERT INTO valid SELECT i, i FROM n;");
+    CHECK(feed.dropped() == 6);
+    CHECK(feed.drain().size() == 4);
+  }
+
+  SECTION("Subscribers drain from another thread") {
+    auto feed = connection.changeFeed(1024);
+    std::size_t received = 0;
+    std::thread subscriber([&]() {
+      while (received < 100) {
+        received += feed.drain().size();
+      }
+    });
+    for (int i = 0; i < 100; ++i) {
+      connection.prepare("INSERT INTO valid (b) VALUES (?);").bind(1, i).execute();
+    }
+    subscriber.join();
+    CHECK(received == 100);
+  }
+
+  SECTION("Destroying the feed removes its hooks") {
+    {
+      auto feed = connection.changeFeed(16);
+    }
+    CHECK_NOTHROW(connection.execute("INSERT INTO valid VALUES (1, 'one');"));
+  }
+}
@@ -1,5 +1,7 @@
 #include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
 #include <catch2/catch_all.hpp>
+#include <fstream>
+#include <system_error>
 
 TEST_CASE("Connection Creation") { // NOLINT
   using Y2KaoZ::Database::Sql::Sqlite3::Connection;
@@ -55,4 +57,107 @@ TEST_CASE("Creating some data in :memory: database") { // NOLINT
     CHECK_THROWS_AS(connection.prepare("INSRT TO valid VALUES (?,?);"), Exception);
     CHECK_NOTHROW(connection.prepare("INSERT INTO valid VALUES (?,?);"));
   }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Executing SQL scripts") { // NOLINT
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::Exception;
+  using Y2KaoZ::Database::Sql::Sqlite3::ScriptOptions;
+  using Y2KaoZ::Database::Sql::Sqlite3::ScriptProgress;
+
+  std::filesystem::path script = std::filesystem::temp_directory_path() / "weirdFileNameToTestSqlScript.sql";
+  auto write = [&](const std::string& text) {
+    std::ofstream file(script, std::ios::binary | std::ios::trunc);
+    file << text;
+  };
+  Connection connection;
+
+  SECTION("Strings do not need to be null-terminated") {
+    std::string_view statements = "CREATE TABLE valid (a);INSERT INTO valid VALUES (1);garbage";
+    CHECK_NOTHROW(connection.execute(statements.substr(0, statements.size() - 7)));
+    CHECK(connection.lastInsertRowId() == 1);
+  }
+
+  SECTION("Statements are committed in batches and progress is reported") {
+    std::string text = "-- a dump\nCREATE TABLE valid (a INTEGER PRIMARY KEY, b TEXT);\n";
+    for (int i = 1; i <= 2500; ++i) {
+      text += "INSERT INTO valid VALUES (" + std::to_string(i) + ", '" + std::string(i % 50, 'x') + "');\n";
+    }
+    text += "CREATE TRIGGER t AFTER INSERT ON valid BEGIN SELECT 1; SELECT 2; END;\n/* trailing comment */";
+    write(text);
+
+    std::vector<ScriptProgress> reports;
+    ScriptOptions options;
+    options.batchSize = 1000;
+    options.progress = [&](const ScriptProgress& progress) {
+      CHECK(sqlite3_get_autocommit(connection.backend()) != 0);
+      reports.push_back(progress);
+    };
+    auto progress = connection.executeFile(script, options);
+    CHECK(progress.statements == 2502);
+    CHECK(progress.bytes == text.size());
+    CHECK(progress.totalBytes == text.size());
+    REQUIRE(reports.size() == 3);
+    CHECK(reports[0].statements == 1000);
+    CHECK(reports[1].statements == 2000);
+    CHECK(reports[2].bytes == text.size());
+    CHECK(connection.prepare("SELECT count(*) FROM valid;").execute().fetchColumn(0)->getInteger() == 2500);
+  }
+
+  SECTION("Statements longer than the read window") {
+    std::string longText(100000, 'y');
+    write("CREATE TABLE valid (a);INSERT INTO valid VALUES ('" + longText + "');");
+    CHECK(connection.executeFile(script).statements == 2);
+    CHECK(connection.prepare("SELECT a FROM valid;").execute().fetchColumn(0)->getString() == longText);
+  }
+
+  SECTION("Semicolons in literals and trigger bodies longer than the read window") {
+    std::string longText(10000, ';');
+    write("CREATE TABLE valid (a);CREATE TABLE copy (a);"
+          "CREATE TRIGGER copying AFTER INSERT ON valid BEGIN INSERT INTO copy VALUES ('[;]'); /* ; */ "
+          "INSERT INTO copy VALUES (new.a || '" +
+          longText + "'); END;"
+          "INSERT INTO valid VALUES ('" + longText + "');");
+    CHECK(connection.executeFile(script).statements == 4);
+    CHECK(connection.prepare("SELECT count(*) FROM copy;").execute().fetchColumn(0)->getInteger() == 2);
+    CHECK(connection.prepare("SELECT a FROM valid;").execute().fetchColumn(0)->getString() == longText);
+  }
+
+  SECTION("Errors before the end of the read window") {
+    std::string text = "CREATE TABLE valid (a);INSERT INTO valid VALUES (1);INSRT INTO valid VALUES (2);";
+    for (int i = 0; i < 1000; ++i) {
+      text += "INSERT INTO valid VALUES ('" + std::string(100, 'z') + "');";
+    }
+    write(text);
+    CHECK_THROWS_WITH(connection.executeFile(script), Catch::Contains("Error at byte 52") && Catch::Contains("INSRT"));
+    write("SELECT * FROM missing;INSERT INTO other VALUES ('" + std::string(100000, 'w') + "');");
+    CHECK_THROWS_WITH(connection.executeFile(script), Catch::Contains("no such table: missing"));
+  }
+
+  SECTION("Scripts that control their own transactions") {
+    write("PRAGMA foreign_keys=OFF;\nBEGIN TRANSACTION;\nCREATE TABLE valid (a);\n"
+          "INSERT INTO valid VALUES (1);\nINSERT INTO valid VALUES (2);\nCOMMIT;\nINSERT INTO valid VALUES (3);");
+    ScriptOptions options;
+    options.batchSize = 1;
+    CHECK(connection.executeFile(script, options).statements == 7);
+    CHECK(connection.prepare("SELECT count(*) FROM valid;").execute().fetchColumn(0)->getInteger() == 3);
+  }
+
+  SECTION("A failing statement rolls back its batch only") {
+    write("CREATE TABLE valid (a);INSERT INTO valid VALUES (1);INSERT INTO valid VALUES (2);INSRT INTO valid;");
+    ScriptOptions options;
+    options.batchSize = 2;
+    CHECK_THROWS_AS(connection.executeFile(script, options), Exception);
+    CHECK(sqlite3_get_autocommit(connection.backend()) != 0);
+    CHECK(connection.prepare("SELECT count(*) FROM valid;").execute().fetchColumn(0)->getInteger() == 1);
+  }
+
+  SECTION("Empty and missing files") {
+    write("");
+    CHECK(connection.executeFile(script).statements == 0);
+    std::filesystem::remove(script);
+    CHECK_THROWS_AS(connection.executeFile(script), std::system_error);
+  }
+
+  std::filesystem::remove(script);
+}
@@ -0,0 +1,114 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <catch2/catch_all.hpp>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+void writeFile(const std::filesystem::path& path, std::string_view content) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(content.data(), static_cast<std::streamsize>(content.size()));
+}
+
+[[nodiscard]] auto readFile(const std::filesystem::path& path) -> std::string {
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+} // namespace
+
+TEST_CASE("CSV import and export") { // NOLINT
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::CsvOptions;
+  using Y2KaoZ::Database::Sql::Sqlite3::Exception;
+  using Y2KaoZ::Database::Sql::Sqlite3::exportCsv;
+  using Y2KaoZ::Database::Sql::Sqlite3::importCsv;
+
+  auto input = std::filesystem::temp_directory_path() / "weirdFileNameToTestCsvImport.csv";
+  auto output = std::filesystem::temp_directory_path() / "weirdFileNameToTestCsvExport.csv";
+  Connection connection{};
+
+  SECTION("The table is created from the header") {
+    writeFile(input, "a,b\n1,one\r\n2,two\n\n3,\n");
+    auto stats = importCsv(connection, input, "fresh");
+    CHECK(stats.rows == 3);
+    CHECK(stats.bytes == 21);
+    auto rows = connection.prepare("SELECT a, b FROM fresh ORDER BY a;").execute().fetchAllVector();
+    REQUIRE(rows.size() == 3);
+    CHECK(rows[0][0].getString() == "1");
+    CHECK(rows[1][1].getString() == "two");
+    CHECK(rows[2][1].getString().empty());
+  }
+
+  SECTION("Quoted fields keep delimiters, newlines and quotes") {
+    writeFile(input, "a,b\n\"x,y\",\"line\none\"\n\"say \"\"hi\"\"\",\"\"\n");
+    connection.execute("CREATE TABLE quoted (a TEXT, b TEXT);");
+    CHECK(importCsv(connection, input, "quoted").rows == 2);
+    auto rows = connection.prepare("SELECT a, b FROM quoted ORDER BY rowid;").execute().fetchAllVector();
+    REQUIRE(rows.size() == 2);
+    CHECK(rows[0][0].getString() == "x,y");
+    CHECK(rows[0][1].getString() == "line\none");
+    CHECK(rows[1][0].getString() == "say \"hi\"");
+    CHECK(rows[1][1].getString().empty());
+  }
+
+  SECTION("Small chunks split records across workers") {
+    connection.execute("CREATE TABLE numbers (a INTEGER, b TEXT);");
+    std::string content;
+    for (int i = 0; i < 1000; ++i) {
+      content += std::to_string(i) + (i % 3 == 0 ? ",\"quoted\n,\"\"" + std::to_string(i) + "\"\"\"\n" : ",plain\n");
+    }
+    writeFile(input, content);
+    CsvOptions options;
+    options.header = false;
+    options.chunkSize = 7;
+    options.threads = 3;
+    options.batchSize = 64;
+    CHECK(importCsv(connection, input, "numbers", options).rows == 1000);
+    auto check = connection.prepare("SELECT count(*), sum(a), sum(b = 'quoted' || char(10) || ',\"' || a || '\"') "
+                                    "FROM numbers;")
+                   .execute()
+                   .fetchVector();
+    REQUIRE(check);
+    CHECK(check->at(0).getInteger() == 1000);
+    CHECK(check->at(1).getInteger() == 499500);
+    CHECK(check->at(2).getInteger() == 334);
+  }
+
+  SECTION("Rows round trip through an export") {
+    connection.execute("CREATE TABLE valid (a INTEGER, b REAL, c TEXT, d);"
+                       "INSERT INTO valid VALUES (1, 1.5, 'plain', NULL), (-2, 0.25, 'a,\"b\"', 'x'),"
+                       "(3, 2.0, 'multi' || char(10) || 'line', 'y');");
+    auto statement = connection.prepare("SELECT * FROM valid ORDER BY a;");
+    auto stats = exportCsv(statement, output);
+    CHECK(stats.rows == 3);
+    CHECK(readFile(output) == "a,b,c,d\n-2,0.25,\"a,\"\"b\"\"\",x\n1,1.5,plain,\n3,2,\"multi\nline\",y\n");
+    CHECK(stats.bytes == readFile(output).size());
+
+    CHECK(importCsv(connection, output, "copy").rows == 3);
+    auto rows = connection.prepare("SELECT c FROM copy ORDER BY CAST(a AS INTEGER);").execute().fetchAllVector();
+    REQUIRE(rows.size() == 3);
+    CHECK(rows[0][0].getString() == "a,\"b\"");
+    CHECK(rows[2][0].getString() == "multi\nline");
+  }
+
+  SECTION("Tab separated values") {
+    writeFile(input, "a\tb\n1\tx,y\n");
+    CsvOptions options;
+    options.delimiter = '\t';
+    CHECK(importCsv(connection, input, "tabs", options).rows == 1);
+    auto statement = connection.prepare("SELECT a, b FROM tabs;");
+    exportCsv(statement, output, options);
+    CHECK(readFile(output) == "a\tb\n1\tx,y\n");
+  }
+
+  SECTION("Records with the wrong number of fields are rejected") {
+    writeFile(input, "a,b\n1,2\n3\n");
+    CHECK_THROWS_AS(importCsv(connection, input, "broken"), Exception);
+  }
+
+  std::filesystem::remove(input);
+  std::filesystem::remove(output);
+}
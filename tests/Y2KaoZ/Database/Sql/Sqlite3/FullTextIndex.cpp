@@ -0,0 +1,129 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <catch2/catch_all.hpp>
+#include <fmt/format.h>
+#include <string>
+#include <vector>
+
+TEST_CASE("Full-text indexes") { // NOLINT
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::Exception;
+  using Y2KaoZ::Database::Sql::Sqlite3::FullTextHit;
+  using Y2KaoZ::Database::Sql::Sqlite3::FullTextIndex;
+  using Y2KaoZ::Database::Sql::Sqlite3::FullTextOptions;
+  using Y2KaoZ::Database::Sql::Sqlite3::SnippetOptions;
+  using Rowids = std::vector<std::int64_t>;
+  Connection connection{};
+  connection.execute("CREATE TABLE documents (id INTEGER PRIMARY KEY, title TEXT, body TEXT, views INTEGER);"
+                     "INSERT INTO documents VALUES"
+                     " (1, 'Sqlite internals', 'The pager reads pages from the database file.', 0),"
+                     " (2, 'Cooking', 'Bake the bread until golden.', 0);");
+
+  SECTION("Existing rows are indexed and changes follow through the triggers") {
+    FullTextIndex index{connection, "documents", {"title", "body"}};
+    CHECK(index.name() == "documents_fts");
+    CHECK(index.search("pager", 10) == Rowids{1});
+    connection.execute("INSERT INTO documents VALUES (3, 'Pagers', 'A pager pages people.', 0);");
+    CHECK(index.search("pager", 10).size() == 2);
+    connection.execute("UPDATE documents SET body = 'Bake the pager.' WHERE id = 2;");
+    CHECK(index.search("bread", 10).empty());
+    CHECK(index.search("pager", 10).size() == 3);
+    connection.execute("UPDATE documents SET views = 1;");
+    connection.execute("DELETE FROM documents WHERE id = 1;");
+    CHECK(index.search("pager", 10).size() == 2);
+    CHECK(index.search("internals", 10).empty());
+    index.check();
+  }
+
+  SECTION("Hits are ranked with snippets") {
+    FullTextOptions options;
+    options.weights = {10.0, 1.0};
+    FullTextIndex index{connection, "documents", {"title", "body"}, options};
+    connection.execute("INSERT INTO documents VALUES (3, 'Database pages', 'Nothing here.', 0);");
+    std::vector<FullTextHit> hits;
+    std::vector<std::string> snippets;
+    SnippetOptions snippet;
+    snippet.column = 1;
+    snippet.before = "<b>";
+    snippet.after = "</b>";
+    auto visited = index.search(
+      "database",
+      10,
+      [&](const FullTextHit& hit) {
+        hits.push_back(hit);
+        snippets.emplace_back(hit.snippet);
+        return true;
+      },
+      snippet);
+    REQUIRE(visited == 2);
+    // The title weighs more than the body.
+    CHECK(hits[0].rowid == 3);
+    CHECK(hits[1].rowid == 1);
+    CHECK(hits[0].score <= hits[1].score);
+    CHECK(snippets[1] == "The pager reads pages from the <b>database</b> file.");
+    CHECK(index.search("database", 1).size() == 1);
+    CHECK(index.search("database", 10, [](const FullTextHit&) { return false; }) == 1);
+  }
+
+  SECTION("Queries use the FTS5 syntax") {
+    FullTextOptions options;
+    options.prefix = "2";
+    FullTextIndex index{connection, "documents", {"title", "body"}, options};
+    CHECK(index.search("pag*", 10) == Rowids{1});
+    CHECK(index.search("title:cooking", 10) == Rowids{2});
+    CHECK(index.search("bread OR pager", 10).size() == 2);
+    CHECK(index.search("\"golden bread\"", 10).empty());
+    CHECK_THROWS_AS(index.search("AND", 10), Exception);
+    CHECK(index.search("bread", 10) == Rowids{2});
+  }
+
+  SECTION("Bulk loads index every row at once") {
+    FullTextIndex index{connection, "documents", {"title", "body"}, {}, "search"};
+    index.setAutomerge(0);
+    auto insert = connection.prepare("INSERT INTO documents (title, body) VALUES (?1, ?2);");
+    index.bulkLoad([&]() {
+      for (int i = 0; i < 1000; ++i) {
+        insert.bind(1, fmt::format("Title {}", i)).bind(2, fmt::format("word{} common", i % 10)).execute();
+      }
+    });
+    CHECK(index.search("common", 2000).size() == 1000);
+    CHECK(index.search("word3", 2000).size() == 100);
+    connection.execute("INSERT INTO documents (title, body) VALUES ('late', 'common');");
+    CHECK(index.search("common", 2000).size() == 1001);
+    for (int i = 0; i < 10; ++i) {
+      connection.execute(fmt::format("INSERT INTO documents (title, body) VALUES ('more', 'segment {}');", i));
+    }
+    static_cast<void>(index.merge(16));
+    index.optimize();
+    CHECK(!index.merge(16));
+    index.check();
+    CHECK_THROWS_AS(index.bulkLoad([]() { throw std::runtime_error("failed"); }), std::runtime_error);
+    CHECK(index.search("common", 2000).size() == 1001);
+  }
+
+  SECTION("Dropping removes the index and its triggers") {
+    FullTextIndex index{connection, "documents", {"title", "body"}};
+    index.drop();
+    connection.execute("INSERT INTO documents VALUES (3, 'After', 'drop', 0);");
+    CHECK(connection.prepare("SELECT count(*) FROM sqlite_schema WHERE name LIKE 'documents_fts%';")
+            .execute()
+            .fetchColumn(0)
+            ->getInteger() == 0);
+  }
+
+  SECTION("Missing tables and columns are rejected") {
+    CHECK_THROWS_AS(FullTextIndex(connection, "missing", {"title"}), Exception);
+    CHECK_THROWS_AS(FullTextIndex(connection, "documents", {}), std::invalid_argument);
+    CHECK_THROWS_AS(FullTextIndex(connection, "documents", {"title", "nosuch"}), Exception);
+    connection.execute("CREATE TABLE empty (a TEXT);");
+    CHECK_THROWS_AS(FullTextIndex(connection, "empty", {"nosuch"}), Exception);
+    FullTextOptions options;
+    options.tokenizer = "nosuch";
+    CHECK_THROWS_AS(FullTextIndex(connection, "documents", {"title"}, options), Exception);
+    // Nothing is left behind: the tables still accept rows.
+    connection.execute("INSERT INTO empty VALUES ('a'); INSERT INTO documents VALUES (3, 'Third', 'row', 0);");
+    CHECK(connection.prepare("SELECT count(*) FROM sqlite_schema WHERE name LIKE '%_fts%';")
+            .execute()
+            .fetchColumn(0)
+            ->getInteger() == 0);
+  }
+}
@@ -0,0 +1,86 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <catch2/catch_all.hpp>
+#include <string>
+
+TEST_CASE("JSON output") { // NOLINT
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::JsonBlobs;
+  using Y2KaoZ::Database::Sql::Sqlite3::JsonLayout;
+  using Y2KaoZ::Database::Sql::Sqlite3::JsonOptions;
+  Connection connection{};
+  connection.execute("CREATE TABLE valid (id INTEGER, \"the \"\"name\"\"\" TEXT, score REAL, data BLOB);"
+                     "INSERT INTO valid VALUES (1, 'one', 1.5, x'00ff10'), (2, NULL, 0.1, NULL);");
+  auto json = [&](const char* sql, const JsonOptions& options = {}) {
+    fmt::memory_buffer buffer;
+    auto statement = connection.prepare(sql);
+    statement.execute().writeJson(buffer, options);
+    return fmt::to_string(buffer);
+  };
+
+  SECTION("Rows are written as objects") {
+    CHECK(
+      json("SELECT * FROM valid;") ==
+      R"([{"id":1,"the \"name\"":"one","score":1.5,"data":"AP8Q"},)"
+      R"({"id":2,"the \"name\"":null,"score":0.1,"data":null}])");
+  }
+
+  SECTION("Rows are written as arrays and lines") {
+    JsonOptions options;
+    options.layout = JsonLayout::Arrays;
+    options.blobs = JsonBlobs::Hex;
+    CHECK(json("SELECT id, data FROM valid;", options) == R"([[1,"00ff10"],[2,null]])");
+    options.layout = JsonLayout::ObjectLines;
+    CHECK(json("SELECT id FROM valid;", options) == "{\"id\":1}\n{\"id\":2}\n");
+    options.layout = JsonLayout::ArrayLines;
+    CHECK(json("SELECT id FROM valid;", options) == "[1]\n[2]\n");
+  }
+
+  SECTION("Empty results are empty arrays") {
+    CHECK(json("SELECT * FROM valid WHERE id > 2;") == "[]");
+  }
+
+  SECTION("Strings are escaped") {
+    CHECK(json("SELECT 'a\"b\\c' || char(10, 9, 1) || 'é' AS s;") == "[{\"s\":\"a\\\"b\\\\c\\n\\t\\u0001é\"}]");
+  }
+
+  SECTION("Blobs are encoded in base64") {
+    CHECK(json("SELECT x'' AS a, x'66' AS b, x'666f' AS c, x'666f6f62' AS d;") ==
+          R"([{"a":"","b":"Zg==","c":"Zm8=","d":"Zm9vYg=="}])");
+  }
+
+  SECTION("Numbers follow the options") {
+    JsonOptions options;
+    options.layout = JsonLayout::Arrays;
+    CHECK(json("SELECT 9007199254740993, -9007199254740993, 1e308 * 10, 1.0 / 3;", options) ==
+          "[[9007199254740993,-9007199254740993,null,0.3333333333333333]]");
+    options.bigIntegersAsStrings = true;
+    options.realPrecision = 3;
+    CHECK(json("SELECT 9007199254740993, 9007199254740991, 1.0 / 3;", options) ==
+          R"([["9007199254740993",9007199254740991,0.333]])");
+    options.realPrecision = 1000;
+    CHECK(json("SELECT -1.0 / 3 * 1e-300, 1.0 / 3;", options) ==
+          "[[-3.3333333333333334e-301,0.33333333333333331]]");
+  }
+
+  SECTION("Callback sinks receive chunks") {
+    connection.execute("WITH RECURSIVE n(i) AS (SELECT 3 UNION ALL SELECT i + 1 FROM n WHERE i < 1000) "
+                       "INSERT INTO valid (id) SELECT i FROM n;");
+    JsonOptions options;
+    options.flushSize = 1024;
+    std::string output;
+    std::size_t chunks = 0;
+    auto statement = connection.prepare("SELECT * FROM valid;");
+    auto rows = statement.execute().writeJson(
+      [&](std::string_view chunk) {
+        output += chunk;
+        ++chunks;
+      },
+      options);
+    CHECK(rows == 1000);
+    CHECK(chunks > 10);
+    CHECK(output.front() == '[');
+    CHECK(output.back() == ']');
+    CHECK(output == json("SELECT * FROM valid;"));
+    CHECK(!statement.rows());
+  }
+}
@@ -0,0 +1,134 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <catch2/catch_all.hpp>
+#include <fmt/format.h>
+
+TEST_CASE("Key filters") { // NOLINT
+  using Y2KaoZ::Database::BlobView;
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::KeyFilter;
+  using Y2KaoZ::Database::Sql::Sqlite3::KeyFilterOptions;
+
+  std::filesystem::path tmp = std::filesystem::temp_directory_path() / "weirdFileNameToTestKeyFilter.sqlite3";
+  std::filesystem::remove(tmp);
+  Connection connection{tmp};
+  connection.execute("CREATE TABLE users (id INTEGER PRIMARY KEY, name TEXT, token BLOB) STRICT;"
+                     "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 10000) "
+                     "INSERT INTO users SELECT i * 2, 'user' || i, randomblob(8) FROM n;");
+
+  SECTION("Present keys always pass and most missing ones are filtered") {
+    KeyFilter filter{connection, "users", "id"};
+    for (std::int64_t i = 1; i <= 10000; ++i) {
+      REQUIRE(filter.mayContain(i * 2));
+    }
+    std::size_t passed = 0;
+    for (std::int64_t i = 0; i < 10000; ++i) {
+      passed += filter.contains(i * 2 + 1) ? 1 : 0;
+    }
+    CHECK(passed == 0);
+    auto stats = filter.stats();
+    CHECK(stats.keys == 10000);
+    CHECK(stats.capacity == 20000);
+    CHECK(stats.lookups == 20000);
+    CHECK(stats.filtered + stats.falsePositives == 10000);
+    CHECK(stats.falsePositiveRate() < 0.02);
+    CHECK(stats.expectedFalsePositiveRate() < 0.01);
+    CHECK(filter.stats(true).lookups == 20000);
+    CHECK(filter.stats().lookups == 0);
+  }
+
+  SECTION("Text and blob keys are filtered by type") {
+    KeyFilter names{connection, "users", "name"};
+    CHECK(names.contains(std::string_view("user42")));
+    CHECK(!names.contains(std::string_view("nobody")));
+    KeyFilter tokens{connection, "users", "token"};
+    auto token = connection.prepare("SELECT token FROM users WHERE id = 4;").execute().fetchColumn(0)->getBlob();
+    BlobView view = token;
+    CHECK(tokens.contains(view));
+  }
+
+  SECTION("Key columns must compare their bytes") {
+    connection.execute("CREATE TABLE tags (id INTEGER PRIMARY KEY, name TEXT COLLATE NOCASE, code TEXT COLLATE RTRIM,"
+                       " label TEXT COLLATE binary);");
+    CHECK_THROWS_AS(KeyFilter(connection, "tags", "name"), std::invalid_argument);
+    CHECK_THROWS_AS(KeyFilter(connection, "tags", "code"), std::invalid_argument);
+    CHECK_NOTHROW(KeyFilter(connection, "tags", "label"));
+    CHECK_NOTHROW(KeyFilter(connection, "tags", "id"));
+    CHECK_THROWS_AS(KeyFilter(connection, "tags", "missing"), Y2KaoZ::Database::Sql::Sqlite3::Exception);
+  }
+
+  SECTION("Lookups run the statement only for keys that may exist") {
+    KeyFilter filter{connection, "users", "name"};
+    auto statement = connection.prepare("SELECT id FROM users WHERE name = ?1;");
+    REQUIRE(filter.lookup(std::string_view("user7"), statement));
+    CHECK(statement.fetchColumn(0)->getInteger() == 14);
+    CHECK(!filter.lookup(std::string_view("user0"), statement));
+    CHECK(!statement.rows());
+  }
+
+  SECTION("Changes through the connection are followed") {
+    KeyFilter filter{connection, "users", "id"};
+    connection.execute("INSERT INTO users VALUES (1, 'odd', NULL);");
+    CHECK(filter.contains(std::int64_t{1}));
+    {
+      auto transaction = connection.beginTransaction();
+      connection.execute("INSERT INTO users VALUES (3, 'odd', NULL);");
+      CHECK(filter.contains(std::int64_t{3}));
+    }
+    CHECK(!filter.contains(std::int64_t{3}));
+    connection.execute("UPDATE users SET id = 5 WHERE id = 1;");
+    CHECK(filter.contains(std::int64_t{5}));
+    CHECK(filter.stats().rebuilds == 0);
+  }
+
+  SECTION("Changes by other connections rebuild the filter") {
+    KeyFilter filter{connection, "users", "id"};
+    CHECK(!filter.contains(std::int64_t{7}));
+    Connection other{tmp};
+    other.execute("INSERT INTO users VALUES (7, 'other', NULL);");
+    CHECK(filter.contains(std::int64_t{7}));
+    CHECK(filter.stats().rebuilds == 1);
+  }
+
+  SECTION("Deletes and growth rebuild the filter") {
+    KeyFilterOptions options;
+    options.rebuildRatio = 0.1;
+    KeyFilter filter{connection, "users", "id", options};
+    connection.execute("DELETE FROM users WHERE id <= 4000;");
+    CHECK(!filter.contains(std::int64_t{2}));
+    CHECK(filter.stats().rebuilds == 1);
+    CHECK(filter.stats().keys == 8000);
+    connection.execute("WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 20000) "
+                       "INSERT INTO users (name) SELECT 'new' || i FROM n;");
+    CHECK(filter.contains(std::int64_t{20001}));
+    CHECK(filter.stats().rebuilds == 2);
+    CHECK(filter.stats().capacity >= 56000);
+  }
+
+  SECTION("Filters built inside a transaction are rebuilt once it ends") {
+    connection.execute("CREATE TABLE t (id INTEGER PRIMARY KEY, k TEXT);"
+                       "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 100) "
+                       "INSERT INTO t SELECT i, 'key' || i FROM n;");
+    KeyFilter filter{connection, "t", "k"};
+    connection.execute("BEGIN;DELETE FROM t WHERE id <= 50;");
+    CHECK(!filter.contains(std::string_view("key5")));
+    CHECK(filter.stats().rebuilds == 1);
+    connection.execute("ROLLBACK;");
+    CHECK(filter.contains(std::string_view("key5")));
+
+    connection.execute("BEGIN;SAVEPOINT s;DELETE FROM t WHERE id <= 50;");
+    CHECK(!filter.contains(std::string_view("key6")));
+    connection.execute("ROLLBACK TO s;");
+    CHECK(filter.contains(std::string_view("key6")));
+    connection.execute("COMMIT;");
+    CHECK(filter.contains(std::string_view("key7")));
+  }
+
+  SECTION("In-memory databases are scanned through the connection") {
+    Connection memory{};
+    memory.execute("CREATE TABLE t (k TEXT); INSERT INTO t VALUES ('a'), ('b');");
+    KeyFilter filter{memory, "t", "k"};
+    CHECK(filter.contains(std::string_view("a")));
+    CHECK(filter.stats().keys == 2);
+  }
+  std::filesystem::remove(tmp);
+}
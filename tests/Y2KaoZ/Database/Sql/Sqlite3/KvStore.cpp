@@ -0,0 +1,129 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <catch2/catch_all.hpp>
+#include <string>
+#include <vector>
+
+TEST_CASE("Key-value stores") { // NOLINT
+  using Y2KaoZ::Database::BlobView;
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::KvEntry;
+  using Y2KaoZ::Database::Sql::Sqlite3::KvStore;
+  Connection connection{};
+  KvStore store{connection};
+  auto keys = [&](BlobView from, std::optional<BlobView> to) {
+    std::vector<std::string> visited;
+    store.scanRange(from, to, [&](BlobView key, BlobView) {
+      visited.emplace_back(KvStore::text(key));
+      return true;
+    });
+    return visited;
+  };
+
+  SECTION("Values are put, read and erased") {
+    CHECK(!store.get("missing"));
+    store.put("key", "one");
+    CHECK(store.get("key") == "one");
+    store.put("key", "two");
+    CHECK(store.get("key") == "two");
+    store.put("empty", "");
+    REQUIRE(store.get("empty"));
+    CHECK(store.get("empty")->empty());
+    CHECK(store.contains(KvStore::bytes("key")));
+    CHECK(store.size() == 2);
+    CHECK(store.erase("key"));
+    CHECK(!store.erase("key"));
+    CHECK(!store.contains(KvStore::bytes("key")));
+    CHECK(store.size() == 1);
+  }
+
+  SECTION("Binary keys and values are kept as is") {
+    const std::array<std::byte, 3> key{std::byte{0}, std::byte{0xff}, std::byte{0}};
+    const std::array<std::byte, 2> value{std::byte{0}, std::byte{1}};
+    store.put(key, value);
+    auto read = store.get(BlobView(key));
+    REQUIRE(read);
+    CHECK(std::ranges::equal(*read, value));
+    store.release();
+    CHECK(connection.prepare("SELECT typeof(key) FROM kv;").execute().fetchColumn(0)->getString() == "blob");
+  }
+
+  SECTION("Batches are applied in one transaction") {
+    std::vector<std::string> names{"a", "b", "c"};
+    std::vector<std::string> doubled{"aa", "bb", "cc"};
+    std::vector<KvEntry> entries;
+    for (std::size_t i = 0; i < names.size(); ++i) {
+      entries.push_back({KvStore::bytes(names[i]), KvStore::bytes(doubled[i])});
+    }
+    store.multiPut(entries);
+    CHECK(sqlite3_get_autocommit(connection.backend()) != 0);
+    std::vector<BlobView> lookups{KvStore::bytes("c"), KvStore::bytes("x"), KvStore::bytes("a")};
+    std::vector<std::optional<std::string>> values(lookups.size());
+    store.multiGet(lookups, [&](std::size_t i, std::optional<BlobView> value) {
+      if (value) {
+        values[i] = KvStore::text(*value);
+      }
+    });
+    CHECK(values[0] == "cc");
+    CHECK(!values[1]);
+    CHECK(values[2] == "aa");
+  }
+
+  SECTION("Batches join the current transaction") {
+    auto transaction = connection.beginTransaction();
+    std::vector<KvEntry> entries{{KvStore::bytes("a"), KvStore::bytes("1")}};
+    store.multiPut(entries);
+    transaction.rollBack();
+    CHECK(store.size() == 0);
+  }
+
+  SECTION("Failed batches leave the current transaction as it was") {
+    connection.execute(
+      "CREATE TRIGGER refuse BEFORE INSERT ON kv WHEN new.key = x'62' BEGIN SELECT RAISE(ABORT, 'b'); END;");
+    auto transaction = connection.beginTransaction();
+    store.put("before", "0");
+    std::vector<KvEntry> entries{
+      {KvStore::bytes("a"), KvStore::bytes("1")},
+      {KvStore::bytes("b"), KvStore::bytes("2")}};
+    CHECK_THROWS(store.multiPut(entries));
+    CHECK(!store.get("a"));
+    CHECK(store.get("before") == "0");
+    transaction.commit();
+    CHECK(store.size() == 1);
+  }
+
+  SECTION("Entries are scanned in key order") {
+    for (const auto* key : {"user:2", "user:10", "group:1", "user:", "users", "user;"}) {
+      store.put(key, key);
+    }
+    using Keys = std::vector<std::string>;
+    CHECK(keys(KvStore::bytes("user:"), {}) == Keys{"user:", "user:10", "user:2", "user;", "users"});
+    CHECK(keys(KvStore::bytes("a"), KvStore::bytes("user:2")) == Keys{"group:1", "user:", "user:10"});
+
+    std::vector<std::string> prefixed;
+    store.scanPrefix(KvStore::bytes("user:"), [&](BlobView key, BlobView value) {
+      CHECK(std::ranges::equal(key, value));
+      prefixed.emplace_back(KvStore::text(key));
+      return prefixed.size() < 2;
+    });
+    CHECK(prefixed == std::vector<std::string>{"user:", "user:10"});
+  }
+
+  SECTION("Prefixes ending with 0xff are scanned to the next prefix") {
+    const std::array<std::byte, 2> prefix{std::byte{1}, std::byte{0xff}};
+    const std::array<std::byte, 3> inside{std::byte{1}, std::byte{0xff}, std::byte{0xff}};
+    const std::array<std::byte, 1> after{std::byte{2}};
+    store.put(inside, inside);
+    store.put(after, after);
+    int visited = 0;
+    store.scanPrefix(prefix, [&](BlobView, BlobView) { return ++visited != 0; });
+    CHECK(visited == 1);
+  }
+
+  SECTION("Stores on the same table share their entries") {
+    store.put("shared", "yes");
+    KvStore other{connection};
+    CHECK(other.get("shared") == "yes");
+    KvStore separate{connection, "other kv"};
+    CHECK(!separate.get("shared"));
+  }
+}
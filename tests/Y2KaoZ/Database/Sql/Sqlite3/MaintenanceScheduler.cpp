@@ -0,0 +1,186 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <catch2/catch_all.hpp>
+#include <mutex>
+#include <thread>
+#if __has_include(<fcntl.h>)
+#include <fcntl.h>
+#endif
+#ifdef F_OFD_GETLK
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Polls the stats of scheduler until done accepts them or a few seconds went by.
+template <typename Done>
+auto waitFor(const Y2KaoZ::Database::Sql::Sqlite3::MaintenanceScheduler& scheduler, Done done)
+  -> Y2KaoZ::Database::Sql::Sqlite3::MaintenanceStats {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  auto stats = scheduler.stats();
+  while (!done(stats) && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    stats = scheduler.stats();
+  }
+  return stats;
+}
+
+} // namespace
+
+TEST_CASE("WAL checkpoints and maintenance") { // NOLINT
+  using Y2KaoZ::Database::Sql::Sqlite3::CheckpointMode;
+  using Y2KaoZ::Database::Sql::Sqlite3::CheckpointReport;
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::MaintenanceOptions;
+  using Y2KaoZ::Database::Sql::Sqlite3::MaintenanceScheduler;
+  using Y2KaoZ::Database::Sql::Sqlite3::MaintenanceStats;
+
+  std::filesystem::path tmp = std::filesystem::temp_directory_path() / "weirdFileNameToTestMaintenance.sqlite3";
+  std::filesystem::path wal = tmp.string() + "-wal";
+  std::filesystem::remove(tmp);
+  Connection writer{tmp};
+  // RESTART and TRUNCATE checkpoints hold the writers back while they wait for the readers.
+  sqlite3_busy_timeout(writer.backend(), 5000);
+  writer.execute("PRAGMA auto_vacuum=INCREMENTAL;"
+                 "PRAGMA journal_mode=WAL;"
+                 "PRAGMA wal_autocheckpoint=0;"
+                 "CREATE TABLE valid (a INTEGER PRIMARY KEY, b);");
+  auto write = [&](int rows) {
+    auto insert = writer.prepare("INSERT INTO valid (b) VALUES (randomblob(1000));");
+    for (int i = 0; i < rows; ++i) {
+      insert.execute().reset();
+    }
+  };
+
+  SECTION("Checkpoints run directly") {
+    MaintenanceOptions options;
+    options.pollInterval = {};
+    MaintenanceScheduler scheduler{tmp, options};
+    write(50);
+    auto passive = scheduler.checkpoint(CheckpointMode::Passive);
+    CHECK(passive.mode == CheckpointMode::Passive);
+    CHECK(passive.framesMoved >= 50);
+    CHECK(passive.walFrames == passive.framesMoved);
+    CHECK_FALSE(passive.busy);
+    write(10);
+    auto truncate = scheduler.checkpoint(CheckpointMode::Truncate);
+    CHECK(truncate.framesMoved > 0);
+    CHECK(std::filesystem::file_size(wal) == 0);
+    auto stats = scheduler.stats();
+    CHECK(stats.checkpoints == 2);
+    CHECK(stats.framesMoved == passive.framesMoved + truncate.framesMoved);
+    CHECK(stats.checkpointTime >= stats.maxCheckpointTime);
+    CHECK(stats.lastCheckpoint->mode == CheckpointMode::Truncate);
+  }
+
+  SECTION("Readers make checkpoints busy") {
+    MaintenanceOptions options;
+    options.pollInterval = {};
+    options.busyTimeout = std::chrono::milliseconds(10);
+    MaintenanceScheduler scheduler{tmp, options};
+    write(10);
+    Connection reader{tmp};
+    auto transaction = reader.beginTransaction();
+    CHECK(reader.prepare("SELECT count(*) FROM valid;").execute().fetchColumn(0)->getInteger() == 10);
+    write(10);
+    CHECK(scheduler.checkpoint(CheckpointMode::Restart).busy);
+    CHECK(scheduler.stats().busyCheckpoints == 1);
+  }
+
+#ifdef F_OFD_GETLK
+  SECTION("Measuring the WAL keeps the locks of the wal-index") {
+    MaintenanceOptions options;
+    options.pollInterval = {};
+    MaintenanceScheduler scheduler{tmp, options};
+    write(10);
+    CHECK(scheduler.checkpoint(CheckpointMode::Passive).framesMoved >= 10);
+    // Every connection using the wal-index holds a shared lock on its byte 128. Locks of open file descriptions
+    // conflict with the POSIX locks of the same process, unlike POSIX locks.
+    auto descriptor = ::open((tmp.string() + "-shm").c_str(), O_RDONLY | O_CLOEXEC); // NOLINT
+    REQUIRE(descriptor >= 0);
+    struct flock shared {};
+    shared.l_type = F_WRLCK;
+    shared.l_whence = SEEK_SET;
+    shared.l_start = 128;
+    shared.l_len = 1;
+    CHECK(::fcntl(descriptor, F_OFD_GETLK, &shared) == 0); // NOLINT(cppcoreguidelines-pro-type-vararg)
+    CHECK(shared.l_type == F_RDLCK);
+    ::close(descriptor);
+  }
+#endif
+
+  SECTION("Passive checkpoints follow the size of the WAL") {
+    std::vector<CheckpointReport> reports;
+    std::mutex mutex;
+    MaintenanceOptions options;
+    options.pollInterval = std::chrono::milliseconds(5);
+    options.checkpointFrames = 100;
+    options.idleTime = {};
+    options.onCheckpoint = [&](const CheckpointReport& report) {
+      std::scoped_lock lock(mutex);
+      reports.push_back(report);
+    };
+    MaintenanceScheduler scheduler{tmp, options};
+    write(50);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(scheduler.stats().checkpoints == 0);
+    write(100);
+    auto stats = waitFor(scheduler, [](const MaintenanceStats& s) { return s.checkpoints > 0; });
+    REQUIRE(stats.checkpoints > 0);
+    CHECK(stats.lastCheckpoint->mode == CheckpointMode::Passive);
+    CHECK(stats.framesMoved >= 100);
+    scheduler.stop();
+    std::scoped_lock lock(mutex);
+    CHECK(reports.size() == stats.checkpoints);
+  }
+
+  SECTION("Idle databases are checkpointed") {
+    MaintenanceOptions options;
+    options.pollInterval = std::chrono::milliseconds(5);
+    options.idleTime = std::chrono::milliseconds(20);
+    MaintenanceScheduler scheduler{tmp, options};
+    write(5);
+    auto stats = waitFor(scheduler, [](const MaintenanceStats& s) { return s.framesMoved >= 5; });
+    CHECK(stats.framesMoved >= 5);
+    // Nothing is written anymore, the WAL is left alone.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(scheduler.stats().checkpoints == stats.checkpoints);
+  }
+
+  SECTION("Large WAL files are truncated") {
+    MaintenanceOptions options;
+    options.pollInterval = std::chrono::milliseconds(5);
+    options.walSizeLimit = 64ULL * 1024ULL;
+    write(100);
+    REQUIRE(std::filesystem::file_size(wal) > options.walSizeLimit);
+    MaintenanceScheduler scheduler{tmp, options};
+    auto stats = waitFor(scheduler, [](const MaintenanceStats& s) {
+      return s.lastCheckpoint && s.lastCheckpoint->mode == CheckpointMode::Truncate && !s.lastCheckpoint->busy;
+    });
+    REQUIRE(stats.lastCheckpoint);
+    CHECK(stats.lastCheckpoint->mode == CheckpointMode::Truncate);
+    CHECK(stats.lastCheckpoint->framesMoved >= 100);
+    CHECK(std::filesystem::file_size(wal) == 0);
+  }
+
+  SECTION("Optimize and incremental vacuum run on schedule") {
+    write(100);
+    writer.execute("DELETE FROM valid;");
+    MaintenanceOptions options;
+    options.pollInterval = std::chrono::milliseconds(5);
+    options.optimizeInterval = std::chrono::milliseconds(10);
+    options.vacuumInterval = std::chrono::milliseconds(10);
+    options.vacuumPages = 0;
+    MaintenanceScheduler scheduler{tmp, options};
+    auto stats =
+      waitFor(scheduler, [](const MaintenanceStats& s) { return s.optimizations > 0 && s.pagesVacuumed > 0; });
+    CHECK(stats.optimizations > 0);
+    CHECK(stats.pagesVacuumed > 0);
+    CHECK(stats.errors == 0);
+    CHECK(writer.prepare("PRAGMA freelist_count;").execute().fetchColumn(0)->getInteger() == 0);
+  }
+
+  writer = Connection{};
+  std::filesystem::remove(tmp);
+  std::filesystem::remove(wal);
+  std::filesystem::remove(tmp.string() + "-shm");
+}
@@ -0,0 +1,97 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <catch2/catch_all.hpp>
+#include <cstring>
+
+TEST_CASE("Memory accounting") { // NOLINT
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::Exception;
+  using Y2KaoZ::Database::Sql::Sqlite3::setSoftHeapLimit;
+
+  SECTION("Connections report their memory") {
+    Connection connection{};
+    connection.execute("CREATE TABLE valid (a INTEGER PRIMARY KEY, b);"
+                       "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 1000)"
+                       "INSERT INTO valid SELECT i, 'row ' || i FROM n;");
+    auto statement = connection.prepare("SELECT b FROM valid WHERE a = ?;");
+    for (int i = 1; i <= 100; ++i) {
+      CHECK(statement.bind(1, i).execute().fetchAllVector().size() == 1);
+    }
+    auto stats = connection.memoryStats(true);
+    CHECK(stats.cacheUsed > 0);
+    CHECK(stats.schemaUsed > 0);
+    CHECK(stats.statementUsed > 0);
+    CHECK(stats.cacheHits > 0);
+    CHECK(stats.memoryUsed > 0);
+    CHECK(stats.memoryHighwater >= stats.memoryUsed);
+    CHECK(stats.mallocCount > 0);
+    CHECK(stats.largestAllocation > 0);
+    CHECK(connection.memoryStats().cacheHits == 0);
+  }
+
+  SECTION("Lookaside is sized per connection") {
+    Connection connection{};
+    connection.setLookaside(256, 64);
+    connection.execute("CREATE TABLE valid (a INTEGER PRIMARY KEY, b);"
+                       "INSERT INTO valid VALUES (1, 'one');");
+    // Some builds of sqlite leave lookaside out, configuring it is then a no-op.
+    if (sqlite3_compileoption_used("OMIT_LOOKASIDE") == 0) {
+      CHECK(connection.memoryStats().lookasideHits > 0);
+      auto statement = connection.prepare("SELECT * FROM valid;");
+      CHECK_THROWS_AS(connection.setLookaside(128, 16), Exception);
+    }
+  }
+
+  SECTION("The soft heap limit is reported") {
+    auto previous = setSoftHeapLimit(64LL * 1024 * 1024);
+    CHECK(Connection{}.memoryStats().softHeapLimit == 64LL * 1024 * 1024);
+    CHECK(setSoftHeapLimit(previous) == 64LL * 1024 * 1024);
+  }
+}
+
+TEST_CASE("Custom allocators") { // NOLINT
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::installAllocator;
+  using Y2KaoZ::Database::Sql::Sqlite3::installedAllocator;
+  using Y2KaoZ::Database::Sql::Sqlite3::SizeClassAllocator;
+
+  SECTION("Size classes") {
+    SizeClassAllocator allocator{4096 + 8};
+    auto* small = allocator.allocate(10);
+    REQUIRE(small != nullptr);
+    CHECK(allocator.size(small) == 16);
+    CHECK(allocator.roundUp(100) == 128);
+    CHECK(allocator.roundUp(5000) == 5000);
+    std::memcpy(small, "0123456789", 10);
+    auto* grown = allocator.reallocate(small, 300);
+    REQUIRE(grown != nullptr);
+    CHECK(allocator.size(grown) == 512);
+    CHECK(std::memcmp(grown, "0123456789", 10) == 0);
+    auto* large = allocator.allocate(10000);
+    CHECK(allocator.size(large) == 10000);
+    CHECK(allocator.bytesInUse() == 10512);
+    // Freed blocks are reused by their class.
+    allocator.deallocate(grown);
+    CHECK(allocator.allocate(400) == grown);
+    allocator.deallocate(grown);
+    allocator.deallocate(large);
+    CHECK(allocator.bytesInUse() == 0);
+  }
+
+  SECTION("sqlite allocates from the installed allocator") {
+    auto allocator = std::make_shared<SizeClassAllocator>();
+    installAllocator(allocator);
+    CHECK(installedAllocator() == allocator);
+    {
+      Connection connection{};
+      connection.execute("CREATE TABLE valid (a INTEGER PRIMARY KEY, b);"
+                         "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 1000)"
+                         "INSERT INTO valid SELECT i, 'row ' || i FROM n;");
+      CHECK(allocator->bytesInUse() > 0);
+      CHECK(connection.prepare("SELECT count(*) FROM valid;").execute().fetchColumn(0)->getInteger() == 1000);
+    }
+    installAllocator(nullptr);
+    CHECK(installedAllocator() == nullptr);
+    CHECK(allocator->bytesInUse() == 0);
+    CHECK(Connection{}.memoryStats().memoryUsed > 0);
+  }
+}
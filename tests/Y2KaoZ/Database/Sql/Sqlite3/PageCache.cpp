@@ -0,0 +1,85 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <catch2/catch_all.hpp>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Shared page cache") { // NOLINT
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::installPageCache;
+  using Y2KaoZ::Database::Sql::Sqlite3::pageCacheInstalled;
+  using Y2KaoZ::Database::Sql::Sqlite3::pageCacheStats;
+  using Y2KaoZ::Database::Sql::Sqlite3::removePageCache;
+  using Y2KaoZ::Database::Sql::Sqlite3::setPageCacheBudget;
+
+  constexpr std::size_t BUDGET = 512ULL * 1024ULL;
+  std::filesystem::path tmp = std::filesystem::temp_directory_path() / "weirdFileNameToTestPageCache.sqlite3";
+  std::filesystem::remove(tmp);
+  installPageCache(BUDGET);
+  REQUIRE(pageCacheInstalled());
+  {
+    Connection connection{tmp};
+    connection.execute("CREATE TABLE hot (a INTEGER PRIMARY KEY, b);"
+                       "CREATE TABLE cold (a INTEGER PRIMARY KEY, b);"
+                       "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 200)"
+                       "INSERT INTO hot SELECT i, randomblob(100) FROM n;"
+                       "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 4000)"
+                       "INSERT INTO cold SELECT i, randomblob(500) FROM n;");
+  }
+
+  SECTION("Connections share one budget") {
+    std::vector<std::int64_t> sums(4);
+    {
+      std::vector<std::jthread> readers;
+      for (auto& sum : sums) {
+        readers.emplace_back([&]() {
+          Connection reader{tmp};
+          for (int round = 0; round < 3; ++round) {
+            sum += reader.prepare("SELECT sum(length(b)) FROM cold;").execute().fetchColumn(0)->getInteger();
+          }
+        });
+      }
+    }
+    CHECK(sums == std::vector<std::int64_t>(4, 3 * 4000 * 500));
+    auto stats = pageCacheStats();
+    CHECK(stats.memoryBudget == BUDGET);
+    CHECK(stats.memoryUsed <= BUDGET);
+    CHECK(stats.evictions > 0);
+    CHECK(stats.pinned == 0);
+    setPageCacheBudget(BUDGET / 4);
+    CHECK(pageCacheStats().memoryUsed <= BUDGET / 4);
+    setPageCacheBudget(BUDGET);
+  }
+
+  SECTION("Scans do not evict the hot pages") {
+    Connection connection{tmp};
+    auto hot = connection.prepare("SELECT b FROM hot WHERE a = ?;");
+    for (int round = 0; round < 2; ++round) {
+      for (int i = 1; i <= 200; ++i) {
+        CHECK(hot.bind(1, i).execute().fetchAllVector().size() == 1);
+      }
+    }
+    CHECK(connection.prepare("SELECT sum(length(b)) FROM cold;").execute().fetchColumn(0)->getInteger() == 2000000);
+    CHECK(pageCacheStats(true).evictions > 0);
+    for (int i = 1; i <= 200; ++i) {
+      CHECK(hot.bind(1, i).execute().fetchAllVector().size() == 1);
+    }
+    auto stats = pageCacheStats();
+    CHECK(stats.misses == 0);
+    CHECK(stats.hits > 0);
+    CHECK(stats.hitRatio() == 1.0);
+  }
+
+  SECTION("In-memory databases are never evicted") {
+    Connection connection{};
+    connection.execute("CREATE TABLE valid (a INTEGER PRIMARY KEY, b);"
+                       "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 4000)"
+                       "INSERT INTO valid SELECT i, randomblob(500) FROM n;");
+    CHECK(connection.prepare("SELECT count(*) FROM valid;").execute().fetchColumn(0)->getInteger() == 4000);
+    CHECK(pageCacheStats().pages * 4096 > BUDGET);
+  }
+
+  removePageCache();
+  CHECK_FALSE(pageCacheInstalled());
+  CHECK(Connection{tmp}.prepare("SELECT count(*) FROM hot;").execute().fetchColumn(0)->getInteger() == 200);
+  std::filesystem::remove(tmp);
+}
@@ -0,0 +1,115 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <catch2/catch_all.hpp>
+
+TEST_CASE("Paged queries") { // NOLINT
+  using Y2KaoZ::Database::ParamVector;
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::Page;
+  using Y2KaoZ::Database::Sql::Sqlite3::PagedQuery;
+
+  Connection connection{};
+  connection.execute("CREATE TABLE items (id INTEGER PRIMARY KEY, grp INTEGER NOT NULL, name TEXT NOT NULL) STRICT;"
+                     "CREATE INDEX items_grp ON items (grp, id);"
+                     "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 1000) "
+                     "INSERT INTO items SELECT i, i % 7, 'item' || i FROM n;");
+
+  auto ids = [](const Page& page) {
+    std::vector<std::int64_t> result;
+    for (const auto& row : page.rows) {
+      result.push_back(row.at(0).getInteger());
+    }
+    return result;
+  };
+
+  SECTION("Pages follow each other forward and backward") {
+    PagedQuery query{connection, "SELECT id, name FROM items;", {{"id"}}, 300};
+    CHECK(query.pageSize() == 300);
+    auto page = query.first();
+    CHECK(page.rows.size() == 300);
+    CHECK(page.rows.front().at(0).getInteger() == 1);
+    CHECK(page.previous.empty());
+    std::vector<std::int64_t> all = ids(page);
+    while (!page.next.empty()) {
+      page = query.page(page.next);
+      auto more = ids(page);
+      all.insert(all.end(), more.begin(), more.end());
+    }
+    CHECK(all.size() == 1000);
+    CHECK(std::is_sorted(all.begin(), all.end()));
+    CHECK(page.rows.size() == 100);
+    CHECK(page.next.empty());
+
+    auto previous = query.page(page.previous);
+    CHECK(ids(previous).front() == 601);
+    CHECK(ids(previous).back() == 900);
+    CHECK(!previous.next.empty());
+    CHECK(ids(query.page(previous.next)) == ids(page));
+
+    auto last = query.last();
+    CHECK(last.rows.size() == 300);
+    CHECK(ids(last).front() == 701);
+    CHECK(ids(last).back() == 1000);
+    CHECK(last.next.empty());
+    auto back = query.page(query.page(query.page(last.previous).previous).previous);
+    CHECK(back.rows.size() == 100);
+    CHECK(ids(back).front() == 1);
+    CHECK(ids(back).back() == 100);
+    CHECK(back.previous.empty());
+  }
+
+  SECTION("Resuming searches the index instead of skipping rows") {
+    PagedQuery query{connection, "SELECT * FROM items WHERE grp = ?1", {{"grp"}, {"id"}}, 10};
+    auto plan = query.queryPlan();
+    CHECK(!plan.usesTempBTree());
+    CHECK(plan.fullScans().empty());
+    CHECK(plan.toString().find("items_grp") != std::string::npos);
+    auto page = query.page(query.first(ParamVector{std::int64_t{3}}).next, ParamVector{std::int64_t{3}});
+    CHECK(ids(page).front() == 73);
+    CHECK(page.rows.front().at(1).getInteger() == 3);
+  }
+
+  SECTION("Keys can be text and descending") {
+    PagedQuery query{connection, "SELECT id, grp, name FROM items", {{"grp", true}, {"name"}}, 200};
+    auto first = query.first();
+    CHECK(first.rows.front().at(2).getString() == "item1000");
+    std::size_t rows = first.rows.size();
+    for (auto page = query.page(first.next); !page.rows.empty(); page = query.page(page.next)) {
+      rows += page.rows.size();
+      if (page.next.empty()) {
+        CHECK(page.rows.back().at(2).getString() == "item994");
+        break;
+      }
+    }
+    CHECK(rows == 1000);
+    auto last = query.last();
+    CHECK(last.rows.back().at(2).getString() == "item994");
+    CHECK(query.page(last.previous).rows.back().at(1).getInteger() == 1);
+  }
+
+  SECTION("Tokens survive changes to the table") {
+    PagedQuery query{connection, "SELECT id FROM items", {{"id"}}, 10};
+    auto page = query.first();
+    connection.execute("DELETE FROM items WHERE id <= 15;");
+    CHECK(ids(query.page(page.next)).front() == 16);
+    connection.execute("DELETE FROM items;");
+    auto empty = query.page(page.next);
+    CHECK(empty.rows.empty());
+    CHECK(empty.next.empty());
+    CHECK(empty.previous.empty());
+  }
+
+  SECTION("Invalid arguments are rejected") {
+    CHECK_THROWS_AS((PagedQuery{connection, "SELECT id FROM items", {}}), std::invalid_argument);
+    CHECK_THROWS_AS((PagedQuery{connection, "SELECT id FROM items", {{"grp"}}}), std::invalid_argument);
+    CHECK_THROWS_AS((PagedQuery{connection, "SELECT id FROM items", {{"id"}}, 0}), std::invalid_argument);
+    PagedQuery query{connection, "SELECT id FROM items", {{"id"}}, 10};
+    CHECK_THROWS_AS(query.page("not a token"), std::invalid_argument);
+    CHECK_THROWS_AS(query.page(query.first().next.substr(0, 10)), std::invalid_argument);
+    // Lengths larger than the rest of the token are rejected before anything is allocated for them.
+    CHECK_THROWS_AS(query.page("asffffffff"), std::invalid_argument);
+    CHECK_THROWS_AS(query.page("bbffffffff00"), std::invalid_argument);
+    PagedQuery twoKeys{connection, "SELECT id, grp FROM items", {{"grp"}, {"id"}}, 10};
+    CHECK_THROWS_AS(twoKeys.page(query.first().next), std::invalid_argument);
+    CHECK_THROWS_AS(query.first(ParamVector{std::int64_t{1}}), std::out_of_range);
+  }
+}
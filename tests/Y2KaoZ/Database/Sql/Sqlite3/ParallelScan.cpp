@@ -0,0 +1,73 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <catch2/catch_all.hpp>
+#include <limits>
+
+TEST_CASE("Parallel partitioned scans") { // NOLINT
+  using Y2KaoZ::Database::ResultType;
+  using Y2KaoZ::Database::ResultVector;
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::ParallelScan;
+
+  std::filesystem::path tmp = std::filesystem::temp_directory_path() / "weirdFileNameToTestParallelScan.sqlite3";
+  std::filesystem::remove(tmp);
+  {
+    Connection connection{tmp};
+    connection.execute("CREATE TABLE valid (a INTEGER PRIMARY KEY, b);"
+                       "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 1000)"
+                       "INSERT INTO valid SELECT i, i % 7 FROM n;");
+  }
+
+  SECTION("Partitions cover every key") {
+    ParallelScan scan{tmp, "valid", "a"};
+    scan.partition(4);
+    const auto& partitions = scan.partitions();
+    REQUIRE(!partitions.empty());
+    REQUIRE(partitions.size() <= 4);
+    CHECK(partitions.front().first == std::numeric_limits<std::int64_t>::min());
+    CHECK(partitions.back().last == std::numeric_limits<std::int64_t>::max());
+    for (std::size_t i = 1; i < partitions.size(); ++i) {
+      CHECK(partitions[i - 1].last + 1 == partitions[i].first);
+    }
+  }
+
+  SECTION("Unordered concatenation") {
+    ParallelScan scan{tmp, "valid"};
+    scan.partition(4);
+    auto rows = scan.fetchAll("SELECT a FROM valid WHERE rowid BETWEEN :first AND :last;");
+    CHECK(rows.size() == 1000);
+  }
+
+  SECTION("Ordered merge") {
+    ParallelScan scan{tmp, "valid"};
+    scan.partition(3);
+    auto rows = scan.fetchAllOrdered(
+      "SELECT b, a FROM valid WHERE rowid BETWEEN :first AND :last AND b > :min ORDER BY b, a;",
+      [](const ResultVector& l, const ResultVector& r) {
+        return std::pair{l[0].asInteger64(), l[1].asInteger64()} < std::pair{r[0].asInteger64(), r[1].asInteger64()};
+      },
+      {{":min", 3}});
+    REQUIRE(rows.size() == 429);
+    CHECK(std::is_sorted(rows.begin(), rows.end(), [](const ResultVector& l, const ResultVector& r) {
+      return l[0].asInteger64() < r[0].asInteger64();
+    }));
+    CHECK(rows.front()[0].asInteger64() == 4);
+    CHECK(rows.back()[0].asInteger64() == 6);
+  }
+
+  SECTION("Aggregates with a combine step") {
+    ParallelScan scan{tmp, "valid"};
+    scan.partition(4);
+    auto total = scan.aggregate(
+      "SELECT count(*), sum(a) FROM valid WHERE rowid BETWEEN :first AND :last;",
+      [](ResultVector accumulated, const ResultVector& row) {
+        return ResultVector{
+          ResultType(accumulated[0].asInteger64() + row[0].asInteger64()),
+          ResultType(accumulated[1].asInteger64() + row[1].asInteger64())};
+      });
+    REQUIRE(total);
+    CHECK(total->at(0).asInteger64() == 1000);
+    CHECK(total->at(1).asInteger64() == 500500);
+  }
+
+  std::filesystem::remove(tmp);
+}
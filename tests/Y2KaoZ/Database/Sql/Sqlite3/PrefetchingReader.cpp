@@ -0,0 +1,62 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <catch2/catch_all.hpp>
+
+TEST_CASE("Prefetching readers") { // NOLINT
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::Exception;
+  using Y2KaoZ::Database::Sql::Sqlite3::PrefetchingReader;
+
+  Connection connection{};
+  connection.execute("CREATE TABLE valid (a INTEGER PRIMARY KEY, b);"
+                     "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 1000)"
+                     "INSERT INTO valid SELECT i, 'row ' || i FROM n;");
+
+  SECTION("Rows arrive in order across batches") {
+    PrefetchingReader reader{connection.prepare("SELECT a, b FROM valid ORDER BY a;"), 7, 2};
+    std::int64_t expected = 1;
+    while (const auto* row = reader.next()) {
+      REQUIRE(row->size() == 2);
+      CHECK(row->at(0).getInteger() == expected);
+      ++expected;
+    }
+    CHECK(expected == 1001);
+    CHECK(reader.next() == nullptr);
+    CHECK(!reader.fetchVector());
+  }
+
+  SECTION("Bound parameters are kept") {
+    auto statement = connection.prepare("SELECT b FROM valid WHERE a > ?;");
+    statement.bind(1, 990);
+    PrefetchingReader reader{std::move(statement)};
+    auto first = reader.fetchVector();
+    REQUIRE(first);
+    CHECK(first->at(0).getString() == "row 991");
+    CHECK(reader.fetchAllVector().size() == 9);
+  }
+
+  SECTION("Empty result sets") {
+    PrefetchingReader reader{connection.prepare("SELECT * FROM valid WHERE a < 0;")};
+    CHECK(reader.fetchAllVector().empty());
+  }
+
+  SECTION("Cancellation stops the producer") {
+    PrefetchingReader reader{connection.prepare("SELECT * FROM valid;"), 1, 1};
+    CHECK(reader.next() != nullptr);
+    reader.cancel();
+    CHECK(reader.next() == nullptr);
+  }
+
+  SECTION("Readers that are not drained are cancelled by the destructor") {
+    PrefetchingReader reader{connection.prepare("SELECT * FROM valid;"), 1, 1};
+  }
+
+  SECTION("Producer errors are rethrown after the rows read before them") {
+    connection.execute("CREATE TABLE numbers (n);"
+                       "INSERT INTO numbers VALUES (1), (2), ('not json');");
+    PrefetchingReader reader{connection.prepare("SELECT json(n) FROM numbers;"), 4, 1};
+    // Like Statement, stepping to the faulty row fails while the previous row is fetched.
+    CHECK(reader.next() != nullptr);
+    CHECK_THROWS_AS(reader.next(), Exception);
+    CHECK(reader.next() == nullptr);
+  }
+}
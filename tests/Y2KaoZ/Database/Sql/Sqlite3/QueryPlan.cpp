@@ -0,0 +1,75 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Testing/QueryPlanMatchers.hpp"
+#include <catch2/catch_all.hpp>
+
+TEST_CASE("Query plans") { // NOLINT
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::QueryPlan;
+  using Y2KaoZ::Database::Sql::Sqlite3::QueryPlanNode;
+  using Y2KaoZ::Database::Sql::Sqlite3::Testing::UsesIndexes;
+  using Kind = QueryPlanNode::Kind;
+
+  Connection connection{};
+  connection.execute("CREATE TABLE valid (a INTEGER PRIMARY KEY, b, c);"
+                     "CREATE INDEX validB ON valid (b);"
+                     "CREATE TABLE other (x, y);");
+
+  SECTION("Details are parsed") {
+    auto scan = QueryPlanNode::parse("SCAN valid");
+    CHECK(scan.kind == Kind::Scan);
+    CHECK(scan.table == "valid");
+    CHECK(scan.index.empty());
+    auto covering = QueryPlanNode::parse("SEARCH valid USING COVERING INDEX validB (b=?)");
+    CHECK(covering.kind == Kind::Search);
+    CHECK(covering.index == "validB");
+    CHECK(covering.coveringIndex);
+    auto rowid = QueryPlanNode::parse("SEARCH valid USING INTEGER PRIMARY KEY (rowid=?)");
+    CHECK(rowid.primaryKey);
+    CHECK(rowid.index.empty());
+    auto automatic = QueryPlanNode::parse("SEARCH other USING AUTOMATIC COVERING INDEX (x=?)");
+    CHECK(automatic.automaticIndex);
+    CHECK(automatic.index.empty());
+    auto old = QueryPlanNode::parse("SCAN TABLE valid AS v USING INDEX validB");
+    CHECK(old.table == "v");
+    CHECK(old.index == "validB");
+    CHECK(QueryPlanNode::parse("SCAN v VIRTUAL TABLE INDEX 0:M1").virtualTable);
+    CHECK(QueryPlanNode::parse("USE TEMP B-TREE FOR ORDER BY").kind == Kind::TempBTree);
+    CHECK(QueryPlanNode::parse("SCAN CONSTANT ROW").table.empty());
+  }
+
+  SECTION("Rows are assembled into a tree") {
+    QueryPlan plan({{2, 0, "CO-ROUTINE (subquery-1)"}, {5, 2, "SCAN valid"}, {13, 0, "SCAN (subquery-1)"}});
+    REQUIRE(plan.roots().size() == 2);
+    REQUIRE(plan.roots()[0].children.size() == 1);
+    CHECK(plan.roots()[0].children[0].table == "valid");
+    CHECK(plan.fullScans() == std::vector<std::string>{"valid"});
+    CHECK(plan.toString() == "QUERY PLAN\n|--CO-ROUTINE (subquery-1)\n|  `--SCAN valid\n`--SCAN (subquery-1)\n");
+  }
+
+  SECTION("Statements explain their plan") {
+    auto search = connection.prepare("SELECT b FROM valid WHERE b = ?;");
+    search.bind(1, 1);
+    CHECK(search.sql() == "SELECT b FROM valid WHERE b = ?;");
+    auto plan = search.queryPlan();
+    REQUIRE(plan.roots().size() == 1);
+    CHECK(plan.roots()[0].kind == Kind::Search);
+    CHECK(plan.roots()[0].index == "validB");
+    CHECK(plan.fullScans().empty());
+    CHECK_THAT(plan, UsesIndexes());
+    CHECK(search.execute().fetchAllVector().empty());
+
+    auto sorted = connection.prepare("SELECT * FROM other ORDER BY y;").queryPlan();
+    CHECK(sorted.fullScans() == std::vector<std::string>{"other"});
+    CHECK(sorted.usesTempBTree());
+    CHECK_THAT(sorted, UsesIndexes({"other"}));
+  }
+
+  SECTION("Full scans and automatic indexes fail the matcher") {
+    auto scan = connection.prepare("SELECT * FROM valid WHERE c = 1;").queryPlan();
+    CHECK(!UsesIndexes().match(scan));
+    auto join = connection.prepare("SELECT * FROM valid JOIN other ON other.x = valid.c;").queryPlan();
+    CHECK(join.automaticIndexes() == std::vector<std::string>{"other"});
+    CHECK(!UsesIndexes({"valid"}).match(join));
+    CHECK(UsesIndexes({"valid"}).describe() == "uses an index for every table but valid");
+  }
+}
@@ -0,0 +1,89 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <catch2/catch_all.hpp>
+#include <fstream>
+#include <thread>
+
+TEST_CASE("Workload recorder") { // NOLINT
+  using Y2KaoZ::Database::BlobType;
+  using Y2KaoZ::Database::NullValue;
+  using Y2KaoZ::Database::ParamVector;
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::Exception;
+  using Y2KaoZ::Database::Sql::Sqlite3::RecordedKind;
+  using Y2KaoZ::Database::Sql::Sqlite3::Recorder;
+  using Y2KaoZ::Database::Sql::Sqlite3::Recording;
+
+  auto path = std::filesystem::temp_directory_path() / "weirdFileNameToTestRecorder.rec";
+  Connection connection{};
+  connection.execute("CREATE TABLE valid (a INTEGER PRIMARY KEY, b);");
+
+  SECTION("Executions are written and read back") {
+    ParamVector values{
+      NullValue,
+      std::int8_t{-8},
+      std::uint8_t{200},
+      std::int16_t{-300},
+      std::uint16_t{60000},
+      std::int32_t{-70000},
+      std::uint32_t{4000000000},
+      std::int64_t{-5000000000},
+      std::uint64_t{9000000000000000000ULL},
+      1.5F,
+      -2.25,
+      std::string("text"),
+      BlobType{std::byte{1}, std::byte{2}}};
+    {
+      auto recorder = std::make_shared<Recorder>(path);
+      connection.record(recorder);
+      CHECK(connection.recorder() == recorder.get());
+      connection.execute("INSERT INTO valid VALUES (1, 'one'), (2, 'two');");
+      auto select = connection.prepare("SELECT b FROM valid WHERE a >= ?;");
+      CHECK(select.bind(1, 1).execute().fetchAllVector().size() == 2);
+      CHECK(select.bind(1, 2).execute().fetchAllVector().size() == 1);
+      auto insert = connection.prepare("INSERT INTO valid (b) VALUES (?);");
+      for (const auto& value : values) {
+        insert.bind(1, value).execute();
+      }
+      std::thread([&]() { connection.execute("DELETE FROM valid WHERE a = 1;"); }).join();
+      connection.record(nullptr);
+      connection.execute("DELETE FROM valid;");
+      CHECK(recorder->calls() == 17);
+    }
+
+    auto recording = Recording::load(path);
+    REQUIRE(recording.calls.size() == 17);
+    REQUIRE(recording.statements.size() == 4);
+    CHECK(recording.statements[0] == "INSERT INTO valid VALUES (1, 'one'), (2, 'two');");
+    CHECK(recording.calls[0].kind == RecordedKind::Script);
+    CHECK(recording.calls[1].kind == RecordedKind::Statement);
+    CHECK(recording.calls[1].statement == 1);
+    CHECK(recording.calls[2].statement == 1);
+    CHECK(recording.calls[1].parameters == ParamVector{std::int32_t{1}});
+    CHECK(recording.calls[2].parameters == ParamVector{std::int32_t{2}});
+    for (std::size_t i = 0; i < 13; ++i) {
+      CHECK(recording.calls[3 + i].statement == 2);
+      CHECK(recording.calls[3 + i].parameters == ParamVector{values[i]});
+    }
+    CHECK(recording.calls[16].thread == 1);
+    CHECK(recording.calls[15].thread == 0);
+    for (std::size_t i = 1; i < recording.calls.size(); ++i) {
+      CHECK(recording.calls[i - 1].time <= recording.calls[i].time);
+    }
+  }
+
+  SECTION("Broken files are rejected") {
+    {
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+      file << "not a recording";
+    }
+    CHECK_THROWS_AS(Recording::load(path), Exception);
+    {
+      auto recorder = std::make_shared<Recorder>(path);
+      recorder->record(RecordedKind::Statement, "SELECT ?;", {std::string("a long enough string")});
+    }
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+    CHECK_THROWS_WITH(Recording::load(path), "Truncated recording.");
+  }
+
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,73 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <catch2/catch_all.hpp>
+
+TEST_CASE("Workload replay") { // NOLINT
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::RecordedKind;
+  using Y2KaoZ::Database::Sql::Sqlite3::Recorder;
+  using Y2KaoZ::Database::Sql::Sqlite3::Recording;
+  using Y2KaoZ::Database::Sql::Sqlite3::replay;
+  using Y2KaoZ::Database::Sql::Sqlite3::ReplayOptions;
+  using namespace std::chrono_literals;
+
+  auto database = std::filesystem::temp_directory_path() / "weirdFileNameToTestReplay.sqlite3";
+  auto path = std::filesystem::temp_directory_path() / "weirdFileNameToTestReplay.rec";
+  std::filesystem::remove(database);
+  Connection{database}.execute("CREATE TABLE valid (a INTEGER PRIMARY KEY, b);");
+
+  Recording recording;
+  recording.statements = {"INSERT INTO valid (b) VALUES (?);", "SELECT count(*) FROM valid WHERE b < ?;", "BOGUS;"};
+  for (std::int64_t i = 0; i < 100; ++i) {
+    recording.calls.push_back({RecordedKind::Statement, i * 10us, 0, 0, {i}});
+    recording.calls.push_back({RecordedKind::Statement, i * 10us, 1, 1, {i}});
+  }
+  recording.calls.push_back({RecordedKind::Script, 1ms, 2, 2, {}});
+
+  SECTION("Calls are replayed as fast as possible across threads") {
+    ReplayOptions options;
+    options.threads = 2;
+    auto report = replay(database, recording, options);
+    CHECK(report.calls == 201);
+    CHECK(report.errors == 1);
+    CHECK(report.callsPerSecond() > 0.0);
+    REQUIRE(report.statements.size() == 3);
+    for (const auto& stats : report.statements) {
+      CHECK(stats.p50 <= stats.p90);
+      CHECK(stats.p90 <= stats.p99);
+      CHECK(stats.p99 <= stats.max);
+      if (stats.sql == "BOGUS;") {
+        CHECK(stats.errors == 1);
+      } else {
+        CHECK(stats.calls == 100);
+        CHECK(stats.errors == 0);
+      }
+    }
+    CHECK(Connection{database}.prepare("SELECT count(*) FROM valid;").execute().fetchColumn(0)->getInteger() == 100);
+  }
+
+  SECTION("The recorded rate is kept") {
+    ReplayOptions options;
+    options.recordedRate = true;
+    auto report = replay(database, recording, options);
+    CHECK(report.seconds >= 0.001);
+    CHECK(report.errors == 1);
+  }
+
+  SECTION("Recordings made by a connection replay") {
+    {
+      Connection connection{database};
+      connection.record(std::make_shared<Recorder>(path));
+      auto insert = connection.prepare("INSERT INTO valid (b) VALUES (?);");
+      for (int i = 0; i < 10; ++i) {
+        insert.bind(1, i).execute();
+      }
+    }
+    auto report = replay(database, Recording::load(path), {});
+    REQUIRE(report.statements.size() == 1);
+    CHECK(report.statements[0].calls == 10);
+    CHECK(Connection{database}.prepare("SELECT count(*) FROM valid;").execute().fetchColumn(0)->getInteger() == 20);
+  }
+
+  std::filesystem::remove(database);
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,155 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <catch2/catch_all.hpp>
+
+TEST_CASE("Query result cache") { // NOLINT
+  using Y2KaoZ::Database::ParamVector;
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::ResultCache;
+
+  std::filesystem::path tmp = std::filesystem::temp_directory_path() / "weirdFileNameToTestResultCache.sqlite3";
+  std::filesystem::remove(tmp);
+  Connection connection{tmp};
+  connection.execute("CREATE TABLE valid (a INTEGER PRIMARY KEY, b);"
+                     "CREATE TABLE other (a INTEGER PRIMARY KEY, b);"
+                     "CREATE VIEW joined AS SELECT valid.b AS v, other.b AS o FROM valid JOIN other USING (a);"
+                     "INSERT INTO valid VALUES (1, 'one'), (2, 'two');"
+                     "INSERT INTO other VALUES (1, 'uno');");
+
+  SECTION("Tables are learned at prepare time") {
+    ResultCache cache{connection};
+    auto tables = cache.tables("SELECT * FROM joined;");
+    std::sort(tables.begin(), tables.end());
+    CHECK(tables == std::vector<std::string>{"joined", "other", "valid"});
+    CHECK(cache.tables("SELECT count(*) FROM valid;") == std::vector<std::string>{"valid"});
+  }
+
+  SECTION("Authorizers of the connection are kept") {
+    auto id = connection.addAuthorizer(
+      [](int action, std::string_view table, std::string_view /*column*/, std::string_view, std::string_view) {
+        return action == SQLITE_READ && table == "other" ? SQLITE_DENY : SQLITE_OK;
+      });
+    ResultCache cache{connection};
+    CHECK(cache.fetchAll("SELECT count(*) FROM valid;")->at(0).at(0).getInteger() == 2);
+    CHECK_THROWS(cache.fetchAll("SELECT b FROM other;"));
+    CHECK_THROWS(connection.prepare("SELECT b FROM other;"));
+    connection.removeHook(id);
+    CHECK(cache.fetchAll("SELECT b FROM other;")->size() == 1);
+  }
+
+  SECTION("Only the most recently used statements stay prepared") {
+    ResultCache cache{connection};
+    auto first = cache.fetchAll("SELECT b FROM valid WHERE a = 1;");
+    for (std::size_t i = 0; i < ResultCache::STATEMENT_CAPACITY; ++i) {
+      CHECK(cache.fetchAll("SELECT " + std::to_string(i) + ", b FROM valid;")->size() == 2);
+    }
+    CHECK(cache.stats().entries == ResultCache::STATEMENT_CAPACITY);
+    CHECK(cache.fetchAll("SELECT b FROM valid WHERE a = 1;") != first);
+    CHECK(cache.stats().hits == 0);
+  }
+
+  SECTION("Repeated queries are served from the cache") {
+    ResultCache cache{connection};
+    auto first = cache.fetchAll("SELECT b FROM valid WHERE a = ?;", {1});
+    auto second = cache.fetchAll("SELECT b FROM valid WHERE a = ?;", {1});
+    auto third = cache.fetchAll("SELECT b FROM valid WHERE a = ?;", {2});
+    REQUIRE(first->size() == 1);
+    CHECK(first == second);
+    CHECK(first != third);
+    CHECK(third->at(0).at(0).getString() == "two");
+    auto stats = cache.stats();
+    CHECK(stats.hits == 1);
+    CHECK(stats.misses == 2);
+    CHECK(stats.entries == 2);
+    CHECK(stats.memoryUsed > 0);
+    CHECK(stats.hitRatio() == Catch::Approx(1.0 / 3.0));
+  }
+
+  SECTION("Changes on the same connection invalidate by table") {
+    ResultCache cache{connection};
+    auto valid = cache.fetchAll("SELECT count(*) FROM valid;");
+    auto other = cache.fetchAll("SELECT count(*) FROM other;");
+    connection.execute("INSERT INTO valid VALUES (3, 'three');");
+    CHECK(cache.fetchAll("SELECT count(*) FROM valid;")->at(0).at(0).getInteger() == 3);
+    CHECK(cache.fetchAll("SELECT count(*) FROM other;") == other);
+    CHECK(cache.stats().invalidations == 1);
+  }
+
+  SECTION("Rolled back changes invalidate the rows read inside the transaction") {
+    ResultCache cache{connection};
+    {
+      auto transaction = connection.beginTransaction();
+      connection.execute("INSERT INTO valid VALUES (3, 'three');");
+      CHECK(cache.fetchAll("SELECT count(*) FROM valid;")->at(0).at(0).getInteger() == 3);
+    }
+    CHECK(cache.fetchAll("SELECT count(*) FROM valid;")->at(0).at(0).getInteger() == 2);
+  }
+
+  SECTION("Rows changed by the transaction in progress are not cached") {
+    connection.execute("CREATE UNIQUE INDEX valid_b ON valid (b);");
+    ResultCache cache{connection};
+    auto transaction = connection.beginTransaction();
+    connection.execute("SAVEPOINT s; INSERT INTO valid VALUES (3, 'three');");
+    CHECK(cache.fetchAll("SELECT count(*) FROM valid;")->at(0).at(0).getInteger() == 3);
+    connection.execute("ROLLBACK TO s;");
+    CHECK(cache.fetchAll("SELECT count(*) FROM valid;")->at(0).at(0).getInteger() == 2);
+    CHECK_THROWS(connection.execute("INSERT INTO valid VALUES (4, 'four'), (5, 'one');"));
+    CHECK(cache.fetchAll("SELECT count(*) FROM valid;")->at(0).at(0).getInteger() == 2);
+    CHECK(cache.fetchAll("SELECT count(*) FROM other;")->at(0).at(0).getInteger() == 1);
+    CHECK(cache.fetchAll("SELECT count(*) FROM other;")->at(0).at(0).getInteger() == 1);
+    CHECK(cache.stats().entries == 1);
+    CHECK(cache.stats().hits == 1);
+    transaction.commit();
+    CHECK(cache.fetchAll("SELECT count(*) FROM valid;")->at(0).at(0).getInteger() == 2);
+    CHECK(cache.stats().entries == 2);
+  }
+
+  SECTION("Changes that bypass the update hook are never cached before the transaction ends") {
+    connection.execute("CREATE TABLE pairs (k PRIMARY KEY, v) WITHOUT ROWID;");
+    ResultCache cache{connection};
+    {
+      auto transaction = connection.beginTransaction();
+      connection.execute("INSERT INTO pairs VALUES (1, 'one');");
+      CHECK(cache.fetchAll("SELECT count(*) FROM pairs;")->at(0).at(0).getInteger() == 1);
+      CHECK(cache.fetchAll("SELECT count(*) FROM pairs;")->at(0).at(0).getInteger() == 1);
+      CHECK(cache.stats().entries == 0);
+    }
+    CHECK(cache.fetchAll("SELECT count(*) FROM pairs;")->at(0).at(0).getInteger() == 0);
+    CHECK(cache.fetchAll("SELECT count(*) FROM pairs;")->at(0).at(0).getInteger() == 0);
+    CHECK(cache.stats().entries == 1);
+  }
+
+  SECTION("Changes that bypass the update hook clear the cache") {
+    ResultCache cache{connection};
+    CHECK(cache.fetchAll("SELECT count(*) FROM valid;")->at(0).at(0).getInteger() == 2);
+    connection.execute("DELETE FROM valid;");
+    CHECK(cache.fetchAll("SELECT count(*) FROM valid;")->at(0).at(0).getInteger() == 0);
+  }
+
+  SECTION("Commits from other connections are detected with data_version") {
+    ResultCache cache{connection};
+    CHECK(cache.fetchAll("SELECT count(*) FROM valid;")->at(0).at(0).getInteger() == 2);
+    Connection{tmp}.execute("INSERT INTO valid VALUES (3, 'three');");
+    CHECK(cache.fetchAll("SELECT count(*) FROM valid;")->at(0).at(0).getInteger() == 3);
+  }
+
+  SECTION("Writes are executed but never cached") {
+    ResultCache cache{connection};
+    CHECK(cache.fetchAll("INSERT INTO valid (b) VALUES (?);", {"x"})->empty());
+    CHECK(cache.fetchAll("INSERT INTO valid (b) VALUES (?);", {"x"})->empty());
+    CHECK(cache.stats().entries == 0);
+    CHECK(cache.fetchAll("SELECT count(*) FROM valid;")->at(0).at(0).getInteger() == 4);
+  }
+
+  SECTION("The memory budget evicts the least recently used entries") {
+    ResultCache cache{connection, 2048};
+    for (int i = 0; i < 100; ++i) {
+      auto rows = cache.fetchAll("SELECT ?, b FROM valid;", {i});
+      REQUIRE(rows->size() == 2);
+      CHECK(cache.stats().memoryUsed <= 2048);
+    }
+    CHECK(cache.stats().evictions > 0);
+    CHECK(cache.stats().entries < 100);
+  }
+
+  std::filesystem::remove(tmp);
+}
@@ -0,0 +1,174 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <catch2/catch_all.hpp>
+
+#ifdef SQLITE_ENABLE_SESSION
+
+#include <algorithm>
+
+TEST_CASE("Sessions") { // NOLINT
+  using Y2KaoZ::Database::BlobType;
+  using Y2KaoZ::Database::BlobView;
+  using Y2KaoZ::Database::Sql::Sqlite3::applyChangeset;
+  using Y2KaoZ::Database::Sql::Sqlite3::ChangesetConflict;
+  using Y2KaoZ::Database::Sql::Sqlite3::ConflictAction;
+  using Y2KaoZ::Database::Sql::Sqlite3::ConflictType;
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::Exception;
+  using Y2KaoZ::Database::Sql::Sqlite3::RowChange;
+  using Y2KaoZ::Database::Sql::Sqlite3::Session;
+  constexpr auto SCHEMA = "CREATE TABLE valid (a INTEGER PRIMARY KEY, b); CREATE TABLE other (a INTEGER PRIMARY KEY);";
+  Connection primary{};
+  Connection replica{};
+  primary.execute(SCHEMA);
+  replica.execute(SCHEMA);
+  auto value = [](Connection& connection, const char* sql) {
+    return connection.prepare(sql).execute().fetchColumn(0);
+  };
+
+  SECTION("A changeset replays the changes on a replica") {
+    Session session{primary};
+    session.attach("valid");
+    CHECK(session.empty());
+    primary.execute("INSERT INTO valid VALUES (1, 'one'), (2, 'two'), (3, 'three');"
+                    "UPDATE valid SET b = 'uno' WHERE a = 1;"
+                    "DELETE FROM valid WHERE a = 2;"
+                    "INSERT INTO other VALUES (1);");
+    CHECK(!session.empty());
+    applyChangeset(replica, session.changeset());
+    CHECK(value(replica, "SELECT count(*) FROM valid;")->getInteger() == 2);
+    CHECK(value(replica, "SELECT b FROM valid WHERE a = 1;")->getString() == "uno");
+    CHECK(value(replica, "SELECT count(*) FROM other;")->getInteger() == 0);
+  }
+
+  SECTION("A patchset is smaller than the changeset") {
+    Session session{primary};
+    session.attachAll();
+    primary.execute("INSERT INTO valid VALUES (1, 'one'), (2, 'two');");
+    auto transaction = primary.beginTransaction();
+    session.setEnabled(false);
+    CHECK(!session.enabled());
+    primary.execute("INSERT INTO other VALUES (1);");
+    session.setEnabled(true);
+    transaction.commit();
+    auto before = session.changeset();
+    applyChangeset(replica, before);
+    CHECK(value(replica, "SELECT count(*) FROM other;")->getInteger() == 0);
+    static_cast<void>(session.takeChangeset());
+    primary.execute("UPDATE valid SET b = 'changed' WHERE a = 1; DELETE FROM valid WHERE a = 2;");
+    auto changeset = session.changeset();
+    auto patchset = session.patchset();
+    CHECK(patchset.size() < changeset.size());
+    applyChangeset(replica, patchset);
+    CHECK(value(replica, "SELECT group_concat(b) FROM valid;")->getString() == "changed");
+  }
+
+  SECTION("Changesets are streamed both ways") {
+    Session session{primary};
+    session.attach("valid");
+    for (int i = 0; i < 100; ++i) {
+      primary.execute("INSERT INTO valid (b) VALUES (randomblob(100));");
+    }
+    BlobType streamed;
+    session.changeset([&](BlobView chunk) { streamed.insert(streamed.end(), chunk.begin(), chunk.end()); });
+    CHECK(streamed == session.changeset());
+    std::size_t offset = 0;
+    std::size_t reads = 0;
+    applyChangeset(replica, [&](std::span<std::byte> buffer) {
+      auto size = std::min(buffer.size(), streamed.size() - offset);
+      std::copy_n(streamed.begin() + static_cast<std::ptrdiff_t>(offset), size, buffer.begin());
+      offset += size;
+      ++reads;
+      return size;
+    });
+    CHECK(reads > 1);
+    CHECK(value(replica, "SELECT count(*) FROM valid;")->getInteger() == 100);
+    CHECK(
+      value(replica, "SELECT sum(length(b)) FROM valid;")->getInteger() ==
+      value(primary, "SELECT sum(length(b)) FROM valid;")->getInteger());
+  }
+
+  SECTION("Taking a changeset starts the session over") {
+    Session session{primary};
+    session.attach("valid");
+    primary.execute("INSERT INTO valid VALUES (1, 'one');");
+    auto first = session.takeChangeset();
+    CHECK(session.empty());
+    primary.execute("INSERT INTO valid VALUES (2, 'two');");
+    auto second = session.takeChangeset();
+    applyChangeset(replica, first);
+    applyChangeset(replica, second);
+    CHECK(value(replica, "SELECT group_concat(b) FROM valid;")->getString() == "one,two");
+  }
+
+  SECTION("Conflicts are handled") {
+    replica.execute("INSERT INTO valid VALUES (1, 'replica'), (3, 'kept');");
+    Session session{primary};
+    session.attach("valid");
+    primary.execute("INSERT INTO valid VALUES (1, 'primary'), (2, 'two');");
+    auto changeset = session.changeset();
+
+    SECTION("Aborted changesets leave the database unchanged") {
+      CHECK_THROWS_AS(applyChangeset(replica, changeset), Exception);
+      CHECK(value(replica, "SELECT count(*) FROM valid;")->getInteger() == 2);
+      CHECK(value(replica, "SELECT b FROM valid WHERE a = 1;")->getString() == "replica");
+    }
+
+    SECTION("Omitted changes are skipped") {
+      std::vector<ChangesetConflict> conflicts;
+      applyChangeset(replica, changeset, [&](const ChangesetConflict& conflict) {
+        conflicts.push_back(conflict);
+        return ConflictAction::Omit;
+      });
+      REQUIRE(conflicts.size() == 1);
+      CHECK(conflicts[0].type == ConflictType::Conflict);
+      CHECK(conflicts[0].table == "valid");
+      CHECK(conflicts[0].change == RowChange::Insert);
+      REQUIRE(conflicts[0].newValues);
+      CHECK(conflicts[0].newValues->at(1).getString() == "primary");
+      REQUIRE(conflicts[0].conflictingValues);
+      CHECK(conflicts[0].conflictingValues->at(1).getString() == "replica");
+      CHECK(value(replica, "SELECT b FROM valid WHERE a = 1;")->getString() == "replica");
+      CHECK(value(replica, "SELECT b FROM valid WHERE a = 2;")->getString() == "two");
+    }
+
+    SECTION("Replaced changes overwrite the row") {
+      applyChangeset(replica, changeset, [](const ChangesetConflict&) { return ConflictAction::Replace; });
+      CHECK(value(replica, "SELECT b FROM valid WHERE a = 1;")->getString() == "primary");
+      CHECK(value(replica, "SELECT count(*) FROM valid;")->getInteger() == 3);
+    }
+
+    SECTION("Handler exceptions abort the changeset") {
+      auto fail = [](const ChangesetConflict&) -> ConflictAction { throw std::runtime_error("failed"); };
+      CHECK_THROWS_AS(applyChangeset(replica, changeset, fail), std::runtime_error);
+      CHECK(value(replica, "SELECT count(*) FROM valid;")->getInteger() == 2);
+    }
+  }
+
+  SECTION("Filtered tables are not applied") {
+    Session session{primary};
+    session.attachAll();
+    primary.execute("INSERT INTO valid VALUES (1, 'one'); INSERT INTO other VALUES (1);");
+    applyChangeset(replica, session.changeset(), {}, [](std::string_view table) { return table == "other"; });
+    CHECK(value(replica, "SELECT count(*) FROM valid;")->getInteger() == 0);
+    CHECK(value(replica, "SELECT count(*) FROM other;")->getInteger() == 1);
+  }
+
+  SECTION("Filter exceptions leave the database unchanged") {
+    Session session{primary};
+    session.attachAll();
+    primary.execute("INSERT INTO valid VALUES (1, 'one'); INSERT INTO other VALUES (1);");
+    auto tables = 0;
+    auto fail = [&](std::string_view) {
+      if (++tables == 2) {
+        throw std::runtime_error("failed");
+      }
+      return true;
+    };
+    CHECK_THROWS_AS(applyChangeset(replica, session.changeset(), {}, fail), std::runtime_error);
+    CHECK(tables == 2);
+    CHECK(value(replica, "SELECT count(*) FROM valid;")->getInteger() == 0);
+    CHECK(value(replica, "SELECT count(*) FROM other;")->getInteger() == 0);
+  }
+}
+
+#endif
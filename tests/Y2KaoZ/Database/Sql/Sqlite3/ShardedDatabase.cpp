@@ -0,0 +1,73 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <catch2/catch_all.hpp>
+
+TEST_CASE("Sharded databases") { // NOLINT
+  using Y2KaoZ::Database::ParamVector;
+  using Y2KaoZ::Database::ResultVector;
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::Exception;
+  using Y2KaoZ::Database::Sql::Sqlite3::ShardedDatabase;
+
+  std::vector<std::filesystem::path> filenames;
+  for (int i = 0; i < 3; ++i) {
+    filenames.emplace_back(
+      std::filesystem::temp_directory_path() / ("weirdFileNameToTestShardedDatabase" + std::to_string(i) + ".sqlite3"));
+    std::filesystem::remove(filenames.back());
+  }
+
+  SECTION("Hash routing is stable and spreads the keys") {
+    ShardedDatabase shards{filenames};
+    REQUIRE(shards.size() == 3);
+    shards.execute("CREATE TABLE valid (a INTEGER PRIMARY KEY, b);");
+    for (std::int64_t key = 0; key < 300; ++key) {
+      CHECK(shards.shardOf(key) == shards.shardOf(static_cast<std::int32_t>(key)));
+      shards.route(key).prepare("INSERT INTO valid VALUES (?, ?);").bind(ParamVector{key, "value"}).execute();
+    }
+    for (std::size_t i = 0; i < shards.size(); ++i) {
+      auto count = shards.shard(i).prepare("SELECT count(*) FROM valid;").execute().fetchColumn(0);
+      REQUIRE(count);
+      CHECK(count->asInteger64() > 0);
+    }
+    CHECK(shards.fetchAll("SELECT a FROM valid WHERE a >= ?;", {100}).size() == 200);
+  }
+
+  SECTION("Range routing and ordered scatter/gather") {
+    ShardedDatabase shards{filenames, ShardedDatabase::rangeRouter({100, 200})};
+    shards.execute("CREATE TABLE valid (a INTEGER PRIMARY KEY, b);");
+    CHECK(shards.shardOf(-5) == 0);
+    CHECK(shards.shardOf(99) == 0);
+    CHECK(shards.shardOf(100) == 1);
+    CHECK(shards.shardOf(1000) == 2);
+    CHECK_THROWS_AS(shards.shardOf("text"), std::invalid_argument);
+    for (std::int64_t key = 0; key < 300; ++key) {
+      shards.route(key).prepare("INSERT INTO valid VALUES (?, ?);").bind(ParamVector{key, key % 10}).execute();
+    }
+    auto rows = shards.fetchAllOrdered(
+      "SELECT b, a FROM valid WHERE b = 3 ORDER BY a DESC;",
+      [](const ResultVector& l, const ResultVector& r) { return l[1].asInteger64() > r[1].asInteger64(); });
+    REQUIRE(rows.size() == 30);
+    CHECK(rows.front()[1].asInteger64() == 293);
+    CHECK(rows.back()[1].asInteger64() == 3);
+  }
+
+  SECTION("ATTACH based cross-shard reads") {
+    ShardedDatabase shards{filenames};
+    shards.execute("CREATE TABLE valid (a INTEGER PRIMARY KEY, b);");
+    for (std::int64_t key = 0; key < 30; ++key) {
+      shards.route(key).prepare("INSERT INTO valid VALUES (?, ?);").bind(ParamVector{key, key}).execute();
+    }
+    Connection connection;
+    shards.attach(connection);
+    auto total = connection.prepare("SELECT sum(b) FROM (" + shards.unionAll("valid", "b") + ");")
+                   .execute()
+                   .fetchColumn(0);
+    REQUIRE(total);
+    CHECK(total->asInteger64() == 435);
+    shards.detach(connection);
+    CHECK_THROWS_AS(connection.prepare("SELECT * FROM shard0.valid;"), Exception);
+  }
+
+  for (const auto& filename : filenames) {
+    std::filesystem::remove(filename);
+  }
+}
@@ -1,5 +1,7 @@
 #include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <array>
 #include <catch2/catch_all.hpp>
+#include <memory_resource>
 
 TEST_CASE("Statement Creation") { // NOLINT
   using Y2KaoZ::Database::Sql::Sqlite3::Connection;
@@ -189,6 +191,25 @@ TEST_CASE("Fetchig data") { // NOLINT
     REQUIRE(!noRow);
   }
 
+  SECTION("Columns as views of the current row") {
+    auto stmt = connection.prepare("SELECT a, b, x'00ff', x'' FROM valid;");
+    REQUIRE(!stmt.columnText(0));
+    stmt.execute();
+    REQUIRE(stmt.columnText(1) == "2");
+    auto blob = stmt.columnBlob(2);
+    REQUIRE(blob);
+    REQUIRE(blob->size() == 2);
+    REQUIRE(blob->back() == std::byte{0xff});
+    REQUIRE(stmt.columnBlob(3));
+    REQUIRE(stmt.columnBlob(3)->empty());
+    REQUIRE(stmt.columnBlob(1)->size() == 1);
+    stmt.execute();
+    stmt.execute();
+    REQUIRE(stmt.columnText(0) == "3");
+    REQUIRE(!stmt.columnText(1));
+    REQUIRE(!stmt.columnBlob(1));
+  }
+
   SECTION("All rows at once as Vectors") {
     auto stmt = connection.prepare("SELECT * FROM valid;");
     REQUIRE(!stmt.rows());
@@ -228,4 +249,93 @@ TEST_CASE("Fetchig data") { // NOLINT
     REQUIRE(rows[1].at("b").isInteger());
     REQUIRE(rows[1].at("b").getInteger() == 3);
   }
-}
\ No newline at end of file
+
+  SECTION("All rows at once in an arena") {
+    std::array<std::byte, 4096> buffer{};
+    std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size(), std::pmr::null_memory_resource()};
+
+    auto vectors = connection.prepare("SELECT * FROM valid;").execute().fetchAllVector(&arena);
+    REQUIRE(vectors.size() == 3);
+    REQUIRE(vectors.get_allocator().resource() == &arena);
+    REQUIRE(vectors[1].get_allocator().resource() == &arena);
+    REQUIRE(vectors[1][1].getInteger() == 3);
+
+    auto maps = connection.prepare("SELECT * FROM valid;").execute().fetchAllMap(&arena);
+    REQUIRE(maps.size() == 3);
+    REQUIRE(maps[0].get_allocator().resource() == &arena);
+    REQUIRE(maps[0].find("a")->first.get_allocator().resource() == &arena);
+    REQUIRE(maps[0].at("b").getString() == "2");
+
+    auto stmt = connection.prepare("SELECT * FROM valid;");
+    stmt.execute();
+    auto row = stmt.fetchMap(&arena);
+    REQUIRE(row);
+    REQUIRE(row->at("a").getInteger() == 1);
+    REQUIRE(stmt.fetchVector(&arena)->at(0).getInteger() == 2);
+  }
+}
+
+TEST_CASE("Interning text columns") { // NOLINT
+  using Y2KaoZ::Database::StringPool;
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::Interning;
+
+  Connection connection{};
+  connection.execute("CREATE TABLE events (status TEXT, detail);"
+                     "INSERT INTO events VALUES ('open', 'a'), ('closed', 'b'), ('open', 1), (NULL, 2), ('open', 3);");
+  auto pool = std::make_shared<StringPool>();
+
+  SECTION("As views into the pool") {
+    auto stmt = connection.prepare("SELECT status, detail FROM events;");
+    stmt.intern(0, pool).execute();
+    auto rows = stmt.fetchAllVector();
+    REQUIRE(rows.size() == 5);
+    CHECK(rows[0][0].stringView() == "open");
+    CHECK(rows[0][0].stringView().data() == rows[2][0].stringView().data());
+    CHECK(rows[0][0].stringView().data() == pool->view(0).data());
+    CHECK(rows[3][0].isNull());
+    CHECK(rows[0][1].getString() == "a");
+    CHECK(pool->dictionary() == std::vector<std::string_view>{"open", "closed"});
+  }
+
+  SECTION("Copies of borrowed cells outlive the pool") {
+    auto local = std::make_shared<StringPool>();
+    auto stmt = connection.prepare("SELECT status FROM events WHERE status IS NOT NULL;");
+    stmt.intern(0, local).execute();
+    auto rows = stmt.fetchAllVector();
+    REQUIRE(rows.size() == 4);
+    auto copy = rows[1];
+    Y2KaoZ::Database::ResultType assigned;
+    assigned = rows[0][0];
+    auto moved = std::move(rows[2]);
+    CHECK(moved[0].stringView().data() == local->view(0).data());
+    CHECK(copy[0].stringView().data() != local->view(1).data());
+    rows.clear();
+    moved.clear();
+    stmt = connection.prepare("SELECT 1;");
+    local.reset();
+    CHECK(copy[0].stringView() == "closed");
+    CHECK(assigned.stringView() == "open");
+  }
+
+  SECTION("As ids shared between statements") {
+    static_cast<void>(pool->intern("closed"));
+    auto stmt = connection.prepare("SELECT status FROM events;");
+    stmt.intern(0, pool, Interning::Id).execute();
+    auto rows = stmt.fetchAllVector();
+    REQUIRE(rows.size() == 5);
+    CHECK(rows[0][0].getInteger() == 1);
+    CHECK(rows[1][0].getInteger() == 0);
+    CHECK(rows[3][0].isNull());
+    CHECK(pool->view(static_cast<StringPool::Id>(rows[4][0].getInteger())) == "open");
+
+    auto other = connection.prepare("SELECT status FROM events WHERE status = 'closed';");
+    other.intern(0, pool, Interning::Id).execute();
+    CHECK(other.fetchColumn(0)->getInteger() == 0);
+  }
+
+  SECTION("Out of range columns are rejected") {
+    auto stmt = connection.prepare("SELECT status FROM events;");
+    CHECK_THROWS_AS(stmt.intern(1, pool), std::out_of_range);
+  }
+}
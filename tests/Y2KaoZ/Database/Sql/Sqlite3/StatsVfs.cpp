@@ -0,0 +1,105 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3.hpp"
+#include <catch2/catch_all.hpp>
+#if __has_include(<fcntl.h>)
+#include <fcntl.h>
+#endif
+#ifdef F_OFD_GETLK
+#include <unistd.h>
+#endif
+
+TEST_CASE("Instrumenting VFS") { // NOLINT
+  using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+  using Y2KaoZ::Database::Sql::Sqlite3::Exception;
+  using Y2KaoZ::Database::Sql::Sqlite3::FileKind;
+  using Y2KaoZ::Database::Sql::Sqlite3::StatsVfs;
+
+  constexpr auto FLAGS = Connection::OPEN_READWRITE | Connection::OPEN_CREATE;
+  std::filesystem::path tmp = std::filesystem::temp_directory_path() / "weirdFileNameToTestStatsVfs.sqlite3";
+  std::filesystem::remove(tmp);
+  StatsVfs vfs{"y2kaoz-stats-test", StatsVfs::DEFAULT_READ_AHEAD};
+  CHECK(vfs.name() == "y2kaoz-stats-test");
+
+  SECTION("I/O is counted by kind of file and by connection") {
+    Connection writer{tmp, FLAGS, vfs.name()};
+    writer.execute("CREATE TABLE valid (a INTEGER PRIMARY KEY, b);"
+                   "INSERT INTO valid VALUES (1, 'one'), (2, 'two');");
+    auto written = vfs.stats(writer);
+    CHECK(written[FileKind::Main].writes.calls > 0);
+    CHECK(written[FileKind::Main].writes.bytes > 0);
+    CHECK(written[FileKind::Main].syncs.calls > 0);
+    CHECK(written[FileKind::Journal].writes.calls > 0);
+    CHECK(written[FileKind::Main].locks.calls > 0);
+    CHECK(written.total().syncs.time.count() > 0);
+    CHECK(written.total().syncs.maxTime <= written.total().syncs.time);
+
+    Connection reader{tmp, FLAGS, vfs.name()};
+    CHECK(reader.prepare("SELECT count(*) FROM valid;").execute().fetchColumn(0)->getInteger() == 2);
+    auto read = vfs.stats(reader, true);
+    CHECK(read[FileKind::Main].reads.calls > 0);
+    CHECK(read.total().writes.calls == 0);
+    CHECK(vfs.stats(reader).total().reads.calls == 0);
+
+    auto total = vfs.stats();
+    CHECK(total.total().writes.calls >= written.total().writes.calls);
+    CHECK(total.total().reads.calls >= read.total().reads.calls);
+  }
+
+  SECTION("The write-ahead log is told apart") {
+    Connection connection{tmp, FLAGS, vfs.name()};
+    connection.execute("PRAGMA journal_mode=WAL;"
+                       "CREATE TABLE valid (a INTEGER PRIMARY KEY, b);"
+                       "INSERT INTO valid VALUES (1, 'one');");
+    auto stats = vfs.stats(connection);
+    CHECK(stats[FileKind::Wal].writes.calls > 0);
+    std::filesystem::remove(tmp.string() + "-wal");
+    std::filesystem::remove(tmp.string() + "-shm");
+  }
+
+#ifdef POSIX_FADV_WILLNEED
+  SECTION("Sequential reads trigger read-ahead") {
+    Connection{tmp, FLAGS, vfs.name()}.execute(
+      "CREATE TABLE valid (a INTEGER PRIMARY KEY, b);"
+      "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 2000)"
+      "INSERT INTO valid SELECT i, randomblob(1000) FROM n;");
+    Connection reader{tmp, FLAGS, vfs.name()};
+    CHECK(reader.prepare("SELECT sum(length(b)) FROM valid;").execute().fetchColumn(0)->getInteger() == 2000000);
+    auto stats = vfs.stats(reader)[FileKind::Main];
+    CHECK(stats.readAheads > 0);
+    CHECK(stats.readAheadBytes >= StatsVfs::DEFAULT_READ_AHEAD);
+  }
+#endif
+
+#if defined(POSIX_FADV_WILLNEED) && defined(F_OFD_GETLK)
+  SECTION("Closing a connection keeps the locks of the others") {
+    Connection{tmp, FLAGS, vfs.name()}.execute("CREATE TABLE valid (a);INSERT INTO valid VALUES (1);");
+    // The locks of connections using the default VFS are not seen by this one.
+    for (auto otherVfs : {false, true}) {
+      auto reader = otherVfs ? Connection{tmp} : Connection{tmp, FLAGS, vfs.name()};
+      reader.execute("BEGIN;SELECT count(*) FROM valid;");
+      {
+        Connection other{tmp, FLAGS, vfs.name()};
+        CHECK(other.prepare("SELECT a FROM valid;").execute().fetchColumn(0)->getInteger() == 1);
+      }
+      // Locks of open file descriptions conflict with the POSIX locks of the same process, unlike POSIX locks.
+      auto descriptor = ::open(tmp.c_str(), O_RDONLY | O_CLOEXEC); // NOLINT(cppcoreguidelines-pro-type-vararg)
+      REQUIRE(descriptor >= 0);
+      struct flock shared {};
+      shared.l_type = F_WRLCK;
+      shared.l_whence = SEEK_SET;
+      shared.l_start = 0x40000002; // The shared byte range of the lock page, after the pending and reserved bytes.
+      shared.l_len = 510;
+      CHECK(::fcntl(descriptor, F_OFD_GETLK, &shared) == 0); // NOLINT(cppcoreguidelines-pro-type-vararg)
+      CHECK(shared.l_type == F_RDLCK);
+      reader.execute("COMMIT;");
+      ::close(descriptor);
+    }
+  }
+#endif
+
+  SECTION("Errors") {
+    CHECK_THROWS_AS(StatsVfs("y2kaoz-stats-missing", 0, "no such vfs"), Exception);
+    CHECK_THROWS_AS(vfs.stats(Connection{tmp}), std::invalid_argument);
+  }
+
+  std::filesystem::remove(tmp);
+}
@@ -0,0 +1,37 @@
+#include "Y2KaoZ/Database/StringPool.hpp"
+#include <catch2/catch_all.hpp>
+#include <stdexcept>
+#include <string>
+
+TEST_CASE("String pools") { // NOLINT
+  using Y2KaoZ::Database::StringPool;
+
+  StringPool pool;
+  CHECK(pool.size() == 0);
+  CHECK(!pool.find("open"));
+
+  auto open = pool.intern("open");
+  auto closed = pool.intern(std::string("closed"));
+  CHECK(open == 0);
+  CHECK(closed == 1);
+  CHECK(pool.intern("open") == open);
+  CHECK(pool.intern("") == 2);
+  CHECK(pool.find("closed") == closed);
+
+  CHECK(pool.size() == 3);
+  CHECK(pool.bytes() == 10);
+  CHECK(pool.view(open) == "open");
+  CHECK(pool.view(2).empty());
+  CHECK_THROWS_AS(pool.view(3), std::out_of_range);
+  CHECK(pool.dictionary() == std::vector<std::string_view>{"open", "closed", ""});
+
+  SECTION("Views stay valid while the pool grows") {
+    auto first = pool.view(open);
+    for (int i = 0; i < 10000; ++i) {
+      static_cast<void>(pool.intern(std::to_string(i)));
+    }
+    CHECK(first.data() == pool.view(open).data());
+    CHECK(pool.view(open) == "open");
+    CHECK(pool.size() == 10003);
+  }
+}
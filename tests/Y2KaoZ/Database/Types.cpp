@@ -1,8 +1,33 @@
 #include "Y2KaoZ/Database/Types.hpp"
+#include <array>
 #include <catch2/catch_all.hpp>
 #include <catch2/catch_approx.hpp>
+#include <cmath>
+#include <memory_resource>
 #include <stdexcept>
 
+namespace {
+
+// Counts the allocations made through it, served by the default resource.
+class CountingResource : public std::pmr::memory_resource {
+public:
+  std::size_t allocations = 0;
+
+private:
+  auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override {
+    ++allocations;
+    return std::pmr::get_default_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override {
+    std::pmr::get_default_resource()->deallocate(pointer, bytes, alignment);
+  }
+  [[nodiscard]] auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override {
+    return this == &other;
+  }
+};
+
+} // namespace
+
 TEST_CASE("ResultType Creation") { // NOLINT
 
   SECTION("The default constructor") {
@@ -275,4 +300,198 @@ TEST_CASE("ResultType Creation") { // NOLINT
     CHECK(resultType.asBlob()[2] == std::byte(0x03));
     CHECK(resultType.asBlob()[3] == std::byte(0x04));
   }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Stable value hashes") { // NOLINT
+  using Y2KaoZ::Database::BlobType;
+  using Y2KaoZ::Database::hashValue;
+  using Y2KaoZ::Database::NullValue;
+  using Y2KaoZ::Database::ParamType;
+  using Y2KaoZ::Database::ResultType;
+
+  CHECK(hashValue(ParamType{std::int8_t{5}}) == hashValue(ParamType{std::uint64_t{5}}));
+  CHECK(hashValue(ParamType{std::int32_t{5}}) == hashValue(ResultType(std::int64_t{5})));
+  CHECK(hashValue(ParamType{2.5F}) == hashValue(ResultType(2.5)));
+  CHECK(hashValue(ParamType{std::string{"5"}}) == hashValue(ResultType("5")));
+  CHECK(hashValue(ParamType{NullValue}) == hashValue(ResultType{}));
+  CHECK(hashValue(ParamType{BlobType{std::byte{1}}}) == hashValue(ResultType(BlobType{std::byte{1}})));
+  CHECK(hashValue(ParamType{std::string{"5"}}) != hashValue(ParamType{5}));
+  CHECK(hashValue(ParamType{std::string{"\x01"}}) != hashValue(ParamType{BlobType{std::byte{1}}}));
+}
+
+TEST_CASE("Locale independent conversions") { // NOLINT
+  using Y2KaoZ::Database::BlobType;
+  using Y2KaoZ::Database::ResultType;
+  using Y2KaoZ::Database::ResultVector;
+
+  SECTION("Integers from text") {
+    CHECK(ResultType("  -42").asInteger64() == -42);
+    CHECK(ResultType("+42abc").asInteger64() == 42);
+    CHECK(ResultType("0x1F").asInteger64() == 31);
+    CHECK(ResultType("-0x10").asInteger64() == -16);
+    CHECK(ResultType("010").asInteger64() == 8);
+    CHECK(ResultType("1234567890123456789").asInteger64() == 1234567890123456789);
+    CHECK(ResultType("9223372036854775807").asInteger64() == INT64_MAX);
+    CHECK(ResultType("-9223372036854775808").asInteger64() == INT64_MIN);
+    CHECK(ResultType("00000000000000000000000000042").asInteger64() == 34);
+    CHECK(ResultType("12345678").asInteger64() == 12345678);
+    CHECK(ResultType("123456789012").asInteger64() == 123456789012);
+    CHECK(ResultType("1234567890123456x").asInteger64() == 1234567890123456);
+    CHECK(ResultType("12345678 9").asInteger64() == 12345678);
+    CHECK_THROWS_AS(ResultType("9223372036854775808").asInteger64(), std::out_of_range);
+    CHECK_THROWS_AS(ResultType("99999999999999999999").asInteger64(), std::out_of_range);
+    CHECK_THROWS_AS(ResultType("-").asInteger64(), std::invalid_argument);
+    CHECK_THROWS_AS(ResultType(1e300).asInteger64(), std::out_of_range);
+  }
+
+  SECTION("Reals from text") {
+    CHECK(ResultType(" 2.5").asReal() == 2.5);
+    CHECK(ResultType("+1e3").asReal() == 1000.0);
+    CHECK(ResultType("-0x1p4").asReal() == -16.0);
+    CHECK(std::isinf(ResultType("inf").asReal()));
+    CHECK_THROWS_AS(ResultType("1e999").asReal(), std::out_of_range);
+    CHECK_THROWS_AS(ResultType(".").asReal(), std::invalid_argument);
+    CHECK_THROWS_AS(ResultType("--5").asReal(), std::invalid_argument);
+    CHECK_THROWS_AS(ResultType("+-5").asReal(), std::invalid_argument);
+    CHECK_THROWS_AS(ResultType("-+5").asReal(), std::invalid_argument);
+  }
+
+  SECTION("Shortest round trip text") {
+    CHECK(ResultType(3.14).asString() == "3.14");
+    CHECK(ResultType(0.1).asString() == "0.1");
+    CHECK(ResultType(-1.0).asString() == "-1");
+    CHECK(ResultType(std::int64_t{INT64_MIN}).asString() == "-9223372036854775808");
+  }
+
+  SECTION("Non throwing conversions") {
+    CHECK(ResultType().tryAsInteger64() == 0);
+    CHECK(ResultType("300").tryAsInteger16() == 300);
+    CHECK(!ResultType("300").tryAsInteger8());
+    CHECK(!ResultType("-1").tryAsUnsigned64());
+    CHECK(ResultType("255").tryAsUnsigned8() == 255);
+    CHECK(!ResultType("hello").tryAsInteger64());
+    CHECK(!ResultType("hello").tryAsReal());
+    CHECK(!ResultType(BlobType(3)).tryAsInteger64());
+    CHECK(ResultType("1.5").tryAsReal() == 1.5);
+  }
+
+  SECTION("Bulk column conversions") {
+    std::vector<ResultVector> rows;
+    for (int i = 0; i < 100; ++i) {
+      rows.push_back({ResultType(std::to_string(i * 1000003)), ResultType(std::to_string(i) + ".5")});
+    }
+    rows.push_back({ResultType("x"), ResultType()});
+    auto integers = Y2KaoZ::Database::columnAsInteger64(rows, 0);
+    auto reals = Y2KaoZ::Database::columnAsReal(rows, 1);
+    REQUIRE(integers.size() == 101);
+    REQUIRE(reals.size() == 101);
+    for (int i = 0; i < 100; ++i) {
+      CHECK(integers[static_cast<std::size_t>(i)] == std::int64_t{i} * 1000003);
+      CHECK(reals[static_cast<std::size_t>(i)] == i + 0.5);
+    }
+    CHECK(!integers[100]);
+    CHECK(reals[100] == 0.0);
+    CHECK_THROWS_AS(Y2KaoZ::Database::columnAsReal(rows, 2), std::out_of_range);
+  }
+}
+
+TEST_CASE("Compact cells") { // NOLINT
+  using Y2KaoZ::Database::BlobType;
+  using Y2KaoZ::Database::ResultType;
+
+  CHECK(sizeof(ResultType) == 24);
+
+  SECTION("Short and long values round trip") {
+    std::string shortText(ResultType::INLINE_CAPACITY, 's');
+    std::string longText(ResultType::INLINE_CAPACITY + 1, 'l');
+    CHECK(ResultType(shortText).getString() == shortText);
+    CHECK(ResultType(longText).getString() == longText);
+    CHECK(ResultType::fromText(longText).asString() == longText);
+
+    auto integer = ResultType(std::int64_t{42}).asBlob();
+    CHECK(ResultType(integer).getBlob().size() == sizeof(std::int64_t));
+    CHECK(ResultType(integer).asInteger64() == 42);
+    BlobType longBlob(100, std::byte{7});
+    CHECK(ResultType::fromBlob(longBlob).asBlob() == longBlob);
+  }
+
+  SECTION("Copies and moves keep the value") {
+    std::string longText(100, 'l');
+    ResultType original(longText);
+    ResultType copy(original);
+    CHECK(copy.getString() == longText);
+    CHECK(copy.stringView().data() != original.stringView().data());
+    ResultType moved(std::move(copy));
+    CHECK(moved.getString() == longText);
+    CHECK(copy.isNull()); // NOLINT(bugprone-use-after-move)
+
+    ResultType assigned(std::int64_t{1});
+    assigned = original;
+    CHECK(assigned.getString() == longText);
+    assigned = ResultType(2.5);
+    CHECK(assigned.getReal() == 2.5);
+    assigned.getReal() = 3.5;
+    CHECK(assigned.asReal() == 3.5);
+  }
+
+  SECTION("Long values are allocated from the memory resource of their container") {
+    std::array<std::byte, 4096> buffer{};
+    std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size(), std::pmr::null_memory_resource()};
+    std::pmr::vector<ResultType> cells(&arena);
+    cells.reserve(2);
+    cells.emplace_back(std::string(100, 'l'));
+    cells.emplace_back(ResultType::fromText(std::string(100, 'm'), &arena));
+    CHECK(cells[0].get_allocator().resource() == &arena);
+    for (const auto& cell : cells) {
+      auto* data = reinterpret_cast<const std::byte*>(cell.stringView().data()); // NOLINT
+      CHECK(data >= buffer.data());
+      CHECK(data < buffer.data() + buffer.size()); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    ResultType copy(cells[1]);
+    CHECK(copy.get_allocator().resource() == std::pmr::get_default_resource());
+    CHECK(copy.getString() == std::string(100, 'm'));
+  }
+
+  SECTION("getString and getBlob keep returning std::string and BlobType") {
+    std::array<std::byte, 4096> buffer{};
+    std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size(), std::pmr::null_memory_resource()};
+    std::pmr::vector<ResultType> cells(&arena);
+    cells.emplace_back(std::string("short"));
+    cells.emplace_back(BlobType(100, std::byte{1}));
+
+    const auto& constCell = cells[0];
+    const std::string& text = constCell.getString();
+    CHECK(std::string_view(text.c_str()) == "short");
+    cells[0].getString() += std::string(100, '!');
+    CHECK(cells[0].stringView() == "short" + std::string(100, '!'));
+    CHECK(cells[0].asString().size() == 105);
+    std::string& owned = cells[0].getString();
+    CHECK(&owned == &cells[0].getString());
+    auto* data = reinterpret_cast<const std::byte*>(&owned); // NOLINT
+    CHECK(data >= buffer.data());
+    CHECK(data < buffer.data() + buffer.size()); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+    cells[1].getBlob().push_back(std::byte{2});
+    CHECK(cells[1].blobView().size() == 101);
+    CHECK(cells[1].getBlob().back() == std::byte{2});
+    ResultType copy(cells[1]);
+    cells[1].getBlob().clear();
+    CHECK(copy.getBlob().size() == 101);
+    CHECK(copy.getBlob() == copy.asBlob());
+    CHECK_THROWS_AS(cells[1].getString(), std::bad_variant_access);
+  }
+
+  SECTION("Only the first call to the non-const getString and getBlob allocates") {
+    CountingResource counting;
+    std::pmr::vector<ResultType> cells(&counting);
+    cells.reserve(2);
+    cells.emplace_back(std::string("short"));
+    cells.emplace_back(BlobType(4, std::byte{1}));
+    counting.allocations = 0;
+    for (int i = 0; i < 3; ++i) {
+      CHECK(cells[0].getString() == "short");
+      CHECK(cells[1].getBlob().size() == 4);
+    }
+    CHECK(counting.allocations == 2);
+  }
+}
@@ -0,0 +1,165 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/KvStore.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Statement.hpp"
+#include "Y2KaoZ/Database/Sql/Sqlite3/Transaction.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <fmt/format.h>
+#include <numeric>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Compares the KvStore fast path with the same operations run through Statement, on a temporary database, and prints
+// the time per operation of both.
+
+namespace {
+
+using Y2KaoZ::Database::BlobView;
+using Y2KaoZ::Database::ParamType;
+using Y2KaoZ::Database::ParamVector;
+using Y2KaoZ::Database::Sql::Sqlite3::Connection;
+using Y2KaoZ::Database::Sql::Sqlite3::KvEntry;
+using Y2KaoZ::Database::Sql::Sqlite3::KvStore;
+using Y2KaoZ::Database::Sql::Sqlite3::Transaction;
+using Clock = std::chrono::steady_clock;
+
+void usage() {
+  fmt::print(stderr, "usage: Y2KaoZDatabaseKvBenchmark [--entries N] [--value-size BYTES]\n");
+}
+
+[[nodiscard]] auto parse(std::string_view value, std::size_t& result) -> bool {
+  return std::from_chars(value.data(), value.data() + value.size(), result).ec == std::errc{};
+}
+
+template <typename Task>
+[[nodiscard]] auto time(std::size_t operations, Task task) -> double {
+  auto start = Clock::now();
+  task();
+  return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(operations);
+}
+
+void removeDatabase(const std::filesystem::path& database) {
+  for (const auto* suffix : {"", "-wal", "-shm"}) {
+    std::filesystem::remove(database.string() + suffix);
+  }
+}
+
+void report(std::string_view operation, double statement, double store) {
+  fmt::print("{:<12} {:>14.1f} {:>14.1f} {:>9.2f}x\n", operation, statement, store, statement / store);
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+  std::span arguments(argv, static_cast<std::size_t>(argc));
+  std::size_t entries = 100000;
+  std::size_t valueSize = 100;
+  for (std::size_t i = 1; i < arguments.size(); ++i) {
+    std::string_view argument = arguments[i];
+    if (i + 1 < arguments.size() && argument == "--entries" && parse(arguments[i + 1], entries)) {
+      ++i;
+    } else if (i + 1 < arguments.size() && argument == "--value-size" && parse(arguments[i + 1], valueSize)) {
+      ++i;
+    } else {
+      usage();
+      return EXIT_FAILURE;
+    }
+  }
+
+  auto name = fmt::format("y2kaoz-kv-benchmark-{}.db", std::random_device{}());
+  auto path = std::filesystem::temp_directory_path() / name;
+  try {
+    std::vector<std::string> keys;
+    keys.reserve(entries);
+    for (std::size_t i = 0; i < entries; ++i) {
+      keys.push_back(fmt::format("key:{:012}", i));
+    }
+    std::string value(valueSize, 'v');
+    std::vector<std::size_t> order(entries);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937_64{entries});
+
+    Connection connection(path);
+    connection.execute("PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL; PRAGMA cache_size=-262144;");
+    connection.execute("CREATE TABLE generic (key BLOB NOT NULL PRIMARY KEY, value BLOB NOT NULL) WITHOUT ROWID;");
+    KvStore store(connection);
+    auto insert = connection.prepare("INSERT OR REPLACE INTO generic (key, value) VALUES (?1, ?2);");
+    auto select = connection.prepare("SELECT value FROM generic WHERE key = ?1;");
+    auto scan = connection.prepare("SELECT key, value FROM generic WHERE key >= ?1 ORDER BY key;");
+
+    fmt::print("{} entries of {} bytes, ns per operation\n", entries, valueSize);
+    fmt::print("{:<12} {:>14} {:>14} {:>10}\n", "operation", "Statement", "KvStore", "speedup");
+
+    auto genericPut = time(entries, [&]() {
+      Transaction transaction(connection);
+      for (auto i : order) {
+        insert.bind(ParamVector{ParamType(keys[i]), ParamType(value)}).execute();
+      }
+      transaction.commit();
+    });
+    auto storePut = time(entries, [&]() {
+      Transaction transaction(connection);
+      for (auto i : order) {
+        store.put(keys[i], value);
+      }
+      transaction.commit();
+    });
+    report("put", genericPut, storePut);
+
+    std::vector<KvEntry> batch;
+    batch.reserve(entries);
+    for (auto i : order) {
+      batch.push_back({KvStore::bytes(keys[i]), KvStore::bytes(value)});
+    }
+    report("multiPut", genericPut, time(entries, [&]() { store.multiPut(batch); }));
+
+    std::size_t bytes = 0;
+    auto genericGet = time(entries, [&]() {
+      for (auto i : order) {
+        bytes += select.bind(1, keys[i]).execute().fetchColumn(0)->getString().size();
+        select.reset();
+      }
+    });
+    auto storeGet = time(entries, [&]() {
+      for (auto i : order) {
+        bytes += store.get(keys[i])->size();
+      }
+      store.release();
+    });
+    report("get", genericGet, storeGet);
+
+    std::vector<BlobView> lookups;
+    lookups.reserve(entries);
+    for (auto i : order) {
+      lookups.push_back(KvStore::bytes(keys[i]));
+    }
+    report("multiGet", genericGet, time(entries, [&]() {
+             store.multiGet(lookups, [&](std::size_t, std::optional<BlobView> found) { bytes += found->size(); });
+           }));
+
+    auto genericScan = time(entries, [&]() {
+      scan.bind(1, std::string("key:")).execute();
+      while (auto row = scan.fetchVector()) {
+        bytes += row->at(1).stringView().size();
+      }
+    });
+    auto storeScan = time(entries, [&]() {
+      store.scanPrefix(KvStore::bytes("key:"), [&](BlobView, BlobView found) {
+        bytes += found.size();
+        return true;
+      });
+    });
+    report("scan", genericScan, storeScan);
+    fmt::print("{} bytes read\n", bytes);
+  } catch (const std::exception& e) {
+    fmt::print(stderr, "{}\n", e.what());
+    ::removeDatabase(path);
+    return EXIT_FAILURE;
+  }
+  ::removeDatabase(path);
+  return EXIT_SUCCESS;
+}
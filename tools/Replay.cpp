@@ -0,0 +1,89 @@
+#include "Y2KaoZ/Database/Sql/Sqlite3/Replay.hpp"
+#include <charconv>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <span>
+#include <string_view>
+
+// Replays a recording made with Y2KaoZ::Database::Sql::Sqlite3::Recorder against a copy of a database and prints the
+// throughput and the latency percentiles of every statement.
+
+namespace {
+
+void usage() {
+  fmt::print(stderr, "usage: Y2KaoZDatabaseReplay <database> <recording> [--threads N] [--recorded-rate]\n");
+}
+
+[[nodiscard]] auto microseconds(std::chrono::nanoseconds duration) -> double {
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+  using namespace Y2KaoZ::Database::Sql::Sqlite3;
+  std::span arguments(argv, static_cast<std::size_t>(argc));
+  if (arguments.size() < 3) {
+    usage();
+    return EXIT_FAILURE;
+  }
+  std::filesystem::path database = arguments[1];
+  std::filesystem::path recordingPath = arguments[2];
+  ReplayOptions options;
+  for (std::size_t i = 3; i < arguments.size(); ++i) {
+    std::string_view argument = arguments[i];
+    if (argument == "--recorded-rate") {
+      options.recordedRate = true;
+    } else if (argument == "--threads" && i + 1 < arguments.size()) {
+      std::string_view value = arguments[++i];
+      if (std::from_chars(value.data(), value.data() + value.size(), options.threads).ec != std::errc{}) {
+        usage();
+        return EXIT_FAILURE;
+      }
+    } else {
+      usage();
+      return EXIT_FAILURE;
+    }
+  }
+
+  auto copy = std::filesystem::temp_directory_path() / (database.filename().string() + ".replay");
+  try {
+    auto recording = Recording::load(recordingPath);
+    std::filesystem::copy_file(database, copy, std::filesystem::copy_options::overwrite_existing);
+    auto report = replay(copy, recording, options);
+    std::filesystem::remove(copy);
+
+    fmt::print(
+      "{} calls, {} errors in {:.3f} s: {:.1f} calls/s\n",
+      report.calls,
+      report.errors,
+      report.seconds,
+      report.callsPerSecond());
+    fmt::print(
+      "{:>10} {:>8} {:>12} {:>12} {:>12} {:>12} {:>12}  sql\n",
+      "calls",
+      "errors",
+      "total ms",
+      "p50 us",
+      "p90 us",
+      "p99 us",
+      "max us");
+    for (const auto& stats : report.statements) {
+      fmt::print(
+        "{:>10} {:>8} {:>12.3f} {:>12.1f} {:>12.1f} {:>12.1f} {:>12.1f}  {}\n",
+        stats.calls,
+        stats.errors,
+        microseconds(stats.total) / 1000.0,
+        microseconds(stats.p50),
+        microseconds(stats.p90),
+        microseconds(stats.p99),
+        microseconds(stats.max),
+        stats.sql);
+    }
+  } catch (const std::exception& e) {
+    std::filesystem::remove(copy);
+    fmt::print(stderr, "{}\n", e.what());
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}